@@ -37,6 +37,7 @@
 #include "md_input.h"
 #include "md_event.h"
 #include "md_rtc.h"
+#include "md_timer.h"
 #include "md_watchdog.h"
 #include "md_modbus.h"
 #include "system.h"
@@ -186,11 +187,6 @@ static  void  AppTaskStart (void *p_arg)
     CPU_STK     EEPROMDataTaskStk[EEPROM_DATA_TASK_STK_SIZE];
 #endif
 
-#if SYSTEM_EVENT_TASK_EN >0                       //系统事件功能
-    OS_TCB      SystemEventTaskTCB;
-    CPU_STK     SystemEventTaskStk[SYSTEM_EVENT_TASK_STK_SIZE];
-#endif
-
 #if SYSTEM_MONITOR_TASK_EN >0                    //系统数据监控功能
     OS_TCB      SystemMonitorTaskTCB;
     CPU_STK     SystemMonitorTaskStk[SYSTEM_MONITOR_TASK_STK_SIZE];
@@ -267,6 +263,8 @@ static  void  AppTaskCreate (void)
 
      myprintf("****************************************************************************\n"); 
     
+    vTimerInit();                   //软件定时器时间轮，xTimerRegist之前初始化
+    
 #if OUTPUT_SET_TASK_EN > 0     //IO输出数据接收功能 
     vOutputInit();   
 #endif
@@ -280,7 +278,7 @@ static  void  AppTaskCreate (void)
 #endif
 
 #if SYSTEM_EVENT_TASK_EN >0      //系统事件功能
-    vEventInit(&SystemEventTaskTCB, SYSTEM_EVENT_TASK_PRIO, SystemEventTaskStk, SYSTEM_EVENT_TASK_STK_SIZE);
+    vEventInit();
 #endif
 
 #if SYSTEM_MONITOR_TASK_EN >0    //系统数据监控功能
@@ -300,6 +298,10 @@ static  void  AppTaskCreate (void)
                 &SystemPollTCB,      SYSTEM_POLL_TASK_PRIO,       SystemPollStk,      SYSTEM_POLL_TASK_STK_SIZE); 
 #endif	
 
+#if INPUT_RECEIVE_TASK_EN > 0   //AI校准参数在系统参数之后注册，不改变已有参数ID
+    vInputRegistEEPROMData();
+#endif
+
 #if EEPROM_DATA_TASK_EN >0       //eeprom参数记忆功能
     vEEPROMInit(&EEPROMDataTaskTCB, EEPROM_DATA_TASK_PRIO, EEPROMDataTaskStk, EEPROM_DATA_TASK_STK_SIZE); 
 #endif	
@@ -20,7 +20,7 @@
 #define SEGMENT_TASK_EN            1      //数码管显示功能
 #define EEPROM_DATA_TASK_EN        1      //eeprom参数记忆功能
 
-#define SYSTEM_EVENT_TASK_EN       1      //系统事件功能
+#define SYSTEM_EVENT_TASK_EN       1      //系统事件总线功能
 #define SYSTEM_MONITOR_TASK_EN     1      //系统数据监控功能
 #define SYSTEM_MAIN_CTRL_TASK_EN   1      //系统逻辑控制功能
 
@@ -40,7 +40,6 @@
 #define MB_MASTER_POLL_TASK_PRIO  	  7
 #define MB_MASTER_SCAN_TASK_PRIO  	  8
 
-#define SYSTEM_EVENT_TASK_PRIO        10 
 #define SYSTEM_MONITOR_TASK_PRIO      11
 #define SYSTEM_POLL_TASK_PRIO         12
 
@@ -66,7 +65,6 @@
 #define SEGMENT_TASK_STK_SIZE             128
 #define EEPROM_DATA_TASK_STK_SIZE         128
 
-#define SYSTEM_EVENT_TASK_STK_SIZE        160
 #define SYSTEM_MONITOR_TASK_STK_SIZE      160
 
 #define SYSTEM_POLL_TASK_STK_SIZE	      128
@@ -83,4 +81,29 @@
 #define WATCHDOG_FEED_TASK_STK_SIZE       128
 #define TASK_STACK_WATCH_TASK_STK_SIZE    100 
 
+/****************************设备数量配置**********************************/ 
+#define MODULAR_ROOF_NUM                  2        //屋顶机数量 
+#define MODULAR_NUM                       4        //机组模块数量
+#define SUP_AIR_FAN_NUM                   2        //机组送风机数量
+#define AMBIENT_OUT_FAN_NUM               2        //模块室外风机数量
+#define COMP_NUM                          2        //模块压缩机数量
+
+#define EX_AIR_FAN_NUM                    4        //排风机数量
+#define CO2_SEN_NUM                       3        //CO2传感器数量
+#define TEMP_HUMI_SEN_OUT_NUM             1        //室外温湿度传感器数量
+#define TEMP_HUMI_SEN_IN_NUM              12       //室内温湿度传感器数量
+
+/**************************对象池配置(各类最大实例数)**************************/ 
+/*type##_new从静态对象池取出，超出返回NULL；BMS、System为静态单例，电表暂未实例化*/
+#define ModularRoof_POOL_NUM              MODULAR_ROOF_NUM
+#define SupAirFan_POOL_NUM                MODULAR_ROOF_NUM                           //每台机组一个送风机对象
+#define Modular_POOL_NUM                  (MODULAR_NUM * ModularRoof_POOL_NUM)
+#define AmbientOutFan_POOL_NUM            (AMBIENT_OUT_FAN_NUM * Modular_POOL_NUM)
+#define Compressor_POOL_NUM               (COMP_NUM * Modular_POOL_NUM)
+
+#define ExAirFan_POOL_NUM                 EX_AIR_FAN_NUM
+#define CO2Sensor_POOL_NUM                CO2_SEN_NUM
+#define TempHumiSensor_POOL_NUM           (TEMP_HUMI_SEN_OUT_NUM + TEMP_HUMI_SEN_IN_NUM)
+#define DTU_POOL_NUM                      1
+
 #endif
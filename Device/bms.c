@@ -161,6 +161,35 @@ BOOL xBMS_DevDataMapIndex(eDataType eDataType, USHORT usAddr, USHORT* psIndex)
             case 305:  i = 138;  break;
             case 306:  i = 139;  break;
             case 307:  i = 140;  break;
+            
+            case 310:  i = 141;  break;
+            case 311:  i = 142;  break;
+            case 312:  i = 143;  break;
+            case 313:  i = 144;  break;
+            case 314:  i = 145;  break;
+            case 315:  i = 146;  break;
+            case 316:  i = 147;  break;
+            case 317:  i = 148;  break;
+            case 318:  i = 149;  break;
+            case 319:  i = 150;  break;
+            case 320:  i = 151;  break;
+            
+            case 330:  i = 152;  break;
+            case 331:  i = 153;  break;
+            case 332:  i = 154;  break;
+            case 333:  i = 155;  break;
+            case 334:  i = 156;  break;
+            case 335:  i = 157;  break;
+            case 336:  i = 158;  break;
+            case 337:  i = 159;  break;
+            case 338:  i = 160;  break;
+            case 339:  i = 161;  break;
+            case 340:  i = 162;  break;
+            case 341:  i = 163;  break;
+            case 342:  i = 164;  break;
+            case 343:  i = 165;  break;
+            case 344:  i = 166;  break;
+            case 345:  i = 167;  break;
 
             default:
     	    	return FALSE;
@@ -495,7 +524,38 @@ SLAVE_BEGIN_DATA_BUF(&pThis->sBMS_RegHoldBuf, &pThis->sBMSCommData.sMBRegHoldTab
         
     SLAVE_REG_HOLD_DATA(307,  uint16, 0, 65535, RO, 1, (void*)&pSystem->pExAirFanMeter->usTotalEnergy_H)   
     
-SLAVE_END_DATA_BUF(0, 307)    
+    //控制执行器统计(us/次)：小帧最大执行时间、小帧超时，各任务最大执行时间、最大释放抖动、截止超时
+    SLAVE_REG_HOLD_DATA(310,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.usFrameExecMax_us)
+    SLAVE_REG_HOLD_DATA(311,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.usFrameOverrun)
+    SLAVE_REG_HOLD_DATA(312,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_PARAM_SYNC].usExecMax_us)
+    SLAVE_REG_HOLD_DATA(313,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_PARAM_SYNC].usJitterMax_us)
+    SLAVE_REG_HOLD_DATA(314,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_PARAM_SYNC].usOverrun)
+    SLAVE_REG_HOLD_DATA(315,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_RUNTIME].usExecMax_us)
+    SLAVE_REG_HOLD_DATA(316,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_RUNTIME].usJitterMax_us)
+    SLAVE_REG_HOLD_DATA(317,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_RUNTIME].usOverrun)
+    SLAVE_REG_HOLD_DATA(318,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_MODE].usExecMax_us)
+    SLAVE_REG_HOLD_DATA(319,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_MODE].usJitterMax_us)
+    SLAVE_REG_HOLD_DATA(320,  uint16, 0, 65535, RO, 1, (void*)&pSystem->sCtrlExec.sJobList[SYS_JOB_MODE].usOverrun)
+    
+    //AI通道校准(掉电记忆)：增益4096为1.0，偏移单位10uA
+    SLAVE_REG_HOLD_DATA(330,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[0])
+    SLAVE_REG_HOLD_DATA(331,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[1])
+    SLAVE_REG_HOLD_DATA(332,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[2])
+    SLAVE_REG_HOLD_DATA(333,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[3])
+    SLAVE_REG_HOLD_DATA(334,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[4])
+    SLAVE_REG_HOLD_DATA(335,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[5])
+    SLAVE_REG_HOLD_DATA(336,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[6])
+    SLAVE_REG_HOLD_DATA(337,  uint16, INPUT_CALIB_GAIN_MIN, INPUT_CALIB_GAIN_MAX, RW, 1, (void*)&pThis->usAICalibGain[7])
+    SLAVE_REG_HOLD_DATA(338,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[0])
+    SLAVE_REG_HOLD_DATA(339,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[1])
+    SLAVE_REG_HOLD_DATA(340,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[2])
+    SLAVE_REG_HOLD_DATA(341,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[3])
+    SLAVE_REG_HOLD_DATA(342,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[4])
+    SLAVE_REG_HOLD_DATA(343,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[5])
+    SLAVE_REG_HOLD_DATA(344,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[6])
+    SLAVE_REG_HOLD_DATA(345,   int16, -INPUT_CALIB_OFFSET_MAX, INPUT_CALIB_OFFSET_MAX, RW, 1, (void*)&pThis->sAICalibOffset[7])
+    
+SLAVE_END_DATA_BUF(0, 345)    
     
     /******************************线圈数据域*************************/ 
 SLAVE_BEGIN_DATA_BUF(&pThis->sBMS_BitCoilBuf,  &pThis->sBMSCommData.sMBCoilTable)
@@ -670,10 +730,13 @@ SLAVE_END_DATA_BUF(0, 240)
 /*BMS数据监控*/
 void vBMS_MonitorRegist(BMS* pt)
 {
+    uint8_t n;
+    
     OS_ERR err = OS_ERR_NONE;
     BMS* pThis = (BMS*)pt;
 
     OSSemCreate( &(pThis->sValChange), "sValChange", 0, &err );  //事件消息量初始化
+    EVENT_TOPIC(&pThis->sValChange, TOPIC_BMS)                              //事件主题
     
     MONITOR(&pThis->eSystemMode,  uint8, &pThis->sValChange)
     MONITOR(&pThis->eRunningMode, uint8, &pThis->sValChange)
@@ -703,11 +766,20 @@ void vBMS_MonitorRegist(BMS* pt)
     MONITOR(&pThis->xAlarmClean,       uint8, &pThis->sValChange)
     MONITOR(&pThis->xAlarmEnable,      uint8, &pThis->sValChange)
     MONITOR(&pThis->xExAirFanErrClean, uint8, &pThis->sValChange)
+    
+    for(n=0; n < AI_NUM; n++)
+    {
+        MONITOR(&pThis->usAICalibGain[n],  uint16, &pThis->sValChange)
+        MONITOR(&pThis->sAICalibOffset[n], int16,  &pThis->sValChange)
+    }
 }
 
 /*BMS数据默认值初始化*/
 void vBMS_InitDefaultData(BMS* pt)
 {
+    uint8_t  n;
+    uint32_t ulCalib;
+    
     BMS*    pThis   = (BMS*)pt;
     System* pSystem = (System*)System_Core();
     
@@ -736,6 +808,13 @@ void vBMS_InitDefaultData(BMS* pt)
     DATA_INIT(pThis->eExAirFanType,         pSystem->eExAirFanType)
     DATA_INIT(pThis->xAlarmEnable,          pSystem->xAlarmEnable)
     
+    for(n=0; n < AI_NUM; n++)   //AI通道校准参数，EEPROM恢复后读取
+    {
+        ulCalib = ulAnalogInputGetCalib(n+1);
+        DATA_INIT(pThis->usAICalibGain[n],  (uint16_t)(ulCalib >> 16))
+        DATA_INIT(pThis->sAICalibOffset[n], (int16_t)(ulCalib & 0xFFFF))
+    }
+    
 //    myprintf("ulExAirFanRated_Vol %ld  usExAirFanRated_Vol_H %d  usExAirFanRated_Vol_L %d \n",pSystem->ulExAirFanRated_Vol,
 //              pThis->usExAirFanRated_Vol_H, pThis->usExAirFanRated_Vol_L);
 }
@@ -750,7 +829,7 @@ void vBMS_Init(BMS* pt)
     vBMS_MonitorRegist(pThis);     
 }
 
-CTOR(BMS)   //BMS构造函数
+STATIC_CTOR(BMS)   //BMS构造函数
 
 END_CTOR
 
@@ -5,7 +5,6 @@
 #include "device.h"
 #include "md_monitor.h"
 
-#define   EX_AIR_FAN_NUM     4
 #define   BMS_REG_HOLD_NUM   200    //BMS通讯数据表保持寄存器数量
 #define   BMS_BIT_COIL_NUM   200    //BMS通讯数据表线圈数量
 
@@ -54,6 +53,9 @@ CLASS(BMS)
     BOOL              xAlarmEnable;             //声光报警使能
     BOOL              xExAirFanErrClean;        //排风机故障清除
     
+    uint16_t          usAICalibGain[AI_NUM];    //AI通道校准增益(4096为1.0)
+    int16_t           sAICalibOffset[AI_NUM];   //AI通道校准偏移(10uA)
+    
     sMBSlaveInfo*     psBMSInfo;          //从栈接口
     sMBSlaveCommData  sBMSCommData;       //系统从栈通讯数据表
     
@@ -10,9 +10,11 @@
 #include "mb_m.h"
 #include "mbmap_m.h"
 #include "md_monitor.h"
+#include "md_event.h"
 #include "md_output.h"
 #include "md_input.h"
 #include "md_eeprom.h"
+#include "md_timer.h"
 #include "my_rtt_printf.h"
 
 typedef uint8_t BOOL;
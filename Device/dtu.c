@@ -38,32 +38,20 @@ void vDTU_TimeoutInd(void * p_tmr, void * p_arg)
 }
 
 /*DTU模块初始化定时器*/
-BOOL xDTU_TmrTimeoutInit(DTU* pt, USHORT usTimerout)
+BOOL xDTU_TmrTimeoutInit(DTU* pt)
 {
-	OS_ERR err = OS_ERR_NONE;
 	DTU* pThis = (DTU*)pt;
     
-	ULONG i = usTimerout  * TMR_TICK_PER_SECOND; 
-	
-	OSTmrCreate(&pThis->DTUTimerTimeout,       //主定时器
-			    "DTUTimerTimeout",
-			    i,      
-			    0,
-			    OS_OPT_TMR_ONE_SHOT,
-			    vDTU_TimeoutInd,
-			    (void*)pThis,
-			    &err);
-	return (err == OS_ERR_NONE);
+	return xTimerCreate(&pThis->DTUTimerTimeout, OS_OPT_TMR_ONE_SHOT, vDTU_TimeoutInd, (void*)pThis);   //主定时器，使能时再启动
 }
 
 /*DTU模块定时器使能*/
 void vDTU_TmrTimeoutEnable(DTU* pt)
 {
-	OS_ERR err = OS_ERR_NONE;
     DTU* pThis = (DTU*)pt;
     
 	pThis->ucDTUInited = FALSE;
-    (void)OSTmrStart(&pThis->DTUTimerTimeout, &err);
+    (void)xTmrRearm(&pThis->DTUTimerTimeout, DTU_TIMEOUT_S);
 }	
 
 /*DTU测试*/
@@ -267,7 +255,7 @@ BOOL xDTU_Init(DTU* pt, sMBMasterInfo* psMBMasterInfo)
     
     pThis->psMBMasterInfo->pvDTUScanDevCallBack = vDTU_ScanDev;  //绑定DTU轮询回调函数
     
-    return xDTU_TmrTimeoutInit(pThis, DTU_TIMEOUT_S);    
+    return xDTU_TmrTimeoutInit(pThis);    
 }
 
 CTOR(DTU)   //BMS构造函数
@@ -13,7 +13,7 @@ CLASS(DTU)   /*DTU模块*/
     USHORT*             psDTUInitCmd;
     USHORT*             psDTUInitedCmd;
                         
-    OS_TMR              DTUTimerTimeout;    
+    sTimer              DTUTimerTimeout;    
     UCHAR               ucDTUInited;
                         
     sMBMasterInfo*      psMBMasterInfo;   //通讯主栈
@@ -83,7 +83,7 @@ void vExAirFan_RegistAnalogIO(ExAirFan* pt, uint8_t ucFreq_AO, uint8_t ucFreq_AI
         
         if(pThis->eCtrlCmd == ON && pThis->usRunningFreq != usFreq)
         {
-            vAnalogOutputSetRealVal(pThis->sFreq_AO.ucChannel, usFreq);
+            (void)xAnalogOutputRamp(pThis->sFreq_AO.ucChannel, usFreq, EX_AIR_FAN_FREQ_RAMP_RATE);  //斜坡输出，不阻塞调用任务
         }
 #if DEBUG_ENABLE > 0 
         if(pThis->eFanFreqType == VARIABLE_FREQ )
@@ -247,6 +247,7 @@ void vExAirFan_RegistMonitor(ExAirFan* pt)
     ExAirFan* pThis = (ExAirFan*)pt;
 
     OSSemCreate( &(pThis->sValChange), "sValChange", 0, &err );  //事件消息量初始化
+    EVENT_TOPIC(&pThis->sValChange, TOPIC_EX_AIR_FAN)                       //事件主题
     
     MONITOR(&pThis->xExAirFanErr,         uint8, &pThis->sValChange)
     MONITOR(&pThis->xExAirFanRemote,      uint8, &pThis->sValChange)
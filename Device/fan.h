@@ -6,6 +6,8 @@
 #define MIN_FAN_FREQ   100
 #define MAX_FAN_FREQ   500
 
+#define EX_AIR_FAN_FREQ_RAMP_RATE   50    //频率输出斜坡速率，每秒变化量 = 实际值*10
+
 typedef enum   /*系统状态*/
 {
     MODE_REAL_TIME   = 0,        //实时新风量 
@@ -73,7 +75,7 @@ CLASS(ExAirFan)           /*排风风机*/
     BOOL         xExAirFanCtrl;     //有无风机控制
     
     OS_SEM       sValChange;        //变量变化事件
-    OS_TMR       sExAirFanTmr;      //风机内部定时器
+    sTimer       sExAirFanTmr;      //风机内部定时器
     
     void (*init)(ExAirFan* pt, const sFanInfo* psFan, uint8_t ucDevIndex);
     void (*changeFreqType)(ExAirFan* pt, const sFanInfo* psFan);    
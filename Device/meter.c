@@ -11,6 +11,7 @@ void vMeter_RegistMonitor(Meter* pt)
     Meter* pThis = (Meter*)pt;
     
     OSSemCreate( &(pThis->sValChange), "sValChange", 0, &err );  //事件消息量初始化
+    EVENT_TOPIC(&pThis->sValChange, TOPIC_METER)                            //事件主题
 
     MONITOR(&pThis->usTotalEnergy_H, uint16, &pThis->sValChange)
 }
@@ -30,31 +31,14 @@ void vMeter_RegistDev(Meter* pt)
     (void)xMBMasterRegistDev(pThis->psMBMasterInfo, &pThis->sMBSlaveDev);
 }
 
-/*通讯映射函数*/
-BOOL xMeter_DevDataMapIndex(eDataType eDataType, UCHAR ucProtocolID, USHORT usAddr, USHORT* psIndex)
+/*保持寄存器点位描述，传输因子为实例通讯地址，由fMeter_RegHoldMultiple按实例给出*/
+static const sMasterRegHoldDesc MeterRegHoldDesc[] = 
 {
-    USHORT i = 0;
-    switch(ucProtocolID)
-	{
-        case 0:
-            if(eDataType == RegHoldData)
-            {
-                switch(usAddr)
-                {
-                    case 1	  :  i = 0 ;  break;
-                    case 0X30 :  i = 1 ;  break;
-                       
-                    default:
-                		return FALSE;
-                	break;
-                }
-            }
-        break;
-        default: break;
-	}
-    *psIndex = i;
-    return TRUE;
-}
+    MASTER_REG_HOLD_DESC(0x30, uint8, 1, 255, 0, RW, 1, 0, Meter, sMBSlaveDev.ucDevAddr)
+};
+MASTER_REG_HOLD_DESC_CHECK(MeterRegHoldDesc, METER_REG_HOLD_NUM)
+
+static UCHAR MeterRegHoldAddrIndex[0x30 - 0x30 + 1];  //保持寄存器地址索引表，容量不小于地址跨度(0x30)
 
 /*通讯数据表初始化*/
 void vMeter_InitDevCommData(Meter* pt)
@@ -62,19 +46,17 @@ void vMeter_InitDevCommData(Meter* pt)
     Meter* pThis = (Meter*)pt;
     sMBTestDevCmd* psMBCmd = &pThis->sDevCommData.sMBDevCmdTable;
     
-    
-MASTER_PBUF_INDEX_ALLOC()
 MASTER_TEST_CMD_INIT(psMBCmd, 0x30, READ_REG_HOLD, pThis->sMBSlaveDev.ucDevAddr, FALSE)  
     
     /******************************保持寄存器数据域*************************/
-MASTER_BEGIN_DATA_BUF(&pThis->sMeter_RegHoldBuf, &pThis->sDevCommData.sMBRegHoldTable; )
+    pThis->pvMeter_RegHoldObj[0] = pThis;
+MASTER_REG_HOLD_TABLE(&pThis->sDevCommData.sMBRegHoldTable, MeterRegHoldDesc, MeterRegHoldAddrIndex,
+                      pThis->pvMeter_RegHoldObj, pThis->usMeter_RegHoldPreVal, pThis->ucMeter_RegHoldPending)
     
-    MASTER_REG_HOLD_DATA(0x30, uint8, 1, 255, 0, RW, pThis->sMBSlaveDev.ucDevAddr, (void*)&pThis->sMBSlaveDev.ucDevAddr)
-        
-MASTER_END_DATA_BUF(1, 0x30)
+    pThis->fMeter_RegHoldMultiple[0] = (float)pThis->sMBSlaveDev.ucDevAddr;
+MASTER_REG_HOLD_MULTIPLE(&pThis->sDevCommData.sMBRegHoldTable, pThis->fMeter_RegHoldMultiple)
 
     pThis->sDevCommData.ucProtocolID = 0;
-    pThis->sDevCommData.pxDevDataMapIndex = xMeter_DevDataMapIndex;    //绑定映射函数
     pThis->sMBSlaveDev.psDevDataInfo = &(pThis->sDevCommData);
 }
 
@@ -99,7 +81,7 @@ void vMeter_Init(Meter* pt, sMBMasterInfo* psMBMasterInfo)
 }
 
 
-CTOR(Meter)    //电表构造函数
+STATIC_CTOR(Meter)    //电表构造函数
     SUPER_CTOR(Device); 
     FUNCTION_SETTING(init, vMeter_Init);
 END_CTOR
\ No newline at end of file
@@ -21,7 +21,10 @@ CLASS(Meter)          /*电表*/
     sMBSlaveDevCommData  sDevCommData;     //通讯数据表
     sMBSlaveDev          sMBSlaveDev;      //本通讯设备
     
-    sMasterRegHoldData   sMeter_RegHoldBuf[METER_REG_HOLD_NUM];  //保持寄存器数据域
+    USHORT               usMeter_RegHoldPreVal[METER_REG_HOLD_NUM];                    //保持寄存器先前值
+    UCHAR                ucMeter_RegHoldPending[MB_BITMAP_BYTES(METER_REG_HOLD_NUM)];  //保持寄存器待写入位图
+    void*                pvMeter_RegHoldObj[1];                                        //保持寄存器所属对象
+    float                fMeter_RegHoldMultiple[METER_REG_HOLD_NUM];                   //保持寄存器本实例传输因子
    
     void (*init)(Meter* pt, sMBMasterInfo* psMBMasterInfo); 
 };
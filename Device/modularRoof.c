@@ -8,6 +8,9 @@
 #define MODULAR_TIME_OUT_S              5
 #define MODULAR_TIME_OUT_DELAY_S        20
 
+#define MODULAR_ROOF_OBJ_SELF           0     //保持寄存器变量所属对象：机组
+#define MODULAR_ROOF_OBJ_MODULAR        1     //保持寄存器变量所属对象：模块，按模块序号递增
+
 /*************************************************************
 *                         模块                               *
 **************************************************************/
@@ -106,46 +109,8 @@ BOOL xModularRoof_DevDataMapIndex(eDataType eDataType, UCHAR ucProtocolID, USHOR
     USHORT i = 0;
     switch(ucProtocolID)
 	{
-        case MODULAR_ROOF_PROTOCOL_TYPE_ID:
-            if(eDataType == RegHoldData)
-            {
-                switch(usAddr)
-                {
-                    case 0 :  i = 0 ;  break;
-                    case 2 :  i = 1 ;  break;
-                    case 3 :  i = 2 ;  break;
-                    case 5 :  i = 3 ;  break;
-                    case 6 :  i = 4 ;  break;
-                    case 8 :  i = 5 ;  break;
-                    case 9 :  i = 6 ;  break;
-                    case 10:  i = 7 ;  break;
-                    case 11:  i = 8 ;  break;
-                    case 12:  i = 9 ;  break;
-                    case 16:  i = 10;  break;
-                    case 17:  i = 11;  break;
-                    case 18:  i = 12;  break;
-                    case 37:  i = 13;  break;
-                    case 38:  i = 14;  break;
-                    case 39:  i = 15;  break;
-                    case 40:  i = 16;  break;
-                    case 44:  i = 17;  break;
-                    case 45:  i = 18;  break;
-                    case 46:  i = 19;  break;
-                    case 47:  i = 20;  break;
-                    case 48:  i = 21;  break;
-                    case 49:  i = 22;  break;
-                    case 51:  i = 23;  break;
-                    case 52:  i = 24;  break;
-                    case 53:  i = 25;  break;
-                    case 54:  i = 26;  break;
-                    case 55:  i = 27;  break;
-
-                    default:
-                		return FALSE;
-                	break;
-                }
-            }
-            else if(eDataType == CoilData)
+        case MODULAR_ROOF_PROTOCOL_TYPE_ID:  //保持寄存器由点位描述表生成地址索引，此处只映射线圈
+            if(eDataType == CoilData)
             {
                 switch(usAddr)
                 {
@@ -201,9 +166,46 @@ BOOL xModularRoof_DevDataMapIndex(eDataType eDataType, UCHAR ucProtocolID, USHOR
     return TRUE;
 }
 
+/*保持寄存器点位描述，同协议机组共用，地址须严格递增，保持寄存器映射与轮询由此表生成*/
+static const sMasterRegHoldDesc ModularRoofRegHoldDesc[] = 
+{
+    MASTER_REG_HOLD_DESC(0,  uint16, 0,           65535,                   0x302A, RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usUnitID)
+    MASTER_REG_HOLD_DESC(2,  uint8,  85,          170,                     0x55,   RW, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, eSwitchState)
+    MASTER_REG_HOLD_DESC(3,  uint8,  1,           4,                       1,      RW, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, eRunningMode)
+    MASTER_REG_HOLD_DESC(5,  uint16, 160,         350,                     260,    RW, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usCoolTempSet)
+    MASTER_REG_HOLD_DESC(6,  uint16, 160,         350,                     200,    RW, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usHeatTempSet)
+    MASTER_REG_HOLD_DESC(8,  uint16, 0,           MODULAR_MAX_FRE_AIR_VOL, 30000,  WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usFreAirSet_Vol)
+    MASTER_REG_HOLD_DESC(9,  uint16, 0,           100,                     55,     WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usHumidityMin)
+    MASTER_REG_HOLD_DESC(10, uint16, 0,           100,                     65,     WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usHumidityMax)
+    MASTER_REG_HOLD_DESC(11, uint16, 0,           5000,                    2700,   WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usCO2AdjustThr_V)
+    MASTER_REG_HOLD_DESC(12, uint16, 5,           500,                     50,     WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usCO2AdjustDeviat)
+    MASTER_REG_HOLD_DESC(16, int16,  MIN_IN_TEMP, MAX_IN_TEMP,             0,      WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, sAmbientIn_T)
+    MASTER_REG_HOLD_DESC(17, uint16, MIN_HUMI,    MAX_HUMI,                0,      WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usAmbientIn_H)
+    MASTER_REG_HOLD_DESC(18, uint16, MIN_CO2_PPM, MAX_CO2_PPM,             0,      WO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usCO2PPM)
+    MASTER_REG_HOLD_DESC(37, uint8,  0,           5,                       0,      RO, 1, MODULAR_ROOF_OBJ_MODULAR + 0, Modular,     ucModularState)
+    MASTER_REG_HOLD_DESC(38, uint8,  0,           5,                       0,      RO, 1, MODULAR_ROOF_OBJ_MODULAR + 1, Modular,     ucModularState)
+    MASTER_REG_HOLD_DESC(39, uint8,  0,           5,                       0,      RO, 1, MODULAR_ROOF_OBJ_MODULAR + 2, Modular,     ucModularState)
+    MASTER_REG_HOLD_DESC(40, uint8,  0,           5,                       0,      RO, 1, MODULAR_ROOF_OBJ_MODULAR + 3, Modular,     ucModularState)
+    MASTER_REG_HOLD_DESC(44, int16,  -200,        1400,                    0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, sRetAir_T)
+    MASTER_REG_HOLD_DESC(45, int16,  -200,        1400,                    0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, sSupAir_T)
+    MASTER_REG_HOLD_DESC(46, int16,  -400,        700,                     0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, sAmbientInSelf_T)
+    MASTER_REG_HOLD_DESC(47, uint16, 0,           100,                     0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usAmbientInSelf_H)
+    MASTER_REG_HOLD_DESC(48, int16,  -400,        700,                     0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, sAmbientOutSelf_T)
+    MASTER_REG_HOLD_DESC(49, uint16, 0,           100,                     0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usAmbientOutSelf_H)
+    MASTER_REG_HOLD_DESC(51, uint16, 0,           1000,                    1000,   RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usFreAirDamper_Ang)
+    MASTER_REG_HOLD_DESC(52, uint16, 0,           5000,                    0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usCO2PPMSelf)
+    MASTER_REG_HOLD_DESC(53, uint16, 0,           65000,                   0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usFreAir_Vol)
+    MASTER_REG_HOLD_DESC(54, uint16, 0,           65000,                   0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usSupAir_Vol)
+    MASTER_REG_HOLD_DESC(55, uint16, 0,           65000,                   0,      RO, 1, MODULAR_ROOF_OBJ_SELF,        ModularRoof, usRetAir_Vol)
+};
+MASTER_REG_HOLD_DESC_CHECK(ModularRoofRegHoldDesc, MODULAR_ROOF_REG_HOLD_NUM)
+
+static UCHAR ModularRoofRegHoldAddrIndex[55 - 0 + 1];  //保持寄存器地址索引表，容量不小于地址跨度(0~55)
+
 /*机组通讯数据表初始化*/
 void vModularRoof_InitDevCommData(ModularRoof* pt)
 {
+    uint8_t      n     = 0;
     ModularRoof* pThis = (ModularRoof*)pt;
     
 MASTER_PBUF_INDEX_ALLOC()
@@ -212,43 +214,13 @@ MASTER_TEST_CMD_INIT(&pThis->sDevCommData.sMBDevCmdTable, 0, READ_REG_HOLD, 0x30
 MASTER_HEART_BEAT_INIT(&pThis->sDevCommData.sMBDevHeartBeat, 0, READ_REG_HOLD, 0x302A, MODULAR_HEART_BEAT_PERIOD_S, TRUE)  //心跳帧
     
     /******************************保持寄存器数据域*************************/
-MASTER_BEGIN_DATA_BUF(&pThis->sModularRoof_RegHoldBuf, &pThis->sDevCommData.sMBRegHoldTable)
-    
-    MASTER_REG_HOLD_DATA(0, uint16,    0, 65535,  0x302A,  RO, 1, (void*)&pThis->usUnitID)
-    MASTER_REG_HOLD_DATA(2,  uint8,   85,   170,    0x55,  RW, 1, (void*)&pThis->eSwitchState)
-    MASTER_REG_HOLD_DATA(3,  uint8,    1,     4,       1,  RW, 1, (void*)&pThis->eRunningMode)
-    MASTER_REG_HOLD_DATA(5, uint16,  160,   350,     260,  RW, 1, (void*)&pThis->usCoolTempSet) 
-    MASTER_REG_HOLD_DATA(6, uint16,  160,   350,     200,  RW, 1, (void*)&pThis->usHeatTempSet)
-
-    MASTER_REG_HOLD_DATA(8,  uint16,   0, MODULAR_MAX_FRE_AIR_VOL,  30000,  WO, 1, (void*)&pThis->usFreAirSet_Vol)
-    MASTER_REG_HOLD_DATA(9,  uint16,   0,   100,                       55,  WO, 1, (void*)&pThis->usHumidityMin)
-    MASTER_REG_HOLD_DATA(10, uint16,   0,   100,                       65,  WO, 1, (void*)&pThis->usHumidityMax)
-    MASTER_REG_HOLD_DATA(11, uint16,   0,  5000,                     2700,  WO, 1, (void*)&pThis->usCO2AdjustThr_V) 
-    MASTER_REG_HOLD_DATA(12, uint16,   5,   500,                       50,  WO, 1, (void*)&pThis->usCO2AdjustDeviat)
-     
-    MASTER_REG_HOLD_DATA(16,  int16,    MIN_IN_TEMP,  MAX_IN_TEMP,  0,  WO, 1, (void*)&pThis->sAmbientIn_T)
-    MASTER_REG_HOLD_DATA(17, uint16,    MIN_HUMI,     MAX_HUMI,     0,  WO, 1, (void*)&pThis->usAmbientIn_H)
-    MASTER_REG_HOLD_DATA(18, uint16,    MIN_CO2_PPM,  MAX_CO2_PPM,  0,  WO, 1, (void*)&pThis->usCO2PPM)   
-    MASTER_REG_HOLD_DATA(37,  uint8,    0,            5,            0,  RO, 1, (void*)&pThis->psModularList[0]->ucModularState) 
-    MASTER_REG_HOLD_DATA(38,  uint8,    0,            5,            0,  RO, 1, (void*)&pThis->psModularList[1]->ucModularState)   
-                                                                                          
-    MASTER_REG_HOLD_DATA(39, uint8,     0,     5,     0,  RO, 1, (void*)&pThis->psModularList[2]->ucModularState) 
-    MASTER_REG_HOLD_DATA(40, uint8,     0,     5,     0,  RO, 1, (void*)&pThis->psModularList[3]->ucModularState)   
-    MASTER_REG_HOLD_DATA(44, int16,  -200,  1400,     0,  RO, 1, (void*)&pThis->sRetAir_T)      
-    MASTER_REG_HOLD_DATA(45, int16,  -200,  1400,     0,  RO, 1, (void*)&pThis->sSupAir_T)
-    MASTER_REG_HOLD_DATA(46, int16,  -400,   700,     0,  RO, 1, (void*)&pThis->sAmbientInSelf_T)
-   
-    MASTER_REG_HOLD_DATA(47, uint16,    0,   100,     0,  RO, 1, (void*)&pThis->usAmbientInSelf_H)
-    MASTER_REG_HOLD_DATA(48, int16,  -400,   700,     0,  RO, 1, (void*)&pThis->sAmbientOutSelf_T) 
-    MASTER_REG_HOLD_DATA(49, uint16,    0,   100,     0,  RO, 1, (void*)&pThis->usAmbientOutSelf_H)
-    MASTER_REG_HOLD_DATA(51, uint16,    0,  1000,  1000,  RO, 1, (void*)&pThis->usFreAirDamper_Ang)
-    MASTER_REG_HOLD_DATA(52, uint16,    0,  5000,     0,  RO, 1, (void*)&pThis->usCO2PPMSelf)         
-   
-    MASTER_REG_HOLD_DATA(53, uint16,    0,  65000,    0,  RO, 1, (void*)&pThis->usFreAir_Vol)
-    MASTER_REG_HOLD_DATA(54, uint16,    0,  65000,    0,  RO, 1, (void*)&pThis->usSupAir_Vol)
-    MASTER_REG_HOLD_DATA(55, uint16,    0,  65000,    0,  RO, 1, (void*)&pThis->usRetAir_Vol)
-
-MASTER_END_DATA_BUF(0, 55)
+    pThis->pvModularRoof_RegHoldObj[MODULAR_ROOF_OBJ_SELF] = pThis;
+    for(n=0; n < MODULAR_NUM; n++)
+    {
+        pThis->pvModularRoof_RegHoldObj[MODULAR_ROOF_OBJ_MODULAR + n] = pThis->psModularList[n];
+    }
+MASTER_REG_HOLD_TABLE(&pThis->sDevCommData.sMBRegHoldTable, ModularRoofRegHoldDesc, ModularRoofRegHoldAddrIndex,
+                      pThis->pvModularRoof_RegHoldObj, pThis->usModularRoof_RegHoldPreVal, pThis->ucModularRoof_RegHoldPending)
     
     /******************************线圈数据域*************************/ 
 MASTER_BEGIN_DATA_BUF(&pThis->sModularRoof_BitCoilBuf, &pThis->sDevCommData.sMBCoilTable) 
@@ -302,8 +274,6 @@ MASTER_BEGIN_DATA_BUF(&pThis->sModularRoof_BitCoilBuf, &pThis->sDevCommData.sMBC
     
 MASTER_END_DATA_BUF(0, 631)  
     
-//    myprintf("&sMBRegHoldTable %d  sModularRoof_RegHoldBuf %d\n", 
-//    &pThis->sDevCommData.sMBRegHoldTable, &pThis->sModularRoof_RegHoldBuf);
     
     pThis->sDevCommData.ucProtocolID = MODULAR_ROOF_PROTOCOL_TYPE_ID;
     pThis->sDevCommData.pxDevDataMapIndex = xModularRoof_DevDataMapIndex;  //绑定映射函数
@@ -324,6 +294,7 @@ void vModularRoof_RegistMonitor(ModularRoof* pt)
     ModularRoof* pThis = (ModularRoof*)pt;
 
     OSSemCreate( &(pThis->sValChange), "sValChange", 0, &err );  //事件消息量初始化
+    EVENT_TOPIC(&pThis->sValChange, TOPIC_MODULAR_ROOF)                     //事件主题
     
     MONITOR(&pThis->Device.eRunningState,  uint8, &pThis->sValChange)
     MONITOR(&pThis->eRunningMode,          uint8, &pThis->sValChange)
@@ -5,13 +5,7 @@
 #include "fan.h"
 #include "compressor.h"
 
-#define   MODULAR_NUM                   4     //机组模块数量
-#define   SUP_AIR_FAN_NUM               2     //机组送风机数量
-                                              
-#define   AMBIENT_OUT_FAN_NUM           2     //模块室外风机数量
-#define   COMP_NUM                      2     //模块压缩机数量
-                                              
-#define   MODULAR_ROOF_REG_HOLD_NUM     50    //机组通讯数据表保持寄存器数量
+#define   MODULAR_ROOF_REG_HOLD_NUM     32    //机组通讯数据表保持寄存器数量
 #define   MODULAR_ROOF_BIT_COIL_NUM     50    //机组通讯数据表线圈数量
 
 #define   MODULAR_MAX_FRE_AIR_VOL       65000 //机组最大新风量
@@ -106,7 +100,7 @@ CLASS(ModularRoof)   /*屋顶机机组*/
     uint16_t      usHumidityMax;            //设定湿度max
     uint16_t      usHumidityMin;            //设定湿度min
     OS_SEM        sValChange;               //变量变化事件
-    OS_TMR        sModularRoofTmr;          //机组内部定时器
+    sTimer        sModularRoofTmr;          //机组内部定时器
     
     SupAirFan*     psSupAirFan;                      //机组送风机
     Modular*       psModularList[MODULAR_NUM];       //模块列表
@@ -115,7 +109,9 @@ CLASS(ModularRoof)   /*屋顶机机组*/
     sMBSlaveDevCommData  sDevCommData;               //本设备通讯数据表
     sMBSlaveDev          sMBSlaveDev;                //本通讯设备
     
-    sMasterRegHoldData   sModularRoof_RegHoldBuf[MODULAR_ROOF_REG_HOLD_NUM];  //保持寄存器数据域
+    USHORT               usModularRoof_RegHoldPreVal[MODULAR_ROOF_REG_HOLD_NUM];                    //保持寄存器先前值
+    UCHAR                ucModularRoof_RegHoldPending[MB_BITMAP_BYTES(MODULAR_ROOF_REG_HOLD_NUM)];  //保持寄存器待写入位图
+    void*                pvModularRoof_RegHoldObj[MODULAR_NUM + 1];                                  //保持寄存器所属对象
     sMasterBitCoilData   sModularRoof_BitCoilBuf[MODULAR_ROOF_BIT_COIL_NUM];  //线圈数据域
 
     void (*init)(ModularRoof* pt, sMBMasterInfo* psMBMasterInfo, UCHAR ucDevAddr, uint8_t ucDevIndex);
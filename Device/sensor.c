@@ -12,6 +12,14 @@
 *                         传感器                             *
 **************************************************************/
 
+/*默认滤波链：中值剔除尖峰，再滑动平均，每个采样都更新输出*/
+void vSensor_InitFilter(sFilterChain* psChain)
+{
+    vFilterChainInit(psChain);
+    (void)xFilterStageSet(psChain, 0, FILTER_MEDIAN, SENSOR_SPIKE_WIN);
+    (void)xFilterStageSet(psChain, 1, FILTER_MEAN,   SENSOR_SAMPLE_NUM);
+}
+
 /*向通讯主栈中注册设备*/
 void vSensor_RegistDev(Sensor* pt)
 {
@@ -50,29 +58,14 @@ END_CTOR
 *                         CO2传感器                          *
 **************************************************************/
 
-/*通讯映射函数*/
-BOOL xCO2Sensor_DevDataMapIndex(eDataType eDataType, UCHAR ucProtocolID, USHORT usAddr, USHORT* psIndex)
+/*保持寄存器点位描述，保持寄存器映射与轮询由此表生成*/
+static const sMasterRegHoldDesc CO2SensorRegHoldDesc[] = 
 {
-    USHORT i = 0;
-    switch(ucProtocolID)
-	{
-        case SENSOR_CO2_PROTOCOL_TYPE_ID:
-            if(eDataType == RegHoldData)
-            {
-                switch(usAddr)
-                {
-                    case 1 :  i = 0;  break;     
-                    default:
-                		return FALSE;
-                	break;
-                }
-            }
-        break;
-        default: break;
-	}
-    *psIndex = i;
-    return TRUE;
-}
+    MASTER_REG_HOLD_DESC(1, uint16, 0, 65535, 0, RO, 1, 0, CO2Sensor, usCO2PPM)
+};
+MASTER_REG_HOLD_DESC_CHECK(CO2SensorRegHoldDesc, SENSOR_REG_HOLD_NUM)
+
+static UCHAR CO2SensorRegHoldAddrIndex[1 - 1 + 1];  //保持寄存器地址索引表，容量不小于地址跨度(1)
 
 /*通讯数据表初始化*/
 void vCO2Sensor_InitDevCommData(IDevCom* pt)
@@ -81,21 +74,19 @@ void vCO2Sensor_InitDevCommData(IDevCom* pt)
     CO2Sensor*     pCO2Sen = SUB_PTR(pThis, Sensor, CO2Sensor);
     sMBTestDevCmd* psMBCmd = &pThis->sDevCommData.sMBDevCmdTable;
     
-MASTER_PBUF_INDEX_ALLOC()
 MASTER_TEST_CMD_INIT(psMBCmd, 2, READ_REG_HOLD, pThis->sMBSlaveDev.ucDevAddr, TRUE)  
     
     /******************************保持寄存器数据域*************************/
-MASTER_BEGIN_DATA_BUF(&pThis->sSensor_RegHoldBuf, &pThis->sDevCommData.sMBRegHoldTable;)
-    
-    MASTER_REG_HOLD_DATA(1, uint16, 0, 65535, 0, RO, 1, (void*)&pCO2Sen->usCO2PPM)
-      
-MASTER_END_DATA_BUF(1, 1)
+    pThis->pvSensor_RegHoldObj[0] = pCO2Sen;
+MASTER_REG_HOLD_TABLE(&pThis->sDevCommData.sMBRegHoldTable, CO2SensorRegHoldDesc, CO2SensorRegHoldAddrIndex,
+                      pThis->pvSensor_RegHoldObj, pThis->usSensor_RegHoldPreVal, pThis->ucSensor_RegHoldPending)
     
     pCO2Sen->usMaxPPM = MAX_CO2_PPM;
     pCO2Sen->usMinPPM = MIN_CO2_PPM;
     
+    vSensor_InitFilter(&pCO2Sen->sCO2Filter);
+    
     pThis->sDevCommData.ucProtocolID = SENSOR_CO2_PROTOCOL_TYPE_ID;
-    pThis->sDevCommData.pxDevDataMapIndex = xCO2Sensor_DevDataMapIndex;    //绑定映射函数
     pThis->sMBSlaveDev.psDevDataInfo = &(pThis->sDevCommData); 
 }
 
@@ -104,8 +95,6 @@ void vCO2Sensor_TimeoutInd(void * p_tmr, void * p_arg)  //定时器中断服务
     Sensor*    pThis    = (Sensor*)p_arg;
     CO2Sensor* psCO2Sen = SUB_PTR(pThis, Sensor, CO2Sensor);
     
-    uint8_t* pcSampleIndex = &pThis->ucSampleIndex;
-    
     //判断传感器是否故障
     if( (psCO2Sen->usAvgCO2PPM < psCO2Sen->usMinPPM) || (psCO2Sen->usAvgCO2PPM > psCO2Sen->usMaxPPM) ||
         (psCO2Sen->Sensor.sMBSlaveDev.xOnLine == FALSE) || (psCO2Sen->Sensor.sMBSlaveDev.xDataReady == FALSE))
@@ -117,26 +106,26 @@ void vCO2Sensor_TimeoutInd(void * p_tmr, void * p_arg)  //定时器中断服务
         psCO2Sen->xCO2SenErr = FALSE;
     }
     
-    //对传感器参数进行采样
-    if(*pcSampleIndex < SENSOR_SAMPLE_NUM)
-    {
-        psCO2Sen->ulTotalCO2PPM = psCO2Sen->ulTotalCO2PPM - psCO2Sen->usSampleCO2PPM[*pcSampleIndex];
-        psCO2Sen->usSampleCO2PPM[*pcSampleIndex]  = psCO2Sen->usCO2PPM;
-        psCO2Sen->ulTotalCO2PPM  = psCO2Sen->ulTotalCO2PPM + psCO2Sen->usCO2PPM;
-     
-        (*pcSampleIndex)++;
-    }
-    else if(*pcSampleIndex == SENSOR_SAMPLE_NUM)
-    {
-        psCO2Sen->usAvgCO2PPM  = psCO2Sen->ulTotalCO2PPM  / SENSOR_SAMPLE_NUM;   //取平均值
-        *pcSampleIndex = 0;
-    } 
+    //对传感器参数进行采样滤波
+    psCO2Sen->usAvgCO2PPM = usFilterChainRun(&psCO2Sen->sCO2Filter, psCO2Sen->usCO2PPM);
        
 #if DEBUG_ENABLE > 0
-//    myprintf("vCO2Sensor_TimeoutInd usTotalCO2PPM %d  usAvgCO2PPM %d\n", psCO2Sen->usTotalCO2PPM , psCO2Sen->usAvgCO2PPM);
+//    myprintf("vCO2Sensor_TimeoutInd usCO2PPM %d  usAvgCO2PPM %d\n", psCO2Sen->usCO2PPM , psCO2Sen->usAvgCO2PPM);
 #endif 
 }
 
+/*设置CO2浓度滤波级*/
+BOOL xCO2Sensor_SetFilter(Sensor* pt, uint8_t ucItem, uint8_t ucStage, eFilterType eType, uint16_t usParam)
+{
+    CO2Sensor* psCO2Sen = SUB_PTR(pt, Sensor, CO2Sensor);
+    
+    if(ucItem != 0)
+    {
+        return FALSE;
+    }
+    return xFilterStageSet(&psCO2Sen->sCO2Filter, ucStage, eType, usParam);
+}
+
 /* CO2传感器数据监控*/
 void vCO2Sensor_RegistMonitor(Sensor* pt)
 {
@@ -144,6 +133,7 @@ void vCO2Sensor_RegistMonitor(Sensor* pt)
     CO2Sensor* pThis = SUB_PTR(pThis, Sensor, CO2Sensor);
     
     OSSemCreate( &(pThis->Sensor.sValChange), "sValChange", 0, &err );  //事件消息量初始化
+    EVENT_TOPIC(&pThis->Sensor.sValChange, TOPIC_CO2_SENSOR)                   //事件主题
 
     MONITOR(&pThis->usAvgCO2PPM, uint16, &pThis->Sensor.sValChange)
     MONITOR(&pThis->xCO2SenErr,   uint8, &pThis->Sensor.sValChange)
@@ -154,37 +144,22 @@ CTOR(CO2Sensor)   //CO2传感器构造函数
     FUNCTION_SETTING(Sensor.registMonitor, vCO2Sensor_RegistMonitor);
     FUNCTION_SETTING(Sensor.IDevCom.initDevCommData, vCO2Sensor_InitDevCommData);
     FUNCTION_SETTING(Sensor.timeoutInd, vCO2Sensor_TimeoutInd);
+    FUNCTION_SETTING(Sensor.setFilter,  xCO2Sensor_SetFilter);
 END_CTOR
 
 
 /*************************************************************
 *                         温湿度传感器                       *
 **************************************************************/
-/*通讯映射函数*/
-BOOL xTempHumiSensor_DevDataMapIndex(eDataType eDataType, UCHAR ucProtocolID, USHORT usAddr, USHORT* psIndex)
+/*保持寄存器点位描述，保持寄存器映射与轮询由此表生成*/
+static const sMasterRegHoldDesc TempHumiSensorRegHoldDesc[] = 
 {
-    USHORT i = 0;
-    switch(ucProtocolID)
-	{
-        case SENSOR_TEMP_HUMI_PROTOCOL_TYPE_ID:
-            if(eDataType == RegHoldData)
-            {
-                switch(usAddr)
-                {
-                    case 1	  :  i = 0 ;  break;
-                    case 2	  :  i = 1 ;  break;
-                       
-                    default:
-                		return FALSE;
-                	break;
-                }
-            }
-        break;
-        default: break;
-	}
-    *psIndex = i;
-    return TRUE; 
-}
+    MASTER_REG_HOLD_DESC(1, int16,  -32768, 32767, 0, RO,  1, 0, TempHumiSensor, sTemp)
+    MASTER_REG_HOLD_DESC(2, uint16,      0, 65535, 0, RO, 10, 0, TempHumiSensor, usHumi)
+};
+MASTER_REG_HOLD_DESC_CHECK(TempHumiSensorRegHoldDesc, SENSOR_REG_HOLD_NUM)
+
+static UCHAR TempHumiSensorRegHoldAddrIndex[2 - 1 + 1];  //保持寄存器地址索引表，容量不小于地址跨度(1~2)
 
 /*通讯数据表初始化*/
 void vTempHumiSensor_InitDevCommData(IDevCom* pt)
@@ -193,16 +168,12 @@ void vTempHumiSensor_InitDevCommData(IDevCom* pt)
     TempHumiSensor* pTempHumiSen = SUB_PTR(pThis, Sensor, TempHumiSensor);  
     sMBTestDevCmd*  psMBCmd      = &pThis->sDevCommData.sMBDevCmdTable;
   
-MASTER_PBUF_INDEX_ALLOC()
 MASTER_TEST_CMD_INIT(psMBCmd, 0x30, READ_REG_HOLD, pThis->sMBSlaveDev.ucDevAddr, TRUE)  
     
     /******************************保持寄存器数据域*************************/
-MASTER_BEGIN_DATA_BUF(&pThis->sSensor_RegHoldBuf, &pThis->sDevCommData.sMBRegHoldTable) 
-    
-    MASTER_REG_HOLD_DATA(1, int16,  -32768, 32767, 0, RO,  1, (void*)&pTempHumiSen->sTemp)
-    MASTER_REG_HOLD_DATA(2, uint16,      0, 65535, 0, RO, 10, (void*)&pTempHumiSen->usHumi) 
-        
-MASTER_END_DATA_BUF(1, 2)
+    pThis->pvSensor_RegHoldObj[0] = pTempHumiSen;
+MASTER_REG_HOLD_TABLE(&pThis->sDevCommData.sMBRegHoldTable, TempHumiSensorRegHoldDesc, TempHumiSensorRegHoldAddrIndex,
+                      pThis->pvSensor_RegHoldObj, pThis->usSensor_RegHoldPreVal, pThis->ucSensor_RegHoldPending)
     
     if(pThis->eSensorType == TYPE_TEMP_HUMI_IN)  
     {
@@ -217,19 +188,35 @@ MASTER_END_DATA_BUF(1, 2)
     pTempHumiSen->usMaxHumi = MAX_HUMI;
     pTempHumiSen->usMinHumi = MIN_HUMI;
     
+    vSensor_InitFilter(&pTempHumiSen->sTempFilter);
+    vSensor_InitFilter(&pTempHumiSen->sHumiFilter);
+    
     pThis->sDevCommData.ucProtocolID = SENSOR_TEMP_HUMI_PROTOCOL_TYPE_ID;
-    pThis->sDevCommData.pxDevDataMapIndex = xTempHumiSensor_DevDataMapIndex;    //绑定映射函数
     pThis->sMBSlaveDev.psDevDataInfo = &(pThis->sDevCommData);
 }
 
+typedef struct   /*温湿度同帧快照*/
+{
+    TempHumiSensor* pTempHumiSen;
+    int16_t         sTemp;
+    uint16_t        usHumi;
+}sTempHumiSnap;
+
+/*温湿度快照拷贝，由顺序锁读者调用*/
+static void vTempHumiSensor_CopySnap(void* pvArg)
+{
+    sTempHumiSnap* psSnap = (sTempHumiSnap*)pvArg;
+
+    psSnap->sTemp  = psSnap->pTempHumiSen->sTemp;
+    psSnap->usHumi = psSnap->pTempHumiSen->usHumi;
+}
+
 void vTempHumiSensor_TimeoutInd(void * p_tmr, void * p_arg)  //定时器中断服务函数
 {
+    sTempHumiSnap         sSnap;
     Sensor*                pThis = (Sensor*)p_arg;
     TempHumiSensor* pTempHumiSen = SUB_PTR(pThis, Sensor, TempHumiSensor);
     
-    uint8_t* pcSampleIndex   = &pThis->ucSampleIndex;
-    uint8_t* pcSampleIndex_2 = &pThis->ucSampleIndex_2;
-    
     //判断传感器是否故障
     if( (pTempHumiSen->sAvgTemp < pTempHumiSen->sMinTemp) || (pTempHumiSen->sAvgTemp > pTempHumiSen->sMaxTemp) ||
         (pTempHumiSen->Sensor.sMBSlaveDev.xOnLine == FALSE) || (pTempHumiSen->Sensor.sMBSlaveDev.xDataReady == FALSE) ) 
@@ -251,32 +238,14 @@ void vTempHumiSensor_TimeoutInd(void * p_tmr, void * p_arg)  //定时器中断
         pTempHumiSen->xHumiSenErr = FALSE;
     }
     
-    //对传感器参数进行采样
-    if(*pcSampleIndex< SENSOR_SAMPLE_NUM)
-    {
-        pTempHumiSen->lTotalTemp  = pTempHumiSen->lTotalTemp - pTempHumiSen->sSampleTemp[*pcSampleIndex];
-        pTempHumiSen->sSampleTemp[*pcSampleIndex]  = pTempHumiSen->sTemp;
-        pTempHumiSen->lTotalTemp  = pTempHumiSen->lTotalTemp + pTempHumiSen->sTemp;
-        (*pcSampleIndex)++;
-    }
-    else if(*pcSampleIndex == SENSOR_SAMPLE_NUM)
-    {
-        pTempHumiSen->sAvgTemp = pTempHumiSen->lTotalTemp / SENSOR_SAMPLE_NUM;  //取平均值
-        *pcSampleIndex = 0;
-    }
+    //温湿度同帧读取，取同一版本采样值
+    sSnap.pTempHumiSen = pTempHumiSen;
+    (void)ulSeqReadCopy(&pThis->sMBSlaveDev.sDataLock, vTempHumiSensor_CopySnap, &sSnap);
     
-    if(*pcSampleIndex_2 < SENSOR_SAMPLE_NUM)
-    {
-        pTempHumiSen->ulTotalHumi = pTempHumiSen->ulTotalHumi - pTempHumiSen->usSampleHumi[*pcSampleIndex_2];
-        pTempHumiSen->usSampleHumi[*pcSampleIndex_2] = pTempHumiSen->usHumi;
-        pTempHumiSen->ulTotalHumi = pTempHumiSen->ulTotalHumi + pTempHumiSen->usHumi;
-        (*pcSampleIndex_2)++;
-    }
-    else if(*pcSampleIndex_2 == SENSOR_SAMPLE_NUM)
-    {
-        pTempHumiSen->usAvgHumi = pTempHumiSen->ulTotalHumi / SENSOR_SAMPLE_NUM;
-        *pcSampleIndex_2 = 0;
-    }   
+    //对传感器参数进行采样滤波，温度为有符号数，偏置后滤波
+    pTempHumiSen->sAvgTemp  = (int16_t)((int32_t)usFilterChainRun(&pTempHumiSen->sTempFilter, 
+                                        (uint16_t)(sSnap.sTemp + SENSOR_TEMP_BIAS)) - SENSOR_TEMP_BIAS);
+    pTempHumiSen->usAvgHumi = usFilterChainRun(&pTempHumiSen->sHumiFilter, sSnap.usHumi);
     
 #if DEBUG_ENABLE > 0
 //    if(pTempHumiSen->Sensor.sMBSlaveDev.ucDevAddr == 18)
@@ -286,6 +255,19 @@ void vTempHumiSensor_TimeoutInd(void * p_tmr, void * p_arg)  //定时器中断
 #endif     
 }
 
+/*设置温湿度滤波级*/
+BOOL xTempHumiSensor_SetFilter(Sensor* pt, uint8_t ucItem, uint8_t ucStage, eFilterType eType, uint16_t usParam)
+{
+    TempHumiSensor* pTempHumiSen = SUB_PTR(pt, Sensor, TempHumiSensor);
+    
+    switch(ucItem)
+    {
+        case 0:  return xFilterStageSet(&pTempHumiSen->sTempFilter, ucStage, eType, usParam);
+        case 1:  return xFilterStageSet(&pTempHumiSen->sHumiFilter, ucStage, eType, usParam);
+        default: return FALSE;
+    }
+}
+
 /*温湿度传感器数据监控*/
 void vTempHumiSensor_RegistMonitor(Sensor* pt)
 {
@@ -293,6 +275,7 @@ void vTempHumiSensor_RegistMonitor(Sensor* pt)
     TempHumiSensor* pThis = SUB_PTR(pThis, Sensor, TempHumiSensor);
 
     OSSemCreate( &(pThis->Sensor.sValChange), "sValChange", 0, &err );  //事件消息量初始化
+    EVENT_TOPIC(&pThis->Sensor.sValChange, TOPIC_TEMP_HUMI_SENSOR)             //事件主题
     
     MONITOR(&pThis->sAvgTemp,    int16, &pThis->Sensor.sValChange)
     MONITOR(&pThis->xTempSenErr, uint8, &pThis->Sensor.sValChange)
@@ -307,6 +290,7 @@ CTOR(TempHumiSensor)   //温湿度传感器构造函数
     FUNCTION_SETTING(Sensor.registMonitor,           vTempHumiSensor_RegistMonitor);
     FUNCTION_SETTING(Sensor.IDevCom.initDevCommData, vTempHumiSensor_InitDevCommData);
     FUNCTION_SETTING(Sensor.timeoutInd,              vTempHumiSensor_TimeoutInd);
+    FUNCTION_SETTING(Sensor.setFilter,               xTempHumiSensor_SetFilter);
 END_CTOR
 
 
@@ -2,8 +2,11 @@
 #define _SENSOR_H_
 
 #include "device.h"
+#include "md_filter.h"
 
-#define SENSOR_SAMPLE_NUM      5
+#define SENSOR_SAMPLE_NUM      5       //默认滑动平均窗口
+#define SENSOR_SPIKE_WIN       3       //默认尖峰剔除中值窗口(3/5)
+#define SENSOR_TEMP_BIAS       0x8000  //温度偏置到无符号域后滤波
 #define SENSOR_REG_HOLD_NUM    3
 
 #define MAX_IN_TEMP     1200
@@ -31,9 +34,6 @@ ABS_CLASS(Sensor)          /*传感器*/
     EXTENDS(Device);
     IMPLEMENTS(IDevCom);            //设备通讯接口
     
-    uint8_t              ucSampleIndex;    //采样次数
-    uint8_t              ucSampleIndex_2;  //采样次数
-    
     eSensorType          eSensorType;      //传感器类型
     
     sMBMasterInfo*       psMBMasterInfo;   //通讯主栈
@@ -41,13 +41,16 @@ ABS_CLASS(Sensor)          /*传感器*/
     sMBSlaveDev          sMBSlaveDev;      //本通讯设备
     
     OS_SEM               sValChange;       //变量变化事件
-    OS_TMR               sSensorTmr;       //传感器内部定时器
+    sTimer               sSensorTmr;       //传感器内部定时器
     
-    sMasterRegHoldData   sSensor_RegHoldBuf[SENSOR_REG_HOLD_NUM];  //保持寄存器数据域
+    USHORT               usSensor_RegHoldPreVal[SENSOR_REG_HOLD_NUM];                    //保持寄存器先前值
+    UCHAR                ucSensor_RegHoldPending[MB_BITMAP_BYTES(SENSOR_REG_HOLD_NUM)];  //保持寄存器待写入位图
+    void*                pvSensor_RegHoldObj[1];                                         //保持寄存器所属对象(子类对象)
     
     void (*init)(Sensor* pt, sMBMasterInfo* psMBMasterInfo, eSensorType eSensorType, UCHAR ucDevAddr, uint8_t ucDevIndex);
     void (*registMonitor)(Sensor* pt);
     void (*timeoutInd)(void * p_tmr, void * p_arg);  //定时器中断服务函数
+    BOOL (*setFilter)(Sensor* pt, uint8_t ucItem, uint8_t ucStage, eFilterType eType, uint16_t usParam); //设置滤波级，ucItem 0:温度/CO2 1:湿度
 };
 
 CLASS(CO2Sensor)          /*CO2传感器*/  
@@ -58,10 +61,9 @@ CLASS(CO2Sensor)          /*CO2传感器*/
     uint16_t     usMinPPM;        //量程下限 = 实际值*10
     uint16_t     usCO2PPM;        //实际值   
     uint16_t     usAvgCO2PPM;     //平均值
-    uint32_t     ulTotalCO2PPM;   //所有采样值之和
     BOOL         xCO2SenErr;      //CO2故障
     
-    uint16_t     usSampleCO2PPM[SENSOR_SAMPLE_NUM];    
+    sFilterChain sCO2Filter;      //CO2浓度滤波链
 };
 
 CLASS(TempHumiSensor)          /*温湿度传感器*/  
@@ -72,18 +74,16 @@ CLASS(TempHumiSensor)          /*温湿度传感器*/
     int16_t      sMinTemp;     //量程下限 = 实际值*10
     int16_t      sTemp;        //实际值  
     int16_t      sAvgTemp;     //平均值
-    int32_t      lTotalTemp;   //所有采样值之和
     BOOL         xTempSenErr;  //温度故障
      
     uint16_t     usMaxHumi;    //量程上限 = 实际值*10
     uint16_t     usMinHumi;    //量程下限 = 实际值*10
     uint16_t     usHumi;       //实际值  
     uint16_t     usAvgHumi;    //平均值
-    uint32_t     ulTotalHumi;  //所有采样值之和
     BOOL         xHumiSenErr;  //湿度故障
     
-    int16_t      sSampleTemp[SENSOR_SAMPLE_NUM];
-    uint16_t     usSampleHumi[SENSOR_SAMPLE_NUM];
+    sFilterChain sTempFilter;  //温度滤波链
+    sFilterChain sHumiFilter;  //湿度滤波链
 
 };
 
@@ -653,6 +653,7 @@ BOOL xMBMasterRegistDev(sMBMasterInfo* psMBMasterInfo, sMBSlaveDev* psMBNewDev)
     psMBDevsInfo =&psMBMasterInfo->sMBDevsInfo;    //从设备信息
     psMBNewDev->psMBMasterInfo = psMBMasterInfo;
     psMBNewDev->pNext = NULL;
+    vSeqLockInit(&psMBNewDev->sDataLock);
     
     if(psMBDevsInfo->psMBSlaveDevsList == NULL)   //无任何结点
     {
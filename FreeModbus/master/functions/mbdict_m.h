@@ -4,6 +4,8 @@
 #include "mbframe.h"
 #include "mbconfig.h"
 #include "port.h"
+#include "md_timer.h"
+#include "md_seqlock.h"
 
 /* -----------------------Master Defines -------------------------------------*/
 
@@ -22,17 +24,21 @@ typedef enum   /*轮询模式*/
     SCAN_READ     = 1,     //轮询读
 }eScanMode;
 
-typedef struct        /* 主栈保持寄存器数据结构 */
+#define MB_BITMAP_BYTES(n)        (((n) + 7) / 8)   //位图字节数
+#define MB_ADDR_INDEX_NONE        0xFF              //地址索引表中该地址无点位
+
+typedef struct        /* 主栈保持寄存器点位描述，常量表存放于Flash，同协议设备共用 */
 {
 	USHORT            usAddr;            //地址
     UCHAR             ucDataType;        //数据类型
-    volatile USHORT   usPreVal;          //先前值
+    UCHAR             ucAccessMode;      //访问权限
+    UCHAR             ucObj;             //变量所属对象(设备对象列表序号)
+    USHORT            usOffset;          //变量在所属对象内的偏移
+    USHORT            usPreValInit;      //先前值初值
     LONG              lMinVal;           //最小值
     LONG              lMaxVal;           //最大值
-    UCHAR             ucAccessMode;      //访问权限
     float             fTransmitMultiple; //传输因子
-    void*             pvValue;           //变量指针    
-}sMasterRegHoldData;     		
+}sMasterRegHoldDesc;     		
 
 typedef struct        /* 主栈字典保持寄存器数据结构 */
 {
@@ -89,12 +95,25 @@ typedef struct   /* 主栈字典数据列表结构 */
     USHORT   usDataCount;           //协议点位总数
 }sMBDevDataTable;
 
+typedef struct   /* 主栈保持寄存器数据表，设备实例只保存先前值与待写位图 */
+{
+    const sMasterRegHoldDesc* psDescBuf;       //点位描述表
+    void**                    ppvObjList;      //变量所属对象列表
+    volatile USHORT*          pusPreValBuf;    //先前值
+    UCHAR*                    pucPendingBits;  //待写位图：本地值已变化，尚未得到从设备写应答
+    UCHAR*                    pucAddrIndex;    //地址索引表：(地址-起始地址)对应点位序号，同类设备共用
+    const float*              pfMultipleBuf;   //本实例传输因子，按点位序号，为NULL时取点位描述中的传输因子
+	USHORT                    usStartAddr;     //起始地址
+	USHORT                    usEndAddr;       //末尾地址
+    USHORT                    usDataCount;     //协议点位总数
+}sMBDevRegHoldTable;
+
 typedef BOOL (*pxMBDevDataMapIndex)(eDataType eDataType, UCHAR ucProtocolID, USHORT usAddr, USHORT* psIndex); //字典映射函数
 
 typedef struct sMBSlaveDevCommData   /* 从设备通讯字典数据结构 */  
 {
 	sMBDevDataTable      sMBRegInTable;       //输入寄存器数据表
-	sMBDevDataTable      sMBRegHoldTable;     //保持寄存器数据表
+	sMBDevRegHoldTable   sMBRegHoldTable;     //保持寄存器数据表
 	sMBDevDataTable      sMBCoilTable;        //线圈数据表
 	sMBDevDataTable      sMBDiscInTable;      //离散量数据表
     sMBTestDevCmd        sMBDevCmdTable;      //用于测试从设备状态命令表
@@ -121,10 +140,11 @@ typedef struct sMBSlaveDev   /* 从设备信息列表 */
     
 //    eScanMode eScanMode;             //当前轮询模式
     
-    OS_TMR  sDevOfflineTmr;          //设备掉线定时器
+    sTimer  sDevOfflineTmr;          //设备掉线定时器
+    sSeqLock sDataLock;              //设备数据版本锁，一帧应答为一次写入
     
 #if MB_MASTER_HEART_BEAT_ENABLED >0
-    OS_TMR  sDevHeartBeatTmr;      //心跳间隔定时器
+    sTimer  sDevHeartBeatTmr;      //心跳间隔定时器
     BOOL    xDevHeartBeatRequest;  //心跳请求
 #endif 
     
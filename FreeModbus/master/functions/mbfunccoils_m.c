@@ -501,7 +501,15 @@ eMBMasterRegCoilsCB(sMBMasterInfo* psMBMasterInfo, UCHAR* pucRegBuffer, USHORT u
 
     if ((usAddress >= COIL_START) && (usAddress + usNCoils -1 <= COIL_END))
     {
+        if(eMode == MB_BIT_READ)
+        {
+            vSeqWriteBegin(&psMBSlaveDevCur->sDataLock);
+        }
         eStatus = eMBMasterUtilSetBits(psMBMasterInfo, pucRegBuffer, usAddress, usNCoils, CoilData, eMode);
+        if(eMode == MB_BIT_READ)
+        {
+            vSeqWriteEnd(&psMBSlaveDevCur->sDataLock);
+        }
     }
     else
     {
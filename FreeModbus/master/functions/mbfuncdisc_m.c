@@ -215,7 +215,9 @@ eMBErrorCode eMBMasterRegDiscreteCB( sMBMasterInfo* psMBMasterInfo, UCHAR * pucR
 
     if ( (usAddress >= DISCRETE_INPUT_START) && (usAddress + usNDiscrete -1 <= DISCRETE_INPUT_END) )
     {
+        vSeqWriteBegin(&psMBSlaveDevCur->sDataLock);
 		eStatus = eMBMasterUtilSetBits(psMBMasterInfo, pucRegBuffer, usAddress, usNDiscrete, DiscInData, MB_BIT_READ);
+        vSeqWriteEnd(&psMBSlaveDevCur->sDataLock);
 	}   
     else
     {
@@ -570,9 +570,12 @@ eMBErrorCode eMBMasterRegHoldingCB(sMBMasterInfo* psMBMasterInfo, UCHAR* pucRegB
 	int8_t cRegHoldValue = 0;
     
     eMBErrorCode        eStatus          = MB_ENOERR;
-	sMasterRegHoldData* pvRegHoldValue   = NULL;
+    USHORT              usIndex          = 0;
+	void*               pvRegHoldValue   = NULL;
+    const sMasterRegHoldDesc* psRegHoldDesc = NULL;
+    float               fMultiple        = 1.0;
     sMBSlaveDev*        psMBSlaveDevCur  = psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur ;    //当前从设备
-    sMBDevDataTable*    psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable; //从设备通讯协议表
+    sMBDevRegHoldTable* psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable; //从设备通讯协议表
     UCHAR               ucMBDestAddr     = ucMBMasterGetDestAddr(psMBMasterInfo);           //从设备通讯地址
     	
     if(psMBMasterInfo->eMBRunMode != STATE_SCAN_DEV) //非轮询从设备模式
@@ -585,7 +588,7 @@ eMBErrorCode eMBMasterRegHoldingCB(sMBMasterInfo* psMBMasterInfo, UCHAR* pucRegB
         psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur = psMBSlaveDevCur;
         psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable;
     }
-    if( (psMBRegHoldTable->pvDataBuf  == NULL) || (psMBRegHoldTable->usDataCount == 0)) //非空且数据点不为0
+    if( (psMBRegHoldTable->psDescBuf  == NULL) || (psMBRegHoldTable->usDataCount == 0)) //非空且数据点不为0
 	{
 		return MB_ENOREG;
 	}
@@ -606,97 +609,112 @@ eMBErrorCode eMBMasterRegHoldingCB(sMBMasterInfo* psMBMasterInfo, UCHAR* pucRegB
     {
     /* read current register values from the protocol stack. */
     case MB_REG_READ:
+        vSeqWriteBegin(&psMBSlaveDevCur->sDataLock);    //整帧数据一次提交，控制侧读取一致快照
         while (usNRegs > 0)          
         {
-    		(void)eMBMasterRegHoldingMap(psMBMasterInfo, ucMBDestAddr, iRegIndex, &pvRegHoldValue);     //扫描字典中变量，找出对应的变量
-    
+            pvRegHoldValue = NULL;
+    		if(eMBMasterRegHoldingMap(psMBMasterInfo, ucMBDestAddr, iRegIndex, &usIndex) == MB_MRE_NO_ERR)  //扫描字典中变量，找出对应的变量
+            {
+                psRegHoldDesc  = &psMBRegHoldTable->psDescBuf[usIndex];
+                pvRegHoldValue = pvMBMasterRegHoldValue(psMBRegHoldTable, usIndex);
+                fMultiple      = fMBMasterRegHoldMultiple(psMBRegHoldTable, usIndex);
+            }
     		usRegHoldValue = ( (USHORT)(*pucRegBuffer++) ) << 8;
     	    usRegHoldValue |=( (USHORT)(*pucRegBuffer++) ) & 0xFF;
     		
-    		if( (pvRegHoldValue != NULL) && (pvRegHoldValue->pvValue != NULL) && (pvRegHoldValue->ucAccessMode != WO) )
+            //待写点位的本地值较新，不被从设备旧值覆盖
+    		if( (pvRegHoldValue != NULL) && (psRegHoldDesc->ucAccessMode != WO) &&
+                (xMBMasterRegHoldPending(psMBRegHoldTable, usIndex) == FALSE) )
     		{
-    			if( (pvRegHoldValue->fTransmitMultiple != 0.0) && (pvRegHoldValue->fTransmitMultiple != 1.0) )
+    			if( (fMultiple != 0.0) && (fMultiple != 1.0) )
     		    {
-    		    	usRegHoldValue = (USHORT)((float)usRegHoldValue / (float)pvRegHoldValue->fTransmitMultiple);     //传输因子
+    		    	usRegHoldValue = (USHORT)((float)usRegHoldValue / fMultiple);     //传输因子
     		    }
     			
-    			if (pvRegHoldValue->ucDataType == uint16)
+    			if (psRegHoldDesc->ucDataType == uint16)
     			{
-    				if( (usRegHoldValue >= (USHORT)pvRegHoldValue->lMinVal ) && (usRegHoldValue <= (USHORT)pvRegHoldValue->lMaxVal))
+    				if( (usRegHoldValue >= (USHORT)psRegHoldDesc->lMinVal ) && (usRegHoldValue <= (USHORT)psRegHoldDesc->lMaxVal))
     				{ 
-    					*(USHORT*)pvRegHoldValue->pvValue = (USHORT)usRegHoldValue;    //更新对应点位
-                        pvRegHoldValue->usPreVal = (USHORT)usRegHoldValue;							
+    					*(USHORT*)pvRegHoldValue = (USHORT)usRegHoldValue;    //更新对应点位
+                        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)usRegHoldValue;							
     				}										
     			}
-    			else if(pvRegHoldValue->ucDataType == uint8)
+    			else if(psRegHoldDesc->ucDataType == uint8)
     			{  
-    				if( ((UCHAR)usRegHoldValue >= (UCHAR)pvRegHoldValue->lMinVal ) && ((UCHAR)usRegHoldValue <= (UCHAR)pvRegHoldValue->lMaxVal) )
+    				if( ((UCHAR)usRegHoldValue >= (UCHAR)psRegHoldDesc->lMinVal ) && ((UCHAR)usRegHoldValue <= (UCHAR)psRegHoldDesc->lMaxVal) )
     				{
-    					*(UCHAR*)pvRegHoldValue->pvValue = (UCHAR)usRegHoldValue;
-                        pvRegHoldValue->usPreVal = (USHORT)usRegHoldValue;							
+    					*(UCHAR*)pvRegHoldValue = (UCHAR)usRegHoldValue;
+                        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)usRegHoldValue;							
     				}
     			}
-    			else if (pvRegHoldValue->ucDataType == int16)
+    			else if (psRegHoldDesc->ucDataType == int16)
     			{
     				sRegHoldValue = (SHORT)usRegHoldValue;
-    				 if( (sRegHoldValue >= (SHORT)pvRegHoldValue->lMinVal ) && (sRegHoldValue <= (SHORT)pvRegHoldValue->lMaxVal) )	
+    				 if( (sRegHoldValue >= (SHORT)psRegHoldDesc->lMinVal ) && (sRegHoldValue <= (SHORT)psRegHoldDesc->lMaxVal) )	
     				{
-    					*(SHORT*)pvRegHoldValue->pvValue = (SHORT)sRegHoldValue;
-    					pvRegHoldValue->usPreVal = (USHORT)sRegHoldValue;
+    					*(SHORT*)pvRegHoldValue = (SHORT)sRegHoldValue;
+    					psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)sRegHoldValue;
     				}			
     			}
-    			else if(pvRegHoldValue->ucDataType == int8)
+    			else if(psRegHoldDesc->ucDataType == int8)
     			{  	
                     cRegHoldValue = (int8_t)usRegHoldValue;
-    				if( (cRegHoldValue >= (int8_t)pvRegHoldValue->lMinVal ) && (cRegHoldValue <= (int8_t)pvRegHoldValue->lMaxVal) )		
+    				if( (cRegHoldValue >= (int8_t)psRegHoldDesc->lMinVal ) && (cRegHoldValue <= (int8_t)psRegHoldDesc->lMaxVal) )		
     				{
-    					*(int8_t*)pvRegHoldValue->pvValue = (int8_t)cRegHoldValue;
-                        pvRegHoldValue->usPreVal = (USHORT)cRegHoldValue;							
+    					*(int8_t*)pvRegHoldValue = (int8_t)cRegHoldValue;
+                        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)cRegHoldValue;							
     				}
     			}
     		}
             iRegIndex++;
             usNRegs--;
         }
+        vSeqWriteEnd(&psMBSlaveDevCur->sDataLock);
     break;
         
     /* write current register values with new values from the protocol stack. */
     case MB_REG_WRITE: 
         while (usNRegs > 0)          
         {
-    		(void)eMBMasterRegHoldingMap(psMBMasterInfo, ucMBDestAddr, iRegIndex, &pvRegHoldValue);     //扫描字典中变量，找出对应的变量
-            if( (pvRegHoldValue != NULL) && (pvRegHoldValue->pvValue != NULL) && (pvRegHoldValue->ucAccessMode != RO) )
+            pvRegHoldValue = NULL;
+    		if(eMBMasterRegHoldingMap(psMBMasterInfo, ucMBDestAddr, iRegIndex, &usIndex) == MB_MRE_NO_ERR)  //扫描字典中变量，找出对应的变量
+            {
+                psRegHoldDesc  = &psMBRegHoldTable->psDescBuf[usIndex];
+                pvRegHoldValue = pvMBMasterRegHoldValue(psMBRegHoldTable, usIndex);
+            }
+            if( (pvRegHoldValue != NULL) && (psRegHoldDesc->ucAccessMode != RO) )
     		{	
-    			if (pvRegHoldValue->ucDataType == uint16)
+                vMBMasterRegHoldSetPending(psMBRegHoldTable, usIndex, FALSE);  //从设备已应答写入
+    			if (psRegHoldDesc->ucDataType == uint16)
     			{
-                    usRegHoldValue = *(USHORT*)pvRegHoldValue->pvValue; 
-    				if( (usRegHoldValue >= (USHORT)pvRegHoldValue->lMinVal ) && (usRegHoldValue <= (USHORT)pvRegHoldValue->lMaxVal))
+                    usRegHoldValue = *(USHORT*)pvRegHoldValue; 
+    				if( (usRegHoldValue >= (USHORT)psRegHoldDesc->lMinVal ) && (usRegHoldValue <= (USHORT)psRegHoldDesc->lMaxVal))
     				{ 
-                        pvRegHoldValue->usPreVal = (USHORT)usRegHoldValue;		 //更新对应点位					
+                        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)usRegHoldValue;		 //更新对应点位					
     				}										
     			}
-    			else if(pvRegHoldValue->ucDataType == uint8)
+    			else if(psRegHoldDesc->ucDataType == uint8)
     			{  
-                    usRegHoldValue = *(UCHAR*)pvRegHoldValue->pvValue;
-    				if( ((UCHAR)usRegHoldValue >= (UCHAR)pvRegHoldValue->lMinVal ) && ((UCHAR)usRegHoldValue <= (UCHAR)pvRegHoldValue->lMaxVal) )
+                    usRegHoldValue = *(UCHAR*)pvRegHoldValue;
+    				if( ((UCHAR)usRegHoldValue >= (UCHAR)psRegHoldDesc->lMinVal ) && ((UCHAR)usRegHoldValue <= (UCHAR)psRegHoldDesc->lMaxVal) )
     				{
-                        pvRegHoldValue->usPreVal = (USHORT)usRegHoldValue;							
+                        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)usRegHoldValue;							
     				}
     			}
-    			else if (pvRegHoldValue->ucDataType == int16)
+    			else if (psRegHoldDesc->ucDataType == int16)
     			{
-    				sRegHoldValue = *(SHORT*)pvRegHoldValue->pvValue;
-    				if( (sRegHoldValue >= (SHORT)pvRegHoldValue->lMinVal ) && (sRegHoldValue <= (SHORT)pvRegHoldValue->lMaxVal) )	
+    				sRegHoldValue = *(SHORT*)pvRegHoldValue;
+    				if( (sRegHoldValue >= (SHORT)psRegHoldDesc->lMinVal ) && (sRegHoldValue <= (SHORT)psRegHoldDesc->lMaxVal) )	
     				{
-    			        pvRegHoldValue->usPreVal = (USHORT)sRegHoldValue;
+    			        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)sRegHoldValue;
     				}			
     			}
-    			else if(pvRegHoldValue->ucDataType == int8)
+    			else if(psRegHoldDesc->ucDataType == int8)
     			{  	
-                    cRegHoldValue = *(int8_t*)pvRegHoldValue->pvValue;
-    				if( (cRegHoldValue >= (int8_t)pvRegHoldValue->lMinVal ) && (cRegHoldValue <= (int8_t)pvRegHoldValue->lMaxVal) )		
+                    cRegHoldValue = *(int8_t*)pvRegHoldValue;
+    				if( (cRegHoldValue >= (int8_t)psRegHoldDesc->lMinVal ) && (cRegHoldValue <= (int8_t)psRegHoldDesc->lMaxVal) )		
     				{
-                        pvRegHoldValue->usPreVal = (USHORT)cRegHoldValue;							
+                        psMBRegHoldTable->pusPreValBuf[usIndex] = (USHORT)cRegHoldValue;							
     				}
     			}
     		}
@@ -219,6 +219,7 @@ eMBErrorCode eMBMasterRegInputCB( sMBMasterInfo* psMBMasterInfo, UCHAR * pucRegB
     }
 
     iRegIndex = usAddress;
+    vSeqWriteBegin(&psMBSlaveDevCur->sDataLock);    //整帧数据一次提交，控制侧读取一致快照
     while (usNRegs > 0)
     {
         (void)eMBMasterRegInMap(psMBMasterInfo, ucMBDestAddr, iRegIndex, &pvRegInValue);    //扫描字典
@@ -266,6 +267,7 @@ eMBErrorCode eMBMasterRegInputCB( sMBMasterInfo* psMBMasterInfo, UCHAR * pucRegB
         iRegIndex++;
         usNRegs--;
     }
+    vSeqWriteEnd(&psMBSlaveDevCur->sDataLock);
     return eStatus;
 }
 
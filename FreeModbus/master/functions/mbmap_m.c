@@ -54,19 +54,19 @@ eMBMasterReqErrCode eMBMasterRegInMap(sMBMasterInfo* psMBMasterInfo, UCHAR ucSnd
  * @brief  保持寄存器字典映射
  * @param  ucSndAddr      从栈地址
  * @param  usRegAddr      寄存器地址
- * @param  pvRegInValue   寄存器指针
+ * @param  pusIndex       点位序号，用于访问点位描述、先前值及待写位
  * @return eMBErrorCode   错误码
  * @author laoc
  * @date 2019.01.22
  *************************************************************************************/
 eMBMasterReqErrCode eMBMasterRegHoldingMap(sMBMasterInfo* psMBMasterInfo, UCHAR ucSndAddr, 
-                                           USHORT usRegAddr, sMasterRegHoldData ** pvRegHoldValue)
+                                           USHORT usRegAddr, USHORT* pusIndex)
 {
 	USHORT usIndex;
     
 	eMBMasterReqErrCode        eStatus  = MB_MRE_NO_ERR;
     sMBSlaveDev*        psMBSlaveDevCur = psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur;     //当前从设备
-    sMBDevDataTable*   psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable;
+    sMBDevRegHoldTable* psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable;
     
     if(psMBSlaveDevCur->ucDevAddr != ucSndAddr) //如果当前从设备地址与要轮询从设备地址不一致，则更新从设备
     {
@@ -74,22 +74,20 @@ eMBMasterReqErrCode eMBMasterRegHoldingMap(sMBMasterInfo* psMBMasterInfo, UCHAR
         psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur = psMBSlaveDevCur;
         psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable;
     } 
-	if( (psMBRegHoldTable->pvDataBuf == NULL) || (psMBRegHoldTable->usDataCount == 0)) //非空且数据点不为0
+	if( (psMBRegHoldTable->psDescBuf == NULL) || (psMBRegHoldTable->usDataCount == 0)) //非空且数据点不为0
 	{
 		return MB_MRE_ILL_ARG;
 	}
-    if(psMBSlaveDevCur->psDevCurData->pxDevDataMapIndex == NULL || psMBRegHoldTable == NULL || psMBRegHoldTable->pvDataBuf == NULL)
+    if( (usRegAddr < psMBRegHoldTable->usStartAddr) || (usRegAddr > psMBRegHoldTable->usEndAddr) )
     {
-         return MB_MRE_EILLSTATE;
-    }
-	if( psMBSlaveDevCur->psDevCurData->pxDevDataMapIndex(RegHoldData, psMBSlaveDevCur->ucProtocolID, usRegAddr, &usIndex))  //字典映射函数
-    {
-        *pvRegHoldValue = (sMasterRegHoldData*)(psMBRegHoldTable->pvDataBuf) + usIndex;
+        return MB_MRE_NO_REG;
     }
-	else
+    usIndex = psMBRegHoldTable->pucAddrIndex[usRegAddr - psMBRegHoldTable->usStartAddr];  //地址索引表直接查序号
+	if( (usIndex == MB_ADDR_INDEX_NONE) || (usIndex >= psMBRegHoldTable->usDataCount) )
 	{
         return MB_MRE_NO_REG;
     }
+    *pusIndex = usIndex;
     return eStatus;		
 } 
 #endif
@@ -187,22 +185,144 @@ eMBMasterReqErrCode eMBMasterDiscreteMap(sMBMasterInfo* psMBMasterInfo, UCHAR uc
 #endif
 
 /***********************************************************************************
- * @brief  保持寄存器数据点初始化
- * @author laoc
- * @date 2019.01.22
+ * @brief  保持寄存器数据表初始化，点位描述为常量表，实例先前值取描述中的初值。
+ *         起止地址取首、末点位地址，由点位表生成地址索引表，同时校验点位地址
+ *         严格递增且地址跨度不超出索引表容量，轮询按点位表顺序合并连续地址，依赖此顺序
+ * @param  psDescBuf       点位描述表(同协议设备共用)
+ * @param  pucAddrIndex    地址索引表(同协议设备共用)，重复生成结果相同，不会出现中间态
+ * @param  usIndexSize     地址索引表容量，不小于地址跨度
+ * @param  ppvObjList      变量所属对象列表，按点位描述中的对象序号索引
+ * @param  pusPreValBuf    先前值，不少于usDataCount个
+ * @param  pucPendingBits  待写位图，不少于MB_BITMAP_BYTES(usDataCount)字节
+ * @return 点位表不合法时返回FALSE，数据表置空，该设备不轮询保持寄存器
  *************************************************************************************/
-void vMBMasterDevRegHoldDataInit(sMasterRegHoldData* pData, USHORT usAddr, UCHAR ucDataType, LONG lMinVal, LONG lMaxVal, 
-                                 USHORT usPreVal, UCHAR ucAccessMode, float fTransmitMultiple, void* pvValue)                                  
+BOOL xMBMasterDevRegHoldTableInit(sMBDevRegHoldTable* psTable, const sMasterRegHoldDesc* psDescBuf, USHORT usDataCount, 
+                                  UCHAR* pucAddrIndex, USHORT usIndexSize, void** ppvObjList, 
+                                  USHORT* pusPreValBuf, UCHAR* pucPendingBits)
+{
+    USHORT n, i;
+    USHORT usAddrSpan;
+    
+    psTable->psDescBuf      = psDescBuf;
+    psTable->pucAddrIndex   = pucAddrIndex;
+    psTable->ppvObjList     = ppvObjList;
+    psTable->pusPreValBuf   = pusPreValBuf;
+    psTable->pucPendingBits = pucPendingBits;
+    psTable->pfMultipleBuf  = NULL;
+    psTable->usDataCount    = 0;
+    
+    if( (usDataCount == 0) || (usDataCount >= MB_ADDR_INDEX_NONE) )
+    {
+        return FALSE;
+    }
+    psTable->usStartAddr = psDescBuf[0].usAddr;
+    psTable->usEndAddr   = psDescBuf[usDataCount-1].usAddr;
+    if( (psTable->usEndAddr < psTable->usStartAddr) || (psTable->usEndAddr - psTable->usStartAddr >= usIndexSize) )
+    {
+        return FALSE;
+    }
+    usAddrSpan = psTable->usEndAddr - psTable->usStartAddr + 1;
+    
+    for(i = 0, n = 0; i < usAddrSpan; i++)  //点位地址递增时依次命中，乱序、重复或越界的点位不会被命中
+    {
+        if( (n < usDataCount) && (psDescBuf[n].usAddr == psTable->usStartAddr + i) )
+        {
+            pucAddrIndex[i] = (UCHAR)n;
+            n++;
+        }
+        else
+        {
+            pucAddrIndex[i] = MB_ADDR_INDEX_NONE;
+        }
+    }
+    if(n != usDataCount)
+    {
+        return FALSE;
+    }
+    for(n = 0; n < usDataCount; n++)
+    {
+        pusPreValBuf[n] = psDescBuf[n].usPreValInit;
+    }
+    memset(pucPendingBits, 0, MB_BITMAP_BYTES(usDataCount));
+    
+    psTable->usDataCount = usDataCount;
+    return TRUE;
+}
 
+/***********************************************************************************
+ * @brief  保持寄存器点位对应的变量地址
+ * @return 所属对象未绑定时返回NULL
+ *************************************************************************************/
+void* pvMBMasterRegHoldValue(const sMBDevRegHoldTable* psTable, USHORT usIndex)
 {
-    pData->usAddr            = usAddr;              //地址
-    pData->ucDataType        = ucDataType;          //数据类型
-    pData->usPreVal          = usPreVal;            //先前值
-    pData->lMinVal           = lMinVal;             //最小值
-    pData->lMaxVal           = lMaxVal;             //最大值
-    pData->ucAccessMode      = ucAccessMode;        //访问权限
-    pData->fTransmitMultiple = fTransmitMultiple;   //传输因子
-    pData->pvValue           = pvValue;             //变量指针 	
+    const sMasterRegHoldDesc* psDesc = &psTable->psDescBuf[usIndex];
+    
+    if(psTable->ppvObjList[psDesc->ucObj] == NULL)
+    {
+        return NULL;
+    }
+    return (void*)((UCHAR*)psTable->ppvObjList[psDesc->ucObj] + psDesc->usOffset);
+}
+
+/***********************************************************************************
+ * @brief  保持寄存器点位的传输因子，绑定了实例传输因子时取实例值
+ *************************************************************************************/
+float fMBMasterRegHoldMultiple(const sMBDevRegHoldTable* psTable, USHORT usIndex)
+{
+    if(psTable->pfMultipleBuf != NULL)
+    {
+        return psTable->pfMultipleBuf[usIndex];
+    }
+    return psTable->psDescBuf[usIndex].fTransmitMultiple;
+}
+
+/***********************************************************************************
+ * @brief  绑定本实例传输因子表
+ *************************************************************************************/
+void vMBMasterRegHoldSetMultiple(sMBDevRegHoldTable* psTable, const float* pfMultipleBuf)
+{
+    psTable->pfMultipleBuf = pfMultipleBuf;
+}
+
+/***********************************************************************************
+ * @brief  保持寄存器点位是否待写
+ *************************************************************************************/
+BOOL xMBMasterRegHoldPending(const sMBDevRegHoldTable* psTable, USHORT usIndex)
+{
+    return (psTable->pucPendingBits[usIndex >> 3] & (1 << (usIndex & 0x07))) ? TRUE : FALSE;
+}
+
+/***********************************************************************************
+ * @brief  设置保持寄存器点位待写位
+ *************************************************************************************/
+void vMBMasterRegHoldSetPending(sMBDevRegHoldTable* psTable, USHORT usIndex, BOOL xPending)
+{
+    if(xPending)
+    {
+        psTable->pucPendingBits[usIndex >> 3] |= (UCHAR)(1 << (usIndex & 0x07));
+    }
+    else
+    {
+        psTable->pucPendingBits[usIndex >> 3] &= (UCHAR)~(1 << (usIndex & 0x07));
+    }
+}
+
+/***********************************************************************************
+ * @brief  清除地址段内点位的待写位，用于写请求失败或从设备掉线
+ * @param  usRegAddr  起始地址
+ * @param  usNRegs    寄存器数量
+ *************************************************************************************/
+void vMBMasterRegHoldClearPending(sMBDevRegHoldTable* psTable, USHORT usRegAddr, USHORT usNRegs)
+{
+    USHORT n;
+    
+    for(n = 0; n < psTable->usDataCount; n++)
+    {
+        if( (psTable->psDescBuf[n].usAddr >= usRegAddr) && (psTable->psDescBuf[n].usAddr - usRegAddr < usNRegs) )
+        {
+            vMBMasterRegHoldSetPending(psTable, n, FALSE);
+        }
+    }
 }
 
 /***********************************************************************************
@@ -1,6 +1,7 @@
 #ifndef _USER_MB_MAP_M_H
 #define _USER_MB_MAP_M_H
 
+#include "stddef.h"
 #include "mbframe.h"
 #include "mb_m.h"
 
@@ -19,10 +20,32 @@
         pvDataBuf   = (void*)BUF; \
         psDataTable = (sMBDevDataTable*)TABLE;
   
-//保持寄存器数据申请  
-#define MASTER_REG_HOLD_DATA(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8) \
-        vMBMasterDevRegHoldDataInit((sMasterRegHoldData*)pvDataBuf + usIndex, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8); \
-        usIndex++;
+//保持寄存器点位描述，用于文件域常量表：地址、类型、最小值、最大值、先前值初值、访问权限、传输因子，
+//变量以所属对象序号、对象类型、成员名给出，同协议设备共用一张表。
+//仅主栈保持寄存器使用点位表，地址索引表在初始化时生成；输入寄存器、线圈、离散量仍由
+//MASTER_*_DATA、MASTER_END_DATA_BUF与设备映射函数手工维护，从栈字典同样手工维护
+#define MASTER_REG_HOLD_DESC(arg1, arg2, arg3, arg4, arg5, arg6, arg7, OBJ, OBJ_TYPE, MEMBER) \
+        {arg1, arg2, arg6, OBJ, (USHORT)offsetof(OBJ_TYPE, MEMBER), arg5, arg3, arg4, arg7},
+
+#define MASTER_DESC_NUM(DESC)  (sizeof(DESC) / sizeof(DESC[0]))
+
+//点位描述表编译期检查：点位数不超过实例先前值容量，且可用单字节地址索引表示
+#define MASTER_REG_HOLD_DESC_CHECK(DESC, NUM) \
+        typedef char DESC##_NumCheck[((MASTER_DESC_NUM(DESC) <= (NUM)) && (MASTER_DESC_NUM(DESC) < MB_ADDR_INDEX_NONE)) ? 1 : -1];
+
+//保持寄存器数据表绑定：常量点位表、地址索引表与本实例的对象列表、先前值、待写位图。
+//起止地址取首、末点位地址，地址索引表长度为容量，映射与轮询均由点位表生成，点位表不合法时输出提示
+#define MASTER_REG_HOLD_TABLE(TABLE, DESC, ADDR_INDEX, OBJ_LIST, PRE_VAL_BUF, PENDING_BITS) \
+        if(xMBMasterDevRegHoldTableInit((sMBDevRegHoldTable*)TABLE, DESC, (USHORT)MASTER_DESC_NUM(DESC), \
+                                        (UCHAR*)ADDR_INDEX, (USHORT)sizeof(ADDR_INDEX), (void**)OBJ_LIST, \
+                                        (USHORT*)PRE_VAL_BUF, (UCHAR*)PENDING_BITS) == FALSE) \
+        { \
+            myprintf("MASTER_REG_HOLD_TABLE " #DESC " invalid, holding registers not polled\n"); \
+        }
+
+//保持寄存器实例传输因子绑定：传输因子随设备实例变化时使用，长度不小于点位数，须在MASTER_REG_HOLD_TABLE之后调用
+#define MASTER_REG_HOLD_MULTIPLE(TABLE, MULTIPLE_BUF) \
+        vMBMasterRegHoldSetMultiple((sMBDevRegHoldTable*)TABLE, (const float*)MULTIPLE_BUF);
         
 //输入寄存器数据申请  
 #define MASTER_REG_IN_DATA(arg1, arg2, arg3, arg4, arg5, arg6, arg7) \
@@ -63,7 +86,7 @@ eMBMasterReqErrCode eMBMasterRegInMap(sMBMasterInfo* psMBMasterInfo, UCHAR ucSnd
                                       USHORT usRegAddr, sMasterRegInData ** pvRegInValue);
 
 eMBMasterReqErrCode eMBMasterRegHoldingMap(sMBMasterInfo* psMBMasterInfo, UCHAR ucSndAddr, 
-                                           USHORT usRegAddr, sMasterRegHoldData ** pvRegHoldValue);
+                                           USHORT usRegAddr, USHORT* pusIndex);
 
 eMBMasterReqErrCode eMBMasterCoilMap(sMBMasterInfo* psMBMasterInfo, UCHAR ucSndAddr, 
                                      USHORT usCoilAddr, sMasterBitCoilData ** pvCoilValue);
@@ -72,8 +95,16 @@ eMBMasterReqErrCode eMBMasterDiscreteMap(sMBMasterInfo* psMBMasterInfo, UCHAR uc
                                          USHORT usDiscreteAddr, sMasterBitDiscData ** pvDiscreteValue);
 
 
-void vMBMasterDevRegHoldDataInit(sMasterRegHoldData* pData, USHORT usAddr, UCHAR ucDataType, LONG lMinVal, LONG lMaxVal, 
-                                 USHORT usPreVal, UCHAR ucAccessMode, float fTransmitMultiple, void* pvValue);
+BOOL xMBMasterDevRegHoldTableInit(sMBDevRegHoldTable* psTable, const sMasterRegHoldDesc* psDescBuf, USHORT usDataCount, 
+                                  UCHAR* pucAddrIndex, USHORT usIndexSize, void** ppvObjList, 
+                                  USHORT* pusPreValBuf, UCHAR* pucPendingBits);
+
+void* pvMBMasterRegHoldValue(const sMBDevRegHoldTable* psTable, USHORT usIndex);
+float fMBMasterRegHoldMultiple(const sMBDevRegHoldTable* psTable, USHORT usIndex);
+void  vMBMasterRegHoldSetMultiple(sMBDevRegHoldTable* psTable, const float* pfMultipleBuf);
+BOOL  xMBMasterRegHoldPending(const sMBDevRegHoldTable* psTable, USHORT usIndex);
+void  vMBMasterRegHoldSetPending(sMBDevRegHoldTable* psTable, USHORT usIndex, BOOL xPending);
+void  vMBMasterRegHoldClearPending(sMBDevRegHoldTable* psTable, USHORT usRegAddr, USHORT usNRegs);
 
 void vMBMasterDevRegInDataInit(sMasterRegInData* pData, USHORT usAddr, UCHAR ucDataType, LONG lMinVal, 
                             LONG lMaxVal, UCHAR ucAccessMode, float fTransmitMultiple, void* pvValue);   
@@ -4,6 +4,7 @@
 
 #include "mbfunc_m.h"
 #include "mbdict_m.h"
+#include "mbmap_m.h"
 #include "mbtest_m.h"
 #include "mbscan_m.h"
 
@@ -111,6 +112,24 @@ eMBMasterReqWriteHoldReg(sMBMasterInfo* psMBMasterInfo, UCHAR ucSndAddr, USHORT
     return eStatus;
 }
 
+/***********************************************************************************
+ * @brief  轮询写保持寄存器，写失败(超时、异常应答)时清除该段点位的待写位，
+ *         读回从设备数值，本地值仍与先前值不同时下次轮询重新写入
+ *************************************************************************************/
+static eMBMasterReqErrCode eMBMasterScanWriteHoldReg(sMBMasterInfo* psMBMasterInfo, sMBDevRegHoldTable* psMBRegHoldTable,
+                                                     UCHAR ucSndAddr, USHORT usRegAddr, USHORT usNRegs)
+{
+    eMBMasterReqErrCode eStatus = MB_MRE_NO_ERR;
+    
+    eStatus = eMBMasterReqWriteHoldReg(psMBMasterInfo, ucSndAddr, usRegAddr, usNRegs, 
+                                       (USHORT*)psMBMasterInfo->RegHoldValList, MB_MASTER_WAITING_DELAY);
+    if(eStatus != MB_MRE_NO_ERR)
+    {
+        vMBMasterRegHoldClearPending(psMBRegHoldTable, usRegAddr, usNRegs);
+    }
+    return eStatus;
+}
+
 /***********************************************************************************
  * @brief  轮询保持寄存器
  * @param  ucSndAddr            从栈地址
@@ -130,10 +149,12 @@ eMBMasterReqErrCode eMBMasterScanHoldingRegister(sMBMasterInfo* psMBMasterInfo,
 	int8_t cRegHoldValue  =0;
 
 	eMBMasterReqErrCode eStatus        = MB_MRE_NO_ERR;
-    sMasterRegHoldData* psRegHoldValue = NULL;
+    void*               pvRegHoldValue = NULL;
+    const sMasterRegHoldDesc* psRegHoldDesc = NULL;
+    float               fMultiple      = 1.0;
     
-    sMBSlaveDev*     psMBSlaveDevCur  = psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur;     //当前从设备
-    sMBDevDataTable* psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable; //从设备通讯协议表
+    sMBSlaveDev*        psMBSlaveDevCur  = psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur;     //当前从设备
+    sMBDevRegHoldTable* psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable; //从设备通讯协议表
 	
 	iLastAddr = 0;
 	iReadStartRegAddr = 0;
@@ -153,79 +174,85 @@ eMBMasterReqErrCode eMBMasterScanHoldingRegister(sMBMasterInfo* psMBMasterInfo,
         psMBMasterInfo->sMBDevsInfo.psMBSlaveDevCur = psMBSlaveDevCur;
         psMBRegHoldTable = &psMBSlaveDevCur->psDevCurData->sMBRegHoldTable;
     }
-    if( (psMBRegHoldTable->pvDataBuf  == NULL) || (psMBRegHoldTable->usDataCount == 0)) //非空且数据点不为0
+    if( (psMBRegHoldTable->psDescBuf  == NULL) || (psMBRegHoldTable->usDataCount == 0)) //非空且数据点不为0
 	{
 		return eStatus;
 	}
     
 	for(iIndex = 0; iIndex < psMBRegHoldTable->usDataCount; iIndex++)  //轮询
 	{
-		psRegHoldValue = (sMasterRegHoldData*)psMBRegHoldTable->pvDataBuf + iIndex;
+		psRegHoldDesc = &psMBRegHoldTable->psDescBuf[iIndex];       //点位描述顺序读取Flash常量表
+        pvRegHoldValue = pvMBMasterRegHoldValue(psMBRegHoldTable, iIndex);
+        fMultiple      = fMBMasterRegHoldMultiple(psMBRegHoldTable, iIndex);
 		
 		/******************* 写保持寄存器***************************/
         if(xWriteEn)
         {
-            if( (psRegHoldValue != NULL) && (psRegHoldValue->pvValue != NULL) && (psRegHoldValue->ucAccessMode != RO) )   //寄存器非只读
+            if( (pvRegHoldValue != NULL) && (psRegHoldDesc->ucAccessMode != RO) )   //寄存器非只读
 		    {
-		    	switch (psRegHoldValue->ucDataType)
+		    	switch (psRegHoldDesc->ucDataType)
                 {	
                 case uint16:	
-                    usRegHoldValue = *(USHORT*)psRegHoldValue->pvValue;
-                    if( psRegHoldValue->fTransmitMultiple != 1.0)
+                    usRegHoldValue = *(USHORT*)pvRegHoldValue;
+                    if(fMultiple != 1.0)
 		    	    {
-		    	    	usRegHoldValue = (USHORT)( (float)usRegHoldValue * (float)psRegHoldValue->fTransmitMultiple ); //传输因子
+		    	    	usRegHoldValue = (USHORT)( (float)usRegHoldValue * fMultiple ); //传输因子
 		    	    }
-		    	    if( (USHORT)psRegHoldValue->usPreVal != usRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
+		    	    if( (USHORT)psMBRegHoldTable->pusPreValBuf[iIndex] != usRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
                     {		
-                        if( (usRegHoldValue >= (USHORT)psRegHoldValue->lMinVal) && (usRegHoldValue <= (USHORT)psRegHoldValue->lMaxVal) )
+                        if( (usRegHoldValue >= (USHORT)psRegHoldDesc->lMinVal) && (usRegHoldValue <= (USHORT)psRegHoldDesc->lMaxVal) )
                         {
                         	psMBMasterInfo->RegHoldValList[iWriteCount] = (USHORT)usRegHoldValue;
                             iWriteCount++;
+                            vMBMasterRegHoldSetPending(psMBRegHoldTable, iIndex, TRUE);  //待写，应答前不被读回值覆盖
                         }
                    	}	
                 break;     
                 case uint8: 		
-                   	usRegHoldValue = *(UCHAR*)psRegHoldValue->pvValue;
-                    if( psRegHoldValue->fTransmitMultiple != 1.0)
+                   	usRegHoldValue = *(UCHAR*)pvRegHoldValue;
+                    if(fMultiple != 1.0)
 		    		{
-		    			usRegHoldValue =  (UCHAR)( (float)usRegHoldValue * (float)psRegHoldValue->fTransmitMultiple ); //传输因子
+		    			usRegHoldValue =  (UCHAR)( (float)usRegHoldValue * fMultiple ); //传输因子
 		    		}
-                   	if( (USHORT)psRegHoldValue->usPreVal != usRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
+                   	if( (USHORT)psMBRegHoldTable->pusPreValBuf[iIndex] != usRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
                    	{
-                        if( (usRegHoldValue >= (USHORT)psRegHoldValue->lMinVal) && (usRegHoldValue <= (USHORT)psRegHoldValue->lMaxVal) )
+                        if( (usRegHoldValue >= (USHORT)psRegHoldDesc->lMinVal) && (usRegHoldValue <= (USHORT)psRegHoldDesc->lMaxVal) )
                         {
                             psMBMasterInfo->RegHoldValList[iWriteCount] = (USHORT)usRegHoldValue;
                             iWriteCount++;
+                            vMBMasterRegHoldSetPending(psMBRegHoldTable, iIndex, TRUE);
                         }			
                    	}	
                 break;    
                 case int16:		
-                   	sRegHoldValue = *(SHORT*)psRegHoldValue->pvValue;
-		    	    if( psRegHoldValue->fTransmitMultiple != 1.0)
+                   	sRegHoldValue = *(SHORT*)pvRegHoldValue;
+		    	    if(fMultiple != 1.0)
 		    		{
-		                sRegHoldValue = (SHORT)( (float)sRegHoldValue * (float)psRegHoldValue->fTransmitMultiple ); //传输因子
+		                sRegHoldValue = (SHORT)( (float)sRegHoldValue * fMultiple ); //传输因子
 		    		}
-                   	if( (SHORT)psRegHoldValue->usPreVal != sRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
+                   	if( (SHORT)psMBRegHoldTable->pusPreValBuf[iIndex] != sRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
                    	{
-                        if( (sRegHoldValue >= (SHORT)psRegHoldValue->lMinVal) && (sRegHoldValue <= (SHORT)psRegHoldValue->lMaxVal) )
+                        if( (sRegHoldValue >= (SHORT)psRegHoldDesc->lMinVal) && (sRegHoldValue <= (SHORT)psRegHoldDesc->lMaxVal) )
                         {
                             psMBMasterInfo->RegHoldValList[iWriteCount] = (USHORT)sRegHoldValue;
                             iWriteCount++;
+                            vMBMasterRegHoldSetPending(psMBRegHoldTable, iIndex, TRUE);
                         }
                    	}		
                 break; 
                 case int8:
-                    cRegHoldValue = *(int8_t*)psRegHoldValue->pvValue;
-		    	    if( psRegHoldValue->fTransmitMultiple != 1.0)
+                    cRegHoldValue = *(int8_t*)pvRegHoldValue;
+		    	    if(fMultiple != 1.0)
 		    	    {
-		    	        cRegHoldValue = (int8_t)( (float)cRegHoldValue * (float)psRegHoldValue->fTransmitMultiple ); //传输因子
+		    	        cRegHoldValue = (int8_t)( (float)cRegHoldValue * fMultiple ); //传输因子
 		    	    }
-                    if( (int8_t)psRegHoldValue->usPreVal != cRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
+                    if( (int8_t)psMBRegHoldTable->pusPreValBuf[iIndex] != cRegHoldValue || xCheckPreValue == FALSE )  //变量变化且或者不检查是否变化
                     {
-                        if( (cRegHoldValue >= (int8_t)psRegHoldValue->lMinVal) && (cRegHoldValue <= (int8_t)psRegHoldValue->lMaxVal) )
+                        if( (cRegHoldValue >= (int8_t)psRegHoldDesc->lMinVal) && (cRegHoldValue <= (int8_t)psRegHoldDesc->lMaxVal) )
                         {
                             psMBMasterInfo->RegHoldValList[iWriteCount] = (USHORT)cRegHoldValue;
                             iWriteCount++;
+                            vMBMasterRegHoldSetPending(psMBRegHoldTable, iIndex, TRUE);
                         }		
                     }	
                 break;
@@ -235,29 +262,27 @@ eMBMasterReqErrCode eMBMasterScanHoldingRegister(sMBMasterInfo* psMBMasterInfo,
             
             if(iWriteCount == 1 && (bStarted != TRUE))    //记录首地址
             {
-                iWriteStartRegAddr = psRegHoldValue->usAddr;
+                iWriteStartRegAddr = psRegHoldDesc->usAddr;
                 bStarted = TRUE;
                 iRegs = 1;
             }
-            if( psRegHoldValue->usAddr != iLastAddr+1 && iWriteCount>0 && iRegs>1 )    //地址不连续，则发送写请求
+            if( psRegHoldDesc->usAddr != iLastAddr+1 && iWriteCount>0 && iRegs>1 )    //地址不连续，则发送写请求
             {
        	        if(iRegs == iWriteCount)    //地址不连续且当前寄存器也发生了变化
        	        {
                     nRegs = iWriteCount-1;
-       	            eStatus = eMBMasterReqWriteHoldReg(psMBMasterInfo, ucSndAddr, iWriteStartRegAddr, iWriteCount-1, 
-       	                                              (USHORT*)psMBMasterInfo->RegHoldValList, MB_MASTER_WAITING_DELAY);	//写寄存器
+       	            eStatus = eMBMasterScanWriteHoldReg(psMBMasterInfo, psMBRegHoldTable, ucSndAddr, iWriteStartRegAddr, iWriteCount-1);	//写寄存器
                     iWriteCount = 1;    //记录当前位置
        	            iRegs = 1;
        	            bStarted = TRUE;
-       	            iWriteStartRegAddr = psRegHoldValue->usAddr;
+       	            iWriteStartRegAddr = psRegHoldDesc->usAddr;
                     
       	            psMBMasterInfo->RegHoldValList[0] = psMBMasterInfo->RegHoldValList[nRegs];
        	        }
        	        else                         //地址不连续但当前寄存器也没有变化
        	        {
                     nRegs = iWriteCount;
-       	            eStatus = eMBMasterReqWriteHoldReg(psMBMasterInfo, ucSndAddr, iWriteStartRegAddr, iWriteCount, 
-       	                                              (USHORT*)psMBMasterInfo->RegHoldValList, MB_MASTER_WAITING_DELAY);	//写寄存器
+       	            eStatus = eMBMasterScanWriteHoldReg(psMBMasterInfo, psMBRegHoldTable, ucSndAddr, iWriteStartRegAddr, iWriteCount);	//写寄存器
                     iWriteCount = 0;
        	            iRegs = 0;
        	            bStarted = FALSE;
@@ -269,8 +294,7 @@ eMBMasterReqErrCode eMBMasterScanHoldingRegister(sMBMasterInfo* psMBMasterInfo,
 		    	if( (iRegs != iWriteCount) || (iIndex == psMBRegHoldTable->usDataCount-1) || (iWriteCount >= MB_SCAN_MAX_REG_NUM)) 
                 {                                                                                                                  
                     nRegs = iWriteCount;
-                    eStatus = eMBMasterReqWriteHoldReg(psMBMasterInfo, ucSndAddr, iWriteStartRegAddr, iWriteCount, 
-                                                      (USHORT*)psMBMasterInfo->RegHoldValList, MB_MASTER_WAITING_DELAY);	//写寄存器
+                    eStatus = eMBMasterScanWriteHoldReg(psMBMasterInfo, psMBRegHoldTable, ucSndAddr, iWriteStartRegAddr, iWriteCount);	//写寄存器
                     iWriteCount = 0;
                     iRegs = 0;
                     bStarted = FALSE;                
@@ -280,38 +304,38 @@ eMBMasterReqErrCode eMBMasterScanHoldingRegister(sMBMasterInfo* psMBMasterInfo,
         /***************************** 读保持寄存器 **********************************/
         if(xReadEn)
         {        
-            if( (psRegHoldValue->usAddr - iLastAddr + 1) > MB_SCAN_MAX_REG_INTERVAL)    //地址间隔超过最大间隔，则发送读请求
+            if( (psRegHoldDesc->usAddr - iLastAddr + 1) > MB_SCAN_MAX_REG_INTERVAL)    //地址间隔超过最大间隔，则发送读请求
             {
                 if(iReadCount > 0)
                 {
                     eStatus = eMBMasterReqReadHoldingRegister(psMBMasterInfo, ucSndAddr, iReadStartRegAddr, iReadCount, MB_MASTER_WAITING_DELAY);
                     iReadCount = 0;
                 }
-                if(psRegHoldValue->ucAccessMode != WO)
+                if(psRegHoldDesc->ucAccessMode != WO)
                 {
                     iReadCount = 1;
-                    iReadStartRegAddr = psRegHoldValue->usAddr;
+                    iReadStartRegAddr = psRegHoldDesc->usAddr;
                 }
             }
             else   //地址连续
             {	
-            	if(iReadCount == 0 && psRegHoldValue->ucAccessMode != WO)
+            	if(iReadCount == 0 && psRegHoldDesc->ucAccessMode != WO)
             	{
-            	    iReadStartRegAddr = psRegHoldValue->usAddr;
+            	    iReadStartRegAddr = psRegHoldDesc->usAddr;
             	}
-            	if(psRegHoldValue->ucAccessMode != WO)
+            	if(psRegHoldDesc->ucAccessMode != WO)
             	{
-            	    iReadCount = psRegHoldValue->usAddr - iReadStartRegAddr + 1;
+            	    iReadCount = psRegHoldDesc->usAddr - iReadStartRegAddr + 1;
             	}
             }
             //1.寄存器为只写，2. 到达数据域的末尾，3. 数据超过Modbus数据帧最大字节数 发送读请求
-            if( (psRegHoldValue->ucAccessMode == WO || iIndex == psMBRegHoldTable->usDataCount-1 || iReadCount >= MB_SCAN_MAX_REG_NUM) && (iReadCount > 0) )  
+            if( (psRegHoldDesc->ucAccessMode == WO || iIndex == psMBRegHoldTable->usDataCount-1 || iReadCount >= MB_SCAN_MAX_REG_NUM) && (iReadCount > 0) )  
             {
                 eStatus = eMBMasterReqReadHoldingRegister(psMBMasterInfo, ucSndAddr, iReadStartRegAddr, iReadCount, MB_MASTER_WAITING_DELAY);
                 iReadCount = 0;	 
             }
         }
-        iLastAddr = psRegHoldValue->usAddr;
+        iLastAddr = psRegHoldDesc->usAddr;
 	}
     return eStatus;
 }
@@ -1,6 +1,7 @@
 #include "mbrtu_m.h"
 #include "mbtest_m.h"
 #include "mbfunc_m.h"
+#include "mbmap_m.h"
 
 #define MB_MASTER_DEV_OFFLINE_TMR_S      10
 #define MB_TEST_RETRY_TIMES              2
@@ -17,7 +18,6 @@
  *********************************************************************/
 void vMBMasterDevOfflineTimeout(void * p_tmr, void * p_arg)
 {
-    OS_ERR err = OS_ERR_NONE;
 
     sMBSlaveDev* psMBSlaveDev = (sMBSlaveDev*)p_arg;
     psMBSlaveDev->xDevOnTimeout = FALSE; 
@@ -32,25 +32,15 @@ void vMBMasterDevOfflineTimeout(void * p_tmr, void * p_arg)
  *********************************************************************/
 BOOL xMBMasterDevOfflineTmrEnable(sMBSlaveDev* psMBDev)
 {
-    OS_STATE  sTmrState;
-    
-    OS_ERR err = OS_ERR_NONE;
-	OS_TICK i = 0;
+    BOOL xResult = TRUE;
     
-    sTmrState = OSTmrStateGet(&psMBDev->sDevOfflineTmr, &err);
-    if(sTmrState == OS_TMR_STATE_UNUSED)
+    if(usGetTmrState(&psMBDev->sDevOfflineTmr) != OS_TMR_STATE_RUNNING)
     { 
-        i = (OS_TICK)(MB_MASTER_DEV_OFFLINE_TMR_S * TMR_TICK_PER_SECOND);  //延时10s
-        
-        OSTmrCreate(&psMBDev->sDevOfflineTmr, "sDevOfflineTmr", i, 0, OS_OPT_TMR_ONE_SHOT, 
-                    vMBMasterDevOfflineTimeout, (void*)psMBDev, &err);//从设备定时器
-    }
-    if(sTmrState != OS_TMR_STATE_RUNNING)
-    {
-        (void)OSTmrStart(&psMBDev->sDevOfflineTmr, &err); 
+        xResult = xTimerRegist(&psMBDev->sDevOfflineTmr, MB_MASTER_DEV_OFFLINE_TMR_S, 0, OS_OPT_TMR_ONE_SHOT, 
+                               vMBMasterDevOfflineTimeout, (void*)psMBDev, FALSE);  //从设备定时器，延时10s
     }
     psMBDev->xDevOnTimeout = TRUE;
-    return (err == OS_ERR_NONE);
+    return xResult;
 }
 
 /**********************************************************************
@@ -65,7 +55,6 @@ BOOL xMBMasterDevOfflineTmrEnable(sMBSlaveDev* psMBDev)
 eMBMasterReqErrCode 
 eMBDevCmdTest(sMBMasterInfo* psMBMasterInfo, const sMBSlaveDev* psMBSlaveDev, const sMBTestDevCmd* psMBDevCmd)
 {
-    OS_ERR err = OS_ERR_NONE;
     eMBMasterReqErrCode errorCode = MB_MRE_EILLSTATE;
    
     if(psMBDevCmd == NULL)
@@ -116,28 +105,18 @@ void vMBDevHeartBeatTimeInd(void * p_tmr, void * p_arg)
  *********************************************************************/
 BOOL xMBMasterDevDevHeartTmrEnable(sMBSlaveDev* psMBSlaveDev)
 {
-    OS_STATE  sTmrState;
-    
-    OS_ERR err = OS_ERR_NONE;
-	OS_TICK i = 0;
+    BOOL xResult = TRUE;
     
     if(psMBSlaveDev->psDevCurData->sMBDevHeartBeat.xHeartBeatEnable == TRUE)
     {
-        sTmrState = OSTmrStateGet(&psMBSlaveDev->sDevHeartBeatTmr, &err);
-        if(sTmrState == OS_TMR_STATE_UNUSED)
-        { 
-            i = (OS_TICK)(psMBSlaveDev->psDevCurData->sMBDevHeartBeat.usHeartBeatPeriod * TMR_TICK_PER_SECOND);
-            
-            OSTmrCreate(&psMBSlaveDev->sDevHeartBeatTmr, "sDevHeartBeatTmr", 0, i, 
-                        OS_OPT_TMR_PERIODIC, vMBDevHeartBeatTimeInd, (void*)psMBSlaveDev, &err);      //心跳间隔定时器
-        }
-        if(sTmrState != OS_TMR_STATE_RUNNING)
+        if(usGetTmrState(&psMBSlaveDev->sDevHeartBeatTmr) != OS_TMR_STATE_RUNNING)
         {
-            (void)OSTmrStart(&psMBSlaveDev->sDevHeartBeatTmr, &err);
+            xResult = xTimerRegist(&psMBSlaveDev->sDevHeartBeatTmr, 0, psMBSlaveDev->psDevCurData->sMBDevHeartBeat.usHeartBeatPeriod, 
+                                   OS_OPT_TMR_PERIODIC, vMBDevHeartBeatTimeInd, (void*)psMBSlaveDev, FALSE);  //心跳间隔定时器
             myprintf("sDevHeartBeatTmr ucDevAddr %d \n", psMBSlaveDev->ucDevAddr);             
         }
     }
-    return (err == OS_ERR_NONE);
+    return xResult;
 }
 
 /**********************************************************************
@@ -146,7 +125,6 @@ BOOL xMBMasterDevDevHeartTmrEnable(sMBSlaveDev* psMBSlaveDev)
 eMBMasterReqErrCode eMBDevHeartBeat(sMBSlaveDev* psMBSlaveDev)
 {
     CPU_TS ts  = 0;
-    OS_ERR err = OS_ERR_NONE;
     
     sMBMasterInfo*   psMBMasterInfo = psMBSlaveDev->psMBMasterInfo;
     sMBDevHeartBeat* psDevHeartBeat = &psMBSlaveDev->psDevCurData->sMBDevHeartBeat;
@@ -268,7 +246,6 @@ void vMBDevTest(sMBMasterInfo* psMBMasterInfo, sMBSlaveDev* psMBSlaveDev)
     UCHAR     n, iIndex, nSlaveTypes;
     USHORT    usDataVal;
 
-    OS_ERR               err       = OS_ERR_NONE;
     eMBMasterReqErrCode  errorCode = MB_MRE_EILLSTATE;
 
     UCHAR*               pcPDUDataCur = NULL;
@@ -365,13 +342,13 @@ void vMBDevCurStateTest(sMBMasterInfo* psMBMasterInfo, sMBSlaveDev* psMBSlaveDev
     UCHAR   n, iIndex, nSlaveTypes;
     USHORT  usDataVal;
     
-    OS_ERR               err       = OS_ERR_NONE;
     eMBMasterReqErrCode  errorCode = MB_MRE_EILLSTATE;
     
     UCHAR*                pcPDUDataCur = NULL;
     const sMBTestDevCmd*       psMBCmd = NULL;
     sMBMasterDevsInfo*    psMBDevsInfo = NULL;
     sMBMasterPort*        psMBPort     = &psMBMasterInfo->sMBPort;
+    sMBDevRegHoldTable*   psRegHoldTable = NULL;
     
     UCHAR ucMaxAddr = psMBMasterInfo->sMBDevsInfo.ucSlaveDevMaxAddr;
     UCHAR ucMinAddr = psMBMasterInfo->sMBDevsInfo.ucSlaveDevMinAddr;
@@ -441,6 +418,9 @@ void vMBDevCurStateTest(sMBMasterInfo* psMBMasterInfo, sMBSlaveDev* psMBSlaveDev
             psMBSlaveDev->xDataReady     = FALSE;    //从设备准备置位
             psMBSlaveDev->xSynchronized  = FALSE;    //从设备同步置位
             psMBSlaveDev->ucOfflineTimes = 0;        //测试次数清零
+            
+            psRegHoldTable = &psMBSlaveDev->psDevCurData->sMBRegHoldTable;   //掉线前未应答的写入不再等待
+            vMBMasterRegHoldClearPending(psRegHoldTable, psRegHoldTable->usStartAddr, psRegHoldTable->usEndAddr - psRegHoldTable->usStartAddr + 1);
             myprintf("vMBDevCurStateTest  ucDevAddr %d errorCode %d\n", psMBSlaveDev->ucDevAddr, errorCode);               
         }
         else
@@ -448,7 +428,7 @@ void vMBDevCurStateTest(sMBMasterInfo* psMBMasterInfo, sMBSlaveDev* psMBSlaveDev
             psMBSlaveDev->ucOfflineTimes++;
             (void)xMBMasterDevOfflineTmrEnable(psMBSlaveDev);
         }
-        (void)OSTmrStop(&psMBSlaveDev->sDevHeartBeatTmr, OS_OPT_TMR_NONE, NULL, &err); //停止心跳   
+        (void)xTmrStop(&psMBSlaveDev->sDevHeartBeatTmr); //停止心跳   
     }
     psMBMasterInfo->eMBRunMode = STATE_SCAN_DEV;  //退出测试从设备状态    
 }
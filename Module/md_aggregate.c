@@ -0,0 +1,226 @@
+#include "md_aggregate.h"
+
+#define AGG_WORD(usIndex)    ((usIndex) >> 5)
+#define AGG_BIT(usIndex)     (1UL << ((usIndex) & 0x1F))
+
+/**************************************************************
+*@brief 有序表二分查找，返回第一个不小于lVal的位置
+***************************************************************/
+static uint16_t usAggregateSearch(const sAggregate* psAgg, int32_t lVal)
+{
+    uint16_t usLow  = 0;
+    uint16_t usHigh = psAgg->usCount;
+    uint16_t usMid;
+
+    while(usLow < usHigh)
+    {
+        usMid = (usLow + usHigh) >> 1;
+        if(psAgg->plSorted[usMid] < lVal)
+        {
+            usLow = usMid + 1;
+        }
+        else
+        {
+            usHigh = usMid;
+        }
+    }
+    return usLow;
+}
+
+/**************************************************************
+*@brief 最值成员失效或离开最值时重新查找，仅遍历有效位图中的成员
+***************************************************************/
+static void vAggregateRescan(sAggregate* psAgg)
+{
+    uint16_t i, usIndex;
+    uint16_t usWords = (psAgg->usMemberNum + 31) >> 5;   //只遍历成员数覆盖的位图字
+    uint32_t ulMask;
+    int32_t  lVal;
+    BOOL     xFirst = TRUE;
+
+    psAgg->lMin = 0;
+    psAgg->lMax = 0;
+    for(i = 0; i < usWords; i++)
+    {
+        ulMask = psAgg->ulValidMask[i];
+        while(ulMask != 0)
+        {
+            usIndex = (i << 5) + (uint16_t)CPU_CntTrailZeros(ulMask);
+            ulMask &= ulMask - 1;
+
+            lVal = psAgg->psMember[usIndex].lVal;
+            if(xFirst || lVal < psAgg->lMin)
+            {
+                psAgg->lMin = lVal;
+                psAgg->usMinIndex = usIndex;
+            }
+            if(xFirst || lVal > psAgg->lMax)
+            {
+                psAgg->lMax = lVal;
+                psAgg->usMaxIndex = usIndex;
+            }
+            xFirst = FALSE;
+        }
+    }
+}
+
+/**************************************************************
+*@brief 聚合初始化，所有成员无效，权重为1
+***************************************************************/
+BOOL xAggregateInit(sAggregate* psAgg, eAggType eType, sAggMember* psMember, int32_t* plSorted, uint16_t usMemberNum)
+{
+    uint16_t i;
+
+    if( (psAgg == NULL) || (psMember == NULL) || (usMemberNum == 0) || (usMemberNum > AGG_MEMBER_MAX_NUM) )
+    {
+        return FALSE;
+    }
+    if( (eType == AGG_MEDIAN) && (plSorted == NULL) )
+    {
+        return FALSE;
+    }
+    memset(psAgg, 0, sizeof(sAggregate));
+    psAgg->ucType      = eType;
+    psAgg->usMemberNum = usMemberNum;
+    psAgg->psMember    = psMember;
+    psAgg->plSorted    = (eType == AGG_MEDIAN) ? plSorted : NULL;
+
+    for(i = 0; i < usMemberNum; i++)
+    {
+        psMember[i].lVal     = 0;
+        psMember[i].ucWeight = 1;
+    }
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 设置成员权重，成员有效时同步修正加权和
+***************************************************************/
+BOOL xAggregateSetWeight(sAggregate* psAgg, uint16_t usIndex, uint8_t ucWeight)
+{
+    sAggMember* psMember = NULL;
+
+    if( (psAgg == NULL) || (usIndex >= psAgg->usMemberNum) || (ucWeight == 0) )
+    {
+        return FALSE;
+    }
+    psMember = &psAgg->psMember[usIndex];
+    if(xAggregateIsValid(psAgg, usIndex))
+    {
+        psAgg->lWeightSum += psMember->lVal * ((int32_t)ucWeight - psMember->ucWeight);
+        psAgg->ulWeight   += (uint32_t)ucWeight - psMember->ucWeight;
+    }
+    psMember->ucWeight = ucWeight;
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 成员数值或有效状态变化，移出旧值、计入新值，O(1)更新
+*       最值成员离开时重新查找最值，中值有序表插入/删除为O(N)搬移
+***************************************************************/
+void vAggregateUpdate(sAggregate* psAgg, uint16_t usIndex, int32_t lVal, BOOL xValid)
+{
+    uint16_t    usPos;
+    BOOL        xOldValid;
+    int32_t     lOldVal;
+    sAggMember* psMember = NULL;
+
+    if( (psAgg == NULL) || (usIndex >= psAgg->usMemberNum) )
+    {
+        return;
+    }
+    psMember  = &psAgg->psMember[usIndex];
+    xOldValid = xAggregateIsValid(psAgg, usIndex);
+    lOldVal   = psMember->lVal;
+    xValid    = (xValid != FALSE);
+
+    if( (xOldValid == xValid) && ((xValid == FALSE) || (lOldVal == lVal)) )  //无变化
+    {
+        psMember->lVal = lVal;
+        return;
+    }
+    if(xOldValid)   //移出旧值
+    {
+        psAgg->lSum       -= lOldVal;
+        psAgg->lWeightSum -= lOldVal * psMember->ucWeight;
+        psAgg->ulWeight   -= psMember->ucWeight;
+        psAgg->usCount--;
+        psAgg->ulValidMask[AGG_WORD(usIndex)] &= ~AGG_BIT(usIndex);
+
+        if(psAgg->plSorted != NULL)
+        {
+            usPos = usAggregateSearch(psAgg, lOldVal);
+            memmove(&psAgg->plSorted[usPos], &psAgg->plSorted[usPos+1], (psAgg->usCount - usPos) * sizeof(int32_t));
+        }
+    }
+    psMember->lVal = lVal;
+    if(xValid)      //计入新值
+    {
+        if(psAgg->plSorted != NULL)
+        {
+            usPos = usAggregateSearch(psAgg, lVal);
+            memmove(&psAgg->plSorted[usPos+1], &psAgg->plSorted[usPos], (psAgg->usCount - usPos) * sizeof(int32_t));
+            psAgg->plSorted[usPos] = lVal;
+        }
+        psAgg->lSum       += lVal;
+        psAgg->lWeightSum += lVal * psMember->ucWeight;
+        psAgg->ulWeight   += psMember->ucWeight;
+        psAgg->usCount++;
+        psAgg->ulValidMask[AGG_WORD(usIndex)] |= AGG_BIT(usIndex);
+    }
+
+    //最值维护：原最值成员失效或数值离开最值时重新查找，否则只与新值比较
+    if( xOldValid && ( ((usIndex == psAgg->usMinIndex) && ((xValid == FALSE) || (lVal > lOldVal))) ||
+                       ((usIndex == psAgg->usMaxIndex) && ((xValid == FALSE) || (lVal < lOldVal))) ) )
+    {
+        vAggregateRescan(psAgg);
+    }
+    else if(xValid)
+    {
+        if( (psAgg->usCount == 1) || (lVal < psAgg->lMin) )
+        {
+            psAgg->lMin = lVal;
+            psAgg->usMinIndex = usIndex;
+        }
+        if( (psAgg->usCount == 1) || (lVal > psAgg->lMax) )
+        {
+            psAgg->lMax = lVal;
+            psAgg->usMaxIndex = usIndex;
+        }
+    }
+}
+
+/**************************************************************
+*@brief 成员是否有效
+***************************************************************/
+BOOL xAggregateIsValid(const sAggregate* psAgg, uint16_t usIndex)
+{
+    return (psAgg->ulValidMask[AGG_WORD(usIndex)] & AGG_BIT(usIndex)) ? TRUE : FALSE;
+}
+
+/**************************************************************
+*@brief 按取值类型返回聚合值，无有效成员返回0
+***************************************************************/
+int32_t lAggregateGetValue(const sAggregate* psAgg)
+{
+    uint16_t usMid;
+
+    if(psAgg->usCount == 0)
+    {
+        return 0;
+    }
+    switch(psAgg->ucType)
+    {
+        case AGG_WEIGHTED:
+            return psAgg->lWeightSum / (int32_t)psAgg->ulWeight;
+        case AGG_MEDIAN:
+            usMid = psAgg->usCount >> 1;
+            if(psAgg->usCount & 0x01)
+            {
+                return psAgg->plSorted[usMid];
+            }
+            return (psAgg->plSorted[usMid-1] + psAgg->plSorted[usMid]) / 2;
+        default:
+            return psAgg->lSum / (int32_t)psAgg->usCount;
+    }
+}
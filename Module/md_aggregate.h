@@ -0,0 +1,53 @@
+#ifndef _MD_AGGREGATE_H_
+#define _MD_AGGREGATE_H_
+
+#include "includes.h"
+#include "lpc_types.h"
+
+/*单个聚合最大成员数，可在编译选项中覆盖(最大65535)。只决定有效位图大小：
+  每个聚合占AGG_MEMBER_MAX_NUM/8字节(256成员为32字节)，成员表与有序表由
+  调用者按实际成员数分配，不随此值增长*/
+#ifndef AGG_MEMBER_MAX_NUM
+#define AGG_MEMBER_MAX_NUM     256
+#endif
+#define AGG_MASK_WORD_NUM      ((AGG_MEMBER_MAX_NUM + 31) / 32)    //有效位图字数
+
+typedef enum   /*聚合取值类型*/
+{
+    AGG_MEAN      = 0,    //算术平均
+    AGG_WEIGHTED  = 1,    //加权平均，权重由xAggregateSetWeight设置，默认1
+    AGG_MEDIAN    = 2,    //中值，需提供有序数值表
+}eAggType;
+
+typedef struct  /*聚合成员*/
+{
+    int32_t   lVal;        //已计入的数值
+    uint8_t   ucWeight;    //权重
+}sAggMember;
+
+typedef struct  /*多成员聚合，成员数值或故障状态变化时增量更新*/
+{
+    uint8_t      ucType;          //取值类型
+    uint16_t     usMemberNum;     //成员数
+    uint16_t     usCount;         //有效成员数
+    uint16_t     usMinIndex;      //最小值成员
+    uint16_t     usMaxIndex;      //最大值成员
+    int32_t      lSum;            //有效成员数值和
+    int32_t      lWeightSum;      //有效成员加权和
+    uint32_t     ulWeight;        //有效成员权重和
+    int32_t      lMin;            //有效成员最小值
+    int32_t      lMax;            //有效成员最大值
+    uint32_t     ulValidMask[AGG_MASK_WORD_NUM];  //有效成员位图
+
+    sAggMember*  psMember;        //成员表，长度为成员数
+    int32_t*     plSorted;        //有序数值表(仅中值)，长度不小于成员数
+}sAggregate;
+
+BOOL    xAggregateInit(sAggregate* psAgg, eAggType eType, sAggMember* psMember, int32_t* plSorted, uint16_t usMemberNum);
+BOOL    xAggregateSetWeight(sAggregate* psAgg, uint16_t usIndex, uint8_t ucWeight);
+void    vAggregateUpdate(sAggregate* psAgg, uint16_t usIndex, int32_t lVal, BOOL xValid);
+
+BOOL    xAggregateIsValid(const sAggregate* psAgg, uint16_t usIndex);
+int32_t lAggregateGetValue(const sAggregate* psAgg);
+
+#endif
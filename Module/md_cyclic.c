@@ -0,0 +1,199 @@
+#include "md_cyclic.h"
+
+CPU_TS32  CyclicClockLastTs = 0;       //上次读取的CPU时间戳
+uint32_t  CyclicClockUs     = 0;       //累计时间(us)
+uint32_t  CyclicClockRem    = 0;       //不足1us的时间戳余数
+
+/*统计值饱和到16位，便于BMS保持寄存器直接映射*/
+static uint16_t usCyclicSat(uint32_t ulVal)
+{
+    return (ulVal > UINT16_MAX) ? UINT16_MAX : (uint16_t)ulVal;
+}
+
+/**************************************************************
+*@brief 执行器初始化，小帧周期须为系统节拍整数倍
+***************************************************************/
+BOOL xCyclicInit(sCyclicExec* psExec, uint16_t usMinorMs, uint16_t usMajorNum, pxCyclicClock pxClock)
+{
+    if( (psExec == NULL) || (usMinorMs == 0) || (usMajorNum == 0) || (pxClock == NULL) )
+    {
+        return FALSE;
+    }
+    memset(psExec, 0, sizeof(sCyclicExec));
+    psExec->usMinorMs  = usMinorMs;
+    psExec->usMajorNum = usMajorNum;
+    psExec->pxClock    = pxClock;
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 注册控制任务到指定槽位，同一小帧内按槽位顺序执行
+*@param usPeriod     执行周期(小帧数)，须整除大帧
+*@param usOffset     执行相位(小帧号)，小于周期
+*@param usDeadlineMs 截止时间，0表示一个小帧
+***************************************************************/
+BOOL xCyclicRegist(sCyclicExec* psExec, uint8_t ucJob, pxCyclicJob pxJob, void* pvArg,
+                   uint16_t usPeriod, uint16_t usOffset, uint16_t usDeadlineMs)
+{
+    sCyclicJob* psJob = NULL;
+
+    if( (psExec == NULL) || (ucJob >= CYCLIC_JOB_MAX_NUM) || (pxJob == NULL) || (usPeriod == 0) ||
+        (usOffset >= usPeriod) || (psExec->usMajorNum % usPeriod != 0) )
+    {
+        return FALSE;
+    }
+    psJob = &psExec->sJobList[ucJob];
+    memset(psJob, 0, sizeof(sCyclicJob));
+
+    psJob->pxJob         = pxJob;
+    psJob->pvArg         = pvArg;
+    psJob->usPeriod      = usPeriod;
+    psJob->usOffset      = usOffset;
+    psJob->ulDeadline_us = (uint32_t)((usDeadlineMs > 0) ? usDeadlineMs : psExec->usMinorMs) * 1000;
+
+    if(ucJob >= psExec->ucJobNum)
+    {
+        psExec->ucJobNum = ucJob + 1;
+    }
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 设置帧开始输入快照函数
+***************************************************************/
+void vCyclicSetSnapshot(sCyclicExec* psExec, pxCyclicJob pxSnapshot, void* pvArg)
+{
+    psExec->pxSnapshot    = pxSnapshot;
+    psExec->pvSnapshotArg = pvArg;
+}
+
+/**************************************************************
+*@brief 从0号小帧开始计时，首帧在一个小帧周期后释放
+***************************************************************/
+void vCyclicStart(sCyclicExec* psExec)
+{
+    psExec->usFrame      = 0;
+    psExec->ulRelease_us = psExec->pxClock() + (uint32_t)psExec->usMinorMs * 1000;
+}
+
+/**************************************************************
+*@brief 执行一个小帧：输入快照后按槽位顺序执行到期任务，记录执行时间、
+*       释放抖动与截止超时。不阻塞，目标板由vCyclicTask按节拍调用，
+*       主机仿真时直接推进模拟时钟后调用
+***************************************************************/
+void vCyclicRunFrame(sCyclicExec* psExec)
+{
+    uint8_t     n;
+    uint32_t    ulMinor_us = (uint32_t)psExec->usMinorMs * 1000;
+    uint32_t    ulStart, ulBegin, ulEnd;
+    sCyclicJob* psJob = NULL;
+
+    ulStart = psExec->pxClock();
+    if((int32_t)(ulStart - psExec->ulRelease_us) >= (int32_t)ulMinor_us)  //整帧滞后，重新对齐释放时刻
+    {
+        psExec->usFrameOverrun++;
+        psExec->ulRelease_us = ulStart;
+    }
+    if(psExec->pxSnapshot != NULL)
+    {
+        psExec->pxSnapshot(psExec->pvSnapshotArg);
+    }
+    ulEnd = ulStart;
+    for(n = 0; n < psExec->ucJobNum; n++)
+    {
+        psJob = &psExec->sJobList[n];
+        if( (psJob->pxJob == NULL) || (psExec->usFrame % psJob->usPeriod != psJob->usOffset) )
+        {
+            continue;
+        }
+        ulBegin = psExec->pxClock();
+        psJob->pxJob(psJob->pvArg);
+        ulEnd   = psExec->pxClock();
+
+        psJob->ulRunCount++;
+        psJob->usExecLast_us = usCyclicSat(ulEnd - ulBegin);
+        if(psJob->usExecLast_us > psJob->usExecMax_us)
+        {
+            psJob->usExecMax_us = psJob->usExecLast_us;
+        }
+        if( ((int32_t)(ulBegin - psExec->ulRelease_us) > 0) &&
+            (usCyclicSat(ulBegin - psExec->ulRelease_us) > psJob->usJitterMax_us) )
+        {
+            psJob->usJitterMax_us = usCyclicSat(ulBegin - psExec->ulRelease_us);
+        }
+        if((int32_t)(ulEnd - psExec->ulRelease_us) > (int32_t)psJob->ulDeadline_us)
+        {
+            psJob->usOverrun++;
+        }
+    }
+    if(usCyclicSat(ulEnd - ulStart) > psExec->usFrameExecMax_us)
+    {
+        psExec->usFrameExecMax_us = usCyclicSat(ulEnd - ulStart);
+    }
+    psExec->ulFrameCount++;
+    psExec->ulRelease_us += ulMinor_us;
+    psExec->usFrame = (psExec->usFrame + 1) % psExec->usMajorNum;
+}
+
+/**************************************************************
+*@brief 清除统计
+***************************************************************/
+void vCyclicResetStats(sCyclicExec* psExec)
+{
+    uint8_t n;
+
+    for(n = 0; n < CYCLIC_JOB_MAX_NUM; n++)
+    {
+        psExec->sJobList[n].ulRunCount     = 0;
+        psExec->sJobList[n].usExecLast_us  = 0;
+        psExec->sJobList[n].usExecMax_us   = 0;
+        psExec->sJobList[n].usJitterMax_us = 0;
+        psExec->sJobList[n].usOverrun      = 0;
+    }
+    psExec->usFrameExecMax_us = 0;
+    psExec->usFrameOverrun    = 0;
+}
+
+/**************************************************************
+*@brief 执行器任务主体，按小帧周期性延时(非相对延时，不累积漂移)
+***************************************************************/
+void vCyclicTask(sCyclicExec* psExec)
+{
+    OS_ERR  err    = OS_ERR_NONE;
+    OS_TICK ulTick = (OS_TICK)psExec->usMinorMs * OS_CFG_TICK_RATE_HZ / 1000;
+
+    vCyclicStart(psExec);
+    while(DEF_TRUE)
+    {
+        OSTimeDly(ulTick, OS_OPT_TIME_PERIODIC, &err);
+        vCyclicRunFrame(psExec);
+    }
+}
+
+/**************************************************************
+*@brief CPU时间戳换算的单调时钟(us)，两次调用间隔须小于时间戳溢出周期
+***************************************************************/
+uint32_t ulCyclicClock_us(void)
+{
+    CPU_SR_ALLOC();
+
+    CPU_ERR  err = CPU_ERR_NONE;
+    CPU_TS32 ts;
+    uint32_t ulTsPerUs = CPU_TS_TmrFreqGet(&err) / 1000000;
+    uint32_t ulDelta;
+
+    if(ulTsPerUs == 0)
+    {
+        ulTsPerUs = 1;
+    }
+    CPU_CRITICAL_ENTER();
+    ts      = CPU_TS_Get32();
+    ulDelta = (uint32_t)(ts - CyclicClockLastTs) + CyclicClockRem;
+    CyclicClockLastTs = ts;
+    CyclicClockUs    += ulDelta / ulTsPerUs;
+    CyclicClockRem    = ulDelta % ulTsPerUs;
+    ts = CyclicClockUs;
+    CPU_CRITICAL_EXIT();
+
+    return ts;
+}
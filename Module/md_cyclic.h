@@ -0,0 +1,58 @@
+#ifndef _MD_CYCLIC_H_
+#define _MD_CYCLIC_H_
+
+#include "includes.h"
+#include "lpc_types.h"
+
+#define CYCLIC_JOB_MAX_NUM     8           //单个执行器最大控制任务数
+
+typedef void     (*pxCyclicJob)(void* pvArg);
+typedef uint32_t (*pxCyclicClock)(void);   //单调时钟(us)，主机仿真时可替换为模拟时钟
+
+typedef struct  /*周期控制任务，统计时间单位us，超出65535饱和*/
+{
+    pxCyclicJob   pxJob;           //控制函数
+    void*         pvArg;           //控制函数参数
+    uint16_t      usPeriod;        //执行周期(小帧数)，须整除大帧
+    uint16_t      usOffset;        //执行相位(小帧号)，错开同周期任务
+    uint32_t      ulDeadline_us;   //截止时间，相对所在小帧释放时刻
+
+    uint32_t      ulRunCount;      //执行次数
+    uint16_t      usExecLast_us;   //最近一次执行时间
+    uint16_t      usExecMax_us;    //最大执行时间
+    uint16_t      usJitterMax_us;  //最大释放抖动(开始时刻-小帧释放时刻)
+    uint16_t      usOverrun;       //超出截止时间次数
+}sCyclicJob;
+
+typedef struct  /*循环执行器：固定小帧节拍，按声明周期与相位调度控制任务*/
+{
+    uint16_t      usMinorMs;       //小帧周期(ms)
+    uint16_t      usMajorNum;      //大帧包含的小帧数
+    uint16_t      usFrame;         //当前小帧号
+    uint8_t       ucJobNum;        //已用任务槽位数
+    uint32_t      ulRelease_us;    //当前小帧理想释放时刻
+    uint32_t      ulFrameCount;    //已执行小帧数
+
+    uint16_t      usFrameExecMax_us;  //单个小帧最大执行时间
+    uint16_t      usFrameOverrun;     //小帧超时(挤占下一帧)次数
+
+    pxCyclicClock pxClock;         //时钟源
+    pxCyclicJob   pxSnapshot;      //帧开始输入快照，本帧各任务使用同一份输入
+    void*         pvSnapshotArg;
+
+    sCyclicJob    sJobList[CYCLIC_JOB_MAX_NUM];
+}sCyclicExec;
+
+BOOL xCyclicInit(sCyclicExec* psExec, uint16_t usMinorMs, uint16_t usMajorNum, pxCyclicClock pxClock);
+BOOL xCyclicRegist(sCyclicExec* psExec, uint8_t ucJob, pxCyclicJob pxJob, void* pvArg,
+                   uint16_t usPeriod, uint16_t usOffset, uint16_t usDeadlineMs);
+void vCyclicSetSnapshot(sCyclicExec* psExec, pxCyclicJob pxSnapshot, void* pvArg);
+
+void vCyclicStart(sCyclicExec* psExec);
+void vCyclicRunFrame(sCyclicExec* psExec);
+void vCyclicResetStats(sCyclicExec* psExec);
+
+void vCyclicTask(sCyclicExec* psExec);
+uint32_t ulCyclicClock_us(void);
+
+#endif
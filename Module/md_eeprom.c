@@ -1,14 +1,17 @@
 #include "app_config.h"
 #include "lpc_eeprom.h"
+#include "lpc_rtc.h"
+#include "lpc_bod.h"
 #include "md_eeprom.h"
+#include "md_eeprom_log.h"
 #include "md_event.h"
 #include "my_rtt_printf.h"
 
-#define EEPROM_READ_DATA_DELAY_MS       50
-#define EEPROM_WRITE_DATA_DELAY_MS      200
 
 #define EEPROM_WRITE_DATA_INTERVAL_S    1
 
+#define EEPROM_FLAG_DATA_READY          0x01   //参数恢复完成事件标志
+
 #define UINT8_PAGE_OFFSET 	0			//uint8类型参数记忆EEPROM页寄存器偏移量
 #define UINT8_PAGE_ADDR 	0			//uint8类型参数记忆EEPROM存储器初始页地址
 
@@ -47,7 +50,8 @@
 #define INT16_SAVE_COUNT	1			//int16类型的参数记忆数量
 #define INT16_SAVE_SIZE		INT16_SAVE_COUNT * sizeof(int16_t)		//int16类型记忆字节长度
 
-#define UINT32_SAVE_COUNT	1			//uint32类型的参数记忆数量
+#define UINT32_SAVE_COUNT	9			//uint32类型的参数记忆数量(含8个AI通道校准参数)
+#define UINT32_LEGACY_COUNT	1			//旧版固定布局中uint32类型的参数数量，AI通道校准参数为新增
 #define UINT32_SAVE_SIZE	UINT32_SAVE_COUNT * sizeof(uint32_t)	//uint32类型记忆字节长度
 
 #define INT32_SAVE_COUNT	1			//int32类型的参数记忆数量
@@ -74,412 +78,449 @@
 
 #define SYSTEM_POLL_TIME_OUT_S   10     //系统轮询时间
 
-BOOL     EEPROMDataReady = FALSE;
-BOOL     EEPROMFirstRun  = TRUE; //主板第一次上电
-
-uint8_t  DataBufUint8Count = 0;
-uint8_t  DataBufInt8Count  = 0;
-
-uint8_t  DataBufUint16Count = 0;
-uint8_t  DataBufInt16Count = 0;
-
-uint8_t  DataBufUint32Count = 0;
-uint8_t  DataBufInt32Count = 0;
-
-uint8_t  DataBufRuntimeCount = 0;
-uint8_t  DataBufE32Count = 0;
-
+#define EEPROM_DATA_MAX_NUM  (UINT8_SAVE_COUNT + INT8_SAVE_COUNT + UINT16_SAVE_COUNT + INT16_SAVE_COUNT + \
+                              UINT32_SAVE_COUNT + INT32_SAVE_COUNT + RUNTIME_SAVE_COUNT + E32_SAVE_COUNT)   //最大记忆参数数量
 
-uint16_t  DataBufUint8ChangedTimes = 0;
-uint16_t  DataBufInt8ChangedTimes  = 0;
+#define EEPROM_DIRTY_MAP_WORDS   ((EEPROM_DATA_MAX_NUM + 31) / 32)   //脏标志位图大小
 
-uint16_t  DataBufUint16ChangedTimes = 0;
-uint16_t  DataBufInt16ChangedTimes = 0;
+#define EEPROM_LEGACY_BUF_WORDS  ((UINT16_SAVE_SIZE + 3) / 4)   //旧版固定布局读缓存，按最大类型分配
 
-uint16_t  DataBufUint32ChangedTimes = 0;
-uint16_t  DataBufInt32ChangedTimes = 0;
+#define EEPROM_BACKUP_NUM        8        //RTC备份寄存器可保存的计数器数量(GPREG1~4，每个计数器16位增量)
+#define EEPROM_BACKUP_NONE       0xFF
+#define EEPROM_BACKUP_INTV_S     5        //备份寄存器写入周期
+#define EEPROM_BACKUP_DELTA_MAX  0xF000   //增量超过该值立即写入EEPROM
+#define EEPROM_BACKUP_GEN_ID     0x0F00   //代号在参数日志中的ID
 
-uint16_t  DataBufRuntimeChangedTimes = 0;
-uint16_t  DataBufE32ChangedTimes = 0;
-
-
-uint8_t*  pDataBufUint8[UINT8_SAVE_COUNT]  = {NULL};
-int8_t*   pDataBufInt8[INT8_SAVE_COUNT]    = {NULL};
-
-uint16_t* pDataBufUint16[UINT16_SAVE_COUNT] = {NULL};
-int16_t*  pDataBufInt16[INT16_SAVE_COUNT]   = {NULL};
-
-uint32_t* pDataBufUint32[UINT32_SAVE_COUNT] = {NULL};
-int32_t*  pDataBufInt32[INT32_SAVE_COUNT]   = {NULL};
+/*参数类型描述表，按eEEPROMDataType顺序*/
+const sEEPROMTypeInfo EEPROMTypeInfo[EEPROM_TYPE_NUM] = 
+{
+    {UINT8_SAVE_COUNT,   sizeof(uint8_t),  UINT8_WRITE_INTV,   UINT8_PAGE_ADDR,   UINT8_PAGE_OFFSET,   MODE_8_BIT},
+    {INT8_SAVE_COUNT,    sizeof(int8_t),   INT8_WRITE_INTV,    INT8_PAGE_ADDR,    INT8_PAGE_OFFSET,    MODE_8_BIT},
+    {UINT16_SAVE_COUNT,  sizeof(uint16_t), UINT16_WRITE_INTV,  UINT16_PAGE_ADDR,  UINT16_PAGE_OFFSET,  MODE_16_BIT},
+    {INT16_SAVE_COUNT,   sizeof(int16_t),  INT16_WRITE_INTV,   INT16_PAGE_ADDR,   INT16_PAGE_OFFSET,   MODE_16_BIT},
+    {UINT32_SAVE_COUNT,  sizeof(uint32_t), UINT32_WRITE_INTV,  UINT32_PAGE_ADDR,  UINT32_PAGE_OFFSET,  MODE_32_BIT},
+    {INT32_SAVE_COUNT,   sizeof(int32_t),  INT32_WRITE_INTV,   INT32_PAGE_ADDR,   INT32_PAGE_OFFSET,   MODE_32_BIT},
+    {RUNTIME_SAVE_COUNT, sizeof(uint32_t), RUNTIME_WRITE_INTV / SYSTEM_POLL_TIME_OUT_S, RUNTIME_PAGE_ADDR, RUNTIME_PAGE_OFFSET, MODE_32_BIT},
+    {E32_SAVE_COUNT,     sizeof(uint32_t), E32_WRITE_INTV,     E32_PAGE_ADDR,     E32_PAGE_OFFSET,     MODE_32_BIT},
+};
+
+/*旧版固定布局各类型参数数量，类型内序号不小于该值的参数为新增参数，不从旧版布局导入*/
+const uint8_t EEPROMLegacyCount[EEPROM_TYPE_NUM] = 
+{
+    UINT8_SAVE_COUNT, INT8_SAVE_COUNT, UINT16_SAVE_COUNT, INT16_SAVE_COUNT,
+    UINT32_LEGACY_COUNT, INT32_SAVE_COUNT, RUNTIME_SAVE_COUNT, E32_SAVE_COUNT,
+};
 
-uint32_t* pDataBufRuntime[RUNTIME_SAVE_COUNT] = {NULL};
-uint32_t* pDataBufE32[E32_SAVE_COUNT] = {NULL};
+BOOL     EEPROMDataReady = FALSE;
+OS_TICK  EEPROMReadyTick = 0;    //上电到参数恢复完成的时间(tick)
 
+OS_FLAG_GRP EEPROMFlagGrp;
+BOOL     EEPROMFirstRun  = TRUE; //主板第一次上电
 
-uint8_t __attribute__((aligned (4))) DataBufFirstRunUint8[UINT8_SAVE_COUNT] = {0};
-uint8_t __attribute__((aligned (4))) DataBufUint8[UINT8_SAVE_COUNT] = {0};
-int8_t  __attribute__((aligned (4))) DataBufInt8[INT8_SAVE_COUNT]   = {0};
+sEEPROMData EEPROMDataList[EEPROM_DATA_MAX_NUM];
+uint16_t    EEPROMDataCount = 0;
 
-uint16_t __attribute__((aligned (4))) DataBufUint16[UINT16_SAVE_COUNT] = {0};
-int16_t  __attribute__((aligned (4))) DataBufInt16[INT16_SAVE_COUNT]   = {0};
+uint8_t   EEPROMTypeCount[EEPROM_TYPE_NUM] = {0};         //各类型注册数量
+uint16_t  EEPROMTypeChangedTimes[EEPROM_TYPE_NUM] = {0};  //各类型变化次数
+uint8_t   EEPROMTypeChanged = 0;                          //本周期有变化的类型(按位)
 
-uint32_t __attribute__((aligned (4))) DataBufUint32[UINT32_SAVE_COUNT] = {0};
-int32_t  __attribute__((aligned (4))) DataBufInt32[INT32_SAVE_COUNT]   = {0};
+uint32_t  EEPROMDirtyMap[EEPROM_DIRTY_MAP_WORDS] = {0};   //数值已变化未写入的参数(按位)
 
-uint32_t __attribute__((aligned (4))) DataBufRuntime[RUNTIME_SAVE_COUNT] = {0};
+uint32_t __attribute__((aligned (4))) EEPROMLegacyBuf[EEPROM_LEGACY_BUF_WORDS] = {0};
 
-//uint16_t __attribute__ ((aligned (4))) ReadBufE16[E16_SAVE_COUNT];
-//uint16_t __attribute__ ((aligned (4))) WriteBufE16[E16_SAVE_COUNT] = {0};
+sEEPROMData* EEPROMBackupList[EEPROM_BACKUP_NUM];        //运行时间、能耗等高频变化的计数器
+uint32_t     EEPROMBackupBase[EEPROM_BACKUP_NUM];        //计数器在EEPROM中已保存的数值
+uint8_t      EEPROMBackupCount = 0;
+uint8_t      EEPROMBackupTimes = 0;
+BOOL         EEPROMBackupBusy  = FALSE;                  //正在写入EEPROM，掉电中断不更新备份寄存器
+BOOL         EEPROMBrownOut    = FALSE;
 
-uint32_t __attribute__ ((aligned (4))) DataBufE32[E32_SAVE_COUNT] = {0};
+sEEPROMBackupStats EEPROMBackupStats;
 
-BOOL xDataUint8Changed(void)
+/*读参数变量原始值*/
+uint32_t ulEEPROMDataGet(sEEPROMData* psData)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
+    switch(EEPROMTypeInfo[psData->ucType - 1].ucSize)
+    {
+        case sizeof(uint8_t):  return *(uint8_t*)psData->pvData;
+        case sizeof(uint16_t): return *(uint16_t*)psData->pvData;
+        default:               return *(uint32_t*)psData->pvData;
+    }
+}
 
-	for (i = 0; i < UINT8_SAVE_COUNT; i++)
-	{
-		if( (pDataBufUint8[i] != NULL) && (DataBufUint8[i] != *(uint8_t*)pDataBufUint8[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufUint8[i] = *(uint8_t*)pDataBufUint8[i];
-		}
-	}
-	return xChanged;
+/*写参数变量原始值*/
+void vEEPROMDataSet(sEEPROMData* psData, uint32_t ulValue)
+{
+    switch(EEPROMTypeInfo[psData->ucType - 1].ucSize)
+    {
+        case sizeof(uint8_t):  *(uint8_t*)psData->pvData  = (uint8_t)ulValue;  break;
+        case sizeof(uint16_t): *(uint16_t*)psData->pvData = (uint16_t)ulValue; break;
+        default:               *(uint32_t*)psData->pvData = ulValue;           break;
+    }
+    psData->ulShadow = ulValue;
 }
 
-BOOL xDataUint16Changed(void)
+/*参数置为已变化*/
+void vEEPROMDirtySet(sEEPROMData* psData)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
+    uint16_t n = psData - EEPROMDataList;
+    CPU_SR_ALLOC();
 
-	for (i = 0; i < UINT16_SAVE_COUNT; i++)
-	{
-		if( (pDataBufUint16[i] != NULL) && (DataBufUint16[i] != *(uint16_t*)pDataBufUint16[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufUint16[i] = *(uint16_t*)pDataBufUint16[i];
-		}
-	}
-	return xChanged;
+    CPU_CRITICAL_ENTER();
+    EEPROMDirtyMap[n / 32] |= (uint32_t)1 << (n % 32);
+    EEPROMTypeChanged      |= (uint8_t)(1 << (psData->ucType - 1));
+    CPU_CRITICAL_EXIT();
 }
 
-BOOL xDataUint32Changed(void)
+/*参数是否已变化未写入*/
+BOOL xEEPROMDirtyTest(sEEPROMData* psData)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
-
-	for (i = 0; i < UINT32_SAVE_COUNT; i++)
-	{
-		if( (pDataBufUint32[i] != NULL) && (DataBufUint32[i] != *(uint32_t*)pDataBufUint32[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufUint32[i] = *(uint32_t*)pDataBufUint32[i];
-		}
-	}
-	return xChanged;
+    uint16_t n = psData - EEPROMDataList;
+    return (EEPROMDirtyMap[n / 32] >> (n % 32)) & 0x01;
 }
 
-BOOL xDataInt8Changed(void)
+/**********************************************************************
+ * @brief  参数赋值后通知写入，不必等待周期比较
+ *********************************************************************/
+BOOL xEEPROMDataChanged(void* pData)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
+    uint16_t n = 0;
+    uint32_t ulValue = 0;
 
-	for (i = 0; i < INT8_SAVE_COUNT; i++)
-	{
-		if( (pDataBufInt8[i] != NULL) && (DataBufInt8[i] != *(int8_t*)pDataBufInt8[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufInt8[i] = *(int8_t*)pDataBufInt8[i];
-		}
-	}
-	return xChanged;
+    sEEPROMData* psData = NULL;
+
+    for(n=0; n<EEPROMDataCount; n++)
+    {
+        psData = &EEPROMDataList[n];
+        if(psData->pvData == pData)
+        {
+            ulValue = ulEEPROMDataGet(psData);
+            if(psData->ulShadow != ulValue)
+            {
+                psData->ulShadow = ulValue;
+                vEEPROMDirtySet(psData);
+            }
+            return TRUE;
+        }
+    }
+    return FALSE;
 }
 
-BOOL xDataInt16Changed(void)
+/*************************************************************
+*   RTC备份寄存器帧：GPREG0 = 代号(16位)|计数器数量(8位)|CRC8，
+*   GPREG1~4 = 各计数器相对EEPROM数值的16位增量。
+*   代号与EEPROM中保存的代号一致时增量才有效
+**************************************************************/
+void vEEPROMBackupFrame(uint32_t* pulFrame)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
+    uint8_t  i;
+    uint32_t ulDelta;
 
-	for (i = 0; i < INT16_SAVE_COUNT; i++)
-	{
-		if( (pDataBufInt16[i] != NULL) && (DataBufInt16[i] != *(int16_t*)pDataBufInt16[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufInt16[i] = *(int16_t*)pDataBufInt16[i];
-		}
-	}
-	return xChanged;
+    memset(pulFrame, 0, (EEPROM_BACKUP_NUM / 2 + 1) * sizeof(uint32_t));
+    for(i=0; i<EEPROMBackupCount; i++)
+    {
+        ulDelta = ulEEPROMDataGet(EEPROMBackupList[i]) - EEPROMBackupBase[i];
+        if(ulDelta > 0xFFFF)
+        {
+            ulDelta = 0xFFFF;
+        }
+        pulFrame[1 + i / 2] |= ulDelta << ((i % 2) * 16);
+    }
+    pulFrame[0]  = ((uint32_t)EEPROMBackupStats.usGen << 16) | ((uint32_t)EEPROMBackupCount << 8);
+    pulFrame[0] |= ucEEPROMCrc8((const uint8_t*)pulFrame, (EEPROM_BACKUP_NUM / 2 + 1) * sizeof(uint32_t), 0);
 }
 
-BOOL xDataInt32Changed(void)
+/*写备份寄存器，GPREG0最后写入*/
+void vEEPROMBackupWrite(const uint32_t* pulFrame)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
-
-	for (i = 0; i < INT32_SAVE_COUNT; i++)
-	{
-		if( (pDataBufInt32[i] != NULL) && (DataBufInt32[i] != *(int32_t*)pDataBufInt32[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufInt32[i] = *(int32_t*)pDataBufInt32[i];
-		}
-	}
-	return xChanged;
+    uint8_t i;
+    for(i=EEPROM_BACKUP_NUM / 2; i>0; i--)
+    {
+        RTC_WriteGPREG(LPC_RTC, i, pulFrame[i]);
+    }
+    RTC_WriteGPREG(LPC_RTC, 0, pulFrame[0]);
+    EEPROMBackupStats.ulSave++;
 }
 
-BOOL xDataRuntimeChanged(void)
+/**********************************************************************
+ * @brief  计数器写入RTC备份寄存器
+ *********************************************************************/
+void vEEPROMBackupSave(void)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
+    uint32_t ulFrame[EEPROM_BACKUP_NUM / 2 + 1];
+    CPU_SR_ALLOC();
 
-	for (i = 0; i < RUNTIME_SAVE_COUNT; i++)
-	{
-		if( (pDataBufRuntime[i] != NULL) && (DataBufRuntime[i] != *(uint32_t*)pDataBufRuntime[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufRuntime[i] = *(uint32_t*)pDataBufRuntime[i];
-		}
-	}
-	return xChanged;
+    CPU_CRITICAL_ENTER();   //避免与掉电中断交叉写入
+    vEEPROMBackupFrame(ulFrame);
+    vEEPROMBackupWrite(ulFrame);
+    CPU_CRITICAL_EXIT();
 }
 
-BOOL xDataE32Changed(void)
+/*备份寄存器作废(参数复位或导入旧版数据时)*/
+void vEEPROMBackupInvalid(void)
 {
-	uint8_t i = 0;
-	BOOL    xChanged = FALSE;
-
-	for (i = 0; i < E32_SAVE_COUNT; i++)
-	{
-		if( (pDataBufE32[i] != NULL) && (DataBufE32[i] != *(uint32_t*)pDataBufE32[i]) ) //检查值是否已经改变
-		{
-			xChanged = TRUE;
-			DataBufE32[i] = *(uint32_t*)pDataBufE32[i];
-		}
-	}
-	return xChanged;
+    RTC_WriteGPREG(LPC_RTC, 0, 0xFFFFFFFF);
 }
 
 /**********************************************************************
- * @brief  读EEPROM数据
+ * @brief  从RTC备份寄存器恢复计数器，须在EEPROM数据恢复之后调用
  *********************************************************************/
-void vReadEEPROMData(void)
+BOOL xEEPROMBackupRestore(void)
 {
-    uint8_t i = 0;
-    OS_ERR err = OS_ERR_NONE;
+    uint8_t  i;
+    uint8_t  ucCrc;
+    uint32_t ulDelta;
+    uint32_t ulFrame[EEPROM_BACKUP_NUM / 2 + 1];
 
-    if(DataBufUint8Count>0)
-    {
-        EEPROM_Read(UINT8_PAGE_OFFSET, UINT8_PAGE_ADDR, (void*)DataBufUint8, MODE_8_BIT, UINT8_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }        
-    if(DataBufInt8Count>0)
-    {
-        EEPROM_Read(INT8_PAGE_OFFSET, INT8_PAGE_ADDR, (void*)DataBufInt8, MODE_8_BIT, INT8_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufUint16Count>0)
-    {    
-        EEPROM_Read(UINT16_PAGE_OFFSET, UINT16_PAGE_ADDR, (void*)DataBufUint16, MODE_16_BIT, UINT16_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufInt16Count>0)
-    {    
-        EEPROM_Read(INT16_PAGE_OFFSET, INT16_PAGE_ADDR, (void*)DataBufInt16, MODE_16_BIT, INT16_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufUint32Count>0)
-    {    
-        EEPROM_Read(UINT32_PAGE_OFFSET, UINT32_PAGE_ADDR, (void*)DataBufUint32, MODE_32_BIT, UINT32_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufInt32Count>0)
-    {
-        EEPROM_Read(INT32_PAGE_OFFSET, INT32_PAGE_ADDR, (void*)DataBufInt32, MODE_32_BIT, INT32_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufRuntimeCount>0)
+    for(i=0; i<EEPROM_BACKUP_NUM / 2 + 1; i++)
     {
-        EEPROM_Read(RUNTIME_PAGE_OFFSET, RUNTIME_PAGE_ADDR, (void*)DataBufRuntime, MODE_32_BIT, RUNTIME_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
+        ulFrame[i] = RTC_ReadGPREG(LPC_RTC, i);
     }
-    if(DataBufE32Count>0)
+    ucCrc = (uint8_t)ulFrame[0];
+    ulFrame[0] &= 0xFFFFFF00;
+
+    if( ucCrc != ucEEPROMCrc8((const uint8_t*)ulFrame, sizeof(ulFrame), 0) ||
+        (uint8_t)(ulFrame[0] >> 8) != EEPROMBackupCount ||
+        (uint16_t)(ulFrame[0] >> 16) != EEPROMBackupStats.usGen )
     {
-        EEPROM_Read(E32_PAGE_OFFSET, E32_PAGE_ADDR, (void*)DataBufE32, MODE_32_BIT, E32_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
+        myprintf("xEEPROMBackupRestore invalid gen %d\n", EEPROMBackupStats.usGen);
+        return FALSE;
     }
-    myprintf("EEPROM_Read\n");
-    
-    for(i=0; i<DataBufUint8Count; i++)
+    for(i=0; i<EEPROMBackupCount; i++)
     {
-        if(pDataBufUint8[i] != NULL)
-        {
-            *(uint8_t*)pDataBufUint8[i] = DataBufUint8[i];
-        }
+        ulDelta = (ulFrame[1 + i / 2] >> ((i % 2) * 16)) & 0xFFFF;
+        vEEPROMDataSet(EEPROMBackupList[i], EEPROMBackupBase[i] + ulDelta);
     }
-    for(i=0; i<DataBufInt8Count; i++)
-    {
-        if(pDataBufInt8[i] != NULL)
-        {
-            *(int8_t*)pDataBufInt8[i] = DataBufInt8[i];
-        }
-    }
-    for(i=0; i<DataBufUint16Count; i++)
+    EEPROMBackupStats.xRestored = TRUE;
+    return TRUE;
+}
+
+/*是否需要将计数器写入EEPROM*/
+BOOL xEEPROMBackupNeedMerge(void)
+{
+    uint8_t i;
+    for(i=0; i<EEPROMBackupCount; i++)
     {
-        if(pDataBufUint16[i] != NULL)
+        if(ulEEPROMDataGet(EEPROMBackupList[i]) - EEPROMBackupBase[i] >= EEPROM_BACKUP_DELTA_MAX)
         {
-            *(uint16_t*)pDataBufUint16[i] = DataBufUint16[i];
+            return TRUE;
         }
     }
-    for(i=0; i<DataBufInt16Count; i++)
+    return EEPROMBrownOut;
+}
+
+const sEEPROMBackupStats* psEEPROMBackupGetStats(void)
+{
+    return &EEPROMBackupStats;
+}
+
+/*掉电检测中断，立即保存计数器到备份寄存器*/
+void BOD_IRQHandler(void);
+void BOD_IRQHandler(void)
+{
+    uint32_t ulFrame[EEPROM_BACKUP_NUM / 2 + 1];
+
+    NVIC_DisableIRQ(BOD_IRQn);   //电压恢复前会持续触发，由任务重新使能
+    if(EEPROMBackupBusy == FALSE)
     {
-        if(pDataBufInt16[i] != NULL)
-        {
-            *(int16_t*)pDataBufInt16[i] = DataBufInt16[i];
-        }
+        vEEPROMBackupFrame(ulFrame);
+        vEEPROMBackupWrite(ulFrame);
     }
-    for(i=0; i<DataBufUint32Count; i++)
+    EEPROMBrownOut = TRUE;
+    EEPROMBackupStats.ulBrownOut++;
+}
+
+/*掉电检测初始化*/
+void vEEPROMBODInit(void)
+{
+    BOD_Config_Type sBODConfig;
+
+    sBODConfig.Enabled            = ENABLE;
+    sBODConfig.PowerReduced       = DISABLE;
+    sBODConfig.ResetOnVoltageDown = ENABLE;
+    BOD_Init(&sBODConfig);
+}
+
+/**********************************************************************
+ * @brief  读EEPROM数据(从参数日志RAM索引恢复)
+ *********************************************************************/
+void vReadEEPROMData(void)
+{
+    uint16_t n = 0;
+    uint32_t ulValue = 0;
+
+    sEEPROMData* psData = NULL;
+
+    for(n=0; n<EEPROMDataCount; n++)
     {
-        if(pDataBufUint32[i] != NULL)
+        psData = &EEPROMDataList[n];
+        if(xEEPROMLogRead(psData->usParamId, &ulValue) == TRUE)
         {
-            *(uint32_t*)pDataBufUint32[i] = DataBufUint32[i];
+            vEEPROMDataSet(psData, ulValue);
         }
-    }
-    for(i=0; i<DataBufInt32Count; i++)
-    {
-        if(pDataBufInt32[i] != NULL)
+        else    //日志中不存在的新参数，保留默认值
         {
-            *(int32_t*)pDataBufInt32[i] = DataBufInt32[i];
+            psData->ulShadow = ulEEPROMDataGet(psData);
+            vEEPROMDirtySet(psData);
         }
-    }
-    for(i=0; i<DataBufRuntimeCount; i++)
-    {
-        if(pDataBufRuntime[i] != NULL)
+        if(psData->ucBackup != EEPROM_BACKUP_NONE)
         {
-            *(uint32_t*)pDataBufRuntime[i] = DataBufRuntime[i];
+            EEPROMBackupBase[psData->ucBackup] = psData->ulShadow;
         }
     }
-    for(i=0; i<DataBufE32Count; i++)
+    if(xEEPROMLogRead(EEPROM_BACKUP_GEN_ID, &ulValue) == TRUE)
     {
-        if(pDataBufE32[i] != NULL)
-        {
-            *(uint32_t*)pDataBufE32[i] = DataBufE32[i];
-        }
+        EEPROMBackupStats.usGen = (uint16_t)ulValue;
     }
-    myprintf("vReadEEPROMData ulExAirFanRated_Vol %ld  %ld \n\n", DataBufUint32[0], *(uint32_t*)pDataBufUint32[0]);
+    (void)xEEPROMBackupRestore();   //备份寄存器中的计数器比EEPROM更新
+    vEEPROMBackupSave();
+
+    myprintf("vReadEEPROMData %d\n", EEPROMDataCount);
+}
+
+/*参数恢复完成，通知等待的任务*/
+void vEEPROMDataReady(void)
+{
+    OS_ERR err = OS_ERR_NONE;
+
+    EEPROMReadyTick = OSTimeGet(&err);
     EEPROMDataReady = TRUE;
+    (void)OSFlagPost(&EEPROMFlagGrp, EEPROM_FLAG_DATA_READY, OS_OPT_POST_FLAG_SET, &err);
+
+    myprintf("vEEPROMDataReady tick %ld\n", EEPROMReadyTick);
 }
 
 BOOL xEEPROMDataIsReady(void)
 {
     return EEPROMDataReady;
 }
+
+/**********************************************************************
+ * @brief  等待参数恢复完成，ulTimeout为0时一直等待
+ *********************************************************************/
+BOOL xEEPROMDataWaitReady(OS_TICK ulTimeout)
+{
+    OS_ERR err = OS_ERR_NONE;
+
+    if(EEPROMDataReady == TRUE)
+    {
+        return TRUE;
+    }
+    (void)OSFlagPend(&EEPROMFlagGrp, EEPROM_FLAG_DATA_READY, ulTimeout,
+                     OS_OPT_PEND_FLAG_SET_ALL | OS_OPT_PEND_BLOCKING, NULL, &err);
+    return (err == OS_ERR_NONE);
+}
+
+OS_TICK ulEEPROMDataReadyTick(void)
+{
+    return EEPROMReadyTick;
+}
   
 /**********************************************************************
- * @brief  写EEPROM数据
+ * @brief  写EEPROM数据，只追加数值变化的参数
  *********************************************************************/
 void vWriteEEPROMData(void)
 {
-    uint8_t i = 0;
-    OS_ERR err = OS_ERR_NONE;
-    
-    if(xDataUint8Changed())
+    uint8_t  i = 0;
+    uint8_t  ucBit = 0;
+    uint16_t n = 0;
+    uint32_t ulValue = 0;
+    uint32_t ulDirty = 0;
+    uint8_t  ucChanged = 0;
+    BOOL     xMerge = FALSE;
+
+    sEEPROMData* psData = NULL;
+    CPU_SR_ALLOC();
+
+    for(n=0; n<EEPROMDataCount; n++)   //未通过xEEPROMDataChanged赋值的参数(如通讯直接写入)
     {
-        DataBufUint8ChangedTimes++;
-        if(DataBufUint8ChangedTimes >= UINT8_WRITE_INTV)
+        psData  = &EEPROMDataList[n];
+        ulValue = ulEEPROMDataGet(psData);
+        if(psData->ulShadow != ulValue) //检查值是否已经改变
         {
-            EEPROM_Write(UINT8_PAGE_OFFSET, UINT8_PAGE_ADDR, (void*)DataBufUint8, MODE_8_BIT, UINT8_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufUint8ChangedTimes = 0;
-            
-            myprintf("xDataUint8Changed\n");
-        } 
+            psData->ulShadow = ulValue;
+            vEEPROMDirtySet(psData);
+        }
     }
-    if(xDataInt8Changed())
+    CPU_CRITICAL_ENTER();
+    ucChanged = EEPROMTypeChanged;
+    EEPROMTypeChanged = 0;
+    CPU_CRITICAL_EXIT();
+
+    for(i=0; i<EEPROM_TYPE_NUM; i++)
     {
-        DataBufInt8ChangedTimes++;
-        if(DataBufInt8ChangedTimes >= INT8_WRITE_INTV)
+        if((ucChanged >> i) & 0x01)
         {
-            EEPROM_Write(INT8_PAGE_OFFSET, INT8_PAGE_ADDR, (void*)DataBufInt8, MODE_8_BIT, INT8_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufInt8ChangedTimes = 0;
-            
-            myprintf("xDataInt8Changed\n");
-        } 
+            EEPROMTypeChangedTimes[i]++;
+        }
     }
-    
-    if(xDataUint16Changed())
+    if(xEEPROMBackupNeedMerge() == TRUE)   //增量将溢出或掉电，计数器立即写入EEPROM
     {
-        DataBufUint16ChangedTimes++;
-        if(DataBufUint16ChangedTimes >= UINT16_WRITE_INTV)
-        {
-            EEPROM_Write(UINT16_PAGE_OFFSET, UINT16_PAGE_ADDR, (void*)DataBufUint16, MODE_16_BIT, UINT16_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufUint16ChangedTimes = 0;
-            
-            myprintf("xDataUint16Changed\n");
-        }  
+        EEPROMTypeChangedTimes[TYPE_RUNTIME - 1] = EEPROMTypeInfo[TYPE_RUNTIME - 1].usWriteIntv;
+        EEPROMTypeChangedTimes[TYPE_E32 - 1]     = EEPROMTypeInfo[TYPE_E32 - 1].usWriteIntv;
     }
-    if(xDataInt16Changed())
+    for(n=0; n<EEPROMBackupCount; n++)
     {
-        DataBufInt16ChangedTimes++;
-        if(DataBufInt16ChangedTimes >= INT16_WRITE_INTV)
+        psData = EEPROMBackupList[n];
+        i = psData->ucType - 1;
+        if(xEEPROMDirtyTest(psData) == TRUE && EEPROMTypeChangedTimes[i] >= EEPROMTypeInfo[i].usWriteIntv)
         {
-            EEPROM_Write(INT16_PAGE_OFFSET, INT16_PAGE_ADDR, (void*)DataBufInt16, MODE_16_BIT, INT16_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufInt16ChangedTimes = 0;
-            
-            myprintf("xDataInt16Changed\n");
-        } 
+            xMerge = TRUE;
+        }
     }
-    if(xDataUint32Changed())
+    if(xMerge == TRUE)   //先写代号，掉电时备份寄存器中的增量作废而不会重复累加
     {
-        DataBufUint32ChangedTimes++;
-        if(DataBufUint32ChangedTimes >= UINT32_WRITE_INTV)
-        {
-            EEPROM_Write(UINT32_PAGE_OFFSET, UINT32_PAGE_ADDR, (void*)DataBufUint32, MODE_32_BIT, UINT32_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufUint32ChangedTimes = 0;
-            
-            myprintf("xDataUint32Changed\n");
-        }     
+        EEPROMBackupBusy = TRUE;
+        EEPROMBackupStats.usGen++;
+        EEPROMBackupStats.ulMerge++;
+        (void)xEEPROMLogWrite(EEPROM_BACKUP_GEN_ID, sizeof(uint16_t), EEPROMBackupStats.usGen);
     }
-    if(xDataInt32Changed())
+    for(n=0; n<EEPROM_DIRTY_MAP_WORDS; n++)   //只处理已变化的参数
     {
-        DataBufInt32ChangedTimes++;
-        if(DataBufInt32ChangedTimes >= INT32_WRITE_INTV)
+        ulDirty = EEPROMDirtyMap[n];
+        while(ulDirty != 0)
         {
-            EEPROM_Write(INT32_PAGE_OFFSET, INT32_PAGE_ADDR, (void*)DataBufInt32, MODE_32_BIT, INT32_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufInt32ChangedTimes = 0;
-            
-            myprintf("xDataInt32Changed\n");
-        } 
+            ucBit   = 31 - __CLZ(ulDirty);
+            ulDirty &= ~((uint32_t)1 << ucBit);
+
+            psData = &EEPROMDataList[n * 32 + ucBit];
+            i = psData->ucType - 1;
+            if(EEPROMTypeChangedTimes[i] < EEPROMTypeInfo[i].usWriteIntv)
+            {
+                continue;
+            }
+            CPU_CRITICAL_ENTER();
+            EEPROMDirtyMap[n] &= ~((uint32_t)1 << ucBit);
+            ulValue = psData->ulShadow;
+            CPU_CRITICAL_EXIT();
+
+            (void)xEEPROMLogWrite(psData->usParamId, EEPROMTypeInfo[i].ucSize, ulValue);
+            if(psData->ucBackup != EEPROM_BACKUP_NONE)
+            {
+                EEPROMBackupBase[psData->ucBackup] = ulValue;
+            }
+        }
     }
-    if(xDataRuntimeChanged())
+    for(i=0; i<EEPROM_TYPE_NUM; i++)
     {
-        DataBufRuntimeChangedTimes++;
-        if(DataBufRuntimeChangedTimes >= RUNTIME_WRITE_INTV / SYSTEM_POLL_TIME_OUT_S)
+        if(EEPROMTypeChangedTimes[i] >= EEPROMTypeInfo[i].usWriteIntv)
         {
-            EEPROM_Write(RUNTIME_PAGE_OFFSET, RUNTIME_PAGE_ADDR, (void*)DataBufRuntime, MODE_32_BIT, RUNTIME_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufRuntimeChangedTimes = 0;
-            
-            myprintf("xDataRuntimeChanged\n");
-        } 
+            EEPROMTypeChangedTimes[i] = 0;
+        }
     }
-    if(xDataE32Changed())
+    vEEPROMLogFlush();
+
+    EEPROMBackupTimes++;
+    if(xMerge == TRUE || EEPROMBackupTimes >= EEPROM_BACKUP_INTV_S)
     {
-        DataBufE32ChangedTimes++;
-        if(DataBufE32ChangedTimes >= E32_WRITE_INTV)
-        {
-            EEPROM_Write(E32_PAGE_OFFSET, E32_PAGE_ADDR, (void*)DataBufE32, MODE_32_BIT, RUNTIME_SAVE_SIZE);
-            OSTimeDlyHMSM(0, 0, 0, EEPROM_WRITE_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-            DataBufE32ChangedTimes = 0;
-            
-            myprintf("xDataE32Changed\n");
-        } 
+        EEPROMBackupTimes = 0;
+        vEEPROMBackupSave();
+        EEPROMBackupBusy = FALSE;
+    }
+    if(EEPROMBrownOut == TRUE)
+    {
+        EEPROMBrownOut = FALSE;
+        NVIC_EnableIRQ(BOD_IRQn);
     }
 }
 
@@ -488,71 +529,85 @@ void vWriteEEPROMData(void)
  *********************************************************************/
 void vWriteEEPROMDataFirstTime(void)
 {
-    OS_ERR err = OS_ERR_NONE;
-    uint16_t usIndex = 0;
+    uint16_t n = 0;
+    sEEPROMData* psData = NULL;
     
-#if EEPROM_RUNNING_TIME_INIT > 0   //运行时间复位   
-    for(usIndex=0; usIndex<DataBufRuntimeCount; usIndex++)  
+    for(n=0; n<EEPROMDataCount; n++)
     {
-        if(pDataBufRuntime[usIndex] != NULL)
+        psData  = &EEPROMDataList[n];
+#if EEPROM_RUNNING_TIME_INIT > 0   //运行时间复位   
+        if(psData->ucType == TYPE_RUNTIME)
         {
-            *(uint32_t*)pDataBufRuntime[usIndex] = usIndex * 100;
-            DataBufRuntime[usIndex] = usIndex * 100;
+            *(uint32_t*)psData->pvData = (psData->usParamId & 0xFF) * 100;
         }
-    }
 #endif     
 #if EEPROM_ENERGY_INIT > 0         //能耗复位 
-    for(usIndex=0; usIndex<DataBufE32Count; usIndex++)    
-    {
-        if(pDataBufE32[usIndex] != NULL)
+        if(psData->ucType == TYPE_E32)
         {
-             *(uint32_t*)pDataBufE32[usIndex] = 0;
-             DataBufE32[usIndex] = 0;
+            *(uint32_t*)psData->pvData = 0;
         }
-    } 
 #endif     
-    if(DataBufUint8Count>0)
-    {
-        EEPROM_Write(UINT8_PAGE_OFFSET, UINT8_PAGE_ADDR, (void*)DataBufUint8, MODE_8_BIT, UINT8_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }        
-    if(DataBufInt8Count>0)
-    {
-        EEPROM_Write(INT8_PAGE_OFFSET, INT8_PAGE_ADDR, (void*)DataBufInt8, MODE_8_BIT, INT8_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufUint16Count>0)
-    {    
-        EEPROM_Write(UINT16_PAGE_OFFSET, UINT16_PAGE_ADDR, (void*)DataBufUint16, MODE_16_BIT, UINT16_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufInt16Count>0)
-    {    
-        EEPROM_Write(INT16_PAGE_OFFSET, INT16_PAGE_ADDR, (void*)DataBufInt16, MODE_16_BIT, INT16_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufUint32Count>0)
-    {    
-        EEPROM_Write(UINT32_PAGE_OFFSET, UINT32_PAGE_ADDR, (void*)DataBufUint32, MODE_32_BIT, UINT32_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufInt32Count>0)
-    {
-        EEPROM_Write(INT32_PAGE_OFFSET, INT32_PAGE_ADDR, (void*)DataBufInt32, MODE_32_BIT, INT32_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
-    if(DataBufRuntimeCount>0)
-    {
-        EEPROM_Write(RUNTIME_PAGE_OFFSET, RUNTIME_PAGE_ADDR, (void*)DataBufRuntime, MODE_32_BIT, RUNTIME_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
+        psData->ulShadow = ulEEPROMDataGet(psData);
+        if(psData->ucBackup != EEPROM_BACKUP_NONE)
+        {
+            EEPROMBackupBase[psData->ucBackup] = psData->ulShadow;
+        }
+        (void)xEEPROMLogSet(psData->usParamId, EEPROMTypeInfo[psData->ucType - 1].ucSize, psData->ulShadow);
     }
-    if(DataBufE32Count>0)
+    (void)xEEPROMLogSet(EEPROM_BACKUP_GEN_ID, sizeof(uint16_t), EEPROMBackupStats.usGen);
+    memset(EEPROMDirtyMap, 0, sizeof(EEPROMDirtyMap));
+    vEEPROMLogFormat();
+    vEEPROMBackupInvalid();
+    myprintf("vWriteEEPROMDataFirstTime %d\n", EEPROMDataCount);
+}
+
+/**********************************************************************
+* @brief  从旧版固定布局导入参数，返回旧版数据是否有效
+ *********************************************************************/
+BOOL xEEPROMLegacyImport(void)
+{
+    uint8_t  i = 0;
+    uint8_t  ucCount = 0;
+    uint16_t n = 0;
+    uint32_t ulValue = 0;
+
+    const sEEPROMTypeInfo* psInfo = NULL;
+    sEEPROMData*           psData = NULL;
+
+    for(i=0; i<EEPROM_TYPE_NUM; i++)
     {
-        EEPROM_Write(E32_PAGE_OFFSET, E32_PAGE_ADDR, (void*)DataBufE32, MODE_32_BIT, E32_SAVE_SIZE);
-        OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
+        if(EEPROMTypeCount[i] == 0)
+        {
+            continue;
+        }
+        psInfo  = &EEPROMTypeInfo[i];
+        ucCount = (EEPROMTypeCount[i] < EEPROMLegacyCount[i]) ? EEPROMTypeCount[i] : EEPROMLegacyCount[i];
+        EEPROM_Read(psInfo->ucPageOffset, psInfo->ucPageAddr, (void*)EEPROMLegacyBuf, (EEPROM_Mode_Type)psInfo->ucMode, ucCount);
+
+        for(n=0; n<EEPROMDataCount; n++)
+        {
+            psData = &EEPROMDataList[n];
+            if( (psData->ucType != i + 1) || ((psData->usParamId & 0xFF) >= ucCount) )  //新增参数保持默认值
+            {
+                continue;
+            }
+            switch(psInfo->ucSize)
+            {
+                case sizeof(uint8_t):  ulValue = ((uint8_t*)EEPROMLegacyBuf)[psData->usParamId & 0xFF];  break;
+                case sizeof(uint16_t): ulValue = ((uint16_t*)EEPROMLegacyBuf)[psData->usParamId & 0xFF]; break;
+                default:               ulValue = EEPROMLegacyBuf[psData->usParamId & 0xFF];              break;
+            }
+            if(psData->pvData == (void*)&EEPROMFirstRun && ulValue == TRUE)  //旧版数据未初始化
+            {
+                return FALSE;
+            }
+            (void)xEEPROMLogSet(psData->usParamId, psInfo->ucSize, ulValue);
+        }
     }
-    myprintf("vWriteEEPROMDataFirstTime ulExAirFanRated_Vol %ld  %ld \n\n", DataBufUint32[0], *(uint32_t*)pDataBufUint32[0]);
-    
+    vEEPROMLogFormat();
+    vEEPROMBackupInvalid();
+    myprintf("xEEPROMLegacyImport %d\n", EEPROMDataCount);
+    return TRUE;
 }
 
 /**********************************************************************
@@ -560,183 +615,42 @@ void vWriteEEPROMDataFirstTime(void)
  *********************************************************************/
 BOOL xRegistEEPROMData(eEEPROMDataType eDataType, void* pData)
 {
-    uint16_t usIndex = 0;
+    uint16_t n = 0;
+    sEEPROMData* psData = NULL;
     
-    if(pData == NULL)
+    if(pData == NULL || eDataType < TYPE_UINT_8 || eDataType > TYPE_E32)
     {
         return FALSE;
     }
-    switch(eDataType)
+    for(n=0; n<EEPROMDataCount; n++)
     {
-        case TYPE_UINT_8:    
-            for(usIndex=0; usIndex<DataBufUint8Count; usIndex++)
-            {
-                if(pDataBufUint8[usIndex] == (uint8_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufUint8Count < UINT8_SAVE_COUNT)
-            {
-                pDataBufUint8[DataBufUint8Count] = (uint8_t*)pData;
-                DataBufUint8[DataBufUint8Count]  = *(uint8_t*)pData;
-                DataBufUint8Count++;
-            }
-            else
-            {
-                myprintf("TYPE_UINT_8 over\n");
-                return FALSE;
-            }                
-        break;
-        
-        case TYPE_INT_8:
-            for(usIndex=0; usIndex<DataBufInt8Count; usIndex++)
-            {
-                if(pDataBufInt8[usIndex] == (int8_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufInt8Count < INT8_SAVE_COUNT)
-            {
-                pDataBufInt8[DataBufInt8Count] = (int8_t*)pData;
-                DataBufInt8[DataBufInt8Count]  = *(int8_t*)pData;
-                DataBufInt8Count++;
-            }
-            else
-            {
-                myprintf("TYPE_INT_8 over\n");
-                return FALSE;
-            }                
-        break;
-        
-        case TYPE_UINT_16:
-            for(usIndex=0; usIndex<DataBufUint16Count; usIndex++)
-            {
-                if(pDataBufUint16[usIndex] == (uint16_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufUint16Count < UINT16_SAVE_COUNT)
-            {
-                pDataBufUint16[DataBufUint16Count] = (uint16_t*)pData;
-                DataBufUint16[DataBufUint16Count]  = *(uint16_t*)pData;
-                DataBufUint16Count++;
-            }
-            else
-            {
-                myprintf("TYPE_UINT_16 over\n");
-                return FALSE;
-            }                
-        break;    
-        
-        case TYPE_INT_16:
-            for(usIndex=0; usIndex<DataBufInt16Count; usIndex++)
-            {
-                if(pDataBufInt16[usIndex] == (int16_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufInt16Count < INT16_SAVE_COUNT)
-            {
-                pDataBufInt16[DataBufInt16Count] = (int16_t*)pData;
-                DataBufInt16[DataBufInt16Count]  = *(int16_t*)pData;
-                DataBufInt16Count++;
-            }
-            else
-            {
-                myprintf("TYPE_INT_16 over\n");
-                return FALSE;
-            }                
-        break;            
-           
-         case TYPE_UINT_32:
-            for(usIndex=0; usIndex<DataBufUint32Count; usIndex++)
-            {
-                if(pDataBufUint32[usIndex] == (uint32_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufUint32Count < UINT32_SAVE_COUNT)
-            {
-                pDataBufUint32[DataBufUint32Count] = (uint32_t*)pData;
-                DataBufUint32[DataBufUint32Count]  = *(uint32_t*)pData;
-                DataBufUint32Count++;
-            }
-            else
-            {
-                myprintf("TYPE_UINT_32 over\n");
-                return FALSE;
-            }                
-        break;    
-        
-        case TYPE_INT_32:
-            for(usIndex=0; usIndex<DataBufInt32Count; usIndex++)
-            {
-                if(pDataBufInt32[usIndex] == (int32_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufInt32Count < INT32_SAVE_COUNT)
-            {
-                pDataBufInt32[DataBufInt32Count] = (int32_t*)pData;
-                DataBufInt32[DataBufInt32Count]  = *(int32_t*)pData;
-                DataBufInt32Count++;
-            }
-            else
-            {
-                myprintf("TYPE_INT_32 over\n");
-                return FALSE;
-            }                
-        break; 
+        if(EEPROMDataList[n].pvData == pData)
+        {
+            return FALSE;
+        }
+    }
+    if(EEPROMTypeCount[eDataType - 1] >= EEPROMTypeInfo[eDataType - 1].ucSaveCount)
+    {
+        myprintf("xRegistEEPROMData type %d over\n", eDataType);
+        return FALSE;
+    }
+    psData = &EEPROMDataList[EEPROMDataCount];
 
-        case TYPE_RUNTIME:
-            for(usIndex=0; usIndex<DataBufRuntimeCount; usIndex++)
-            {
-                if(pDataBufRuntime[usIndex] == (uint32_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufRuntimeCount < RUNTIME_SAVE_COUNT)
-            {
-                pDataBufRuntime[DataBufRuntimeCount] = (uint32_t*)pData;
-                DataBufRuntime[DataBufRuntimeCount]  = *(uint32_t*)pData;
-                DataBufRuntimeCount++;
-            }
-            else
-            {
-                myprintf("TYPE_RUNTIME over\n");
-                return FALSE;
-            }                
-        break; 
+    psData->pvData    = pData;
+    psData->ucType    = (uint8_t)eDataType;
+    psData->usParamId = ((uint16_t)eDataType << 8) | EEPROMTypeCount[eDataType - 1];
+    psData->ulShadow  = ulEEPROMDataGet(psData);
+    psData->ucBackup  = EEPROM_BACKUP_NONE;
 
-        case TYPE_E32:
-            for(usIndex=0; usIndex<DataBufE32Count; usIndex++)
-            {
-                if(pDataBufE32[usIndex] == (uint32_t*)pData)
-                {
-                    return FALSE;
-                }
-            }
-            if(DataBufE32Count < E32_SAVE_COUNT)
-            {
-                pDataBufE32[DataBufE32Count] = (uint32_t*)pData;
-                DataBufE32[DataBufE32Count] = *(uint32_t*)pData;
-                DataBufE32Count++;
-            }
-            else
-            {
-                myprintf("TYPE_E32 over\n");
-                return FALSE;
-            }                
-        break;               
-        default: break;
+    if((eDataType == TYPE_RUNTIME || eDataType == TYPE_E32) && EEPROMBackupCount < EEPROM_BACKUP_NUM)  //高频计数器使用RTC备份寄存器
+    {
+        psData->ucBackup = EEPROMBackupCount;
+        EEPROMBackupList[EEPROMBackupCount] = psData;
+        EEPROMBackupBase[EEPROMBackupCount] = psData->ulShadow;
+        EEPROMBackupCount++;
     }
+    EEPROMTypeCount[eDataType - 1]++;
+    EEPROMDataCount++;
     return TRUE;
 }
 
@@ -746,28 +660,31 @@ BOOL xRegistEEPROMData(eEEPROMDataType eDataType, void* pData)
 void vEEPROMDataTask(void * p_arg)
 {
     OS_ERR err = OS_ERR_NONE;
+    BOOL   xLogValid = FALSE;
+
     EEPROM_Init(); 
+    xLogValid = xEEPROMLogInit();
 
 #if EEPROM_USE_DEFAULT_DATA == 0    //不使用默认参数
     
 #if EEPROM_DATA_INIT > 0    //参数复位
-    
     vWriteEEPROMDataFirstTime();
 #else 
-    EEPROM_Read(UINT8_PAGE_OFFSET, UINT8_PAGE_ADDR, (void*)DataBufFirstRunUint8, MODE_8_BIT, UINT8_SAVE_SIZE);   //上电
-    OSTimeDlyHMSM(0, 0, 0, EEPROM_READ_DATA_DELAY_MS, OS_OPT_TIME_HMSM_STRICT, &err);
-    
-    EEPROMFirstRun = DataBufFirstRunUint8[DataBufUint8Count-1];  //特别注意一定要保证该变量位于最后位置 
-    if(EEPROMFirstRun == TRUE)       //首次上电,先同步默认参数
+    if(xLogValid == FALSE)          //参数日志无效，先尝试导入旧版数据
     {
-        EEPROMFirstRun = FALSE;
-        DataBufUint8[DataBufUint8Count-1] = FALSE;
-        
-        vWriteEEPROMDataFirstTime();
+        if(xEEPROMLegacyImport() == FALSE)   //首次上电,先同步默认参数
+        {
+            EEPROMFirstRun = FALSE;
+            vWriteEEPROMDataFirstTime();
+        }
     }
 #endif 
     vReadEEPROMData();
+#else
+    (void)xLogValid;
 #endif    
+    vEEPROMDataReady();
+    vEEPROMBODInit();
     
     while(DEF_TRUE)
 	{
@@ -781,6 +698,9 @@ void vEEPROMDataTask(void * p_arg)
  *********************************************************************/
 void vEEPROMInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size)
 {
+     OS_ERR err = OS_ERR_NONE;
+
+     OSFlagCreate(&EEPROMFlagGrp, "EEPROMFlagGrp", (OS_FLAGS)0, &err);
      EEPROM_DATA(TYPE_UINT_8, EEPROMFirstRun);
      (void)eTaskCreate(p_tcb, vEEPROMDataTask, NULL, prio, p_stk_base, stk_size);
-}
\ No newline at end of file
+}
@@ -6,6 +6,9 @@
 
 #define EEPROM_DATA(arg1, arg2)  (void)xRegistEEPROMData(arg1, &arg2);
 
+//记忆参数赋值并通知写入
+#define EEPROM_SET(arg1, arg2)   {arg1 = arg2; (void)xEEPROMDataChanged((void*)&arg1);}
+
 typedef enum   /*运行模式*/
 {
     TYPE_UINT_8    = 1,   
@@ -21,10 +24,45 @@ typedef enum   /*运行模式*/
     TYPE_E32       = 8,
 }eEEPROMDataType;
 
+#define EEPROM_TYPE_NUM     8      //参数类型数量
+
+typedef struct  /*参数类型描述*/
+{
+    uint8_t   ucSaveCount;   //记忆数量
+    uint8_t   ucSize;        //数据长度(1/2/4)
+    uint16_t  usWriteIntv;   //记忆周期
+    uint8_t   ucPageAddr;    //旧版固定布局初始页地址
+    uint8_t   ucPageOffset;  //旧版固定布局页寄存器偏移量
+    uint8_t   ucMode;        //旧版固定布局读写模式
+}sEEPROMTypeInfo;
+
+typedef struct  /*记忆参数*/
+{
+    void*     pvData;        //参数变量
+    uint32_t  ulShadow;      //上次检查时的数值
+    uint16_t  usParamId;     //参数日志ID，高8位类型，低8位类型内序号
+    uint8_t   ucType;        //参数类型
+    uint8_t   ucBackup;      //RTC备份寄存器槽位，EEPROM_BACKUP_NONE无
+}sEEPROMData;
+
+typedef struct  /*RTC备份寄存器统计*/
+{
+    uint16_t  usGen;         //当前代号，每次写入EEPROM加1
+    uint32_t  ulSave;        //备份寄存器写入次数
+    uint32_t  ulMerge;       //写入EEPROM次数
+    uint32_t  ulBrownOut;    //掉电检测次数
+    BOOL      xRestored;     //上电是否从备份寄存器恢复
+}sEEPROMBackupStats;
+
 void vReadEEPROMData(void);
 
 BOOL xEEPROMDataIsReady(void);
+BOOL xEEPROMDataWaitReady(OS_TICK ulTimeout);
+OS_TICK ulEEPROMDataReadyTick(void);
 BOOL xRegistEEPROMData(eEEPROMDataType eDataType, void* pData);
+BOOL xEEPROMDataChanged(void* pData);
+
+const sEEPROMBackupStats* psEEPROMBackupGetStats(void);
 
 void vEEPROMInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size);
 
@@ -0,0 +1,419 @@
+#include "lpc_eeprom.h"
+#include "md_eeprom_log.h"
+#include "my_rtt_printf.h"
+
+/*************************************************************
+*   参数日志存储：EEPROM按组追加写入记录(参数ID,长度,数值,CRC)，
+*   上电扫描重建RAM索引，当前组写满后整理到另一组。
+*   新页不预先清空，首次写入时整页编程。尾页之后残留的旧记录
+*   CRC初值(组序号低8位)与当前不同，扫描时作为日志结束；
+*   每256代整理时清空一次新组尾页之后的各页，保证残留记录
+*   与当前组序号相差不足256，不会混淆
+**************************************************************/
+
+#define EEPROM_LOG_PAGE_RECORDS    (EEPROM_PAGE_SIZE / sizeof(sEEPROMRecord))            //每页记录数
+#define EEPROM_LOG_SET_RECORDS     (EEPROM_LOG_SET_PAGES * EEPROM_LOG_PAGE_RECORDS)     //每组记录数
+#define EEPROM_LOG_PAGE_WORDS      (EEPROM_PAGE_SIZE / 4)
+
+#define EEPROM_LOG_PROG_TIMEOUT_MS 10       //页编程完成等待超时(典型值3ms)
+
+#define EEPROM_LOG_PAGE(set, slot) (EEPROM_LOG_START_PAGE + (set) * EEPROM_LOG_SET_PAGES + (slot) / EEPROM_LOG_PAGE_RECORDS)
+
+#define EEPROM_LOG_WIPE_SEQ(seq)   ((((seq) - 1) & 0xFF) < 2)   //每组每256代清空一次尾页之后的旧记录，含两组首次使用(序号1、2)
+
+uint8_t   EEPROMLogSet  = 1;       //当前组
+uint16_t  EEPROMLogTail = 0;       //当前组下一条记录位置
+uint32_t  EEPROMLogSeq  = 0;       //当前组序号
+
+sEEPROMRecord __attribute__((aligned (4))) EEPROMLogPage[EEPROM_LOG_PAGE_RECORDS];  //尾页缓存
+uint16_t  EEPROMLogPageAddr  = 0;
+BOOL      EEPROMLogPageDirty = FALSE;
+
+uint16_t  EEPROMLogId[EEPROM_LOG_PARAM_MAX_NUM];     //RAM索引
+uint8_t   EEPROMLogLen[EEPROM_LOG_PARAM_MAX_NUM];
+uint32_t  EEPROMLogVal[EEPROM_LOG_PARAM_MAX_NUM];
+uint16_t  EEPROMLogCount = 0;
+
+sEEPROMLogStats EEPROMLogStats;
+
+OS_TCB*   EEPROMLogWaitTCB = NULL;   //等待页编程完成的任务
+
+/*CRC8(x^8+x^2+x+1)*/
+uint8_t ucEEPROMCrc8(const uint8_t* pucData, uint16_t usLen, uint8_t ucSeed)
+{
+    uint8_t  j, ucCrc = ucSeed;
+    uint16_t i;
+
+    for(i=0; i<usLen; i++)
+    {
+        ucCrc ^= pucData[i];
+        for(j=0; j<8; j++)
+        {
+            ucCrc = (ucCrc & 0x80) ? (uint8_t)((ucCrc << 1) ^ 0x07) : (uint8_t)(ucCrc << 1);
+        }
+    }
+    return ucCrc;
+}
+
+/*记录CRC，以组序号为初值*/
+uint8_t ucEEPROMLogCrc(const sEEPROMRecord* psRec, uint8_t ucSeed)
+{
+    uint8_t  ucData[7];
+
+    ucData[0] = (uint8_t)(psRec->usParamId);
+    ucData[1] = (uint8_t)(psRec->usParamId >> 8);
+    ucData[2] = psRec->ucLen;
+    ucData[3] = (uint8_t)(psRec->ulValue);
+    ucData[4] = (uint8_t)(psRec->ulValue >> 8);
+    ucData[5] = (uint8_t)(psRec->ulValue >> 16);
+    ucData[6] = (uint8_t)(psRec->ulValue >> 24);
+
+    return ucEEPROMCrc8(ucData, sizeof(ucData), ucSeed);
+}
+
+/*记录是否为空(日志结束)*/
+BOOL xEEPROMLogRecordEmpty(const sEEPROMRecord* psRec)
+{
+    return (psRec->usParamId == 0x0000 || psRec->usParamId == 0xFFFF);
+}
+
+void vEEPROMLogReadPage(uint16_t usPage, sEEPROMRecord* psBuf)
+{
+    EEPROM_Read(0, usPage, (void*)psBuf, MODE_32_BIT, EEPROM_LOG_PAGE_WORDS);
+}
+
+/**********************************************************************
+ * @brief  页编程：数据写入页寄存器后启动擦写，任务挂起等待编程完成中断，
+ *         psBuf为NULL时整页写0
+ *********************************************************************/
+void vEEPROMLogProgramPage(uint16_t usPage, const sEEPROMRecord* psBuf)
+{
+    uint8_t  i;
+    OS_ERR   err = OS_ERR_NONE;
+    const uint32_t* pulData = (const uint32_t*)psBuf;
+
+    LPC_EEPROM->INT_CLR_STATUS = ((1 << EEPROM_ENDOF_RW) | (1 << EEPROM_ENDOF_PROG));
+    LPC_EEPROM->ADDR = EEPROM_PAGE_OFFSET(0);
+    LPC_EEPROM->CMD  = EEPROM_CMD_32_BIT_WRITE;
+    for(i=0; i<EEPROM_LOG_PAGE_WORDS; i++)
+    {
+        LPC_EEPROM->WDATA = (pulData == NULL) ? 0 : pulData[i];
+        while(!((LPC_EEPROM->INT_STATUS >> EEPROM_ENDOF_RW) & 0x01));
+        LPC_EEPROM->INT_CLR_STATUS = (1 << EEPROM_ENDOF_RW);
+    }
+
+    (void)OSTaskSemSet(NULL, 0, &err);  //清除上次超时后迟到的完成通知
+    EEPROMLogWaitTCB = OSTCBCurPtr;
+
+    LPC_EEPROM->INT_SET_ENABLE = (1 << EEPROM_ENDOF_PROG);
+    LPC_EEPROM->ADDR = EEPROM_PAGE_ADRESS(usPage);
+    LPC_EEPROM->CMD  = EEPROM_CMD_ERASE_PRG_PAGE;
+
+    (void)OSTaskSemPend(EEPROM_LOG_PROG_TIMEOUT_MS * OS_CFG_TICK_RATE_HZ / 1000, OS_OPT_PEND_BLOCKING, NULL, &err);
+    if(err != OS_ERR_NONE)   //未收到中断，查询完成状态
+    {
+        while(!((LPC_EEPROM->INT_STATUS >> EEPROM_ENDOF_PROG) & 0x01));
+        EEPROMLogStats.ulProgTimeout++;
+    }
+    LPC_EEPROM->INT_CLR_ENABLE = (1 << EEPROM_ENDOF_PROG);
+    LPC_EEPROM->INT_CLR_STATUS = (1 << EEPROM_ENDOF_PROG);
+    EEPROMLogWaitTCB = NULL;
+
+    EEPROMLogStats.ulPageProgram++;
+}
+
+/*EEPROM编程完成中断*/
+void EEPROM_IRQHandler(void);
+void EEPROM_IRQHandler(void)
+{
+    OS_ERR err = OS_ERR_NONE;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    OSIntEnter();
+    CPU_CRITICAL_EXIT();
+
+    if((LPC_EEPROM->INT_STATUS >> EEPROM_ENDOF_PROG) & 0x01)
+    {
+        LPC_EEPROM->INT_CLR_ENABLE = (1 << EEPROM_ENDOF_PROG);
+        LPC_EEPROM->INT_CLR_STATUS = (1 << EEPROM_ENDOF_PROG);
+        if(EEPROMLogWaitTCB != NULL)
+        {
+            (void)OSTaskSemPost(EEPROMLogWaitTCB, OS_OPT_POST_NONE, &err);
+        }
+    }
+    OSIntExit();
+}
+
+/*读取组头，返回组是否有效*/
+BOOL xEEPROMLogReadHead(uint8_t ucSet, uint32_t* pulSeq)
+{
+    sEEPROMRecord* psHead = &EEPROMLogPage[0];
+
+    vEEPROMLogReadPage(EEPROM_LOG_PAGE(ucSet, 0), EEPROMLogPage);
+    if(psHead->usParamId != EEPROM_LOG_HEAD_ID || psHead->ucCrc != ucEEPROMLogCrc(psHead, 0))
+    {
+        return FALSE;
+    }
+    *pulSeq = psHead->ulValue;
+    return TRUE;
+}
+
+/*查找RAM索引*/
+int16_t sEEPROMLogFind(uint16_t usParamId)
+{
+    uint16_t n;
+    for(n=0; n<EEPROMLogCount; n++)
+    {
+        if(EEPROMLogId[n] == usParamId)
+        {
+            return (int16_t)n;
+        }
+    }
+    return -1;
+}
+
+/**********************************************************************
+ * @brief  更新RAM索引，不写EEPROM
+ *********************************************************************/
+BOOL xEEPROMLogSet(uint16_t usParamId, uint8_t ucLen, uint32_t ulValue)
+{
+    int16_t sIndex = sEEPROMLogFind(usParamId);
+
+    if(sIndex < 0)
+    {
+        if(EEPROMLogCount >= EEPROM_LOG_PARAM_MAX_NUM)
+        {
+            myprintf("xEEPROMLogSet over EEPROMLogCount %d\n", EEPROMLogCount);
+            return FALSE;
+        }
+        sIndex = (int16_t)EEPROMLogCount;
+        EEPROMLogId[sIndex] = usParamId;
+        EEPROMLogCount++;
+    }
+    EEPROMLogLen[sIndex] = ucLen;
+    EEPROMLogVal[sIndex] = ulValue;
+    EEPROMLogStats.usParamCount = EEPROMLogCount;
+    return TRUE;
+}
+
+/**********************************************************************
+ * @brief  读参数
+ *********************************************************************/
+BOOL xEEPROMLogRead(uint16_t usParamId, uint32_t* pulValue)
+{
+    int16_t sIndex = sEEPROMLogFind(usParamId);
+    if(sIndex < 0)
+    {
+        return FALSE;
+    }
+    *pulValue = EEPROMLogVal[sIndex];
+    return TRUE;
+}
+
+/**********************************************************************
+ * @brief  尾页写入EEPROM
+ *********************************************************************/
+void vEEPROMLogFlush(void)
+{
+    if(EEPROMLogPageDirty == TRUE)
+    {
+        vEEPROMLogProgramPage(EEPROMLogPageAddr, EEPROMLogPage);
+        EEPROMLogPageDirty = FALSE;
+    }
+}
+
+/*切换尾页缓存*/
+void vEEPROMLogLoadTail(void)
+{
+    EEPROMLogPageAddr  = EEPROM_LOG_PAGE(EEPROMLogSet, EEPROMLogTail);
+    EEPROMLogPageDirty = FALSE;
+    if(EEPROMLogTail % EEPROM_LOG_PAGE_RECORDS == 0)
+    {
+        memset(EEPROMLogPage, 0, sizeof(EEPROMLogPage));
+    }
+    else
+    {
+        vEEPROMLogReadPage(EEPROMLogPageAddr, EEPROMLogPage);
+    }
+    EEPROMLogStats.usFreeRecord = EEPROM_LOG_SET_RECORDS - EEPROMLogTail;
+}
+
+/*清空组内usTail所在页及之后各页*/
+void vEEPROMLogWipe(uint8_t ucSet, uint16_t usTail)
+{
+    uint16_t usPage;
+
+    for(usPage = EEPROM_LOG_PAGE(ucSet, usTail); usPage < EEPROM_LOG_PAGE(ucSet + 1, 0); usPage++)
+    {
+        vEEPROMLogProgramPage(usPage, NULL);
+    }
+}
+
+/**********************************************************************
+ * @brief  整理：把RAM索引中的全部参数写入另一组，最后写组头
+ *********************************************************************/
+void vEEPROMLogFormat(void)
+{
+    uint16_t n, usSlot;
+    uint8_t  ucNewSet = 1 - EEPROMLogSet;
+    uint32_t ulNewSeq = EEPROMLogSeq + 1;
+
+    sEEPROMRecord* psRec = NULL;
+
+    vEEPROMLogFlush();
+    memset(EEPROMLogPage, 0, sizeof(EEPROMLogPage));
+
+    for(n=0, usSlot=1; n<EEPROMLogCount; n++, usSlot++)
+    {
+        psRec = &EEPROMLogPage[usSlot % EEPROM_LOG_PAGE_RECORDS];
+        psRec->usParamId = EEPROMLogId[n];
+        psRec->ucLen     = EEPROMLogLen[n];
+        psRec->ulValue   = EEPROMLogVal[n];
+        psRec->ucCrc     = ucEEPROMLogCrc(psRec, (uint8_t)ulNewSeq);
+
+        if((usSlot + 1) % EEPROM_LOG_PAGE_RECORDS == 0)
+        {
+            vEEPROMLogProgramPage(EEPROM_LOG_PAGE(ucNewSet, usSlot), EEPROMLogPage);
+            memset(EEPROMLogPage, 0, sizeof(EEPROMLogPage));
+        }
+    }
+    if(usSlot % EEPROM_LOG_PAGE_RECORDS != 0)
+    {
+        vEEPROMLogProgramPage(EEPROM_LOG_PAGE(ucNewSet, usSlot), EEPROMLogPage);
+    }
+    if(EEPROM_LOG_WIPE_SEQ(ulNewSeq))
+    {
+        vEEPROMLogWipe(ucNewSet, (usSlot + EEPROM_LOG_PAGE_RECORDS - 1) / EEPROM_LOG_PAGE_RECORDS * EEPROM_LOG_PAGE_RECORDS);
+    }
+
+    /*组头最后写入，中途掉电时旧组仍然有效*/
+    vEEPROMLogReadPage(EEPROM_LOG_PAGE(ucNewSet, 0), EEPROMLogPage);
+    psRec = &EEPROMLogPage[0];
+    psRec->usParamId = EEPROM_LOG_HEAD_ID;
+    psRec->ucLen     = sizeof(uint32_t);
+    psRec->ulValue   = ulNewSeq;
+    psRec->ucCrc     = ucEEPROMLogCrc(psRec, 0);
+    vEEPROMLogProgramPage(EEPROM_LOG_PAGE(ucNewSet, 0), EEPROMLogPage);
+
+    EEPROMLogSet  = ucNewSet;
+    EEPROMLogSeq  = ulNewSeq;
+    EEPROMLogTail = usSlot;
+    vEEPROMLogLoadTail();
+
+    EEPROMLogStats.ulSeq = EEPROMLogSeq;
+    EEPROMLogStats.ulCompact++;
+}
+
+/**********************************************************************
+ * @brief  写参数，数值未变化时不写，变化时追加一条记录到尾页缓存
+ *********************************************************************/
+BOOL xEEPROMLogWrite(uint16_t usParamId, uint8_t ucLen, uint32_t ulValue)
+{
+    int16_t sIndex = sEEPROMLogFind(usParamId);
+    sEEPROMRecord* psRec = NULL;
+
+    if(sIndex >= 0 && EEPROMLogVal[sIndex] == ulValue && EEPROMLogLen[sIndex] == ucLen)
+    {
+        return TRUE;
+    }
+    if(xEEPROMLogSet(usParamId, ucLen, ulValue) == FALSE)
+    {
+        return FALSE;
+    }
+    if(EEPROMLogTail >= EEPROM_LOG_SET_RECORDS)   //当前组已满，整理到另一组
+    {
+        vEEPROMLogFormat();
+        return TRUE;
+    }
+    psRec = &EEPROMLogPage[EEPROMLogTail % EEPROM_LOG_PAGE_RECORDS];
+    psRec->usParamId = usParamId;
+    psRec->ucLen     = ucLen;
+    psRec->ulValue   = ulValue;
+    psRec->ucCrc     = ucEEPROMLogCrc(psRec, (uint8_t)EEPROMLogSeq);
+
+    EEPROMLogPageDirty = TRUE;
+    EEPROMLogTail++;
+    EEPROMLogStats.ulRecordAppend++;
+
+    if(EEPROMLogTail % EEPROM_LOG_PAGE_RECORDS == 0)
+    {
+        vEEPROMLogFlush();
+        vEEPROMLogLoadTail();      //新页在首次写入时编程
+    }
+    EEPROMLogStats.usFreeRecord = EEPROM_LOG_SET_RECORDS - EEPROMLogTail;
+    return TRUE;
+}
+
+/**********************************************************************
+ * @brief  上电扫描当前组，重建RAM索引，返回是否存在有效数据
+ *********************************************************************/
+BOOL xEEPROMLogInit(void)
+{
+    uint16_t usSlot;
+    uint32_t ulSeq0 = 0, ulSeq1 = 0;
+    BOOL     xValid0, xValid1;
+
+    sEEPROMRecord* psRec = NULL;
+
+    EEPROMLogCount = 0;
+    memset(&EEPROMLogStats, 0, sizeof(EEPROMLogStats));
+    BSP_IntEn(BSP_INT_ID_EEPROM);
+
+    xValid0 = xEEPROMLogReadHead(0, &ulSeq0);
+    xValid1 = xEEPROMLogReadHead(1, &ulSeq1);
+
+    if(xValid0 == FALSE && xValid1 == FALSE)
+    {
+        EEPROMLogSet  = 1;      //整理时写入第0组
+        EEPROMLogSeq  = 0;
+        EEPROMLogTail = EEPROM_LOG_SET_RECORDS;
+        return FALSE;
+    }
+    if(xValid0 == TRUE && (xValid1 == FALSE || (int32_t)(ulSeq0 - ulSeq1) > 0))
+    {
+        EEPROMLogSet = 0;
+        EEPROMLogSeq = ulSeq0;
+    }
+    else
+    {
+        EEPROMLogSet = 1;
+        EEPROMLogSeq = ulSeq1;
+    }
+    for(usSlot=1; usSlot<EEPROM_LOG_SET_RECORDS; usSlot++)
+    {
+        if(usSlot == 1 || usSlot % EEPROM_LOG_PAGE_RECORDS == 0)
+        {
+            vEEPROMLogReadPage(EEPROM_LOG_PAGE(EEPROMLogSet, usSlot), EEPROMLogPage);
+        }
+        psRec = &EEPROMLogPage[usSlot % EEPROM_LOG_PAGE_RECORDS];
+        if(xEEPROMLogRecordEmpty(psRec) == TRUE)
+        {
+            break;
+        }
+        if(psRec->ucCrc != ucEEPROMLogCrc(psRec, (uint8_t)EEPROMLogSeq))  //写入中途掉电，之后的记录无效
+        {
+            if(usSlot % EEPROM_LOG_PAGE_RECORDS != 0)   //页首为旧代残留记录时属正常的日志结束
+            {
+                EEPROMLogStats.ulCrcErr++;
+            }
+            break;
+        }
+        (void)xEEPROMLogSet(psRec->usParamId, psRec->ucLen, psRec->ulValue);
+    }
+    EEPROMLogTail = usSlot;
+    if(EEPROMLogTail < EEPROM_LOG_SET_RECORDS)
+    {
+        vEEPROMLogLoadTail();
+    }
+    EEPROMLogStats.ulSeq        = EEPROMLogSeq;
+    EEPROMLogStats.usFreeRecord = EEPROM_LOG_SET_RECORDS - EEPROMLogTail;
+
+    myprintf("xEEPROMLogInit set %d seq %ld params %d tail %d\n", EEPROMLogSet, EEPROMLogSeq, EEPROMLogCount, EEPROMLogTail);
+    return TRUE;
+}
+
+const sEEPROMLogStats* psEEPROMLogGetStats(void)
+{
+    return &EEPROMLogStats;
+}
@@ -0,0 +1,45 @@
+#ifndef _MD_EEPROM_LOG_H_
+#define _MD_EEPROM_LOG_H_
+
+#include "includes.h"
+#include "lpc_types.h"
+
+#define EEPROM_LOG_START_PAGE       12      //参数日志起始页(0~9页为旧版固定布局)
+#define EEPROM_LOG_SET_PAGES        24      //每组页数，共两组轮换
+#define EEPROM_LOG_PARAM_MAX_NUM    64      //最大参数数量(RAM索引大小)
+
+#define EEPROM_LOG_HEAD_ID          0xFFFE  //组头记录ID，数值为组序号
+
+typedef struct  /*参数日志记录，8字节，每页8条*/
+{
+    uint16_t  usParamId;    //参数ID
+    uint8_t   ucLen;        //数据长度(1/2/4)
+    uint8_t   ucCrc;        //CRC8，以组序号为初值
+    uint32_t  ulValue;      //数据值
+}sEEPROMRecord;
+
+typedef struct  /*参数日志统计*/
+{
+    uint32_t  ulSeq;            //当前组序号
+    uint32_t  ulRecordAppend;   //追加记录数
+    uint32_t  ulPageProgram;    //页编程次数
+    uint32_t  ulCompact;        //整理次数
+    uint32_t  ulCrcErr;         //上电扫描CRC错误数
+    uint32_t  ulProgTimeout;    //页编程完成中断超时次数
+    uint16_t  usFreeRecord;     //当前组剩余记录数
+    uint16_t  usParamCount;     //有效参数数量
+}sEEPROMLogStats;
+
+BOOL xEEPROMLogInit(void);
+BOOL xEEPROMLogRead(uint16_t usParamId, uint32_t* pulValue);
+BOOL xEEPROMLogWrite(uint16_t usParamId, uint8_t ucLen, uint32_t ulValue);
+BOOL xEEPROMLogSet(uint16_t usParamId, uint8_t ucLen, uint32_t ulValue);
+
+void vEEPROMLogFlush(void);
+void vEEPROMLogFormat(void);
+
+const sEEPROMLogStats* psEEPROMLogGetStats(void);
+
+uint8_t ucEEPROMCrc8(const uint8_t* pucData, uint16_t usLen, uint8_t ucSeed);
+
+#endif
@@ -1,91 +1,461 @@
 #include "os.h"
 #include "md_event.h"
+#include "md_monitor.h"
 #include "my_rtt_printf.h"
 
-#define  EVENT_MAX_NUM        50     //最大可监控点位数，根据实际情况调整
+typedef struct  /*消息量与主题绑定*/
+{
+    OS_SEM*   psSem;
+    uint8_t   ucTopic;
+}sEventTopic;
+
+sEventSubscriber*  SubscriberList = NULL;    //按优先级排序
+sEventSubscriber   SubscriberBuf[EVENT_SUB_MAX_NUM];
+uint16_t           SubscriberID = 0;
+
+typedef char EventMsgPoolCheck[(EVENT_MSG_POOL_NUM <= OS_CFG_MSG_POOL_SIZE) ? 1 : -1];  //在途消息不超过系统消息池
 
+sEventTopic   EventTopicBuf[EVENT_TOPIC_MAX_NUM];
+uint16_t      EventTopicID = 0;
 
-sEvent*  EventList = NULL;
-sEvent   EventBuf[EVENT_MAX_NUM];
+sEventHandler  EventHandlerTable[MONITOR_DATA_MAX_NUM];   //按监控ID索引的事件响应表
 
-uint16_t EventID = 0;
+OS_MEM       EventMsgPool;
+sEventBatch  EventMsgPoolBuf[EVENT_MSG_POOL_NUM];
+sEventStats  EventStats;
 
-OS_TCB*  pEventTCB;
+/**************************************************************
+*@brief 消息量主题注册
+***************************************************************/
+void vEventTopicRegist(OS_SEM* psSem, uint8_t ucTopic)
+{
+    uint16_t n;
+    for(n=0; n<EventTopicID; n++)
+    {
+        if(EventTopicBuf[n].psSem == psSem)
+        {
+            EventTopicBuf[n].ucTopic = ucTopic;
+            return;
+        }
+    }
+    if(EventTopicID >= EVENT_TOPIC_MAX_NUM)
+    {
+        myprintf("vEventTopicRegist over EventTopicID %d  \n", EventTopicID);
+        return;
+    }
+    EventTopicBuf[EventTopicID].psSem   = psSem;
+    EventTopicBuf[EventTopicID].ucTopic = ucTopic;
+    EventTopicID++;
+}
+
+/**************************************************************
+*@brief 查询消息量所属主题，只在注册监控点位时调用
+***************************************************************/
+uint8_t ucEventGetTopic(OS_SEM* psSem)
+{
+    uint16_t n;
+    for(n=0; n<EventTopicID; n++)
+    {
+        if(EventTopicBuf[n].psSem == psSem)
+        {
+            return EventTopicBuf[n].ucTopic;
+        }
+    }
+    return TOPIC_ALL;
+}
+
+/**************************************************************
+*@brief 订阅者注册，按优先级插入订阅者链表
+***************************************************************/
+sEventSubscriber* psEventSubscriberRegist(uint8_t ucTopic, OS_SEM* psSem, uint8_t ucPrio)
+{
+    sEventSubscriber*  psSub  = NULL;
+    sEventSubscriber** ppNode = NULL;
+
+    if(SubscriberID >= EVENT_SUB_MAX_NUM)
+    {
+        myprintf("psEventSubscribe over SubscriberID %d  \n", SubscriberID);
+        return NULL;
+    }
+    psSub = &SubscriberBuf[SubscriberID];
+    SubscriberID++;
+
+    memset(psSub, 0, sizeof(sEventSubscriber));
+    psSub->ucTopic  = ucTopic;
+    psSub->ucPrio   = ucPrio;
+    psSub->psSem    = psSem;
+    psSub->usDataId = EVENT_ID_ANY;
+
+    for(ppNode = &SubscriberList; *ppNode != NULL; ppNode = &(*ppNode)->pNext)
+    {
+        if((*ppNode)->ucPrio > ucPrio)
+        {
+            break;
+        }
+    }
+    psSub->pNext = *ppNode;
+    *ppNode = psSub;
+
+    return psSub;
+}
+
+/**************************************************************
+*@brief 订阅主题，消息投递到任务消息队列
+***************************************************************/
+sEventSubscriber* psEventSubscribe(uint8_t ucTopic, OS_SEM* psSem, OS_TCB* psTCB, uint8_t ucPrio)
+{
+    sEventSubscriber* psSub = psEventSubscriberRegist(ucTopic, psSem, ucPrio);
+    if(psSub != NULL)
+    {
+        psSub->psTCB = psTCB;
+    }
+    return psSub;
+}
 
 /**************************************************************
-*@brief 事件注册
+*@brief 订阅主题，在发布者上下文中直接回调，回调中不可阻塞
 ***************************************************************/
-void vEventRegist(OS_SEM* psSem, OS_TCB* psTCB)
+sEventSubscriber* psEventSubscribeCallback(uint8_t ucTopic, OS_SEM* psSem, pxEventCallback pxCallback, void* pvArg, uint8_t ucPrio)
 {
-    sEvent* psEvent = NULL;   
-    if(EventID >= EVENT_MAX_NUM)
+    sEventSubscriber* psSub = psEventSubscriberRegist(ucTopic, psSem, ucPrio);
+    if(psSub != NULL)
+    {
+        psSub->pxCallback = pxCallback;
+        psSub->pvArg      = pvArg;
+    }
+    return psSub;
+}
+
+/**************************************************************
+*@brief 订阅者按点位过滤，只接收该监控变量的变化，变量须已注册监控
+***************************************************************/
+BOOL xEventSubscriberSetPoint(sEventSubscriber* psSub, void* pvVal)
+{
+    uint16_t usDataId = usMonitorGetID(pvVal);
+
+    if(psSub == NULL || usDataId >= MONITOR_DATA_MAX_NUM)
+    {
+        return FALSE;
+    }
+    psSub->usDataId = usDataId;
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 订阅者是否接收该消息
+***************************************************************/
+BOOL xEventSubscriberMatch(sEventSubscriber* psSub, sEventMsg* psMsg)
+{
+    if(psSub->ucTopic != TOPIC_ALL && psSub->ucTopic != psMsg->ucTopic)
+    {
+        return FALSE;
+    }
+    if(psSub->psSem != NULL && psSub->psSem != psMsg->psSem)
+    {
+        return FALSE;
+    }
+    if(psSub->usDataId != EVENT_ID_ANY && psSub->usDataId != psMsg->usDataId)
+    {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 从内存池申请批量消息，申请者持有一个引用
+***************************************************************/
+sEventBatch* psEventBatchAlloc(void)
+{
+    OS_ERR       err     = OS_ERR_NONE;
+    sEventBatch* psBatch = NULL;
+    CPU_SR_ALLOC();
+
+    psBatch = (sEventBatch*)OSMemGet(&EventMsgPool, &err);
+    if(psBatch == NULL || err != OS_ERR_NONE)
+    {
+        EventStats.ulAllocFail++;
+        return NULL;
+    }
+    psBatch->ucCount      = 0;
+    psBatch->ucRefCount   = 1;
+    psBatch->ulPostTick   = 0;
+    psBatch->psSubscriber = NULL;
+
+    CPU_CRITICAL_ENTER();
+    EventStats.usPoolUsed++;
+    if(EventStats.usPoolUsed > EventStats.usPoolUsedMax)
+    {
+        EventStats.usPoolUsedMax = EventStats.usPoolUsed;
+    }
+    CPU_CRITICAL_EXIT();
+    return psBatch;
+}
+
+/**************************************************************
+*@brief 释放一个引用，引用为0时统计投递延时并归还内存池
+***************************************************************/
+void vEventBatchRelease(sEventBatch* psBatch)
+{
+    uint8_t  ucRefCount = 0;
+    uint16_t usLatency  = 0;
+
+    OS_ERR  err = OS_ERR_NONE;
+    sEventSubscriber* psSub = NULL;
+    CPU_SR_ALLOC();
+
+    if(psBatch == NULL)
+    {
+        return;
+    }
+    CPU_CRITICAL_ENTER();
+    if(psBatch->ucRefCount > 0)
+    {
+        psBatch->ucRefCount--;
+    }
+    ucRefCount = psBatch->ucRefCount;
+    if(ucRefCount == 0 && EventStats.usPoolUsed > 0)
+    {
+        EventStats.usPoolUsed--;
+    }
+    CPU_CRITICAL_EXIT();
+
+    if(ucRefCount > 0)
     {
         return;
     }
-    psEvent = &EventBuf[EventID];
-    EventID++;
-     
-    psEvent->psSem = psSem;
-    psEvent->psTCB = psTCB;
-    psEvent->pNext = NULL;
- 
-    if(EventList == NULL)
+    psSub = psBatch->psSubscriber;
+    if(psSub != NULL && psBatch->ulPostTick != 0)
     {
-        EventList = psEvent;
+        usLatency = (uint16_t)(OSTimeGet(&err) - psBatch->ulPostTick);
+        psSub->usLatencyLast = usLatency;
+        if(usLatency > psSub->usLatencyMax)
+        {
+            psSub->usLatencyMax = usLatency;
+        }
+    }
+    OSMemPut(&EventMsgPool, (void*)psBatch, &err);
+}
+
+/**************************************************************
+*@brief 投递批量消息，投递成功后接收者持有一个引用
+***************************************************************/
+BOOL xEventBatchPost(OS_TCB* psTCB, sEventBatch* psBatch)
+{
+    OS_ERR err = OS_ERR_NONE;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    psBatch->ucRefCount++;
+    CPU_CRITICAL_EXIT();
+
+    psBatch->ulPostTick = OSTimeGet(&err);
+    (void)OSTaskQPost(psTCB, (void*)psBatch, sizeof(sEventBatch), OS_OPT_POST_FIFO, &err);
+    if(err != OS_ERR_NONE)
+    {
+        EventStats.ulPostFail++;
+        vEventBatchRelease(psBatch);
+        return FALSE;
+    }
+    if(psTCB->MsgQ.NbrEntries > EventStats.usQueueMax)
+    {
+        EventStats.usQueueMax = psTCB->MsgQ.NbrEntries;
+    }
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 批量消息投递给订阅者，投递后发布者释放自己的引用
+***************************************************************/
+void vEventBatchDeliver(sEventSubscriber* psSub, sEventBatch* psBatch)
+{
+    psBatch->psSubscriber = psSub;
+    if(xEventBatchPost(psSub->psTCB, psBatch) == TRUE)
+    {
+        psSub->ulDeliverCount += psBatch->ucCount;
     }
     else
     {
-        EventList->pLast->pNext = psEvent;
+        psSub->ulDropCount += psBatch->ucCount;
     }
-    EventList->pLast = psEvent;
+    vEventBatchRelease(psBatch);
 }
 
 /**************************************************************
-*@brief 事件轮询
+*@brief 发布消息，按优先级依次投递给所有匹配的订阅者。投递前按
+*       匹配点位数核算所需内存块、系统消息和各订阅任务队列空间，
+*       任一不足时全部不投递并返回FALSE，由发布者保留变化下一轮
+*       重发，避免部分订阅者重复接收。只有监控任务发布，核算到
+*       投递之间空闲块和队列空间只会增加
 ***************************************************************/
-void vEventPollTask(void * p_arg)
+BOOL xEventPublish(sEventMsg* psMsgList, uint8_t ucCount)
 {
-    CPU_TS            ts = 0;
-    OS_MSG_SIZE  msgSize = 0;
-    OS_ERR           err = OS_ERR_NONE;
-    
-    sEvent*    psEvent    = NULL;
-    sEventMsg* psEventMsg = NULL;
-    
-    while(DEF_TRUE)
-	{
-        psEventMsg = (sEventMsg*)OSTaskQPend(0, OS_OPT_PEND_BLOCKING, &msgSize, &ts, &err);
-        for(psEvent = EventList; psEvent != NULL; psEvent = psEvent->pNext) //轮询所有注册的事件
+    uint8_t  n, i, j, ucMatch;
+    uint16_t usNeed = 0;
+    uint16_t usTaskNeed = 0;
+    uint8_t  ucNeedList[EVENT_SUB_MAX_NUM];
+
+    sEventMsg*        psMsg   = NULL;
+    sEventBatch*      psBatch = NULL;
+    sEventSubscriber* psSub   = NULL;
+    sEventSubscriber* psNext  = NULL;
+
+    for(psSub = SubscriberList, i = 0; psSub != NULL; psSub = psSub->pNext, i++)
+    {
+        ucNeedList[i] = 0;
+        if(psSub->pxCallback != NULL)
+        {
+            continue;
+        }
+        for(n=0, ucMatch=0; n<ucCount; n++)
+        {
+            if(xEventSubscriberMatch(psSub, &psMsgList[n]) == TRUE)
+            {
+                ucMatch++;
+            }
+        }
+        ucNeedList[i] = (ucMatch + EVENT_MSG_BATCH_NUM - 1) / EVENT_MSG_BATCH_NUM;
+        usNeed += ucNeedList[i];
+    }
+    if( (usNeed > EventMsgPool.NbrFree) || (usNeed > OSMsgPool.NbrFree) )
+    {
+        EventStats.ulAllocFail++;
+        return FALSE;
+    }
+    for(psSub = SubscriberList, i = 0; psSub != NULL; psSub = psSub->pNext, i++)   //同一任务的订阅者合并核算队列空间
+    {
+        if( (ucNeedList[i] == 0) || (psSub->psTCB->MsgQ.NbrEntriesSize == 0) )   //无队列的任务投递失败计入丢弃
         {
-            if(psEventMsg->psSem == psEvent->psSem)    //判断是否为同一消息
+            continue;
+        }
+        usTaskNeed = ucNeedList[i];
+        for(psNext = psSub->pNext, j = i + 1; psNext != NULL; psNext = psNext->pNext, j++)
+        {
+            if(psNext->psTCB == psSub->psTCB)
             {
-                (void)OSTaskQPost(psEvent->psTCB, (void*)psEventMsg, sizeof(sEventMsg), OS_OPT_POST_FIFO, &err);  //转发到特定的Task	
+                usTaskNeed += ucNeedList[j];
+                ucNeedList[j] = 0;
             }
         }
+        if(usTaskNeed > psSub->psTCB->MsgQ.NbrEntriesSize - psSub->psTCB->MsgQ.NbrEntries)
+        {
+            EventStats.ulQueueFull++;
+            return FALSE;
+        }
     }
+    EventStats.ulPublishCount += ucCount;
+
+    for(psSub = SubscriberList; psSub != NULL; psSub = psSub->pNext)
+    {
+        for(n=0; n<ucCount; n++)
+        {
+            psMsg = &psMsgList[n];
+            if(xEventSubscriberMatch(psSub, psMsg) == FALSE)
+            {
+                continue;
+            }
+            if(psSub->pxCallback != NULL)      //发布者上下文直接投递
+            {
+                psSub->pxCallback(psMsg, psSub->pvArg);
+                psSub->ulDeliverCount++;
+                continue;
+            }
+            if(psBatch == NULL)
+            {
+                psBatch = psEventBatchAlloc();
+                if(psBatch == NULL)
+                {
+                    psSub->ulDropCount++;
+                    continue;
+                }
+            }
+            psBatch->sMsgList[psBatch->ucCount++] = *psMsg;
+            if(psBatch->ucCount >= EVENT_MSG_BATCH_NUM)
+            {
+                vEventBatchDeliver(psSub, psBatch);
+                psBatch = NULL;
+            }
+        }
+        if(psBatch != NULL)
+        {
+            vEventBatchDeliver(psSub, psBatch);
+            psBatch = NULL;
+        }
+    }
+    return TRUE;
+}
+
+const sEventStats* psEventGetStats(void)
+{
+    return &EventStats;
+}
+
+/**************************************************************
+*@brief 事件响应注册，将监控变量与响应函数绑定
+***************************************************************/
+BOOL xEventHandlerRegist(void* pvVal, pxEventHandler pxHandler, void* pvArg)
+{
+    uint16_t usDataId = usMonitorGetID(pvVal);
+
+    if(usDataId >= MONITOR_DATA_MAX_NUM)
+    {
+        myprintf("xEventHandlerRegist no monitor %d \n", pvVal);
+        return FALSE;
+    }
+    EventHandlerTable[usDataId].pxHandler = pxHandler;
+    EventHandlerTable[usDataId].pvArg     = pvArg;
+    return TRUE;
 }
 
 /**************************************************************
-*@brief 事件消息泵初始化
+*@brief 事件响应，按监控ID直接索引响应函数
 ***************************************************************/
-void vEventInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size)
+BOOL xEventHandle(sEventMsg* psEventMsg)
 {
-    pEventTCB = p_tcb;
-    (void)eTaskCreate(p_tcb, vEventPollTask, NULL, prio, p_stk_base, stk_size);
+    sEventHandler* psHandler = NULL;
+
+    if(psEventMsg == NULL || psEventMsg->usDataId >= MONITOR_DATA_MAX_NUM)
+    {
+        return FALSE;
+    }
+    psHandler = &EventHandlerTable[psEventMsg->usDataId];
+    if(psHandler->pxHandler == NULL)
+    {
+        return FALSE;
+    }
+    psHandler->pxHandler(psHandler->pvArg);
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 事件总线初始化
+***************************************************************/
+void vEventInit(void)
+{
+    OS_ERR err = OS_ERR_NONE;
+    OSMemCreate(&EventMsgPool, "EventMsgPool", (void*)EventMsgPoolBuf, EVENT_MSG_POOL_NUM, sizeof(sEventBatch), &err);
 }
 
+/**************************************************************
+*@brief 创建任务，不带任务消息队列
+***************************************************************/
 OS_ERR eTaskCreate(OS_TCB *p_tcb, OS_TASK_PTR p_task, void *p_arg, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size)
 {
     OS_ERR err = OS_ERR_NONE;
-    
+
     OSTaskCreate( p_tcb, NULL, p_task, p_arg, prio, p_stk_base, stk_size/10u, stk_size, 0u, 0u, 0u,
                   (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR), &err);
     return err;
 }
 
-OS_TCB* psGetEventTCB(void)
+/**************************************************************
+*@brief 创建事件订阅任务，任务消息队列深度按在途批量消息数配置，
+*       订阅任务数须与EVENT_SUB_TASK_NUM一致
+***************************************************************/
+OS_ERR eEventTaskCreate(OS_TCB *p_tcb, OS_TASK_PTR p_task, void *p_arg, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size)
 {
-    return pEventTCB;
-}
-
+    OS_ERR err = OS_ERR_NONE;
 
+    OSTaskCreate( p_tcb, NULL, p_task, p_arg, prio, p_stk_base, stk_size/10u, stk_size, EVENT_TASK_Q_SIZE, 0u, 0u,
+                  (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR), &err);
+    return err;
+}
@@ -2,31 +2,126 @@
 #define _MD_EVENT_H_
 
 #include "includes.h"
+#include "lpc_types.h"
 
-//事件绑定  
+//设备实例事件绑定(订阅该消息量下所有点位)
 #define CONNECT(psSem, psTCB) \
-       vEventRegist((OS_SEM*)psSem, (OS_TCB*)psTCB);
+       (void)psEventSubscribe(TOPIC_ALL, (OS_SEM*)psSem, (OS_TCB*)psTCB, EVENT_SUB_PRIO_DEFAULT);
 
+//设备类别事件订阅
+#define SUBSCRIBE(ucTopic, psTCB, ucPrio) \
+       (void)psEventSubscribe(ucTopic, NULL, (OS_TCB*)psTCB, ucPrio);
 
-typedef struct sEvent /*事件类型*/
+//单个点位事件订阅(变量须已注册监控)
+#define SUBSCRIBE_POINT(pvVal, psTCB, ucPrio) \
+       (void)xEventSubscriberSetPoint(psEventSubscribe(TOPIC_ALL, NULL, (OS_TCB*)psTCB, ucPrio), (void*)pvVal);
+
+//设备消息量所属主题
+#define EVENT_TOPIC(psSem, ucTopic) \
+       vEventTopicRegist((OS_SEM*)psSem, ucTopic);
+
+#define EVENT_MSG_BATCH_NUM     16     //单条消息最多携带的变化点位数
+#define EVENT_SUB_TASK_NUM      1      //队列投递的订阅任务数(系统事件任务)
+#define EVENT_SUB_BATCH_NUM     8      //每个订阅任务可积压的批量消息数
+#define EVENT_MSG_POOL_NUM      (EVENT_SUB_TASK_NUM * EVENT_SUB_BATCH_NUM)  //消息内存池块数
+#define EVENT_TASK_Q_SIZE       EVENT_MSG_POOL_NUM   //订阅任务队列深度，不小于在途消息数，队列不会先于内存池耗尽
+#define EVENT_SUB_MAX_NUM       20     //最大订阅者数量
+#define EVENT_TOPIC_MAX_NUM     50     //最大可绑定主题的消息量数量
+
+#define EVENT_SUB_PRIO_DEFAULT  10     //订阅者默认优先级，数值越小越先投递
+#define EVENT_ID_ANY            0xFFFF //不按点位过滤
+
+typedef enum   /*事件主题(设备类别)*/
 {
-    OS_SEM*         psSem;     
-    OS_TCB*         psTCB; 
-    struct sEvent*  pNext;
-    struct sEvent*  pLast;    
-}sEvent;
+    TOPIC_ALL              = 0,    //全部
+    TOPIC_SYSTEM           = 1,    //系统
+    TOPIC_BMS              = 2,    //BMS
+    TOPIC_MODULAR_ROOF     = 3,    //屋顶机
+    TOPIC_EX_AIR_FAN       = 4,    //排风机
+    TOPIC_CO2_SENSOR       = 5,    //CO2传感器
+    TOPIC_TEMP_HUMI_SENSOR = 6,    //温湿度传感器
+    TOPIC_METER            = 7,    //电表
+    TOPIC_MAX
+}eEventTopic;
+
+typedef void (*pxEventHandler)(void* pvArg);  //事件响应函数
 
 typedef struct  /*消息结构封装*/
 {
-    OS_SEM*        psSem; 
-    void*          pvArg;     
+    OS_SEM*        psSem;       //设备实例
+    void*          pvArg;       //变化的变量
+    uint16_t       usDataId;    //监控ID
+    uint8_t        ucTopic;     //主题
 }sEventMsg;
 
+typedef void (*pxEventCallback)(sEventMsg* psMsg, void* pvArg);  //发布者上下文中直接调用
+
+typedef struct sEventSubscriber /*订阅者*/
+{
+    uint8_t          ucTopic;        //订阅主题，TOPIC_ALL不过滤
+    uint8_t          ucPrio;         //投递优先级
+    OS_SEM*          psSem;          //设备实例过滤，NULL不过滤
+    uint16_t         usDataId;       //点位过滤，EVENT_ID_ANY不过滤
+
+    OS_TCB*          psTCB;          //队列投递的目标任务
+    pxEventCallback  pxCallback;     //直接投递的回调函数
+    void*            pvArg;          //回调函数参数
+
+    uint32_t         ulDeliverCount; //投递点位数
+    uint32_t         ulDropCount;    //丢弃点位数
+    uint16_t         usLatencyLast;  //最近一次投递延时(tick)
+    uint16_t         usLatencyMax;   //最大投递延时(tick)
+
+    struct sEventSubscriber* pNext;
+}sEventSubscriber;
+
+typedef struct  /*批量消息，由内存池分配，最后一个持有者释放*/
+{
+    uint8_t            ucCount;       //变化点位数
+    uint8_t            ucRefCount;    //引用计数
+    OS_TICK            ulPostTick;    //投递时刻
+    sEventSubscriber*  psSubscriber;  //接收的订阅者
+    sEventMsg          sMsgList[EVENT_MSG_BATCH_NUM];
+}sEventBatch;
+
+typedef struct  /*消息统计*/
+{
+    uint32_t       ulPublishCount; //发布点位数
+    uint32_t       ulAllocFail;    //内存池耗尽次数
+    uint32_t       ulQueueFull;    //订阅任务队列空间不足次数
+    uint32_t       ulPostFail;     //消息投递失败次数
+    uint16_t       usPoolUsed;     //内存池当前使用块数
+    uint16_t       usPoolUsedMax;  //内存池使用峰值
+    uint16_t       usQueueMax;     //任务消息队列峰值
+}sEventStats;
+
+typedef struct  /*事件响应绑定*/
+{
+    pxEventHandler pxHandler;   //响应函数
+    void*          pvArg;       //响应函数参数
+}sEventHandler;
+
+void    vEventTopicRegist(OS_SEM* psSem, uint8_t ucTopic);
+uint8_t ucEventGetTopic(OS_SEM* psSem);
+
+sEventSubscriber* psEventSubscribe(uint8_t ucTopic, OS_SEM* psSem, OS_TCB* psTCB, uint8_t ucPrio);
+sEventSubscriber* psEventSubscribeCallback(uint8_t ucTopic, OS_SEM* psSem, pxEventCallback pxCallback, void* pvArg, uint8_t ucPrio);
+
+BOOL xEventSubscriberSetPoint(sEventSubscriber* psSub, void* pvVal);
+
+BOOL xEventPublish(sEventMsg* psMsgList, uint8_t ucCount);
+
+BOOL xEventHandlerRegist(void* pvVal, pxEventHandler pxHandler, void* pvArg);
+BOOL xEventHandle(sEventMsg* psEventMsg);
+
+sEventBatch* psEventBatchAlloc(void);
+void vEventBatchRelease(sEventBatch* psBatch);
+BOOL xEventBatchPost(OS_TCB* psTCB, sEventBatch* psBatch);
+const sEventStats* psEventGetStats(void);
 
-void vEventRegist(OS_SEM* psSem, OS_TCB* psTCB);
-void vEventInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size);
+void vEventInit(void);
 
 OS_ERR eTaskCreate(OS_TCB *p_tcb, OS_TASK_PTR p_task, void *p_arg, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size);
-OS_TCB* psGetEventTCB(void);
+OS_ERR eEventTaskCreate(OS_TCB *p_tcb, OS_TASK_PTR p_task, void *p_arg, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,315 @@
+#include "md_filter.h"
+
+#define DEBOUNCE_STATE_NONE    0xFF    //尚未采样
+
+//4位二进制中1的个数
+static const uint8_t BitCountList[16] = {0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4};
+
+/**************************************************************
+*@brief 中值滤波，窗口不超过FILTER_WIN_MAX_NUM，插入排序
+***************************************************************/
+static uint16_t usFilterMedian(sFilterStage* psStage, uint16_t usIn)
+{
+    uint8_t  i, j;
+    uint16_t usTmp;
+    uint16_t usSort[FILTER_WIN_MAX_NUM];
+
+    psStage->usWin[psStage->ucIndex] = usIn;
+    psStage->ucIndex = (psStage->ucIndex + 1) % psStage->usParam;
+    if(psStage->ucCount < psStage->usParam)
+    {
+        psStage->ucCount++;
+    }
+    for(i = 0; i < psStage->ucCount; i++)
+    {
+        usTmp = psStage->usWin[i];
+        for(j = i; (j > 0) && (usSort[j-1] > usTmp); j--)
+        {
+            usSort[j] = usSort[j-1];
+        }
+        usSort[j] = usTmp;
+    }
+    return usSort[psStage->ucCount / 2];
+}
+
+/**************************************************************
+*@brief 截尾均值滤波，窗口和增量维护，去除最大、最小值取平均
+***************************************************************/
+static uint16_t usFilterTrimMean(sFilterStage* psStage, uint16_t usIn)
+{
+    uint8_t  i;
+    uint16_t usMax, usMin;
+
+    if(psStage->ucCount < psStage->usParam)
+    {
+        psStage->ucCount++;
+    }
+    else
+    {
+        psStage->lState -= psStage->usWin[psStage->ucIndex];   //移出最旧样本
+    }
+    psStage->usWin[psStage->ucIndex] = usIn;
+    psStage->ucIndex = (psStage->ucIndex + 1) % psStage->usParam;
+    psStage->lState += usIn;
+
+    if(psStage->ucCount < 3)
+    {
+        return (uint16_t)(psStage->lState / psStage->ucCount);
+    }
+    usMax = psStage->usWin[0];
+    usMin = psStage->usWin[0];
+    for(i = 1; i < psStage->ucCount; i++)
+    {
+        if(usMax < psStage->usWin[i])
+        {
+            usMax = psStage->usWin[i];
+        }
+        if(usMin > psStage->usWin[i])
+        {
+            usMin = psStage->usWin[i];
+        }
+    }
+    return (uint16_t)((psStage->lState - usMax - usMin) / (psStage->ucCount - 2));
+}
+
+/**************************************************************
+*@brief 滑动平均滤波，环形窗口和增量维护，每个样本输出一次
+***************************************************************/
+static uint16_t usFilterMean(sFilterStage* psStage, uint16_t usIn)
+{
+    if(psStage->ucCount < psStage->usParam)
+    {
+        psStage->ucCount++;
+    }
+    else
+    {
+        psStage->lState -= psStage->usWin[psStage->ucIndex];   //移出最旧样本
+    }
+    psStage->usWin[psStage->ucIndex] = usIn;
+    psStage->ucIndex = (psStage->ucIndex + 1) % psStage->usParam;
+    psStage->lState += usIn;
+
+    return (uint16_t)((psStage->lState + (psStage->ucCount >> 1)) / psStage->ucCount);
+}
+
+/**************************************************************
+*@brief 一阶低通滤波，累加值Q8定点，避免小偏差被截断
+***************************************************************/
+static uint16_t usFilterIIR(sFilterStage* psStage, uint16_t usIn)
+{
+    if(psStage->ucCount == 0)
+    {
+        psStage->lState  = (int32_t)usIn << 8;
+        psStage->ucCount = 1;
+    }
+    else
+    {
+        psStage->lState += (((int32_t)usIn << 8) - psStage->lState) >> psStage->usParam;
+    }
+    return (uint16_t)((psStage->lState + 0x80) >> 8);
+}
+
+/**************************************************************
+*@brief 变化率限制，每次输出变化不超过参数值
+***************************************************************/
+static uint16_t usFilterRateLimit(sFilterStage* psStage, uint16_t usIn)
+{
+    int32_t lDelta;
+
+    if(psStage->ucCount == 0)
+    {
+        psStage->lState  = usIn;
+        psStage->ucCount = 1;
+    }
+    else
+    {
+        lDelta = (int32_t)usIn - psStage->lState;
+        if(lDelta > (int32_t)psStage->usParam)
+        {
+            lDelta = psStage->usParam;
+        }
+        else if(lDelta < -(int32_t)psStage->usParam)
+        {
+            lDelta = -(int32_t)psStage->usParam;
+        }
+        psStage->lState += lDelta;
+    }
+    return (uint16_t)psStage->lState;
+}
+
+/**************************************************************
+*@brief 滤波链初始化，所有级不滤波
+***************************************************************/
+void vFilterChainInit(sFilterChain* psChain)
+{
+    memset(psChain, 0, sizeof(sFilterChain));
+}
+
+/**************************************************************
+*@brief 设置滤波级，参数不合法返回FALSE
+***************************************************************/
+BOOL xFilterStageSet(sFilterChain* psChain, uint8_t ucStage, eFilterType eType, uint16_t usParam)
+{
+    sFilterStage* psStage = NULL;
+
+    if( (psChain == NULL) || (ucStage >= FILTER_STAGE_MAX_NUM) )
+    {
+        return FALSE;
+    }
+    switch(eType)
+    {
+        case FILTER_NONE:
+            break;
+        case FILTER_RATE_LIMIT:
+            if(usParam < 1)      //步长为0时输出永远停在首个样本
+            {
+                return FALSE;
+            }
+            break;
+        case FILTER_MEDIAN:
+            if( (usParam < 3) || (usParam >= FILTER_WIN_MAX_NUM) || ((usParam & 0x01) == 0) )
+            {
+                return FALSE;
+            }
+            break;
+        case FILTER_TRIM_MEAN:
+            if( (usParam < 3) || (usParam > FILTER_WIN_MAX_NUM) )
+            {
+                return FALSE;
+            }
+            break;
+        case FILTER_MEAN:
+            if( (usParam < 1) || (usParam > FILTER_WIN_MAX_NUM) )
+            {
+                return FALSE;
+            }
+            break;
+        case FILTER_IIR:
+            if( (usParam < 1) || (usParam > 8) )
+            {
+                return FALSE;
+            }
+            break;
+        default:
+            return FALSE;
+    }
+    psStage = &psChain->sStage[ucStage];
+    memset(psStage, 0, sizeof(sFilterStage));
+    psStage->ucType  = eType;
+    psStage->usParam = usParam;
+
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 样本依次经过滤波链各级
+***************************************************************/
+uint16_t usFilterChainRun(sFilterChain* psChain, uint16_t usIn)
+{
+    uint8_t  i;
+    uint16_t usOut = usIn;
+
+    for(i = 0; i < FILTER_STAGE_MAX_NUM; i++)
+    {
+        switch(psChain->sStage[i].ucType)
+        {
+            case FILTER_MEDIAN:
+                usOut = usFilterMedian(&psChain->sStage[i], usOut);
+                break;
+            case FILTER_TRIM_MEAN:
+                usOut = usFilterTrimMean(&psChain->sStage[i], usOut);
+                break;
+            case FILTER_IIR:
+                usOut = usFilterIIR(&psChain->sStage[i], usOut);
+                break;
+            case FILTER_RATE_LIMIT:
+                usOut = usFilterRateLimit(&psChain->sStage[i], usOut);
+                break;
+            case FILTER_MEAN:
+                usOut = usFilterMean(&psChain->sStage[i], usOut);
+                break;
+            default:break;
+        }
+    }
+    return usOut;
+}
+
+/**************************************************************
+*@brief 设置开关量消抖，参数不合法返回FALSE
+***************************************************************/
+BOOL xDebounceSet(sDebounce* psDebounce, eDebounceType eType, uint8_t ucParam)
+{
+    if(psDebounce == NULL)
+    {
+        return FALSE;
+    }
+    switch(eType)
+    {
+        case DEBOUNCE_NONE:
+            break;
+        case DEBOUNCE_COUNT:
+            if(ucParam < 1)
+            {
+                return FALSE;
+            }
+            break;
+        case DEBOUNCE_MAJORITY:
+            if( (ucParam < 3) || (ucParam >= DEBOUNCE_WIN_MAX_NUM) || ((ucParam & 0x01) == 0) )
+            {
+                return FALSE;
+            }
+            break;
+        default:
+            return FALSE;
+    }
+    psDebounce->ucType  = eType;
+    psDebounce->ucParam = ucParam;
+    psDebounce->ucCount = 0;
+    psDebounce->ucHist  = 0;
+    psDebounce->ucState = DEBOUNCE_STATE_NONE;
+
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 开关量消抖，首次采样直接作为初始状态
+***************************************************************/
+uint8_t ucDebounceRun(sDebounce* psDebounce, uint8_t ucIn)
+{
+    uint8_t ucOnes;
+
+    ucIn = (ucIn != 0);
+    if(psDebounce->ucState == DEBOUNCE_STATE_NONE)
+    {
+        psDebounce->ucState = ucIn;
+        psDebounce->ucHist  = ucIn ? 0xFF : 0x00;
+        return ucIn;
+    }
+    switch(psDebounce->ucType)
+    {
+        case DEBOUNCE_COUNT:
+            if(ucIn != psDebounce->ucState)
+            {
+                psDebounce->ucCount++;
+                if(psDebounce->ucCount >= psDebounce->ucParam)
+                {
+                    psDebounce->ucState = ucIn;
+                    psDebounce->ucCount = 0;
+                }
+            }
+            else
+            {
+                psDebounce->ucCount = 0;
+            }
+            break;
+        case DEBOUNCE_MAJORITY:
+            psDebounce->ucHist = (uint8_t)((psDebounce->ucHist << 1) | ucIn) & ((1 << psDebounce->ucParam) - 1);
+            ucOnes = BitCountList[psDebounce->ucHist & 0x0F] + BitCountList[psDebounce->ucHist >> 4];
+            psDebounce->ucState = (ucOnes * 2 > psDebounce->ucParam);
+            break;
+        default:
+            psDebounce->ucState = ucIn;
+            break;
+    }
+    return psDebounce->ucState;
+}
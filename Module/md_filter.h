@@ -0,0 +1,59 @@
+#ifndef _MD_FILTER_H_
+#define _MD_FILTER_H_
+
+#include "includes.h"
+#include "lpc_types.h"
+
+#define FILTER_STAGE_MAX_NUM    3       //每条滤波链最大级数
+#define FILTER_WIN_MAX_NUM      8       //中值/截尾均值最大窗口
+#define DEBOUNCE_WIN_MAX_NUM    8       //多数表决最大窗口
+
+typedef enum   /*模拟量滤波类型*/
+{
+    FILTER_NONE       = 0,    //不滤波
+    FILTER_MEDIAN     = 1,    //中值，参数为窗口(奇数，3~7)
+    FILTER_TRIM_MEAN  = 2,    //去最大最小值平均，参数为窗口(3~8)
+    FILTER_IIR        = 3,    //一阶低通 y += (x-y)/2^k，参数为k(1~8)
+    FILTER_RATE_LIMIT = 4,    //变化率限制，参数为每次最大变化量
+    FILTER_MEAN       = 5,    //滑动平均，每个样本更新一次，参数为窗口(1~8)
+}eFilterType;
+
+typedef enum   /*开关量消抖类型*/
+{
+    DEBOUNCE_NONE     = 0,    //不消抖
+    DEBOUNCE_COUNT    = 1,    //连续N次一致才翻转，参数为N(1~255)
+    DEBOUNCE_MAJORITY = 2,    //最近N次多数表决，参数为N(奇数，3~7)
+}eDebounceType;
+
+typedef struct  /*滤波级*/
+{
+    uint8_t   ucType;                       //滤波类型
+    uint8_t   ucCount;                      //窗口内有效样本数
+    uint8_t   ucIndex;                      //窗口写入位置
+    uint16_t  usParam;                      //滤波参数
+    int32_t   lState;                       //IIR累加值(Q8)/限幅上次输出/窗口和
+    uint16_t  usWin[FILTER_WIN_MAX_NUM];    //样本窗口
+}sFilterStage;
+
+typedef struct  /*滤波链*/
+{
+    sFilterStage  sStage[FILTER_STAGE_MAX_NUM];
+}sFilterChain;
+
+typedef struct  /*开关量消抖*/
+{
+    uint8_t   ucType;     //消抖类型
+    uint8_t   ucParam;    //消抖参数
+    uint8_t   ucCount;    //连续不一致次数
+    uint8_t   ucHist;     //最近采样位图
+    uint8_t   ucState;    //消抖后状态
+}sDebounce;
+
+void     vFilterChainInit(sFilterChain* psChain);
+BOOL     xFilterStageSet(sFilterChain* psChain, uint8_t ucStage, eFilterType eType, uint16_t usParam);
+uint16_t usFilterChainRun(sFilterChain* psChain, uint16_t usIn);
+
+BOOL     xDebounceSet(sDebounce* psDebounce, eDebounceType eType, uint8_t ucParam);
+uint8_t  ucDebounceRun(sDebounce* psDebounce, uint8_t ucIn);
+
+#endif
@@ -1,22 +1,47 @@
 #include "lpc_pinsel.h"
 #include "lpc_gpio.h"
 #include "lpc_adc.h"
+#include "lpc_timer.h"
 #include "includes.h"
 #include "md_input.h"
 #include "md_event.h"
+#include "md_eeprom.h"
 #include "my_rtt_printf.h"
 
-#define AI_NUM 8
 #define DI_NUM 15
 
+#define INPUT_MUX_CHANNEL_NUM    8                   //4051通道数
+#define INPUT_SCAN_RATE_HZ       100                 //8通道完整扫描频率
+#define INPUT_SLOT_US            (1000000 / INPUT_SCAN_RATE_HZ / INPUT_MUX_CHANNEL_NUM)  //每通道时隙
+#define INPUT_MUX_SETTLE_US      500                 //4051切换后稳定时间，须小于INPUT_SLOT_US
+#define INPUT_AI_SAMPLE_NUM      7                   //每通道采样次数
+#define INPUT_SCAN_RING_NUM      4                   //扫描结果环形缓冲深度
+#define INPUT_DI_EVENT_NUM       32                  //DI边沿事件环形缓冲深度
+
+#define INPUT_AI_SPIKE_WIN       3                   //AI默认滤波：中值去尖峰窗口
+#define INPUT_AI_IIR_SHIFT       2                   //AI默认滤波：一阶低通 约4个扫描周期(40ms)
+#define INPUT_DI_DEBOUNCE_CNT    3                   //DI默认消抖：连续3次扫描(30ms)一致
+
+#if INPUT_DI_PIN_EN > 0
+#define DI_PIN_MODE(ucCh)        (DigitalInputData[(ucCh)-1].xPinMode)   //通道是否直连管脚
+#else
+#define DI_PIN_MODE(ucCh)        FALSE
+#endif
+
+#define INPUT_CALIB_SEG_SHIFT    5                   //校准表每段2^5个采样值
+#define INPUT_CALIB_NODE_NUM     ((4096 >> INPUT_CALIB_SEG_SHIFT) + 1)   //校准表节点数
+#define INPUT_CALIB_POINT_NUM    81                  //出厂校准点数
+#define INPUT_CALIB_DEFAULT      ((uint32_t)INPUT_CALIB_GAIN_ONE << 16)  //通道默认校准参数
+#define INPUT_SCALE_SHIFT        24                  //量程换算增益小数位
+
 //采样电流误差,单位uA*10，每个20个单位的采样偏差，400、420、440、、、
-const int8_t DeltaUAList[81] = { 32,32,32,33,32,32,32,31,31,31,32,32,31,31,31,31,32,31,
+const int8_t DeltaUAList[INPUT_CALIB_POINT_NUM] = { 32,32,32,33,32,32,32,31,31,31,32,32,31,31,31,31,32,31,
 								 31,30,30,29,31,31,30,30,29,29,28,29,29,29,28,28,27,29,
 								 29,28,28,27,26,27,27,26,25,23,21,19,18,16,14,13,12,11,
 								 13,12,11,11,11,10,11,11,10,9, 9, 8, 10, 8, 8, 7, 6, 6,
 								 6, 6, 5, 3, 1, 0,-15,-42,-60};
 
-const int16_t RealUAList[81] = { 432,452,472,493,512,532,552,571,591,
+const int16_t RealUAList[INPUT_CALIB_POINT_NUM] = { 432,452,472,493,512,532,552,571,591,
 								 611,632,652,671,691,711,731,752,771,
 								 791,810,830,849,871,891,910,930,949,
 								 969,988,1009,1029,1049,1068,1088,1107,1129,
@@ -26,6 +51,13 @@ const int16_t RealUAList[81] = { 432,452,472,493,512,532,552,571,591,
 								 1669,1689,1708,1730,1748,1768,1787,1806,1826,
 								 1846,1866,1885,1903,1921,1940,1945,1938,1940};
 
+//AI通道对应的4051通道，AI的定义与原理图不是一一对应，需参照原理图
+const uint8_t AIMuxIndexList[AI_NUM] = {2, 1, 0, 3, 7, 5, 4, 6};
+
+//4051输出的DI接口位对应的DI通道，0为未使用，与ucDigitalInputGetRawVal一致
+const uint8_t DIFromLogic1List[8] = {12, 11, 10, 13, 8, 15, 9, 14};
+const uint8_t DIFromLogic2List[8] = {5,  4,  3,  6,  1, 7,  2, 0};
+
 /***************************全局变量*************************************/
 uint8_t ControllerID = 1;       //控制器ID 通过拨码设置                           
 uint8_t	SaInput;                //拨码值
@@ -33,12 +65,110 @@ uint8_t	SaInput;                //拨码值
 uint8_t LogicInput1;            //DI接口临时存储
 uint8_t	LogicInput2;            
 								
-int16_t AnalogInputuA[8];       //AI接口临时存储
+int16_t AnalogInputuA[8];       //AI接口临时存储(未校准)
+
+int32_t AnalogInputCalibList[INPUT_CALIB_NODE_NUM];   //采样值等间隔校准表，单位10uA/16
+
+OS_TCB*  psInputTaskTCB = NULL;
+
+uint8_t  InputMuxChannel   = INPUT_MUX_CHANNEL_NUM - 1;      //当前4051通道(0~7)
+uint8_t  InputSampleCount  = INPUT_AI_SAMPLE_NUM;            //当前通道已采样次数
+uint16_t InputSampleBuf[INPUT_AI_SAMPLE_NUM];                //当前通道采样值
+sInputScan InputScanWork;                                    //正在进行的扫描
+
+sInputScan InputScanRing[INPUT_SCAN_RING_NUM];               //完成的扫描，中断写入，任务读取
+uint8_t    InputScanHead = 0;
+uint8_t    InputScanTail = 0;
+
+sInputAcqStats InputAcqStats;
+
+uint32_t InputSlotCount    = 0;                              //通道时隙计数，用于事件时间戳
+uint8_t  InputDIMux1       = 0;                              //上次扫描的DI接口1
+uint8_t  InputDIMux2       = 0;                              //上次扫描的DI接口2
+uint8_t  InputDIMuxValid   = 0;                              //已扫描过的4051通道
+
+sDIEvent DIEventRing[INPUT_DI_EVENT_NUM];                    //DI边沿事件，中断写入，任务读取
+uint8_t  DIEventHead = 0;
+uint8_t  DIEventTail = 0;
+#if INPUT_DI_PIN_EN > 0
+uint16_t DigitalInputPinRaw = 0;                             //直连管脚DI电平，由事件维护
+#endif
                                 
 sAIData AnalogInputData[AI_NUM];   //AI接口数据                            
 sDIData DigitalInputData[DI_NUM];  //DI接口数据
 	
 
+/******************************************************************
+*@brief  生成校准表，出厂校准点之间线性插值，节点为等间隔采样值
+******************************************************************/
+void vAnalogInputCalibInit(void)
+{
+	uint16_t n;
+	uint8_t  k = 0;
+	uint8_t  ucLast = 0;
+	int32_t  lMeasQ4;
+	int32_t  lReal;
+	
+	for(n = 0; n < INPUT_CALIB_NODE_NUM; n++)
+	{
+		lMeasQ4 = (int32_t)(n << INPUT_CALIB_SEG_SHIFT) * 275 / 32;   //采样值对应电流: 330000/4096/150*16 = 275/32
+		
+		//查找所在校准段，忽略末端饱和后不再递增的校准点
+		while( (k + 1 < INPUT_CALIB_POINT_NUM) && (lMeasQ4 >= RealUAList[k+1] * 16) )
+		{
+			k++;
+			if(RealUAList[k] > RealUAList[ucLast])
+			{
+				ucLast = k;
+			}
+		}
+		lReal = RealUAList[ucLast] - DeltaUAList[ucLast];
+		if( (lMeasQ4 < RealUAList[0] * 16) || (ucLast + 1 >= INPUT_CALIB_POINT_NUM) || (RealUAList[ucLast+1] <= RealUAList[ucLast]) )
+		{
+			//超出校准范围，沿用最近校准点的偏差
+			AnalogInputCalibList[n] = lMeasQ4 - DeltaUAList[(lMeasQ4 < RealUAList[0] * 16) ? 0 : ucLast] * 16;
+		}
+		else
+		{
+			AnalogInputCalibList[n] = lReal * 16 + (lMeasQ4 - RealUAList[ucLast] * 16) *
+			                          ((RealUAList[ucLast+1] - DeltaUAList[ucLast+1]) - lReal) / (RealUAList[ucLast+1] - RealUAList[ucLast]);
+		}
+	}
+}
+
+/******************************************************************
+*@brief  采样值转换为校准后的电流，查表插值
+*@return 电流值 单位10uA/16
+******************************************************************/
+int32_t lAnalogInputCalibrate(uint16_t usSample)
+{
+	const int32_t* plNode = &AnalogInputCalibList[usSample >> INPUT_CALIB_SEG_SHIFT];
+	
+	return plNode[0] + (((plNode[1] - plNode[0]) * (int32_t)(usSample & ((1 << INPUT_CALIB_SEG_SHIFT) - 1))) >> INPUT_CALIB_SEG_SHIFT);
+}
+
+/******************************************************************
+*@brief  计算通道量程换算系数，合并通道校准与4~20mA量程
+******************************************************************/
+void vAnalogInputCalcScale(sAIData* psAI)
+{
+	int64_t  llRange = (int64_t)psAI->lMax - psAI->lMin;
+	uint32_t ulCalib = psAI->ulCalib;
+	int32_t  lGain   = (int32_t)(ulCalib >> 16);
+	int32_t  lOffset = (int16_t)(ulCalib & 0xFFFF);
+	
+	if( (lGain < INPUT_CALIB_GAIN_MIN) || (lGain > INPUT_CALIB_GAIN_MAX) )  //参数无效使用默认值
+	{
+		lGain   = INPUT_CALIB_GAIN_ONE;
+		lOffset = 0;
+	}
+	//实际值 = ((lCurQ4/16)*lGain/4096 + lOffset - 400) * (lMax - lMin) / (2000 - 400) + lMin
+	psAI->lGain       = (int32_t)((llRange * lGain << (INPUT_SCALE_SHIFT - 16)) / (2000 - 400));
+	psAI->lOffset     = (int32_t)((lOffset - 400) * llRange / (2000 - 400) + psAI->lMin);
+	psAI->lThreshold  = (400 - lOffset) * 16 * INPUT_CALIB_GAIN_ONE / lGain;
+	psAI->ulCalibUsed = ulCalib;
+}
+
 /**************************************************************
 *@brief DI接口变量注册
 ***************************************************************/
@@ -50,6 +180,81 @@ void vDigitalInputRegist(uint8_t ucChannel, void* pvVal)
 	}
 }
 
+#if INPUT_DI_PIN_EN > 0
+/**************************************************************
+*@brief DI接口使用直连GPIO管脚，双边沿中断采集，不再经4051扫描
+*@param  channel	DI通道  D1~D15
+*@param  ucPort	    端口，0或2
+*@param  ucPin	    管脚
+***************************************************************/
+BOOL xDigitalInputRegistPin(uint8_t ucChannel, uint8_t ucPort, uint8_t ucPin)
+{
+	sDIData* psDI = NULL;
+	CPU_SR_ALLOC();
+	
+	if( (ucChannel == 0) || (ucChannel > DI_NUM) || ((ucPort != 0) && (ucPort != 2)) || (ucPin > 31) )
+	{
+		return FALSE;
+	}
+	psDI = &DigitalInputData[ucChannel-1];
+	
+	(void)PINSEL_ConfigPin(ucPort, ucPin, 0);
+	GPIO_SetDir(ucPort, 1 << ucPin, 0);
+	
+	CPU_CRITICAL_ENTER();
+	psDI->ucPort   = ucPort;
+	psDI->ucPin    = ucPin;
+	psDI->xPinMode = TRUE;
+	if((GPIO_ReadValue(ucPort) >> ucPin) & 0x01)
+	{
+		DigitalInputPinRaw |= 1 << (ucChannel-1);
+	}
+	else
+	{
+		DigitalInputPinRaw &= ~(1 << (ucChannel-1));
+	}
+	GPIO_ClearInt(ucPort, 1 << ucPin);
+	if(ucPort == 0)                         //GPIO_IntCmd直接覆盖使能寄存器，此处按位置位保留已注册管脚
+	{
+		LPC_GPIOINT->IO0IntEnR |= 1 << ucPin;   //上升沿
+		LPC_GPIOINT->IO0IntEnF |= 1 << ucPin;   //下降沿
+	}
+	else
+	{
+		LPC_GPIOINT->IO2IntEnR |= 1 << ucPin;
+		LPC_GPIOINT->IO2IntEnF |= 1 << ucPin;
+	}
+	CPU_CRITICAL_EXIT();
+	
+	BSP_IntEn(BSP_INT_ID_GPIO);
+	return TRUE;
+}
+#endif
+
+/**************************************************************
+*@brief DI接口边沿计数
+***************************************************************/
+uint16_t usDigitalInputGetEdgeCount(uint8_t ucChannel)
+{
+	if( (ucChannel > 0) && (ucChannel <= DI_NUM) )
+	{
+		return DigitalInputData[ucChannel-1].usEdgeCount;
+	}
+	return 0;
+}
+
+/**************************************************************
+*@brief DI接口最近一次边沿时刻 us
+***************************************************************/
+uint32_t ulDigitalInputGetEdgeTime(uint8_t ucChannel)
+{
+	if( (ucChannel > 0) && (ucChannel <= DI_NUM) )
+	{
+		return DigitalInputData[ucChannel-1].ulEdgeTimeUs;
+	}
+	return 0;
+}
+
 /**************************************************************
 *@brief AI接口变量注册
 ***************************************************************/
@@ -60,55 +265,75 @@ void vAnalogInputRegist(uint8_t ucChannel, int32_t lMin, int32_t lMax, void* pvV
 		AnalogInputData[ucChannel-1].lMax    = lMax;
 		AnalogInputData[ucChannel-1].lMin    = lMin;
 		AnalogInputData[ucChannel-1].pvAIVal = pvVal;
+		vAnalogInputCalcScale(&AnalogInputData[ucChannel-1]);
+	}
+}
+
+/**************************************************************
+*@brief DI接口消抖设置
+*@param  channel	DI通道  D1~D15
+*@param  eType	    消抖类型
+*@param  ucParam	消抖参数，单位为扫描周期
+***************************************************************/
+BOOL xDigitalInputSetDebounce(uint8_t ucChannel, eDebounceType eType, uint8_t ucParam)
+{
+	BOOL xRet = FALSE;
+	CPU_SR_ALLOC();
+	
+	if( (ucChannel > 0) && (ucChannel <= DI_NUM) )
+	{
+		CPU_CRITICAL_ENTER();
+		xRet = xDebounceSet(&DigitalInputData[ucChannel-1].sDebounce, eType, ucParam);
+		CPU_CRITICAL_EXIT();
 	}
+	return xRet;
+}
+
+/**************************************************************
+*@brief AI接口滤波设置，采样值依次经过各级滤波
+*@param  channel	AI通道  AI1~AI8
+*@param  ucStage	滤波级  0~FILTER_STAGE_MAX_NUM-1
+*@param  eType	    滤波类型
+*@param  usParam	滤波参数
+***************************************************************/
+BOOL xAnalogInputSetFilter(uint8_t ucChannel, uint8_t ucStage, eFilterType eType, uint16_t usParam)
+{
+	BOOL xRet = FALSE;
+	CPU_SR_ALLOC();
+	
+	if( (ucChannel > 0) && (ucChannel <= AI_NUM) )
+	{
+		CPU_CRITICAL_ENTER();
+		xRet = xFilterStageSet(&AnalogInputData[ucChannel-1].sFilter, ucStage, eType, usParam);
+		CPU_CRITICAL_EXIT();
+	}
+	return xRet;
 }
 
 /******************************************************************
-*@brief  模拟输入采样函数，采7次，去除最大、最小值取平均	
-*@return 采样电流值
+*@brief  模拟输入采样滤波，第一次采样值不要，去除最大、最小值取平均	
+*@return 采样值
 ******************************************************************/
-uint32_t ulAnalogInputSampling(void)
+uint16_t usAnalogInputFilter(const uint16_t* pusHits)
 {
-	uint8_t i, n;
-	uint32_t hits[7];											//存取7次采样值
-	uint32_t max = 0;
-	uint32_t min = 0;
+	uint8_t  i;
+	uint32_t max = pusHits[1];
+	uint32_t min = pusHits[1];
 	uint32_t sum = 0;
-	OS_ERR err = OS_ERR_NONE;
 	
-	//连续采样7次，并求其中的最大值和最小值
-	for(i = 0; i < 7; i++)
+	for(i = 1; i < INPUT_AI_SAMPLE_NUM; i++)	//第一次采样值不要
 	{
-		ADC_StartCmd(LPC_ADC, ADC_START_NOW);
-		
-		while ( (ADC_ChannelGetStatus(LPC_ADC, ADC_CHANNEL_2, ADC_DATA_DONE)) == 0)
+		if(max < pusHits[i])
 		{
-			//等待数据获取完毕
+			max = pusHits[i];									//求最大值
 		}
-		hits[i] = ADC_ChannelGetData(LPC_ADC, ADC_CHANNEL_2);
-        
-		if(i > 0)
+		if(min > pusHits[i])
 		{
-			if(i == 1)
-			{
-				max = hits[i];
-				min = hits[i];
-			}
-			if(max < hits[i])
-			{
-				max = hits[i];									//求最大值
-			}
-			if(min > hits[i])
-			{
-				min = hits[i];									//求最小值
-			}
+			min = pusHits[i];									//求最小值
 		}
+		sum += pusHits[i];
 	}
-	for(i = 1; i < 7; i++)	//第一次采样值不要
-	{
-		sum += hits[i];
-	}
-	return (sum - max - min) / 4;
+	return (uint16_t)((sum - max - min) / (INPUT_AI_SAMPLE_NUM - 3));
 }
 
 /******************************************************************
@@ -212,126 +437,313 @@ uint8_t ucSaInputConvertToID(void)
 }
 
 /******************************************************************
-*@brief 输入数据接收函数，包括拨码、数字量和模拟量								
+*@brief 采集时基 us，由通道时隙定时器计算
 ******************************************************************/
-void vInputReceive(void)
+uint32_t ulInputGetTimeUs(void)
 {
-	int16_t i, n;
-    
-	uint8_t SaInputTmp=0; 
-	uint8_t LogicInput1Tmp=0; 
-	uint8_t LogicInput2Tmp = 0;
-    
-    uint32_t ucMax, ucMin;
-	uint32_t AnalogInputTmp[8] = {0};
+	return InputSlotCount * INPUT_SLOT_US + LPC_TIM1->TC;
+}
+
+/******************************************************************
+*@brief DI边沿事件入队，中断中调用
+*@return 入队成功返回TRUE
+******************************************************************/
+static BOOL xInputDIEventPush(uint8_t ucChannel, uint8_t ucVal)
+{
+	uint8_t ucNext;
+	CPU_SR_ALLOC();
 	
-	OS_ERR err = OS_ERR_NONE;
+	CPU_CRITICAL_ENTER();     //TIMER1与GPIO中断均可写入
+	ucNext = (DIEventHead + 1) % INPUT_DI_EVENT_NUM;
+	if(ucNext == DIEventTail)
+	{
+		InputAcqStats.ulDIEventDrop++;
+		CPU_CRITICAL_EXIT();
+		return FALSE;
+	}
+	DIEventRing[DIEventHead].ulTimeUs  = ulInputGetTimeUs();
+	DIEventRing[DIEventHead].ucChannel = ucChannel;
+	DIEventRing[DIEventHead].ucVal     = ucVal;
+	DIEventHead = ucNext;
+	CPU_CRITICAL_EXIT();
+	return TRUE;
+}
+
+/******************************************************************
+*@brief 4051通道DI接口与上次扫描比较，产生边沿事件
+*@return 有边沿返回TRUE
+******************************************************************/
+static BOOL xInputDIMuxEdge(uint8_t ucMux, uint8_t ucBit1, uint8_t ucBit2)
+{
+	BOOL    xEdge = FALSE;
+	uint8_t ucMask = 1 << ucMux;
+	uint8_t ucCh = 0;
 	
-	//将模拟输入转换为实际电流值
-	for(i = 0; i < 8; i++)
+	if(InputDIMuxValid & ucMask)
 	{
-		n = 0;
-		vInputSet4051Channel(i+1);   //输入通道设置
-		
-		/* 等待4051设置完毕 */
-		while( (ucInputGet4051Channel() != i) && (n < 10) )
-        {
-			(void)OSTimeDlyHMSM(0, 0, 0, 10, OS_OPT_TIME_HMSM_STRICT, &err);
-			n++;
-		};
-		SaInputTmp     |= (uint8_t)(GPIO_ReadValue(0)>>28 & 1) << i;
-		LogicInput1Tmp |= (uint8_t)(GPIO_ReadValue(0)>>29 & 1) << i;
-		LogicInput2Tmp |= (uint8_t)(GPIO_ReadValue(1)>>19 & 1) << i;
-				
-		AnalogInputTmp[i] = ulAnalogInputSampling();			
-		AnalogInputuA[i]  = sAnalogInputToUA(AnalogInputTmp[i]);
-	}
-//    myprintf("LogicInput1Tmp %d\n", LogicInput1Tmp);
-//    myprintf("LogicInput2Tmp %d\n", LogicInput2Tmp);
-    
-	SaInput = SaInputTmp;
-	LogicInput1 = LogicInput1Tmp;
-	LogicInput2 = LogicInput2Tmp;
+		ucCh = DIFromLogic1List[ucMux];
+		if( (((InputDIMux1 >> ucMux) & 1) != ucBit1) && (ucCh != 0) && (DI_PIN_MODE(ucCh) == FALSE) )
+		{
+			xEdge |= xInputDIEventPush(ucCh, ucBit1);
+		}
+		ucCh = DIFromLogic2List[ucMux];
+		if( (((InputDIMux2 >> ucMux) & 1) != ucBit2) && (ucCh != 0) && (DI_PIN_MODE(ucCh) == FALSE) )
+		{
+			xEdge |= xInputDIEventPush(ucCh, ucBit2);
+		}
+	}
+	InputDIMux1 = (InputDIMux1 & ~ucMask) | (ucBit1 << ucMux);
+	InputDIMux2 = (InputDIMux2 & ~ucMask) | (ucBit2 << ucMux);
+	InputDIMuxValid |= ucMask;
 	
-	for(i = 0; i < AI_NUM; i++)
+	return xEdge;
+}
+
+/******************************************************************
+*@brief 通道时隙定时器中断：MR0切换4051通道，MR1(稳定时间后)锁存DI并启动AD采样
+******************************************************************/
+void TIMER1_IRQHandler(void);
+void TIMER1_IRQHandler(void)
+{
+	uint8_t ucBit1 = 0;
+	uint8_t ucBit2 = 0;
+	OS_ERR  err = OS_ERR_NONE;
+	CPU_SR_ALLOC();
+	
+	CPU_CRITICAL_ENTER();
+	OSIntEnter();
+	CPU_CRITICAL_EXIT();
+	
+	if(TIM_GetIntStatus(LPC_TIM1, TIM_MR0_INT) == SET)
 	{
-		if( AnalogInputData[i].pvAIVal != NULL )
+		TIM_ClearIntPending(LPC_TIM1, TIM_MR0_INT);
+		
+		InputSlotCount++;
+		InputMuxChannel = (InputMuxChannel + 1) % INPUT_MUX_CHANNEL_NUM;
+		vInputSet4051Channel(InputMuxChannel + 1);   //输入通道设置
+	}
+	if(TIM_GetIntStatus(LPC_TIM1, TIM_MR1_INT) == SET)
+	{
+		TIM_ClearIntPending(LPC_TIM1, TIM_MR1_INT);
+		
+		if(InputSampleCount < INPUT_AI_SAMPLE_NUM)   //上一通道采样未完成
 		{
-			*((int32_t*)(AnalogInputData[i].pvAIVal)) = ulAnalogInputGetRealVal(i+1);
-		}	
+			InputAcqStats.ulSlotOverrun++;
+		}
+		else
+		{
+			if(ucInputGet4051Channel() != InputMuxChannel)
+			{
+				InputAcqStats.ulMuxErr++;
+			}
+			ucBit1 = (uint8_t)(GPIO_ReadValue(0)>>29 & 1);
+			ucBit2 = (uint8_t)(GPIO_ReadValue(1)>>19 & 1);
+			
+			InputScanWork.ucSaInput     |= (uint8_t)(GPIO_ReadValue(0)>>28 & 1) << InputMuxChannel;
+			InputScanWork.ucLogicInput1 |= ucBit1 << InputMuxChannel;
+			InputScanWork.ucLogicInput2 |= ucBit2 << InputMuxChannel;
+			
+			InputSampleCount = 0;
+			ADC_StartCmd(LPC_ADC, ADC_START_NOW);
+			
+			if( (xInputDIMuxEdge(InputMuxChannel, ucBit1, ucBit2) == TRUE) && (psInputTaskTCB != NULL) )
+			{
+				(void)OSTaskSemPost(psInputTaskTCB, OS_OPT_POST_NONE, &err);   //DI变化立即通知
+			}
+		}
 	}
+	OSIntExit();
+}
+
+#if INPUT_DI_PIN_EN > 0
+/******************************************************************
+*@brief 直连DI管脚边沿中断
+******************************************************************/
+void GPIO_IRQHandler(void);
+void GPIO_IRQHandler(void)
+{
+	uint8_t  i = 0;
+	BOOL     xEdge = FALSE;
+	sDIData* psDI = NULL;
+	OS_ERR   err = OS_ERR_NONE;
+	CPU_SR_ALLOC();
+	
+	CPU_CRITICAL_ENTER();
+	OSIntEnter();
+	CPU_CRITICAL_EXIT();
+	
 	for(i = 0; i < DI_NUM; i++)
 	{
-		if( DigitalInputData[i].pvDIVal !=NULL )
+		psDI = &DigitalInputData[i];
+		if(psDI->xPinMode == FALSE)
 		{
-			*(uint8_t*)(DigitalInputData[i].pvDIVal) = !ucDigitalInputGetRealVal(i+1); /* DI接通为低电平，断开为高电平 */
+			continue;
 		}
-    }
-    ControllerID = ucSaInputConvertToID();
+		if( (GPIO_GetIntStatus(psDI->ucPort, psDI->ucPin, 0) == ENABLE) || (GPIO_GetIntStatus(psDI->ucPort, psDI->ucPin, 1) == ENABLE) )
+		{
+			GPIO_ClearInt(psDI->ucPort, 1 << psDI->ucPin);
+			xEdge |= xInputDIEventPush(i+1, (uint8_t)((GPIO_ReadValue(psDI->ucPort) >> psDI->ucPin) & 0x01));
+		}
+	}
+	if( (xEdge == TRUE) && (psInputTaskTCB != NULL) )
+	{
+		(void)OSTaskSemPost(psInputTaskTCB, OS_OPT_POST_NONE, &err);
+	}
+	OSIntExit();
 }
+#endif
 
 /******************************************************************
-*@brief  校准电流
-*@param  uA	电流值 单位10uA
-*@return 实际电流值								
+*@brief AD转换完成中断：连续采样INPUT_AI_SAMPLE_NUM次，8通道完成后存入环形缓冲
 ******************************************************************/
-int16_t sAnalogInputCalibrateuA(int16_t us10_uA)
+void ADC_IRQHandler(void);
+void ADC_IRQHandler(void)
 {
-	uint8_t i = 0;
-	int16_t delta = 0;
-	int16_t deltaMin = 0;
-	uint8_t deltaMinIndex = 0;
-
-	if (us10_uA > RealUAList[0])
+	uint8_t ucNext;
+	OS_ERR  err = OS_ERR_NONE;
+	CPU_SR_ALLOC();
+	
+	CPU_CRITICAL_ENTER();
+	OSIntEnter();
+	CPU_CRITICAL_EXIT();
+	
+	InputSampleBuf[InputSampleCount] = ADC_ChannelGetData(LPC_ADC, ADC_CHANNEL_2);  //读数据同时清除完成标志
+	InputSampleCount++;
+	
+	if(InputSampleCount < INPUT_AI_SAMPLE_NUM)
 	{
-		deltaMin = us10_uA - RealUAList[0];
+		ADC_StartCmd(LPC_ADC, ADC_START_NOW);
 	}
 	else
 	{
-		deltaMin = RealUAList[0] - us10_uA;
-	}
-	for (i = 0; i < 81; i++)
-	{
-		if (us10_uA > RealUAList[i])
+		InputScanWork.usAISample[InputMuxChannel] = usAnalogInputFilter(InputSampleBuf);
+		if(InputMuxChannel == INPUT_MUX_CHANNEL_NUM - 1)   //完成一次完整扫描
 		{
-			delta = us10_uA - RealUAList[i];
+			ucNext = (InputScanHead + 1) % INPUT_SCAN_RING_NUM;
+			if(ucNext != InputScanTail)
+			{
+				InputScanRing[InputScanHead] = InputScanWork;
+				InputScanHead = ucNext;
+			}
+			else
+			{
+				InputAcqStats.ulScanOverrun++;
+			}
+			InputAcqStats.ulScanCount++;
+			memset(&InputScanWork, 0, sizeof(InputScanWork));
+			
+			if(psInputTaskTCB != NULL)
+			{
+				(void)OSTaskSemPost(psInputTaskTCB, OS_OPT_POST_NONE, &err);
+			}
 		}
-		else
+	}
+	OSIntExit();
+}
+
+uint8_t ucDigitalInputGetRawVal(uint8_t ucChannel);
+
+/******************************************************************
+*@brief 处理一次完整扫描，包括拨码、数字量和模拟量								
+******************************************************************/
+void vInputProcessScan(const sInputScan* psScan)
+{
+	uint8_t i;
+	
+	uint8_t  ucMux;
+	uint16_t usSample;
+	
+	//模拟输入经滤波后转换为实际电流值
+	for(i = 0; i < AI_NUM; i++)
+	{
+		ucMux    = AIMuxIndexList[i];
+		usSample = usFilterChainRun(&AnalogInputData[i].sFilter, psScan->usAISample[ucMux]);
+		
+		AnalogInputuA[ucMux]       = sAnalogInputToUA(usSample);
+		AnalogInputData[i].lCurQ4  = lAnalogInputCalibrate(usSample);
+		AnalogInputData[i].s10_uA  = (int16_t)(AnalogInputData[i].lCurQ4 >> 4);
+	}
+	SaInput     = psScan->ucSaInput;
+	LogicInput1 = psScan->ucLogicInput1;
+	LogicInput2 = psScan->ucLogicInput2;
+	
+	//数字输入消抖
+	for(i = 0; i < DI_NUM; i++)
+	{
+		DigitalInputData[i].ucVal = ucDebounceRun(&DigitalInputData[i].sDebounce, ucDigitalInputGetRawVal(i+1));
+	}
+}
+
+/******************************************************************
+*@brief 处理DI边沿事件：记录边沿时刻和次数，不消抖的通道立即更新
+******************************************************************/
+void vInputProcessDIEvent(void)
+{
+	sDIEvent* psEvent = NULL;
+	sDIData*  psDI = NULL;
+	
+	while(DIEventTail != DIEventHead)
+	{
+		psEvent = &DIEventRing[DIEventTail];
+		psDI    = &DigitalInputData[psEvent->ucChannel-1];
+		
+		psDI->usEdgeCount++;
+		psDI->ulEdgeTimeUs = psEvent->ulTimeUs;
+#if INPUT_DI_PIN_EN > 0
+		if(psDI->xPinMode == TRUE)
 		{
-			delta = RealUAList[i] - us10_uA;
+			if(psEvent->ucVal)
+			{
+				DigitalInputPinRaw |= 1 << (psEvent->ucChannel-1);
+			}
+			else
+			{
+				DigitalInputPinRaw &= ~(1 << (psEvent->ucChannel-1));
+			}
 		}
-		
-		if(deltaMin > delta)
+#endif
+		if(psDI->sDebounce.ucType == DEBOUNCE_NONE)
 		{
-			deltaMin = delta;
-			deltaMinIndex = i;
+			psDI->ucVal = ucDebounceRun(&psDI->sDebounce, psEvent->ucVal);
 		}
+		DIEventTail = (DIEventTail + 1) % INPUT_DI_EVENT_NUM;
 	}
-	return (us10_uA - DeltaUAList[deltaMinIndex]);
 }
 
 /******************************************************************
-*@brief 将AI输入转换成实际值*10
-*@param  min	量程最小值 = 实际值*10
-*@param  max	量程最大值 = 实际值*10
-*@param  uA	    电流值  单位为10uA
-*@return 实际值	
+*@brief 输入数据更新到注册变量								
 ******************************************************************/
-uint32_t ulInputConvertToReal(int32_t lMin, int32_t lMax, int16_t s10uA)
+void vInputReceive(void)
 {
-	int16_t  s10uA_C = 0;
-	uint32_t ulReal = 0;
-
-	s10uA_C = sAnalogInputCalibrateuA(s10uA);
-	if (s10uA_C >= 400)
+	int16_t i;
+	
+	for(i = 0; i < AI_NUM; i++)
 	{
-		ulReal = (s10uA_C - 400) * (lMax - lMin) / (2000 - 400) + lMin;  //对应4~20mA
+		if(AnalogInputData[i].ulCalib != AnalogInputData[i].ulCalibUsed)   //校准参数已修改
+		{
+			vAnalogInputCalcScale(&AnalogInputData[i]);
+		}
+		if( AnalogInputData[i].pvAIVal != NULL )
+		{
+			*((int32_t*)(AnalogInputData[i].pvAIVal)) = ulAnalogInputGetRealVal(i+1);
+		}	
 	}
-	else
+	for(i = 0; i < DI_NUM; i++)
 	{
-		ulReal = 0;
-	}
-	return ulReal;
+		if( DigitalInputData[i].pvDIVal !=NULL )
+		{
+			*(uint8_t*)(DigitalInputData[i].pvDIVal) = !ucDigitalInputGetRealVal(i+1); /* DI接通为低电平，断开为高电平 */
+		}
+    }
+    ControllerID = ucSaInputConvertToID();
+}
+
+/******************************************************************
+*@brief 采集统计								
+******************************************************************/
+const sInputAcqStats* psInputGetAcqStats(void)
+{
+	return &InputAcqStats;
 }
 
 /******************************************************************
@@ -388,13 +800,15 @@ int16_t sAnalogInputGetuA(uint8_t ucChannel)
 uint32_t ulAnalogInputGetRealVal(uint8_t ucChannel)
 {
 	uint32_t ulRealValue = 0;
+	sAIData* psAI = NULL;
 	
 	if((ucChannel > 0) && (ucChannel <= AI_NUM))
 	{
-        uint32_t lMin = AnalogInputData[ucChannel-1].lMin;
-        uint32_t lMax = AnalogInputData[ucChannel-1].lMax;
-        
-        ulRealValue = ulInputConvertToReal(lMin, lMax, sAnalogInputGetuA(ucChannel));	
+        psAI = &AnalogInputData[ucChannel-1];
+        if(psAI->lCurQ4 >= psAI->lThreshold)    //对应4~20mA
+        {
+            ulRealValue = (uint32_t)((int32_t)(((int64_t)psAI->lCurQ4 * psAI->lGain) >> INPUT_SCALE_SHIFT) + psAI->lOffset);
+        }
 	}
 	return ulRealValue;
 }
@@ -412,7 +826,44 @@ void vAnalogInputSetRange(uint8_t ucChannel, int32_t lMin, int32_t lMax)
 	{
 		AnalogInputData[ucChannel-1].lMax = lMax;
 		AnalogInputData[ucChannel-1].lMin = lMin;
+		vAnalogInputCalcScale(&AnalogInputData[ucChannel-1]);
+	}
+}
+
+/******************************************************************
+*@brief  修改AI通道校准参数，掉电记忆
+*@param  channel	AI通道  AI1~AI8
+*@param  usGain	    增益，4096为1.0
+*@param  sOffset	偏移，单位10uA
+******************************************************************/
+BOOL xAnalogInputSetCalib(uint8_t ucChannel, uint16_t usGain, int16_t sOffset)
+{
+	uint32_t ulCalib = ((uint32_t)usGain << 16) | (uint16_t)sOffset;
+	
+	if( (ucChannel == 0) || (ucChannel > AI_NUM) || (usGain < INPUT_CALIB_GAIN_MIN) || (usGain > INPUT_CALIB_GAIN_MAX) ||
+	    (sOffset < -INPUT_CALIB_OFFSET_MAX) || (sOffset > INPUT_CALIB_OFFSET_MAX) )
+	{
+		return FALSE;
+	}
+	if(AnalogInputData[ucChannel-1].ulCalib != ulCalib)   //未修改不写EEPROM
+	{
+		EEPROM_SET(AnalogInputData[ucChannel-1].ulCalib, ulCalib);
+	}
+	return TRUE;
+}
+
+/******************************************************************
+*@brief  读取AI通道校准参数
+*@param  channel	AI通道  AI1~AI8
+*@return 高16位增益，低16位偏移
+******************************************************************/
+uint32_t ulAnalogInputGetCalib(uint8_t ucChannel)
+{
+	if( (ucChannel == 0) || (ucChannel > AI_NUM) )
+	{
+		return INPUT_CALIB_DEFAULT;
 	}
+	return AnalogInputData[ucChannel-1].ulCalib;
 }
 
 /******************************************************************
@@ -434,13 +885,19 @@ uint8_t ucDigitalInputGetBit(uint8_t ucDACNum, uint8_t ucOffsetBit)
 }
 
 /******************************************************************
-*@brief 提取DI实际值
+*@brief 提取DI采样值(未消抖)
 *@param  channel	DI通道  D1~D15
 ******************************************************************/
-uint8_t ucDigitalInputGetRealVal(uint8_t ucChannel)
+uint8_t ucDigitalInputGetRawVal(uint8_t ucChannel)
 {
 	uint8_t ucBit = 0;
 	
+#if INPUT_DI_PIN_EN > 0
+	if( (ucChannel > 0) && (ucChannel <= DI_NUM) && (DigitalInputData[ucChannel-1].xPinMode == TRUE) )
+	{
+		return (DigitalInputPinRaw >> (ucChannel-1)) & 0x01;
+	}
+#endif
 	if( (ucChannel > 0) && (ucChannel <= DI_NUM) )
 	{
 		switch (ucChannel)
@@ -496,6 +953,19 @@ uint8_t ucDigitalInputGetRealVal(uint8_t ucChannel)
     return ucBit;
 }
 
+/******************************************************************
+*@brief 提取DI实际值(消抖后)
+*@param  channel	DI通道  D1~D15
+******************************************************************/
+uint8_t ucDigitalInputGetRealVal(uint8_t ucChannel)
+{
+	if( (ucChannel > 0) && (ucChannel <= DI_NUM) )
+	{
+		return DigitalInputData[ucChannel-1].ucVal;
+	}
+	return 0;
+}
+
 /******************************************************************
 *@brief 输入量所有管脚初始化								
 ******************************************************************/
@@ -536,6 +1006,41 @@ static void vInputIOInit(void)
 	ADC_ChannelCmd(LPC_ADC, ADC_CHANNEL_2, ENABLE);	
 }
 
+/******************************************************************
+*@brief 采集定时器及AD中断初始化								
+******************************************************************/
+static void vInputAcqInit(void)
+{
+	TIM_TIMERCFG_Type sTimerCfg;
+	TIM_MATCHCFG_Type sMatchCfg;
+	
+	memset(&InputScanWork, 0, sizeof(InputScanWork));
+	
+	ADC_IntConfig(LPC_ADC, ADC_ADGINTEN, DISABLE);
+	ADC_IntConfig(LPC_ADC, ADC_ADINTEN2, ENABLE);
+	BSP_IntEn(BSP_INT_ID_ADC);
+	
+	sTimerCfg.PrescaleOption = TIM_PRESCALE_USVAL;   //1us计数
+	sTimerCfg.PrescaleValue  = 1;
+	TIM_Init(LPC_TIM1, TIM_TIMER_MODE, &sTimerCfg);
+	
+	sMatchCfg.MatchChannel       = 0;                //通道时隙
+	sMatchCfg.IntOnMatch         = ENABLE;
+	sMatchCfg.StopOnMatch        = DISABLE;
+	sMatchCfg.ResetOnMatch       = ENABLE;
+	sMatchCfg.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+	sMatchCfg.MatchValue         = INPUT_SLOT_US;
+	TIM_ConfigMatch(LPC_TIM1, &sMatchCfg);
+	
+	sMatchCfg.MatchChannel       = 1;                //4051稳定后采样
+	sMatchCfg.ResetOnMatch       = DISABLE;
+	sMatchCfg.MatchValue         = INPUT_MUX_SETTLE_US;
+	TIM_ConfigMatch(LPC_TIM1, &sMatchCfg);
+	
+	BSP_IntEn(BSP_INT_ID_TIMER1);
+	TIM_Cmd(LPC_TIM1, ENABLE);
+}
+
 /******************************************************************
 *@brief 读取输入量任务函数							
 ******************************************************************/
@@ -544,18 +1049,39 @@ void vInputReceiveTask(void *p_arg)
 	OS_ERR err = OS_ERR_NONE;
 	
     vInputIOInit();
+    vInputAcqInit();
 	while(DEF_TRUE)
 	{
+        (void)OSTaskSemPend(0, OS_OPT_PEND_BLOCKING, NULL, &err);   //等待扫描完成或DI变化
+        
+        while(InputScanTail != InputScanHead)   //先处理已完成的扫描，再处理边沿事件，
+        {                                       //避免较早的扫描值覆盖较新的边沿电平
+            vInputProcessScan(&InputScanRing[InputScanTail]);
+            InputScanTail = (InputScanTail + 1) % INPUT_SCAN_RING_NUM;
+        }
+        vInputProcessDIEvent();
         vInputReceive();
-        OSTimeDlyHMSM(0, 0, 1, 0, OS_OPT_TIME_HMSM_STRICT, &err);	
 	}
 }
 
-/******************************************************************
-*@brief 输入量初始化								
-******************************************************************/
+/**************************************************************
+*@brief 注册通道校准参数。参数ID按类型内注册顺序分配，须在已有
+*       参数(系统参数)全部注册之后调用，已有参数ID保持不变
+***************************************************************/
+void vInputRegistEEPROMData(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < AI_NUM; i++)
+    {
+        EEPROM_DATA(TYPE_UINT_32, AnalogInputData[i].ulCalib)
+    }
+}
+
 void vInputInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size)
 {
+	uint8_t i;
+	
 	GPIO_Init();
 	
 	//设置管脚功能，4051A---P1.27，4051B---P1.28，4051C---P1.29  两块4051共用A、B、C管脚
@@ -590,5 +1116,20 @@ void vInputInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE s
 	ADC_Init(LPC_ADC, 200000);
 	ADC_ChannelCmd(LPC_ADC, ADC_CHANNEL_2, ENABLE);	
     
+    //生成校准表，通道校准参数由vInputRegistEEPROMData注册
+    vAnalogInputCalibInit();
+    for(i = 0; i < AI_NUM; i++)
+    {
+        AnalogInputData[i].ulCalib = INPUT_CALIB_DEFAULT;
+        vAnalogInputCalcScale(&AnalogInputData[i]);
+        
+        (void)xAnalogInputSetFilter(i+1, 0, FILTER_MEDIAN, INPUT_AI_SPIKE_WIN);   //默认滤波，设备可按通道覆盖
+        (void)xAnalogInputSetFilter(i+1, 1, FILTER_IIR,    INPUT_AI_IIR_SHIFT);
+    }
+    for(i = 0; i < DI_NUM; i++)
+    {
+        (void)xDigitalInputSetDebounce(i+1, DEBOUNCE_COUNT, INPUT_DI_DEBOUNCE_CNT);
+    }
+    psInputTaskTCB = p_tcb;
     (void)eTaskCreate(p_tcb, vInputReceiveTask, NULL, prio, p_stk_base, stk_size);
 }
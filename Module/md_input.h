@@ -2,26 +2,89 @@
 #define _MD_INPUT_H_
 
 #include "includes.h"
+#include "md_filter.h"
 
 #define GET_QUICK_TEST		(GPIO_ReadValue(1)>>25 & 1)
 
+#define AI_NUM                   8                   //AI通道数
+#define INPUT_DI_PIN_EN          0                   //DI直连GPIO管脚(边沿中断)功能，当前硬件DI均经4051扫描
+
+#define INPUT_CALIB_GAIN_ONE     4096                //通道增益1.0
+#define INPUT_CALIB_GAIN_MIN     2048
+#define INPUT_CALIB_GAIN_MAX     8192
+#define INPUT_CALIB_OFFSET_MAX   400                 //通道偏移上限 单位10uA
+
 typedef struct        /**AI数据结构**/
 {
     int32_t         lMax;          //量程最大值 = 实际量程最大值*10
 	int32_t         lMin;          //量程最小值 = 实际量程最小值*10
     int16_t         s10_uA;        //输入电流值  单位10uA
 	void*           pvAIVal;       //根据量程转化为实际值       
+	sFilterChain    sFilter;       //采样值滤波链
+	
+	uint32_t        ulCalib;       //通道校准参数(记忆)，高16位增益(4096为1.0)，低16位偏移(10uA)
+	uint32_t        ulCalibUsed;   //当前换算系数对应的校准参数
+	int32_t         lCurQ4;        //校准后的输入电流 单位10uA/16
+	int32_t         lGain;         //量程换算增益，实际值 = lCurQ4 * lGain >> 24 + lOffset
+	int32_t         lOffset;       //量程换算偏移
+	int32_t         lThreshold;    //4mA对应的lCurQ4，低于该值实际值为0
 }sAIData; 
 
 typedef struct        /**DI数据结构**/
 {
 	void*           pvDIVal;       //当前实际值       
+	sDebounce       sDebounce;     //消抖
+	uint8_t         ucVal;         //消抖后的值
+	
+#if INPUT_DI_PIN_EN > 0
+	BOOL            xPinMode;      //直连GPIO管脚(边沿中断)，否则经4051扫描
+	uint8_t         ucPort;        //直连管脚端口，仅P0/P2支持边沿中断
+	uint8_t         ucPin;         //直连管脚
+#endif
+	uint16_t        usEdgeCount;   //边沿计数
+	uint32_t        ulEdgeTimeUs;  //最近一次边沿时刻 us
 }sDIData; 
 
+typedef struct        /**DI边沿事件**/
+{
+	uint32_t        ulTimeUs;      //边沿时刻 us
+	uint8_t         ucChannel;     //DI通道 D1~D15
+	uint8_t         ucVal;         //边沿后的电平
+}sDIEvent; 
+
+typedef struct        /**一次完整扫描(4051全部8个通道)**/
+{
+	uint16_t        usAISample[8]; //AI采样值(12位)
+	uint8_t         ucSaInput;     //拨码
+	uint8_t         ucLogicInput1; //DI接口1
+	uint8_t         ucLogicInput2; //DI接口2
+}sInputScan; 
+
+typedef struct        /**采集统计**/
+{
+	uint32_t        ulScanCount;   //完成扫描次数
+	uint32_t        ulScanOverrun; //环形缓冲满丢弃的扫描次数
+	uint32_t        ulSlotOverrun; //通道时隙内采样未完成次数
+	uint32_t        ulMuxErr;      //4051通道回读错误次数
+	uint32_t        ulDIEventDrop; //DI事件缓冲满丢弃次数
+}sInputAcqStats; 
+
 void     vDigitalInputRegist(uint8_t ucChannel, void* pvVal);
 void     vAnalogInputRegist(uint8_t ucChannel, int32_t lMin, int32_t lMax, void* pvVal);
+
+#if INPUT_DI_PIN_EN > 0
+BOOL     xDigitalInputRegistPin(uint8_t ucChannel, uint8_t ucPort, uint8_t ucPin);
+#endif
+uint16_t usDigitalInputGetEdgeCount(uint8_t ucChannel);
+uint32_t ulDigitalInputGetEdgeTime(uint8_t ucChannel);
+uint32_t ulInputGetTimeUs(void);
+
+BOOL     xDigitalInputSetDebounce(uint8_t ucChannel, eDebounceType eType, uint8_t ucParam);
+BOOL     xAnalogInputSetFilter(uint8_t ucChannel, uint8_t ucStage, eFilterType eType, uint16_t usParam);
          
 void     vAnalogInputSetRange(uint8_t ucChannel, int32_t lMin, int32_t lMax);
+BOOL     xAnalogInputSetCalib(uint8_t ucChannel, uint16_t usGain, int16_t sOffset);
+uint32_t ulAnalogInputGetCalib(uint8_t ucChannel);
 
 uint32_t ulAnalogInputGetRealVal(uint8_t ucChannel);
 uint8_t  ucDigitalInputGetRealVal(uint8_t ucChannel);
@@ -30,6 +93,9 @@ uint8_t  ucGetControllerID(void);
 uint8_t* pcGetControllerID(void);
 uint8_t  ucGetSaInput(void);
 
+const sInputAcqStats* psInputGetAcqStats(void);
+
+void vInputRegistEEPROMData(void);
 void vInputInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size);
 
 #endif
@@ -1,82 +1,170 @@
 #include "md_monitor.h"
 #include "md_event.h"
 #include "my_rtt_printf.h"
+#include "LPC407x_8x_177x_8x.h"
 
-#include "system.h"
+#define MONITOR_POLL_INTERVAL_MS    1000    //监控轮询周期(ms)
 
-#define MONITOR_DATA_MAX_NUM        200     //最大可监控点位数，根据实际情况调整
-#define MONITOR_POLL_INTERVAL_S     1     //
+#define MONITOR_BITMAP_WORDS        ((MONITOR_DATA_MAX_NUM + 31) / 32)
 
-sMonitorInfo* MonitorList = NULL;
-sMonitorInfo  MonitorBuf[MONITOR_DATA_MAX_NUM];
+sMonitorInfo  MonitorBuf[MONITOR_DATA_MAX_NUM];    //按监控ID索引
+uint16_t      MonitorID = 0;
 
-uint16_t MonitorID = 0;
+/*按数据宽度分组的连续指针表，轮询时顺序采集到快照区，与影子区按字比较*/
+uint8_t*  MonitorPtr8[MONITOR_DATA_MAX_NUM];
+uint16_t  MonitorIdList8[MONITOR_DATA_MAX_NUM];
+uint8_t   __attribute__((aligned (4))) MonitorSnap8[MONITOR_DATA_MAX_NUM]   = {0};
+uint8_t   __attribute__((aligned (4))) MonitorShadow8[MONITOR_DATA_MAX_NUM] = {0};
+uint16_t  MonitorCount8 = 0;
+
+uint16_t* MonitorPtr16[MONITOR_DATA_MAX_NUM];
+uint16_t  MonitorIdList16[MONITOR_DATA_MAX_NUM];
+uint16_t  __attribute__((aligned (4))) MonitorSnap16[MONITOR_DATA_MAX_NUM]   = {0};
+uint16_t  __attribute__((aligned (4))) MonitorShadow16[MONITOR_DATA_MAX_NUM] = {0};
+uint16_t  MonitorCount16 = 0;
+
+uint32_t  MonitorChanged[MONITOR_BITMAP_WORDS] = {0};   //变化位图，按监控ID置位
+
+sEventMsg MonitorMsgBuf[EVENT_MSG_BATCH_NUM];           //一次轮询的变化打包发布
 
 /**************************************************************
-*@brief 数据监控注册
+*@brief 数据监控注册，返回监控ID。只有8/16位整型点位参与轮询
+*       比较并触发事件，boolean与32位点位仅分配ID，不触发事件
 ***************************************************************/
-void vMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem)
+uint16_t usMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem)
 {
-    uint8_t  ucValue, n;
-    uint16_t usValue;
-    
-    int8_t   cValue;
-    int16_t  sValue;
-    
+    uint16_t n;
     sMonitorInfo* psMonitor = NULL;
-    
+
     if(MonitorID >= MONITOR_DATA_MAX_NUM)
     {
-        myprintf("vMonitorRegist over MonitorID %d  \n", MonitorID);  
-        return;
+        myprintf("vMonitorRegist over MonitorID %d  \n", MonitorID);
+        return MONITOR_ID_NONE;
     }
     for(n=0; n<MonitorID; n++)
     {
-        psMonitor = &MonitorBuf[n];
-        if(psMonitor->pvVal == pvVal)
+        if(MonitorBuf[n].pvVal == pvVal)
         {
-            return ;
+            return n;
         }
     }
+    switch(ucDataType)
+    {
+        case int8:
+        case uint8:
+            MonitorPtr8[MonitorCount8]    = (uint8_t*)pvVal;
+            MonitorIdList8[MonitorCount8] = MonitorID;
+            MonitorSnap8[MonitorCount8]   = *(uint8_t*)pvVal;
+            MonitorShadow8[MonitorCount8] = MonitorSnap8[MonitorCount8];
+            MonitorCount8++;
+        break;
+        case int16:
+        case uint16:
+            MonitorPtr16[MonitorCount16]    = (uint16_t*)pvVal;
+            MonitorIdList16[MonitorCount16] = MonitorID;
+            MonitorSnap16[MonitorCount16]   = *(uint16_t*)pvVal;
+            MonitorShadow16[MonitorCount16] = MonitorSnap16[MonitorCount16];
+            MonitorCount16++;
+        break;
+        case boolean:
+        case single:
+        case int32:
+        case uint32:
+        break;
+        default:
+            return MONITOR_ID_NONE;
+    }
     psMonitor = &MonitorBuf[MonitorID];
-    MonitorID++;
-    
+
     psMonitor->pvVal      = pvVal;
     psMonitor->psSem      = psSem;
     psMonitor->ucDataType = ucDataType;
-    psMonitor->usDataId   = MonitorID + 1;   //全局标示
-    psMonitor->pNext      = NULL;
-    
-    if(ucDataType == uint8)
-    {
-        ucValue = *(uint8_t*)pvVal;
-        psMonitor->usDataVal = (uint16_t)ucValue;
-    }
-    else if(ucDataType == uint16)
-    {
-        usValue = *(uint16_t*)pvVal;
-        psMonitor->usDataVal = (uint16_t)usValue;
-    }
-    else if(ucDataType == int8)
+    psMonitor->ucTopic    = ucEventGetTopic(psSem);
+    psMonitor->usDataId   = MonitorID;   //全局标示
+    MonitorID++;
+
+    return psMonitor->usDataId;
+}
+
+void vMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem)
+{
+    (void)usMonitorRegist(pvVal, ucDataType, psSem);
+}
+
+/**************************************************************
+*@brief 根据变量地址查找监控ID
+***************************************************************/
+uint16_t usMonitorGetID(void* pvVal)
+{
+    uint16_t n;
+    for(n=0; n<MonitorID; n++)
     {
-        cValue = *(int8_t*)pvVal;
-        psMonitor->usDataVal = (uint16_t)cValue;
+        if(MonitorBuf[n].pvVal == pvVal)
+        {
+            return n;
+        }
     }
-    else if(ucDataType == int16)
+    return MONITOR_ID_NONE;
+}
+
+uint16_t usMonitorGetCount(void)
+{
+    return MonitorID;
+}
+
+sMonitorInfo* psMonitorGetInfo(uint16_t usDataId)
+{
+    return (usDataId < MonitorID) ? &MonitorBuf[usDataId] : NULL;
+}
+
+/**************************************************************
+*@brief 快照区与影子区按字比较，变化的点位在位图中置位
+*@param ucPerWord 每个32位字中包含的点位数(4/2)
+***************************************************************/
+void vMonitorCompare(uint32_t* pulSnap, uint32_t* pulShadow, uint16_t usCount, uint8_t ucPerWord, uint16_t* pusIdList)
+{
+    uint16_t w, usWords, usIndex;
+    uint8_t  k, ucBits;
+    uint32_t ulDiff, ulMask;
+
+    usWords = (usCount + ucPerWord - 1) / ucPerWord;
+    ucBits  = 32 / ucPerWord;
+
+    for(w=0; w<usWords; w++)
     {
-        sValue = *(int16_t*)pvVal;
-        psMonitor->usDataVal = (uint16_t)sValue;
+        ulDiff = pulSnap[w] ^ pulShadow[w];
+        if(ulDiff == 0)
+        {
+            continue;
+        }
+        pulShadow[w] = pulSnap[w];
+        for(k=0; k<ucPerWord; k++)
+        {
+            ulMask = ((1UL << ucBits) - 1) << (k * ucBits);
+            usIndex = w * ucPerWord + k;
+            if( (ulDiff & ulMask) && usIndex < usCount )
+            {
+                MonitorChanged[pusIdList[usIndex] >> 5] |= 1UL << (pusIdList[usIndex] & 0x1F);
+            }
+        }
     }
-    if(MonitorList == NULL)
+}
+
+/**************************************************************
+*@brief 发布一组变化，内存池不足未发布时重新置位变化位，下一轮重发
+***************************************************************/
+void vMonitorPublish(sEventMsg* psMsgList, uint8_t ucCount)
+{
+    uint8_t n;
+
+    if(xEventPublish(psMsgList, ucCount) == TRUE)
     {
-        MonitorList = psMonitor;
+        return;
     }
-    else
+    for(n=0; n<ucCount; n++)
     {
-        MonitorList->pLast->pNext = psMonitor;
+        MonitorChanged[psMsgList[n].usDataId >> 5] |= 1UL << (psMsgList[n].usDataId & 0x1F);
     }
-//    myprintf("vMonitorRegist %d \n", psMonitor->usDataVal); 
-    MonitorList->pLast = psMonitor;
 }
 
 /**************************************************************
@@ -84,66 +172,62 @@ void vMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem)
 ***************************************************************/
 void vMonitorPollTask(void *p_arg)
 {
-    sEventMsg sEventMsg;
-    
-    uint8_t  ucValue;
-    int8_t   cValue;
-    uint16_t usValue;
-    int16_t  sValue;
-
-    uint16_t usDataValue = 0;
-    
-    CPU_TS  ts = 0;
+    uint8_t  ucCount;
+    uint16_t n, usDataId;
+    uint32_t ulBits;
+
     OS_ERR err = OS_ERR_NONE;
     sMonitorInfo* psMonitor = NULL;
-    
-    OS_TCB* psEventTCB = psGetEventTCB();
-    
-     System* psSystem = System_Core();
-    
-    
+    sEventMsg*    psMsg     = NULL;
+
     while(DEF_TRUE)
 	{
-        (void)OSTimeDlyHMSM(0, 0, MONITOR_POLL_INTERVAL_S, 0, OS_OPT_TIME_HMSM_STRICT, &err);
-        for(psMonitor = MonitorList; psMonitor != NULL; psMonitor = psMonitor->pNext)
+        (void)OSTimeDlyHMSM(0, 0, 0, MONITOR_POLL_INTERVAL_MS, OS_OPT_TIME_HMSM_STRICT, &err);
+
+        /*顺序采集快照*/
+        for(n=0; n<MonitorCount8; n++)
         {
-//            usDataValue = psMonitor->usDataVal;      
-            if(psMonitor->ucDataType == uint8)
-            {
-                ucValue = *(uint8_t*)psMonitor->pvVal;
-                usDataValue = (uint16_t)ucValue;
-            }
-            else if(psMonitor->ucDataType == uint16)
-            {
-                usValue = *(uint16_t*)psMonitor->pvVal;
-                usDataValue = (uint16_t)usValue;                
-            }
-            else if(psMonitor->ucDataType == int8)
-            {
-                cValue = *(int16_t*)psMonitor->pvVal;
-                usDataValue = (uint16_t)cValue;
-            }
-            else if(psMonitor->ucDataType == int16)
-            {
-                sValue = *(int16_t*)psMonitor->pvVal;
-                usDataValue = (uint16_t)sValue;
-            }
-            
-            if(psMonitor->usDataVal != usDataValue)
+            MonitorSnap8[n] = *MonitorPtr8[n];
+        }
+        for(n=0; n<MonitorCount16; n++)
+        {
+            MonitorSnap16[n] = *MonitorPtr16[n];
+        }
+
+        /*按字比较，生成变化位图*/
+        vMonitorCompare((uint32_t*)MonitorSnap8,  (uint32_t*)MonitorShadow8,  MonitorCount8,  4, MonitorIdList8);
+        vMonitorCompare((uint32_t*)MonitorSnap16, (uint32_t*)MonitorShadow16, MonitorCount16, 2, MonitorIdList16);
+
+        /*只处理发生变化的点位，一次轮询的变化打包发布*/
+        ucCount = 0;
+        for(n=0; n<MONITOR_BITMAP_WORDS; n++)
+        {
+            ulBits = MonitorChanged[n];
+            MonitorChanged[n] = 0;
+            while(ulBits)
             {
-                sEventMsg.psSem = psMonitor->psSem;
-                sEventMsg.pvArg = psMonitor->pvVal;
-                psMonitor->usDataVal = usDataValue;     
-                
-//                if(&psSystem->psTempHumiSenInList[11]->sAvgTemp == psMonitor->pvVal)
-//                {
-//                    myprintf("vMonitorPollTask  sEventMsg.pvArg %d  sAvgTemp %d\n", sEventMsg.pvArg, &psSystem->psTempHumiSenInList[11]->sAvgTemp);  
-//                }
-//                (void)OSTimeDlyHMSM(0, 0, 0, 100, OS_OPT_TIME_HMSM_STRICT, &err);
-                (void)OSTaskQPost(psEventTCB, (void*)&sEventMsg, sizeof(sEventMsg), OS_OPT_POST_FIFO, &err);  //转发到特定的Task            
-                              
+                usDataId = (n << 5) + (31 - __CLZ(ulBits));
+                ulBits  &= ~(1UL << (usDataId & 0x1F));
+
+                psMonitor = &MonitorBuf[usDataId];
+                psMsg     = &MonitorMsgBuf[ucCount++];
+
+                psMsg->psSem    = psMonitor->psSem;
+                psMsg->pvArg    = psMonitor->pvVal;
+                psMsg->usDataId = usDataId;
+                psMsg->ucTopic  = psMonitor->ucTopic;
+
+                if(ucCount >= EVENT_MSG_BATCH_NUM)
+                {
+                    vMonitorPublish(MonitorMsgBuf, ucCount);
+                    ucCount = 0;
+                }
             }
         }
+        if(ucCount > 0)
+        {
+            vMonitorPublish(MonitorMsgBuf, ucCount);
+        }
     }
 }
 
@@ -15,20 +15,25 @@
 #define uint16          0x06
 #define uint32          0x07
 
+#define MONITOR_DATA_MAX_NUM        200      //最大可监控点位数，根据实际情况调整
+#define MONITOR_ID_NONE             0xFFFF   //无效监控ID
+
 typedef struct sMonitorInfo /*设备模拟量接口类型*/
 {
-    void*      pvVal;    
+    void*      pvVal;
     OS_SEM*    psSem;
-    
-    uint8_t    ucDataType;  //数据类型    
-    uint16_t   usDataVal;   //数据值  
-    uint16_t   usDataId;    //全局标示
-    
-    struct sMonitorInfo*  pNext;
-    struct sMonitorInfo*  pLast;    
+
+    uint8_t    ucDataType;  //数据类型
+    uint8_t    ucTopic;     //所属事件主题
+    uint16_t   usDataId;    //全局标示(注册顺序分配，连续且固定不变)
 }sMonitorInfo;
 
-void vMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem);
- 
+uint16_t usMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem);
+void     vMonitorRegist(void* pvVal, uint8_t ucDataType, OS_SEM* psSem);
+
+uint16_t usMonitorGetID(void* pvVal);
+uint16_t usMonitorGetCount(void);
+sMonitorInfo* psMonitorGetInfo(uint16_t usDataId);
+
 void vMonitorInit(OS_TCB *p_tcb, OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_size);
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,7 @@
 #include "lpc_gpio.h"
 #include "lpc_ssp.h"
 #include "lpc_pwm.h"
+#include "lpc_timer.h"
 #include "md_output.h"
 #include "my_rtt_printf.h"
 
@@ -15,9 +16,16 @@
 #define AO_NUM              8
 #define DO_NUM              13
 #define PWM_NUM             6
+#define DO_PORT_NUM         6            //GPIO端口数 P0~P5
 
 #define PWM_MATCH_VALUE     200          //PWM匹配值，对应20mA电流
 
+#define DAC_FRAME_Q_NUM     8            //DAC7760发送队列深度
+#define AO_SHADOW_NONE      0xFFFFFFFF   //输出未生效，下次必须下发
+
+#define AO_RAMP_TICK_HZ     100          //斜坡更新频率
+#define AO_RAMP_VAL_MAX     0x7FFF       //斜坡起止值上限，左移16位后不超出int32
+
 #define SET_VALUE_DAC7760_CLR1			vSetDAC7760IO(&DAC1CLR)
 #define	CLR_VALUE_DAC7760_CLR1			vClrDAC7760IO(&DAC1CLR)
 #define	SET_VALUE_DAC7760_LATCH1		vSetDAC7760IO(&DAC1LATCH)
@@ -33,13 +41,29 @@ const IODef* DO_IOList[DO_NUM]={ &DOutput1, &DOutput2, &DOutput3, &DOutput4, &DO
 							     &DOutput13
                                };
 
+LPC_GPIO_TypeDef* const DO_PortList[DO_PORT_NUM] = { LPC_GPIO0, LPC_GPIO1, LPC_GPIO2, LPC_GPIO3, LPC_GPIO4, LPC_GPIO5 };
+
 const IODef* PWM_IOList[PWM_NUM]={ &AOutput1, &AOutput2, &AOutput3, &AOutput4, &AOutput5, &AOutput6 };
                                		  
 /**************************************************************
 *变量声明
 ***************************************************************/
 sDOData DigitalOutputData[DO_NUM];
+sDOPort DigitalOutputPort[DO_PORT_NUM];     //DO端口影子寄存器
+
+uint8_t  DOTransDepth = 0;                  //事务嵌套层数，事务期间锁调度器
 sAOData AnalogOutputData[AO_NUM]; 
+
+sDACFrame DACFrameQueue[DAC_FRAME_Q_NUM];   //DAC7760发送队列，任务入队，SSP1中断发送
+uint8_t   DACFrameHead = 0;
+uint8_t   DACFrameTail = 0;
+BOOL      DACFrameBusy = FALSE;             //队尾帧正在发送
+
+sAOStats  AnalogOutputStats;
+
+sAORamp   AORampList[AO_NUM];             //斜坡状态，TIMER2中断推进
+uint8_t   AORampActive = 0;               //进行中的斜坡，每位对应一个通道
+OS_FLAG_GRP AORampFlagGrp;                //斜坡完成事件，每位对应一个通道
 					  
 /**************************************************************
 *@brief AO接口注册
@@ -69,19 +93,110 @@ void vDigitalOutputInit(void)
         
 		GPIO_SetDir( DO_IOList[i]->Port, ulBitVal, 1 );
 		GPIO_ClearValue( DO_IOList[i]->Port, ulBitVal );
+		
+		DigitalOutputData[i].eDOVal = OFF;
 	}
+	memset(DigitalOutputPort, 0, sizeof(DigitalOutputPort));
 }
 
 /***************************************************
-*@brief  获取DO输出值 
-*@param  Channel       通道，AO1~AO8
-*@param  realData	   实际值
+*@brief  获取DO输出值，读取影子寄存器 
+*@param  Channel       通道，DO1~DO13
 *@author laoc
 *@date	 2019-02-17							
 ***************************************************/
 eCtrlEn eGetDORealValue(uint8_t ucChannel)
 {
+	if((ucChannel > 0) && (ucChannel <= DO_NUM))
+	{
+		return DigitalOutputData[ucChannel-1].eDOVal;
+	}
+	return OFF;
+}
+
+/***************************************************
+*@brief  开始DO事务，事务内的修改在提交时按端口一次写入
+*@note   可嵌套，最外层提交时生效；事务期间锁调度器，其他任务的DO操作在提交后执行
+***************************************************/
+void vDigitalOutputBegin(void)
+{
+	OS_ERR err = OS_ERR_NONE;
+	
+	OSSchedLock(&err);
+	DOTransDepth++;
+}
+
+/***************************************************
+*@brief  事务内设置DO输出
+*@param  Channel    通道，DO1~DO13
+*@param  eCtrl      IO输出控制： 0：off   1：on  								
+***************************************************/
+void vDigitalOutputSet(uint8_t ucChannel, eCtrlEn eCtrl)
+{
+	const IODef* psIO = NULL;
+	sDOPort*   psPort = NULL;
+	uint32_t   ulMask = 0;
+	
+	if( (ucChannel == 0) || (ucChannel > DO_NUM) || (DOTransDepth == 0) )
+	{
+		return;
+	}
+	psIO   = DO_IOList[ucChannel-1];
+	psPort = &DigitalOutputPort[psIO->Port];
+	ulMask = 1 << psIO->Pin;
+	
+	if(psPort->ulDirty == 0)
+	{
+		psPort->ulPending = psPort->ulShadow;
+	}
+	if(eCtrl > 0)
+	{
+		psPort->ulPending |= ulMask;      //输出开启，继电器闭合
+	}
+	else
+	{
+		psPort->ulPending &= ~ulMask;     //输出关闭，继电器断开
+	}
+	psPort->ulDirty |= ulMask;
+	DigitalOutputData[ucChannel-1].eDOVal = (eCtrl > 0) ? ON : OFF;
+}
+
+/***************************************************
+*@brief  提交DO事务，每个端口通过屏蔽寄存器一次写入所有变化的位
+***************************************************/
+void vDigitalOutputCommit(void)
+{
+	uint8_t  n = 0;
+	uint32_t ulChanged = 0;
+	sDOPort* psPort = NULL;
+	OS_ERR   err = OS_ERR_NONE;
+	CPU_SR_ALLOC();
 	
+	if(DOTransDepth == 0)
+	{
+		return;
+	}
+	DOTransDepth--;
+	if(DOTransDepth == 0)
+	{
+		for(n = 0; n < DO_PORT_NUM; n++)
+		{
+			psPort    = &DigitalOutputPort[n];
+			ulChanged = (psPort->ulPending ^ psPort->ulShadow) & psPort->ulDirty;
+			if(ulChanged != 0)
+			{
+				CPU_CRITICAL_ENTER();
+				DO_PortList[n]->MASK = ~ulChanged;   //只写入变化的位
+				DO_PortList[n]->PIN  = psPort->ulPending;
+				DO_PortList[n]->MASK = 0;
+				CPU_CRITICAL_EXIT();
+				
+				psPort->ulShadow = (psPort->ulShadow & ~ulChanged) | (psPort->ulPending & ulChanged);
+			}
+			psPort->ulDirty = 0;
+		}
+	}
+	OSSchedUnlock(&err);
 }
 
 /***************************************************
@@ -93,25 +208,9 @@ void vDigitalOutputCtrl(uint8_t ucChannel, eCtrlEn eCtrl)
 {
     if((ucChannel > 0) && (ucChannel <= DO_NUM))
     {
-        const IODef*    psIO = DO_IOList[ucChannel-1];
-	    uint32_t   ulPortVal = GPIO_ReadValue(psIO->Port);
-        
-	    if(eCtrl > 0)
-	    {
-	    	if( ((ulPortVal >> psIO->Pin) & 0x01) == OFF )   
-            {
-	    		GPIO_SetValue(psIO->Port, 1 << psIO->Pin );    //输出开启，继电器闭合
-//	    		myprintf("GPIO_SetValue ucChannel %d  Port: %d   Pin: %d\n",ucChannel, psIO->Port, psIO->Pin);
-	    	}			
-	    }
-	    else
-	    {
-	    	if( ((ulPortVal >> psIO->Pin) & 0x01) == ON )
-            {	
-	    		GPIO_ClearValue(psIO->Port, 1 << psIO->Pin );	//输出关闭，继电器断开
-//	    		myprintf("GPIO_ClearValue ucChannel %d Port: %d   Pin: %d\n",ucChannel, psIO->Port, psIO->Pin);	
-	    	}			
-	    }
+        vDigitalOutputBegin();
+        vDigitalOutputSet(ucChannel, eCtrl);
+        vDigitalOutputCommit();
     }
 }
 
@@ -123,11 +222,7 @@ void vDigitalOutputToggle( uint8_t ucChannel )
 {
     if((ucChannel > 0) && (ucChannel <= DO_NUM))
     {
-        const IODef*  psIO = DO_IOList[ucChannel-1];
-	    uint32_t    ulMask = 1 << psIO->Pin;  
-        eCtrlEn      eCtrl = ( (GPIO_ReadValue(psIO->Port) & ulMask) >> psIO->Pin ) & 0x01;
-	   
-        if(eCtrl)
+        if(eGetDORealValue(ucChannel) == ON)
 	    {
 	    	vDigitalOutputCtrl(ucChannel, OFF);    //输出关闭，继电器断开
 	    }
@@ -165,67 +260,106 @@ void MyDelay(int ticks)
 	}
 }
 
+/***************************************************
+*@brief DAC7760的LATCH管脚
+*@param ucSuperIO 	使用的超级IO口，1或者2								
+***************************************************/
+static const IODef* psDAC7760LatchIO(uint8_t ucSuperIO)
+{
+	return (ucSuperIO == 1) ? &DAC1LATCH : &DAC2LATCH;
+}
+
+/*************************************************************************
+*@brief	  发送队尾的DAC7760数据帧，LATCH置低后3字节写入SSP1发送FIFO
+*@note    需在临界区或SSP1中断中调用
+***************************************************************************/
+static void vDAC7760StartFrame(void)
+{
+	const sDACFrame* psFrame = NULL;
+	
+	if(DACFrameTail == DACFrameHead)
+	{
+		DACFrameBusy = FALSE;
+		return;
+	}
+	psFrame = &DACFrameQueue[DACFrameTail];
+	DACFrameBusy = TRUE;
+	
+	vClrDAC7760IO(psDAC7760LatchIO(psFrame->ucSuperIO));     //LATCH置低，开始移位
+	SSP_SendData(LPC_SSP1, (psFrame->ulData >> 16) & 0xFF);
+	SSP_SendData(LPC_SSP1, (psFrame->ulData >> 8) & 0xFF);
+	SSP_SendData(LPC_SSP1, psFrame->ulData & 0xFF);
+}
+
+/*************************************************************************
+*@brief	  SSP1接收超时中断：3字节已全部移出，产生LATCH上升沿并发送下一帧
+***************************************************************************/
+void SSP1_IRQHandler(void);
+void SSP1_IRQHandler(void)
+{
+	while(SSP_GetStatus(LPC_SSP1, SSP_STAT_RXFIFO_NOTEMPTY) == SET)
+	{
+		(void)SSP_ReceiveData(LPC_SSP1);
+	}
+	SSP_ClearIntPending(LPC_SSP1, SSP_INTCLR_RT);
+	
+	if(DACFrameBusy == TRUE)
+	{
+		vSetDAC7760IO(psDAC7760LatchIO(DACFrameQueue[DACFrameTail].ucSuperIO));  //产生上升沿，将发送到DAC7760的数据转化为输出
+		AnalogOutputStats.ulFrameSent++;
+		
+		DACFrameTail = (DACFrameTail + 1) % DAC_FRAME_Q_NUM;
+		vDAC7760StartFrame();
+	}
+}
+
 /*************************************************************************
-*@brief	  超级IO模拟量输出数据发送函数	原理：根据DAC7760芯片的时序图来进行设置
+*@brief	  超级IO模拟量输出数据入队，由SSP1中断发送，立即返回
 *@param	  ucSuperIO 	使用的超级IO口，1或者2
 *@param   ulData	    数据	格式：1字节寄存器地址+2字节数据
-*@author  laoc
-*@date	  2019-02-17
+*@return  队列已满返回FALSE
 ***************************************************************************/
-void vSendDataToDAC7760(uint8_t ucSuperIO, uint32_t ulData)
+BOOL xSendDataToDAC7760(uint8_t ucSuperIO, uint32_t ulData)
 {
-	uint8_t i;
-	OS_ERR err = OS_ERR_NONE;
+	uint8_t n = 0;
+	uint8_t ucNext = 0;
+	CPU_SR_ALLOC();
 	
-	uint8_t ucSpidata[3];
-	ucSpidata[2] = ulData & 0xFF;
-	ucSpidata[1] = (ulData >> 8) & 0xFF;
-	ucSpidata[0] = (ulData >> 16) & 0xFF;
+	CPU_CRITICAL_ENTER();
 	
-	if( ucSuperIO == 1)
+	//同一芯片尚未发送的数据寄存器帧直接替换为最新值
+	if( (ulData & 0xFF0000) == DAC7760_REG_DATA )
 	{
-		SET_VALUE_DAC7760_CLR1;	  //CLR管脚置高电平，清空7760输入								
-		SET_VALUE_DAC7760_LATCH1; //LATCH管脚置高电平
-		MyDelay(20);			  //延时保证DAC7760输出清零
-		                         
-		CLR_VALUE_DAC7760_CLR1;	 //CLR管脚置低电平，以便输入新的数据
-		MyDelay(20);
-		
-		for(i = 0; i <= 2; i++)
+		n = (DACFrameBusy == TRUE) ? (DACFrameTail + 1) % DAC_FRAME_Q_NUM : DACFrameTail;
+		for(; n != DACFrameHead; n = (n + 1) % DAC_FRAME_Q_NUM)
 		{
-			SSP_SendData(LPC_SSP1, ucSpidata[i]);
+			if( (DACFrameQueue[n].ucSuperIO == ucSuperIO) && ((DACFrameQueue[n].ulData & 0xFF0000) == DAC7760_REG_DATA) )
+			{
+				DACFrameQueue[n].ulData = ulData;
+				AnalogOutputStats.ulFrameMerged++;
+				CPU_CRITICAL_EXIT();
+				return TRUE;
+			}
 		}
-		/* 等待数据发送完毕 */
-
-		while( (LPC_SSP1->SR & 0x01) == 0) {}  //等待数据发送完毕
-		CLR_VALUE_DAC7760_LATCH1;			   //置LATCH为低电平
-		MyDelay(50);
-			
-		SET_VALUE_DAC7760_LATCH1;			   //产生上升沿，将发送到DAC7760的数据转化为输出
-		MyDelay(50);
 	}
-	else if( ucSuperIO == 2 )
+	ucNext = (DACFrameHead + 1) % DAC_FRAME_Q_NUM;
+	if(ucNext == DACFrameTail)
 	{
-		SET_VALUE_DAC7760_CLR2;
-		SET_VALUE_DAC7760_LATCH2;
-		MyDelay(20);
-		
-		CLR_VALUE_DAC7760_CLR2;
-		MyDelay(20);
-		
-		for(i = 0; i <= 2; i++)
-		{
-			SSP_SendData(LPC_SSP1, ucSpidata[i]);
-		}
-		/* 等待数据发送完毕 */
-		while( (LPC_SSP1->SR & 0x01) == 0 ){}
-		
-		CLR_VALUE_DAC7760_LATCH2;
-		MyDelay(50);
-			
-		SET_VALUE_DAC7760_LATCH2;
-		MyDelay(50);
+		AnalogOutputStats.ulQueueFull++;
+		CPU_CRITICAL_EXIT();
+		return FALSE;
+	}
+	DACFrameQueue[DACFrameHead].ucSuperIO = ucSuperIO;
+	DACFrameQueue[DACFrameHead].ulData    = ulData;
+	DACFrameHead = ucNext;
+	AnalogOutputStats.ulFrameQueued++;
+	
+	if(DACFrameBusy == FALSE)
+	{
+		vDAC7760StartFrame();
 	}
+	CPU_CRITICAL_EXIT();
+	return TRUE;
 }
 
 /***************************************************
@@ -235,9 +369,6 @@ void vSendDataToDAC7760(uint8_t ucSuperIO, uint32_t ulData)
 ***************************************************/
 void vDAC7760Init(void)
 {
-	uint8_t n;
-	OS_ERR err = OS_ERR_NONE;
-	
 	SSP_CFG_Type SSP1_ConfigStruct = {SSP_DATABIT_8, 0, 0, 0, SSP_FRAME_SPI, 1000000};
 	GPIO_Init();
 	
@@ -252,6 +383,9 @@ void vDAC7760Init(void)
 	SSP1_ConfigStruct.ClockRate = 3000000;
 	SSP_Init(LPC_SSP1, &SSP1_ConfigStruct);
 	SSP_Cmd(LPC_SSP1, ENABLE);
+	
+	SSP_IntConfig(LPC_SSP1, SSP_INTCFG_RT, ENABLE);    //接收超时即一帧发送完毕
+	BSP_IntEn(BSP_INT_ID_SSP1);
 		
 #if USE_SUPER_IO_1 > 0
 	(void)PINSEL_ConfigPin( DAC1ALARM.Port, DAC1ALARM.Pin, 0);		//该管脚在DAC7760报警时变为低电平
@@ -264,11 +398,15 @@ void vDAC7760Init(void)
 
 	(void)PINSEL_ConfigPin( DAC1LATCH.Port, DAC1LATCH.Pin, 0);		//该管脚出现上升沿时会将DAC7760的输入数据转为输出数据，即更新DAC7760的输出值
 	GPIO_SetDir( DAC1LATCH.Port, 1 << DAC1LATCH.Pin, 1);
-	GPIO_ClearValue( DAC1LATCH.Port, 1<< DAC1LATCH.Pin);
+	GPIO_SetValue( DAC1LATCH.Port, 1<< DAC1LATCH.Pin);
+	
+	SET_VALUE_DAC7760_CLR1;	  //CLR管脚置高电平，清空7760输出
+	MyDelay(20);
+	CLR_VALUE_DAC7760_CLR1;
 	
-	vSendDataToDAC7760(1, DAC7760_REG_CFG);                       //写配置寄存器，配置为电流输出
-	vSendDataToDAC7760(1, Iout4To20 | DAC7760_REG_OUT);           //写控制寄存器  并配置输出量程为4~20mA
-	vSendDataToDAC7760(1, DAC7760_REG_DATA);                      //输出值置0  
+	(void)xSendDataToDAC7760(1, DAC7760_REG_CFG);                 //写配置寄存器，配置为电流输出
+	(void)xSendDataToDAC7760(1, Iout4To20 | DAC7760_REG_OUT);     //写控制寄存器  并配置输出量程为4~20mA
+	(void)xSendDataToDAC7760(1, DAC7760_REG_DATA);                //输出值置0  
 #endif
 	
 #if USE_SUPER_IO_2 > 0
@@ -282,24 +420,25 @@ void vDAC7760Init(void)
 
 	(void)PINSEL_ConfigPin( DAC2LATCH.Port, DAC2LATCH.Pin, 0);		//该管脚出现上升沿时会将DAC7760的输入数据转为输出数据，即更新DAC7760的输出值
 	GPIO_SetDir( DAC2LATCH.Port, 1 << DAC2LATCH.Pin, 1);
-	GPIO_ClearValue( DAC2LATCH.Port, 1 << DAC2LATCH.Pin);
+	GPIO_SetValue( DAC2LATCH.Port, 1 << DAC2LATCH.Pin);
 	
-	vSendDataToDAC7760(2, DAC7760_REG_CFG);
-	vSendDataToDAC7760(2, Iout4To20 | DAC7760_REG_OUT);
-	vSendDataToDAC7760(2, DAC7760_REG_DATA);
+	SET_VALUE_DAC7760_CLR2;
+	MyDelay(20);
+	CLR_VALUE_DAC7760_CLR2;
+	
+	(void)xSendDataToDAC7760(2, DAC7760_REG_CFG);
+	(void)xSendDataToDAC7760(2, Iout4To20 | DAC7760_REG_OUT);
+	(void)xSendDataToDAC7760(2, DAC7760_REG_DATA);
 #endif
-
-	while(LPC_SSP1->SR == 0){}
 }
 
 /***************************************************
-*@brief  设置超级IO电流值，电流单位uA     公式：Iout = 16000 * data / 4096 + 4000
-*@param  ucSuperIO     使用的超级IO口，1或者2
+*@brief  超级IO电流值转换为数据帧，电流单位uA     公式：Iout = 16000 * data / 4096 + 4000
 *@param  uA	          设置的电流值
 *@author laoc
 *@date	 2019-02-17							
 ***************************************************/
-void vSetDAC7760OutputuA(uint8_t ucSuperIO, uint16_t uA)
+uint32_t ulDAC7760OutputuAToData(uint16_t uA)
 {
 	uint16_t ulDataToSet;
 	ulDataToSet = (uA - 4000) * 4096 / 16000;
@@ -308,22 +447,21 @@ void vSetDAC7760OutputuA(uint8_t ucSuperIO, uint16_t uA)
 	{
 		ulDataToSet = 4095;
 	}
-	vSendDataToDAC7760(ucSuperIO, DAC7760_REG_DATA | ulDataToSet << 4);
+	return DAC7760_REG_DATA | ulDataToSet << 4;
 }
 
 /***************************************************
-*@brief  超级IO发送真实值 单位uA
-*@param  ucSuperIO     使用的超级IO口，1或者2
+*@brief  超级IO真实值转换为数据帧 单位uA
 *@param  min	       量程最小值
 *@param  max	       量程最大值
 *@param  realData	   实际值
 *@author laoc
 *@date	 2019-02-17							
 ***************************************************/
-void vSetDAC7760RealVal(uint8_t ucSuperIO, int32_t lMin, int32_t lMax, uint32_t ulRealData)
+uint32_t ulDAC7760RealValToData(int32_t lMin, int32_t lMax, uint32_t ulRealData)
 {
 	uint16_t uA = 16000 * (ulRealData - lMin) / (lMax - lMin) + 4000;      //对应4~20mA的量程
-	vSetDAC7760OutputuA(ucSuperIO, uA);
+	return ulDAC7760OutputuAToData(uA);
 }
 
 /****************************************************
@@ -387,23 +525,67 @@ static void vSetPWMData(uint8_t pwmChannel, uint32_t data)
 }
 
 /***************************************************
-*@brief  根据量程将真实的值转化为PWM输出 
-*@param  pwmChannel    pwm通道，1~6
+*@brief  根据量程将真实的值转化为PWM匹配值 
 *@param  min	       量程最小值 = 实际值*10
 *@param  max	       量程最大值 = 实际值*10
 *@param  realData	   实际值
 *@author laoc
 *@date	 2019-02-17							
 ***************************************************/
-void vSetPWMRealVal(uint8_t pwmChannel, int32_t lMin, int32_t lMax, uint32_t ulRealData)
+uint32_t ulPWMRealValToData(int32_t lMin, int32_t lMax, uint32_t ulRealData)
 {
-	uint32_t ulData = 160 * (ulRealData - lMin) / (lMax - lMin) + 40;    //对应4~20mA的量程   20mA*10=200
-    PWM_ChannelCmd(1, pwmChannel, ENABLE);
-	vSetPWMData(pwmChannel, ulData);
+	return 160 * (ulRealData - lMin) / (lMax - lMin) + 40;    //对应4~20mA的量程   20mA*10=200
 }
 
 /***************************************************
-*@brief  根据量程将真实的值转化为输出 
+*@brief  根据量程将真实的值转化为输出，与上次下发值相同则不再发送
+*@param  Channel       通道，AO1~AO8
+*@param  realData	   实际值 = 目标值*10
+*@return 输出已是该值或已下发返回TRUE，DAC7760队列满返回FALSE
+*@note   任务中调用需在临界区内，斜坡中断直接调用
+***************************************************/
+static BOOL xAnalogOutputWrite(uint8_t ucChannel, uint32_t ulRealData)
+{
+	sAOData* psAO = &AnalogOutputData[ucChannel-1];
+	uint32_t ulData = 0;
+	
+	psAO->lAOVal = ulRealData;
+	
+	if(ucChannel <=PWM_NUM)
+	{
+		ulData = ulPWMRealValToData(psAO->lMin, psAO->lMax, ulRealData);
+		if(ulData == psAO->ulShadow)
+		{
+			AnalogOutputStats.ulSkipped++;
+			return TRUE;
+		}
+		if(psAO->ulShadow == AO_SHADOW_NONE)
+		{
+			PWM_ChannelCmd(1, ucChannel, ENABLE);
+		}
+		vSetPWMData(ucChannel, ulData);
+		psAO->ulShadow = ulData;
+	}
+	else
+	{
+		ulData = ulDAC7760RealValToData(psAO->lMin, psAO->lMax, ulRealData);
+		if(ulData == psAO->ulShadow)
+		{
+			AnalogOutputStats.ulSkipped++;
+			return TRUE;
+		}
+		if(xSendDataToDAC7760(ucChannel-PWM_NUM, ulData) != TRUE)   //队列满则保持原影子值，下次重发
+		{
+			return FALSE;
+		}
+		psAO->ulShadow = ulData;
+	}
+	return TRUE;
+}
+
+/***************************************************
+*@brief  根据量程将真实的值转化为输出，取消该通道进行中的斜坡。
+*        DAC7760队列满时按零步长斜坡挂起，由斜坡中断逐节拍重发
 *@param  Channel       通道，AO1~AO8
 *@param  realData	   实际值 = 目标值*10
 *@author laoc
@@ -411,22 +593,241 @@ void vSetPWMRealVal(uint8_t pwmChannel, int32_t lMin, int32_t lMax, uint32_t ulR
 ***************************************************/
 void vAnalogOutputSetRealVal(uint8_t ucChannel, uint32_t ulRealData)
 {
+	OS_ERR   err = OS_ERR_NONE;
+	uint8_t  ucBit = 0;
+	sAORamp* psRamp = NULL;
+	CPU_SR_ALLOC();
+	
 	if((ucChannel > 0) && (ucChannel <= AO_NUM))
 	{
-        int32_t lMax = AnalogOutputData[ucChannel-1].lMax;
-        int32_t lMin = AnalogOutputData[ucChannel-1].lMin;
-        
-        AnalogOutputData[ucChannel].lAOVal = ulRealData;
-        
-		if(ucChannel <=PWM_NUM)
+		ucBit  = 1 << (ucChannel-1);
+		psRamp = &AORampList[ucChannel-1];
+		
+		CPU_CRITICAL_ENTER();
+		AORampActive &= ~ucBit;
+		if(xAnalogOutputWrite(ucChannel, ulRealData) != TRUE)
+		{
+			psRamp->lTarget  = (int32_t)ulRealData;
+			psRamp->lStepQ16 = 0;
+			AORampActive |= ucBit;
+			TIM_Cmd(LPC_TIM2, ENABLE);
+			AnalogOutputStats.ulRetry++;
+		}
+		CPU_CRITICAL_EXIT();
+		
+		if( (AORampActive & ucBit) == 0 )
 		{
-			vSetPWMRealVal(ucChannel, lMin, lMax, ulRealData);
+			(void)OSFlagPost(&AORampFlagGrp, ucBit, OS_OPT_POST_FLAG_SET, &err);
 		}
 		else
 		{
-			vSetDAC7760RealVal(ucChannel-PWM_NUM, lMin, lMax, ulRealData);
-		}			
+			(void)OSFlagPost(&AORampFlagGrp, ucBit, OS_OPT_POST_FLAG_CLR, &err);
+		}
+	}
+}
+
+/***************************************************
+*@brief  斜坡定时器中断，推进所有进行中的斜坡并输出
+***************************************************/
+void TIMER2_IRQHandler(void);
+void TIMER2_IRQHandler(void)
+{
+	uint8_t  i = 0;
+	uint8_t  ucBit = 0;
+	uint8_t  ucDone = 0;
+	int32_t  lTargetQ16 = 0;
+	int64_t  llCurQ16 = 0;
+	sAORamp* psRamp = NULL;
+	OS_ERR   err = OS_ERR_NONE;
+	CPU_SR_ALLOC();
+	
+	CPU_CRITICAL_ENTER();
+	OSIntEnter();
+	CPU_CRITICAL_EXIT();
+	
+	TIM_ClearIntPending(LPC_TIM2, TIM_MR0_INT);
+	
+	CPU_CRITICAL_ENTER();
+	for(i = 0; i < AO_NUM; i++)
+	{
+		ucBit = 1 << i;
+		if( (AORampActive & ucBit) == 0 )
+		{
+			continue;
+		}
+		psRamp = &AORampList[i];
+		if(psRamp->lStepQ16 != 0)           //零步长为直接输出重发
+		{
+			lTargetQ16 = psRamp->lTarget << 16;
+			llCurQ16   = (int64_t)psRamp->lCurQ16 + psRamp->lStepQ16;
+			if( (psRamp->lStepQ16 > 0 && llCurQ16 < lTargetQ16) || (psRamp->lStepQ16 < 0 && llCurQ16 > lTargetQ16) )
+			{
+				psRamp->lCurQ16 = (int32_t)llCurQ16;
+				(void)xAnalogOutputWrite(i+1, (uint32_t)((psRamp->lCurQ16 + 0x8000) >> 16));
+				continue;
+			}
+			psRamp->lCurQ16 = lTargetQ16;   //到达目标
+		}
+		if(xAnalogOutputWrite(i+1, (uint32_t)psRamp->lTarget) == TRUE)
+		{
+			AORampActive &= ~ucBit;
+			ucDone |= ucBit;
+		}                                   //目标值未下发则保持斜坡，下个节拍重发
+	}
+	if(AORampActive == 0)
+	{
+		TIM_Cmd(LPC_TIM2, DISABLE);   //无斜坡时停止定时器
+	}
+	CPU_CRITICAL_EXIT();
+	
+	if(ucDone != 0)
+	{
+		(void)OSFlagPost(&AORampFlagGrp, ucDone, OS_OPT_POST_FLAG_SET, &err);
+	}
+	OSIntExit();
+}
+
+/***************************************************
+*@brief  启动模拟量输出斜坡，由TIMER2中断按速率逼近目标值
+*@param  Channel       通道，AO1~AO8
+*@param  ulTarget	   目标值 = 实际值*10，须在通道量程内
+*@param  ulRatePerSec  每秒变化量，0为直接输出
+*@return 目标值超出量程返回FALSE
+***************************************************/
+BOOL xAnalogOutputRamp(uint8_t ucChannel, uint32_t ulTarget, uint32_t ulRatePerSec)
+{
+	OS_ERR   err = OS_ERR_NONE;
+	uint8_t  ucBit = 0;
+	int32_t  lStepQ16 = 0;
+	uint64_t ullStepQ16 = 0;
+	sAORamp* psRamp = NULL;
+	sAOData* psAO = NULL;
+	CPU_SR_ALLOC();
+	
+	if( (ucChannel == 0) || (ucChannel > AO_NUM) )
+	{
+		return FALSE;
+	}
+	psAO   = &AnalogOutputData[ucChannel-1];
+	psRamp = &AORampList[ucChannel-1];
+	ucBit  = 1 << (ucChannel-1);
+	
+	if( (ulTarget > AO_RAMP_VAL_MAX) || ((int32_t)ulTarget < psAO->lMin) || ((int32_t)ulTarget > psAO->lMax) )
+	{
+		return FALSE;
+	}
+	CPU_CRITICAL_ENTER();
+	if( (ulRatePerSec == 0) || (psAO->ulShadow == AO_SHADOW_NONE) || 
+	    (psAO->lAOVal < 0) || (psAO->lAOVal > AO_RAMP_VAL_MAX) )
+	{
+		CPU_CRITICAL_EXIT();
+		vAnalogOutputSetRealVal(ucChannel, ulTarget);   //输出未生效或当前值超出斜坡范围时直接输出
+		return TRUE;
+	}
+	if( ((AORampActive & ucBit) == 0) || (psRamp->lStepQ16 == 0) )
+	{
+		psRamp->lCurQ16 = psAO->lAOVal << 16;   //从当前输出值开始
+	}
+	if(psRamp->lCurQ16 == ((int32_t)ulTarget << 16))
+	{
+		CPU_CRITICAL_EXIT();
+		vAnalogOutputSetRealVal(ucChannel, ulTarget);
+		return TRUE;
 	}
+	ullStepQ16 = ((uint64_t)ulRatePerSec << 16) / AO_RAMP_TICK_HZ;
+	if(ullStepQ16 > ((uint64_t)AO_RAMP_VAL_MAX << 16))   //单步不超过满量程
+	{
+		ullStepQ16 = (uint64_t)AO_RAMP_VAL_MAX << 16;
+	}
+	lStepQ16 = (ullStepQ16 == 0) ? 1 : (int32_t)ullStepQ16;
+	psRamp->lTarget  = (int32_t)ulTarget;
+	psRamp->lStepQ16 = (psRamp->lCurQ16 < ((int32_t)ulTarget << 16)) ? lStepQ16 : -lStepQ16;
+	AORampActive |= ucBit;
+	TIM_Cmd(LPC_TIM2, ENABLE);
+	CPU_CRITICAL_EXIT();
+	
+	(void)OSFlagPost(&AORampFlagGrp, ucBit, OS_OPT_POST_FLAG_CLR, &err);
+	return TRUE;
+}
+
+/***************************************************
+*@brief  启动模拟量输出斜坡，在指定时间内到达目标值
+*@param  Channel       通道，AO1~AO8
+*@param  ulTarget	   目标值 = 实际值*10
+*@param  ulTimeMs      斜坡时间 ms
+***************************************************/
+BOOL xAnalogOutputRampTime(uint8_t ucChannel, uint32_t ulTarget, uint32_t ulTimeMs)
+{
+	uint32_t ulDelta = 0;
+	
+	if( (ucChannel == 0) || (ucChannel > AO_NUM) )
+	{
+		return FALSE;
+	}
+	if(ulTimeMs == 0)
+	{
+		return xAnalogOutputRamp(ucChannel, ulTarget, 0);
+	}
+	ulDelta = (ulTarget > (uint32_t)AnalogOutputData[ucChannel-1].lAOVal) ? ulTarget - AnalogOutputData[ucChannel-1].lAOVal :
+	                                                                   AnalogOutputData[ucChannel-1].lAOVal - ulTarget;
+	return xAnalogOutputRamp(ucChannel, ulTarget, (uint32_t)(((uint64_t)ulDelta * 1000 + ulTimeMs - 1) / ulTimeMs));
+}
+
+/***************************************************
+*@brief  模拟量输出斜坡是否完成
+*@param  Channel       通道，AO1~AO8
+***************************************************/
+BOOL xAnalogOutputRampIsDone(uint8_t ucChannel)
+{
+	if( (ucChannel == 0) || (ucChannel > AO_NUM) )
+	{
+		return TRUE;
+	}
+	return (AORampActive & (1 << (ucChannel-1))) == 0;
+}
+
+/***************************************************
+*@brief  等待模拟量输出斜坡完成
+*@param  Channel       通道，AO1~AO8
+*@param  ulTimeout     超时时间 tick，0为一直等待
+***************************************************/
+BOOL xAnalogOutputRampWait(uint8_t ucChannel, OS_TICK ulTimeout)
+{
+	OS_ERR err = OS_ERR_NONE;
+	
+	if(xAnalogOutputRampIsDone(ucChannel) == TRUE)
+	{
+		return TRUE;
+	}
+	(void)OSFlagPend(&AORampFlagGrp, 1 << (ucChannel-1), ulTimeout,
+	                 OS_OPT_PEND_FLAG_SET_ALL | OS_OPT_PEND_BLOCKING, NULL, &err);
+	return (err == OS_ERR_NONE);
+}
+
+/***************************************************
+*@brief  斜坡定时器初始化，斜坡进行时才运行
+***************************************************/
+void vAnalogOutputRampInit(void)
+{
+	OS_ERR err = OS_ERR_NONE;
+	TIM_TIMERCFG_Type sTimerCfg;
+	TIM_MATCHCFG_Type sMatchCfg;
+	
+	OSFlagCreate(&AORampFlagGrp, "AORampFlagGrp", (OS_FLAGS)0xFF, &err);
+	
+	sTimerCfg.PrescaleOption = TIM_PRESCALE_USVAL;   //1us计数
+	sTimerCfg.PrescaleValue  = 1;
+	TIM_Init(LPC_TIM2, TIM_TIMER_MODE, &sTimerCfg);
+	
+	sMatchCfg.MatchChannel       = 0;
+	sMatchCfg.IntOnMatch         = ENABLE;
+	sMatchCfg.StopOnMatch        = DISABLE;
+	sMatchCfg.ResetOnMatch       = ENABLE;
+	sMatchCfg.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+	sMatchCfg.MatchValue         = 1000000 / AO_RAMP_TICK_HZ;
+	TIM_ConfigMatch(LPC_TIM2, &sMatchCfg);
+	
+	BSP_IntEn(BSP_INT_ID_TIMER2);
 }
 
 /***************************************************
@@ -437,19 +838,37 @@ void vAnalogOutputSetRealVal(uint8_t ucChannel, uint32_t ulRealData)
 ***************************************************/
 void vAnalogOutputDisable(uint8_t ucChannel)
 {
+	CPU_SR_ALLOC();
+	
 	if((ucChannel > 0) && (ucChannel <= AO_NUM))
 	{
+		CPU_CRITICAL_ENTER();
+		AORampActive &= ~(1 << (ucChannel-1));
+		CPU_CRITICAL_EXIT();
+		
 		if(ucChannel <=PWM_NUM)
 		{
 			PWM_ChannelCmd(1, ucChannel, DISABLE);
+			AnalogOutputData[ucChannel-1].ulShadow = AO_SHADOW_NONE;
 		}
-		else
+		else if(AnalogOutputData[ucChannel-1].ulShadow != DAC7760_REG_DATA)
 		{
-            vSendDataToDAC7760(ucChannel-PWM_NUM, DAC7760_REG_DATA);  //输出值置0 
+            if(xSendDataToDAC7760(ucChannel-PWM_NUM, DAC7760_REG_DATA) == TRUE)  //输出值置0 
+            {
+                AnalogOutputData[ucChannel-1].ulShadow = DAC7760_REG_DATA;
+            }
 		}			
 	}
 }
 
+/******************************************************************
+*@brief  模拟量输出统计
+******************************************************************/
+const sAOStats* psAnalogOutputGetStats(void)
+{
+	return &AnalogOutputStats;
+}
+
 /******************************************************************
 *@brief  修改AO通道量程
 *@param  channel	AI通道  AO1~AO8
@@ -470,8 +889,15 @@ void vAnalogOutputSetRange(uint8_t ucChannel, int32_t lMin, int32_t lMax)
 ******************************************************************/
 void vOutputInit(void)
 {
+	uint8_t i;
+	
+	for(i = 0; i < AO_NUM; i++)
+	{
+		AnalogOutputData[i].ulShadow = AO_SHADOW_NONE;
+	}
 	vDigitalOutputInit();
 	vDAC7760Init();
 	vPWM1Init();
+	vAnalogOutputRampInit();
 }
 
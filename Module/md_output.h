@@ -22,22 +22,65 @@ typedef struct
 	int32_t      lMin;            //量程最小值 = 实际量程最小值*10
 	int16_t      s10_uA;          //输出电流值  单位10uA电流值       
     int32_t      lAOVal;          //根据量程转化为实际输出值      
+    uint32_t     ulShadow;        //最近一次下发的PWM匹配值或DAC7760数据帧
 }sAOData;  
 
+typedef struct        /**模拟量输出斜坡**/
+{
+    int32_t      lCurQ16;         //当前输出值，16位小数
+    int32_t      lStepQ16;        //每个斜坡周期的变化量，16位小数
+    int32_t      lTarget;         //目标值
+}sAORamp;  
+
+typedef struct        /**DAC7760数据帧**/
+{
+    uint8_t      ucSuperIO;       //超级IO口，1或者2
+    uint32_t     ulData;          //1字节寄存器地址+2字节数据
+}sDACFrame;  
+
+typedef struct        /**模拟量输出统计**/
+{
+    uint32_t     ulFrameQueued;   //入队帧数
+    uint32_t     ulFrameSent;     //发送完成帧数
+    uint32_t     ulFrameMerged;   //合并到未发送帧的次数
+    uint32_t     ulQueueFull;     //队列满次数
+    uint32_t     ulSkipped;       //输出值未变化跳过次数
+    uint32_t     ulRetry;         //直接输出因队列满转为中断重发次数
+}sAOStats;  
+
 typedef struct        
 {
 	eCtrlEn      eDOVal;         //当前实际值       
 }sDOData; 
 
+typedef struct        /**DO端口影子寄存器**/
+{
+    uint32_t     ulShadow;        //已输出的端口值
+    uint32_t     ulPending;       //事务中待输出的端口值
+    uint32_t     ulDirty;         //事务中修改过的位
+}sDOPort; 
+
 void vOutputInit(void);
 void vAnalogOutputRegist(uint8_t ucChannel, int32_t lMin, int32_t lMax);
 
 void vDigitalOutputCtrl( uint8_t ucChannel, eCtrlEn eCtrl);
 void vDigitalOutputDataToggle(uint8_t ucChannel);
+eCtrlEn eGetDORealValue(uint8_t ucChannel);
+
+void vDigitalOutputBegin(void);
+void vDigitalOutputSet(uint8_t ucChannel, eCtrlEn eCtrl);
+void vDigitalOutputCommit(void);
 
 void vAnalogOutputSetRealVal(uint8_t ucChannel, uint32_t ulRealData);
 void vAnalogOutputSetRange(uint8_t ucChannel, int32_t lMin, int32_t lMax);
 void vAnalogOutputDisable(uint8_t ucChannel);
 
+BOOL xAnalogOutputRamp(uint8_t ucChannel, uint32_t ulTarget, uint32_t ulRatePerSec);
+BOOL xAnalogOutputRampTime(uint8_t ucChannel, uint32_t ulTarget, uint32_t ulTimeMs);
+BOOL xAnalogOutputRampIsDone(uint8_t ucChannel);
+BOOL xAnalogOutputRampWait(uint8_t ucChannel, OS_TICK ulTimeout);
+
+const sAOStats* psAnalogOutputGetStats(void);
+
 void vOutputInit(void);
 #endif
@@ -0,0 +1,92 @@
+#include "md_seqlock.h"
+#include "LPC407x_8x_177x_8x.h"
+
+#define SEQLOCK_READ_RETRY_MAX    4    //ulSeqReadCopy无锁重读次数，超出后锁调度拷贝
+
+/**************************************************************
+*@brief 顺序锁初始化
+***************************************************************/
+void vSeqLockInit(sSeqLock* psLock)
+{
+    psLock->ulSeq   = 0;
+    psLock->ulRetry = 0;
+}
+
+/**************************************************************
+*@brief 写入开始，版本号变为奇数。写者锁调度，单核下读者不会
+*       打断写者，写入区间须短且不可阻塞
+***************************************************************/
+void vSeqWriteBegin(sSeqLock* psLock)
+{
+    OS_ERR err = OS_ERR_NONE;
+
+    OSSchedLock(&err);
+    psLock->ulSeq++;
+    __DMB();
+}
+
+/**************************************************************
+*@brief 写入结束，版本号变为偶数
+***************************************************************/
+void vSeqWriteEnd(sSeqLock* psLock)
+{
+    OS_ERR err = OS_ERR_NONE;
+
+    __DMB();
+    psLock->ulSeq++;
+    OSSchedUnlock(&err);
+}
+
+/**************************************************************
+*@brief 读取开始，返回当前版本号
+***************************************************************/
+uint32_t ulSeqReadBegin(sSeqLock* psLock)
+{
+    uint32_t ulSeq = psLock->ulSeq;
+
+    __DMB();
+    return ulSeq;
+}
+
+/**************************************************************
+*@brief 读取结束校验，写入中开始读取或读取期间版本号变化需重读
+***************************************************************/
+BOOL xSeqReadRetry(sSeqLock* psLock, uint32_t ulSeq)
+{
+    __DMB();
+    if( (ulSeq & 0x01) || (psLock->ulSeq != ulSeq) )
+    {
+        psLock->ulRetry++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/**************************************************************
+*@brief 拷贝一致快照，返回快照版本号。有限次无锁重读后锁调度拷贝，
+*       保证低优先级读者在频繁写入下也能结束
+*@param  pvCopy  拷贝函数，字段分散时由读者把所需字段拷入快照
+*@param  pvArg   拷贝函数参数
+***************************************************************/
+uint32_t ulSeqReadCopy(sSeqLock* psLock, pvSeqReadCopy pvCopy, void* pvArg)
+{
+    uint8_t  n;
+    uint32_t ulSeq;
+    OS_ERR   err = OS_ERR_NONE;
+
+    for(n = 0; n < SEQLOCK_READ_RETRY_MAX; n++)
+    {
+        ulSeq = ulSeqReadBegin(psLock);
+        pvCopy(pvArg);
+        if(xSeqReadRetry(psLock, ulSeq) == FALSE)
+        {
+            return ulSeq;
+        }
+    }
+    OSSchedLock(&err);
+    ulSeq = psLock->ulSeq;
+    pvCopy(pvArg);
+    OSSchedUnlock(&err);
+
+    return ulSeq;
+}
@@ -0,0 +1,25 @@
+#ifndef _MD_SEQLOCK_H_
+#define _MD_SEQLOCK_H_
+
+#include "includes.h"
+#include "lpc_types.h"
+
+typedef struct  /*顺序锁：写者递增版本号(奇数表示写入中)，读者拷贝后校验版本号，不阻塞写者*/
+{
+    volatile uint32_t   ulSeq;     //版本号
+    uint32_t            ulRetry;   //读者重读次数
+}sSeqLock;
+
+typedef void (*pvSeqReadCopy)(void* pvArg);   /*读者拷贝函数，把所需字段拷贝到快照，可被重复调用*/
+
+void vSeqLockInit(sSeqLock* psLock);
+
+void vSeqWriteBegin(sSeqLock* psLock);
+void vSeqWriteEnd(sSeqLock* psLock);
+
+uint32_t ulSeqReadBegin(sSeqLock* psLock);
+BOOL     xSeqReadRetry(sSeqLock* psLock, uint32_t ulSeq);
+
+uint32_t ulSeqReadCopy(sSeqLock* psLock, pvSeqReadCopy pvCopy, void* pvArg);
+
+#endif
@@ -1,82 +1,402 @@
 #include "md_timer.h"
 #include "my_rtt_printf.h"
 
+#define TIMER_WHEEL_INDEX(ulTick, ucLevel)   (((ulTick) >> ((ucLevel) * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK)
+
+BOOL        TimerWheelReady   = FALSE;                               //时间轮已初始化
+uint32_t    TimerWheelJiffies = 0;                                   //时间轮当前节拍
+OS_TMR      TimerWheelTmr;                                           //驱动时间轮的内核定时器
+sTimerNode  TimerWheel[TIMER_WHEEL_LEVEL_NUM][TIMER_WHEEL_SIZE];     //各层槽位链表头
+sTimerStats TimerWheelStats;                                         //时间轮运行统计
+
+static void vTimerListInit(sTimerNode* psHead)
+{
+    psHead->pNext = psHead;
+    psHead->pPrev = psHead;
+}
+
+static void vTimerListAdd(sTimerNode* psHead, sTimerNode* psNode)
+{
+    psNode->pPrev = psHead->pPrev;
+    psNode->pNext = psHead;
+    psHead->pPrev->pNext = psNode;
+    psHead->pPrev = psNode;
+}
+
+static void vTimerListDel(sTimerNode* psNode)
+{
+    psNode->pPrev->pNext = psNode->pNext;
+    psNode->pNext->pPrev = psNode->pPrev;
+    vTimerListInit(psNode);
+}
+
+/*槽位链表整体移到psList，O(1)*/
+static void vTimerListMove(sTimerNode* psHead, sTimerNode* psList)
+{
+    if(psHead->pNext == psHead)
+    {
+        vTimerListInit(psList);
+        return;
+    }
+    psList->pNext = psHead->pNext;
+    psList->pPrev = psHead->pPrev;
+    psList->pNext->pPrev = psList;
+    psList->pPrev->pNext = psList;
+    vTimerListInit(psHead);
+}
+
 /**************************************************************
-*@brief 定时器注册
+*@brief 按剩余节拍挂入对应层槽位，已过期的挂入当前槽位
 ***************************************************************/
-BOOL xTimerRegist(OS_TMR *p_tmr, uint32_t ulDlyTime_s, uint32_t ulPeriod_s, OS_OPT opt, 
-                  OS_TMR_CALLBACK_PTR p_callback, void *p_callback_arg, uint8_t xExcuteCallback)
+static void vTimerWheelAdd(sTimer* psTmr)
 {
-    OS_ERR err     = OS_ERR_NONE;
-    OS_TICK dly    = ulDlyTime_s * TMR_TICK_PER_SECOND;
-    OS_TICK period = ulPeriod_s * TMR_TICK_PER_SECOND;
-    
-    OS_STATE  sTmrState = OSTmrStateGet(p_tmr, &err);
-    if(sTmrState == OS_TMR_STATE_UNUSED)
+    uint8_t  ucLevel;
+    uint32_t ulDelta = psTmr->ulExpire - TimerWheelJiffies;
+
+    if((int32_t)ulDelta < 0)
     {
-        OSTmrCreate(p_tmr, "Tmr", dly, period, opt, p_callback, (void*)p_callback_arg, &err);
+        psTmr->ulExpire = TimerWheelJiffies;
+        ulDelta = 0;
     }
-    else if(sTmrState == OS_TMR_STATE_RUNNING)
+    for(ucLevel = 0; ucLevel < TIMER_WHEEL_LEVEL_NUM - 1; ucLevel++)
     {
-        OSTmrStop(p_tmr, OS_OPT_TMR_NONE, NULL, &err);
+        if(ulDelta < (1UL << ((ucLevel + 1) * TIMER_WHEEL_BITS)))
+        {
+            break;
+        }
     }
-    if( p_tmr->Dly != dly || p_tmr->Period != period)
+    vTimerListAdd(&TimerWheel[ucLevel][TIMER_WHEEL_INDEX(psTmr->ulExpire, ucLevel)], &psTmr->sNode);
+}
+
+/**************************************************************
+*@brief 上层槽位下放，按剩余节拍重新挂入
+***************************************************************/
+static void vTimerWheelCascade(uint8_t ucLevel, uint32_t ulIndex)
+{
+    sTimerNode  sList;
+    sTimerNode* psNode = NULL;
+
+    vTimerListMove(&TimerWheel[ucLevel][ulIndex], &sList);
+    while(sList.pNext != &sList)
     {
-//        p_tmr->Dly    = dly;
-//        p_tmr->Period = period;
-//        if(p_callback != NULL)
-//        {
-//            p_tmr->CallbackPtr = p_callback;
-//        }
-//        if(p_callback_arg != NULL)
-//        {
-//            p_tmr->CallbackPtrArg = p_callback_arg;
-//        }
-        OSTmrDel(p_tmr, &err);
-        OSTmrCreate(p_tmr, "Tmr", dly, period, opt, p_callback, (void*)p_callback_arg, &err); 
+        psNode = sList.pNext;
+        vTimerListDel(psNode);
+        vTimerWheelAdd((sTimer*)psNode);
+        TimerWheelStats.ulCascade++;
     }
-    if(err == OS_ERR_NONE)
+}
+
+/**************************************************************
+*@brief 按延时(节拍)挂入时间轮，延时为0时按周期，调用者需锁调度
+***************************************************************/
+static void vTimerArm(sTimer* psTmr, uint32_t ulDly)
+{
+    if(psTmr->ucState == OS_TMR_STATE_RUNNING)
     {
-        if(xExcuteCallback && p_callback != NULL)  //是否首先执行回调函数
+        vTimerListDel(&psTmr->sNode);
+    }
+    psTmr->ulDly    = ulDly;
+    psTmr->ulExpire = TimerWheelJiffies + ((ulDly > 0) ? ulDly : psTmr->ulPeriod);
+    psTmr->ucState  = OS_TMR_STATE_RUNNING;
+    vTimerWheelAdd(psTmr);
+}
+
+/*秒转节拍，超出时间轮范围取最大值*/
+static uint32_t ulTimerTicks(uint32_t ulTime_s)
+{
+    if(ulTime_s > TIMER_WHEEL_MAX_TICKS / TIMER_WHEEL_TICK_PER_S)
+    {
+        return TIMER_WHEEL_MAX_TICKS;
+    }
+    return ulTime_s * TIMER_WHEEL_TICK_PER_S;
+}
+
+/**************************************************************
+*@brief 时间轮节拍，由内核定时器周期回调，当前槽位整体取出批量处理
+***************************************************************/
+static void vTimerWheelTick(void* p_tmr, void* p_arg)
+{
+    OS_ERR   err = OS_ERR_NONE;
+    uint8_t  ucLevel;
+    uint16_t usExpireNum = 0;
+    uint32_t ulSlot, ulIndex;
+
+    sTimerNode sList;
+    sTimer*    psTmr = NULL;
+
+    OSSchedLock(&err);
+
+    ulSlot  = TimerWheelJiffies & TIMER_WHEEL_MASK;
+    ulIndex = ulSlot;
+    for(ucLevel = 1; (ulIndex == 0) && (ucLevel < TIMER_WHEEL_LEVEL_NUM); ucLevel++)  //下层转完一圈
+    {
+        ulIndex = TIMER_WHEEL_INDEX(TimerWheelJiffies, ucLevel);
+        vTimerWheelCascade(ucLevel, ulIndex);
+    }
+    vTimerListMove(&TimerWheel[0][ulSlot], &sList);
+    TimerWheelJiffies++;
+
+    while(sList.pNext != &sList)
+    {
+        psTmr = (sTimer*)sList.pNext;
+        vTimerListDel(&psTmr->sNode);
+        usExpireNum++;
+
+        if(psTmr->opt == OS_OPT_TMR_PERIODIC)   //周期定时器先重新挂入，回调中可直接停止
         {
-            p_callback(p_tmr, p_callback_arg);
+            psTmr->ulExpire += psTmr->ulPeriod;
+            vTimerWheelAdd(psTmr);
+        }
+        else
+        {
+            psTmr->ucState = OS_TMR_STATE_COMPLETED;
+        }
+        if(psTmr->pxCallback != NULL)
+        {
+            OSSchedUnlock(&err);
+            psTmr->pxCallback((void*)psTmr, psTmr->pvArg);
+            OSSchedLock(&err);
         }
-        OSTmrStart(p_tmr, &err);
     }
-    else
+    TimerWheelStats.ulExpire += usExpireNum;
+    if(usExpireNum > TimerWheelStats.usTickMax)
+    {
+        TimerWheelStats.usTickMax = usExpireNum;
+    }
+    OSSchedUnlock(&err);
+}
+
+/**************************************************************
+*@brief 时间轮初始化，所有定时器共用一个内核定时器
+***************************************************************/
+void vTimerInit(void)
+{
+    OS_ERR  err = OS_ERR_NONE;
+    uint8_t i, j;
+
+    for(i = 0; i < TIMER_WHEEL_LEVEL_NUM; i++)
+    {
+        for(j = 0; j < TIMER_WHEEL_SIZE; j++)
+        {
+            vTimerListInit(&TimerWheel[i][j]);
+        }
+    }
+    OSTmrCreate(&TimerWheelTmr, "TimerWheelTmr", 0, TMR_TICK_PER_SECOND * TIMER_WHEEL_TICK_MS / 1000,
+                OS_OPT_TMR_PERIODIC, vTimerWheelTick, NULL, &err);
+    OSTmrStart(&TimerWheelTmr, &err);
+
+    TimerWheelReady = (err == OS_ERR_NONE);
+}
+
+/**************************************************************
+*@brief 定时器注册，运行中则先摘除再按新参数挂入，O(1)
+***************************************************************/
+BOOL xTimerRegist(sTimer *p_tmr, uint32_t ulDlyTime_s, uint32_t ulPeriod_s, OS_OPT opt,
+                  OS_TMR_CALLBACK_PTR p_callback, void *p_callback_arg, uint8_t xExcuteCallback)
+{
+    OS_ERR   err    = OS_ERR_NONE;
+    uint32_t dly    = ulTimerTicks(ulDlyTime_s);
+    uint32_t period = ulTimerTicks(ulPeriod_s);
+
+    //与OSTmrCreate参数检查一致：单次定时器延时不为0，周期定时器周期不为0
+    if( (p_tmr == NULL) || (TimerWheelReady == FALSE) ||
+        ((opt == OS_OPT_TMR_ONE_SHOT) && (dly == 0)) || ((opt == OS_OPT_TMR_PERIODIC) && (period == 0)) )
+    {
+        myprintf("xTimerRegist usDlyTime_s %d  ulPeriod_s %d  err\n", ulDlyTime_s, ulPeriod_s);
+        return FALSE;
+    }
+    OSSchedLock(&err);
+    TimerWheelStats.ulRegist++;
+    if(p_tmr->ucState == OS_TMR_STATE_RUNNING)
+    {
+        vTimerListDel(&p_tmr->sNode);
+    }
+    p_tmr->ulDly      = dly;
+    p_tmr->ulPeriod   = period;
+    p_tmr->opt        = opt;
+    p_tmr->pxCallback = p_callback;
+    p_tmr->pvArg      = p_callback_arg;
+    p_tmr->ucState    = OS_TMR_STATE_STOPPED;
+    OSSchedUnlock(&err);
+
+    if(xExcuteCallback && p_callback != NULL)  //是否首先执行回调函数
+    {
+        p_callback((void*)p_tmr, p_callback_arg);
+    }
+
+    OSSchedLock(&err);
+    if(p_tmr->ucState != OS_TMR_STATE_RUNNING)  //回调中未重新注册
     {
-        myprintf("xTimerRegist usDlyTime_s %d  ulPeriod_s %d  err %d\n", ulDlyTime_s, ulPeriod_s, err);
+        vTimerArm(p_tmr, dly);
     }
-    return err == OS_ERR_NONE;
+    OSSchedUnlock(&err);
+
+    return TRUE;
 }
 
 /**************************************************************
-*@brief 定时器剩余计时
+*@brief 绑定定时器类型与回调但不启动，之后由xTmrRearm/xTmrStartIfIdle
+*       按需启动，控制逻辑中无需重复注册
 ***************************************************************/
-uint32_t ulGetTmrElapsedTime(OS_TMR *p_tmr)
+BOOL xTimerCreate(sTimer *p_tmr, OS_OPT opt, OS_TMR_CALLBACK_PTR p_callback, void *p_callback_arg)
 {
     OS_ERR err = OS_ERR_NONE;
-    return  OSTmrRemainGet(p_tmr, &err) / TMR_TICK_PER_SECOND;
+
+    if(p_tmr == NULL)
+    {
+        return FALSE;
+    }
+    OSSchedLock(&err);
+    if(p_tmr->ucState == OS_TMR_STATE_RUNNING)
+    {
+        vTimerListDel(&p_tmr->sNode);
+    }
+    p_tmr->ulDly      = 0;
+    p_tmr->ulPeriod   = 0;
+    p_tmr->opt        = opt;
+    p_tmr->pxCallback = p_callback;
+    p_tmr->pvArg      = p_callback_arg;
+    p_tmr->ucState    = OS_TMR_STATE_STOPPED;
+    OSSchedUnlock(&err);
+
+    return TRUE;
 }
 
 /**************************************************************
-*@brief 定时器状态
+*@brief 按已注册参数重新启动定时器，O(1)
 ***************************************************************/
-OS_STATE usGetTmrState(OS_TMR *p_tmr)
+BOOL xTmrStart(sTimer *p_tmr)
 {
-    OS_ERR err     = OS_ERR_NONE;
+    OS_ERR err = OS_ERR_NONE;
+
+    if( (p_tmr->ucState == OS_TMR_STATE_UNUSED) || ((p_tmr->ulDly == 0) && (p_tmr->ulPeriod == 0)) )  //未注册
+    {
+        return FALSE;
+    }
+    OSSchedLock(&err);
+    vTimerArm(p_tmr, p_tmr->ulDly);
+    TimerWheelStats.ulRearm++;
+    OSSchedUnlock(&err);
 
-    OS_STATE  sTmrState = OSTmrStateGet(p_tmr, &err);
-    return  sTmrState; 
+    return TRUE;
 }
 
 /**************************************************************
-*@brief 停止定时器
+*@brief 按新延时原位重新启动，其余注册参数不变，O(1)
 ***************************************************************/
-BOOL xTmrStop(OS_TMR *p_tmr)
+BOOL xTmrRearm(sTimer *p_tmr, uint32_t ulDlyTime_s)
+{
+    OS_ERR   err = OS_ERR_NONE;
+    uint32_t dly = ulTimerTicks(ulDlyTime_s);
+
+    if( (p_tmr == NULL) || (p_tmr->ucState == OS_TMR_STATE_UNUSED) ||
+        ((dly == 0) && ((p_tmr->opt == OS_OPT_TMR_ONE_SHOT) || (p_tmr->ulPeriod == 0))) )
+    {
+        return FALSE;
+    }
+    OSSchedLock(&err);
+    vTimerArm(p_tmr, dly);
+    TimerWheelStats.ulRearm++;
+    OSSchedUnlock(&err);
+
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 未运行时按新延时启动，运行中不打断已有计时，返回是否启动
+***************************************************************/
+BOOL xTmrStartIfIdle(sTimer *p_tmr, uint32_t ulDlyTime_s)
 {
     OS_ERR err     = OS_ERR_NONE;
-    OSTmrStop(p_tmr, OS_OPT_TMR_NONE, NULL, &err);
-    
-    return err == OS_ERR_NONE;
+    BOOL   xResult = FALSE;
+
+    if(p_tmr == NULL)
+    {
+        return FALSE;
+    }
+    OSSchedLock(&err);     //调度锁可嵌套，判断与启动之间不被打断
+    if(p_tmr->ucState == OS_TMR_STATE_RUNNING)
+    {
+        TimerWheelStats.ulIdleSkip++;
+    }
+    else
+    {
+        xResult = xTmrRearm(p_tmr, ulDlyTime_s);
+    }
+    OSSchedUnlock(&err);
+
+    return xResult;
+}
+
+/**************************************************************
+*@brief 修改周期，不打断当前计时，从下次到期起按新周期重装
+***************************************************************/
+BOOL xTmrChangePeriod(sTimer *p_tmr, uint32_t ulPeriod_s)
+{
+    OS_ERR   err    = OS_ERR_NONE;
+    uint32_t period = ulTimerTicks(ulPeriod_s);
+
+    if( (p_tmr == NULL) || (p_tmr->ucState == OS_TMR_STATE_UNUSED) ||
+        ((p_tmr->opt == OS_OPT_TMR_PERIODIC) && (period == 0)) )
+    {
+        return FALSE;
+    }
+    OSSchedLock(&err);
+    if(p_tmr->ulPeriod != period)
+    {
+        p_tmr->ulPeriod = period;
+        TimerWheelStats.ulPeriodChange++;
+    }
+    OSSchedUnlock(&err);
+
+    return TRUE;
+}
+
+/**************************************************************
+*@brief 定时器剩余计时(s)
+***************************************************************/
+uint32_t ulGetTmrElapsedTime(sTimer *p_tmr)
+{
+    if(p_tmr->ucState != OS_TMR_STATE_RUNNING)
+    {
+        return 0;
+    }
+    return (p_tmr->ulExpire - TimerWheelJiffies) / TIMER_WHEEL_TICK_PER_S;
+}
+
+/**************************************************************
+*@brief 定时器状态
+***************************************************************/
+OS_STATE usGetTmrState(sTimer *p_tmr)
+{
+    return p_tmr->ucState;
+}
+
+/**************************************************************
+*@brief 停止定时器，O(1)
+***************************************************************/
+BOOL xTmrStop(sTimer *p_tmr)
+{
+    OS_ERR err = OS_ERR_NONE;
+    BOOL   xRunning;
+
+    OSSchedLock(&err);
+    xRunning = (p_tmr->ucState == OS_TMR_STATE_RUNNING);
+    if(xRunning)
+    {
+        vTimerListDel(&p_tmr->sNode);
+        p_tmr->ucState = OS_TMR_STATE_STOPPED;
+        TimerWheelStats.ulStop++;
+    }
+    OSSchedUnlock(&err);
+
+    return xRunning;
+}
+
+/**************************************************************
+*@brief 时间轮运行统计
+***************************************************************/
+const sTimerStats* psTimerGetStats(void)
+{
+    return &TimerWheelStats;
 }
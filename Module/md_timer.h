@@ -8,11 +8,58 @@
 
 #define TIMER_HANDLE uint16_t
 
-BOOL xTimerRegist(OS_TMR *p_tmr, uint32_t ulDlyTime_s, uint32_t ulPeriod_s, OS_OPT opt, 
+#define TIMER_WHEEL_TICK_MS      100                                  //时间轮节拍(ms)
+#define TIMER_WHEEL_TICK_PER_S   (1000 / TIMER_WHEEL_TICK_MS)         //每秒节拍数
+#define TIMER_WHEEL_BITS         6                                    //每层槽位数 2^6
+#define TIMER_WHEEL_SIZE         (1UL << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK         (TIMER_WHEEL_SIZE - 1)
+#define TIMER_WHEEL_LEVEL_NUM    4                                    //层数，最长定时2^24节拍(约19天)
+#define TIMER_WHEEL_MAX_TICKS    ((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVEL_NUM)) - 1)
+
+typedef struct sTimerNode  /*侵入式双向链表节点*/
+{
+    struct sTimerNode*   pNext;
+    struct sTimerNode*   pPrev;
+}sTimerNode;
+
+typedef struct  /*时间轮定时器，状态沿用OS_TMR_STATE_xxx*/
+{
+    sTimerNode           sNode;         //槽位挂接节点，必须为首成员
+    uint32_t             ulExpire;      //到期节拍
+    uint32_t             ulDly;         //首次延时(节拍)
+    uint32_t             ulPeriod;      //周期(节拍)
+    OS_OPT               opt;           //OS_OPT_TMR_ONE_SHOT/OS_OPT_TMR_PERIODIC
+    OS_STATE             ucState;       //定时器状态
+    OS_TMR_CALLBACK_PTR  pxCallback;    //到期回调，在系统定时器任务中执行
+    void*                pvArg;         //回调参数
+}sTimer;
+
+typedef struct  /*时间轮运行统计，用于观察定时器抖动(频繁重装/停止)*/
+{
+    uint32_t             ulRegist;      //xTimerRegist次数
+    uint32_t             ulRearm;       //原位重装次数(xTmrStart/xTmrRearm/xTmrStartIfIdle)
+    uint32_t             ulIdleSkip;    //xTmrStartIfIdle因运行中跳过次数
+    uint32_t             ulPeriodChange;//xTmrChangePeriod次数
+    uint32_t             ulStop;        //运行中被停止次数
+    uint32_t             ulExpire;      //到期次数
+    uint32_t             ulCascade;     //上层槽位下放的定时器数
+    uint16_t             usTickMax;     //单节拍最大到期数
+}sTimerStats;
+
+void vTimerInit(void);
+
+BOOL xTimerRegist(sTimer *p_tmr, uint32_t ulDlyTime_s, uint32_t ulPeriod_s, OS_OPT opt,
                   OS_TMR_CALLBACK_PTR p_callback, void *p_callback_arg, uint8_t xExcuteCallback);
-BOOL xTmrStop(OS_TMR *p_tmr);
+BOOL xTimerCreate(sTimer *p_tmr, OS_OPT opt, OS_TMR_CALLBACK_PTR p_callback, void *p_callback_arg);
+BOOL xTmrStart(sTimer *p_tmr);
+BOOL xTmrRearm(sTimer *p_tmr, uint32_t ulDlyTime_s);
+BOOL xTmrStartIfIdle(sTimer *p_tmr, uint32_t ulDlyTime_s);
+BOOL xTmrChangePeriod(sTimer *p_tmr, uint32_t ulPeriod_s);
+BOOL xTmrStop(sTimer *p_tmr);
+
+uint32_t ulGetTmrElapsedTime(sTimer *p_tmr);
+OS_STATE usGetTmrState(sTimer *p_tmr);
 
-uint32_t ulGetTmrElapsedTime(OS_TMR *p_tmr);
-OS_STATE usGetTmrState(OS_TMR *p_tmr);
+const sTimerStats* psTimerGetStats(void);
 
-#endif
\ No newline at end of file
+#endif
@@ -37,6 +37,10 @@
 // 是否支持内存泄露检测，缺省不支持
 //#define LW_OOPC_SUPPORT_MEMORY_LEAK_DETECTOR
 
+// 是否使用静态对象池，缺省使用。各类须定义最大实例数type##_POOL_NUM，
+// type##_new从本类对象池顺序取出(O(1))，不使用堆，链接映射中可见各类对象池大小
+#define LW_OOPC_USE_STATIC_POOL
+
 #include "stdlib.h"
 
 typedef int lw_oopc_bool;
@@ -74,6 +78,33 @@ void lw_oopc_report();
 
 #endif
 
+#ifdef LW_OOPC_USE_STATIC_POOL
+
+#if defined(__CC_ARM)
+#define LW_OOPC_POOL_SECTION __attribute__((section("LW_OOPC_POOL"), zero_init))
+#elif defined(__GNUC__)
+#define LW_OOPC_POOL_SECTION __attribute__((section(".bss.lw_oopc_pool")))
+#else
+#define LW_OOPC_POOL_SECTION
+#endif
+
+typedef struct LW_OOPC_Pool    // 对象池使用情况
+{
+    const char*     type;      // 类名
+    size_t          size;      // 单个对象大小
+    unsigned short  num;       // 最大实例数
+    unsigned short  used;      // 已取出实例数
+} LW_OOPC_Pool;
+
+#define LW_OOPC_POOL_DECLARE(type)  extern LW_OOPC_Pool type##_PoolInfo;
+#define LW_OOPC_POOL_INFO(type)     (&type##_PoolInfo)
+
+#else
+
+#define LW_OOPC_POOL_DECLARE(type)
+
+#endif
+
 #define INTERFACE(type)             \
 typedef struct type type;           \
 void type##_ctor(type* t);          \
@@ -89,6 +120,7 @@ struct type
 
 #define CLASS(type)                 \
 typedef struct type type;           \
+LW_OOPC_POOL_DECLARE(type)          \
 type* type##_new(lw_oopc_file_line_params); \
 void type##_ctor(type* t);          \
 int type##_dtor(type* t);           \
@@ -109,6 +141,24 @@ struct type
 }                                                       \
                                                         \
 void type##_ctor(type* cthis) {
+#elif defined(LW_OOPC_USE_STATIC_POOL)
+// 对象池在启动阶段由初始化任务顺序取出，对象常驻不归还
+#define CTOR(type)                                      \
+static struct type type##_Pool[type##_POOL_NUM] LW_OOPC_POOL_SECTION;    \
+LW_OOPC_Pool type##_PoolInfo = {#type, sizeof(struct type), type##_POOL_NUM, 0}; \
+                                                        \
+    type* type##_new() {                                \
+    struct type *cthis;                                 \
+    if(type##_PoolInfo.used >= type##_POOL_NUM)         \
+    {                                                   \
+        return 0;                                       \
+    }                                                   \
+    cthis = &type##_Pool[type##_PoolInfo.used++];       \
+    type##_ctor(cthis);                                 \
+    return cthis;                                       \
+}                                                       \
+                                                        \
+void type##_ctor(type* cthis) {
 #else
 #define CTOR(type)                                      \
     type* type##_new() {                                \
@@ -127,6 +177,19 @@ void type##_ctor(type* cthis) {
 
 #define END_CTOR	}
 
+// 只生成构造函数，不生成type##_new：用于静态单例或暂未实例化的类，以END_CTOR结束
+#define STATIC_CTOR(type)           \
+void type##_ctor(type* cthis) {
+
+#ifdef LW_OOPC_USE_STATIC_POOL
+#define DTOR(type)                  \
+void type##_delete(type* cthis)     \
+{                                   \
+        (void)type##_dtor(cthis);   \
+}                                   \
+int type##_dtor(type* cthis)        \
+{
+#else
 #define DTOR(type)                  \
 void type##_delete(type* cthis)     \
 {                                   \
@@ -137,6 +200,7 @@ void type##_delete(type* cthis)     \
 }                                   \
 int type##_dtor(type* cthis)        \
 {
+#endif
 
 #define END_DTOR }
 
@@ -12,11 +12,14 @@ void vSystem_CloseExAirFans(System* pt)
     System* pThis = (System*)pt;
     
     ExAirFan* pExAirFan = NULL;
+    
+    vDigitalOutputBegin();
     for(n=0; n < EX_AIR_FAN_NUM; n++)  
     {
         pExAirFan = pThis->psExAirFanList[n];
         pExAirFan->IDevSwitch.switchClose(SUPER_PTR(pExAirFan, IDevSwitch)); //关闭所有排风机
     }
+    vDigitalOutputCommit();
     (void)xTmrStop(&pThis->sExAirFanRequestTimeTmr);   //停止运行需求时间定时器
     (void)xTmrStop(&pThis->sExAirFanCtrlTmr);          //停止周期轮询
 }
@@ -138,11 +141,17 @@ void vSystem_ExAirFanRequestTimeTmrCallback(void* p_tmr, void* p_arg)
     }
 }
 
+/*排风机定时器初始化，运行需求时间定时器只绑定回调，按需原位重装*/
+void vSystem_InitExAirFanTmr(System* pt)
+{
+    System* pThis = (System*)pt;
+    (void)xTimerCreate(&pThis->sExAirFanRequestTimeTmr, OS_OPT_TMR_ONE_SHOT, vSystem_ExAirFanRequestTimeTmrCallback, pThis);
+}
+
 /*系统启停常开定频排风风机*/
 void vSystem_ExAirFanConstantAlwaysOpen(System* pt)
 {
     uint8_t   i, n, ucConstantNum, ucRunningNum;
-    OS_ERR    err   = OS_ERR_NONE;
     
     System*   pThis     = (System*)pt;
     ExAirFan* pExAirFan = NULL;   
@@ -180,6 +189,8 @@ void vSystem_ExAirFanConstantAlwaysOpen(System* pt)
             }
         }
     }
+    vDigitalOutputBegin();   //风机启停同时输出
+    
     //系统常开排风机个数 > 无故障定频排风机，则最大频率开启变频风机 
     if(pThis->ucConstantFanOpenNum > ucConstantNum && pThis->eExAirFanType == TYPE_CONSTANT_VARIABLE && 
        pThis->pExAirFanVariate->xExAirFanErr == FALSE && pThis->pExAirFanVariate != NULL && pThis->pExAirFanVariate->xExAirFanRemote == TRUE)
@@ -219,6 +230,7 @@ void vSystem_ExAirFanConstantAlwaysOpen(System* pt)
             }
         }
     }
+    vDigitalOutputCommit();
 //    ucConstantFanRequestNum = pThis->ucConstantFanRequestNum;   
 #if DEBUG_ENABLE > 0
     myprintf("vSystem_ExAirFanConstantAlwaysOpen  ucConstantFanRequestNum %d  ucRunningNum %d \n", pThis->ucConstantFanRequestNum, ucRunningNum);
@@ -230,7 +242,6 @@ void vSystem_ExAirFanConstantAlwaysOpen(System* pt)
 void vSystem_ExAirFanConstantSwitch(System* pt)
 {
     uint8_t   i, n, ucConstantNum, ucRunningNum;
-    OS_ERR    err   = OS_ERR_NONE;
     
     System*   pThis     = (System*)pt;
     ExAirFan* pExAirFan = NULL;   
@@ -268,6 +279,8 @@ void vSystem_ExAirFanConstantSwitch(System* pt)
             }
         }
     }
+    vDigitalOutputBegin();   //风机启停同时输出
+    
     //系统需求排风机个数 > 无故障定频排风机，则最大频率开启变频风机 
     if(pThis->ucConstantFanRequestNum > ucConstantNum && pThis->eExAirFanType == TYPE_CONSTANT_VARIABLE && 
        pThis->pExAirFanVariate->xExAirFanErr == FALSE && pThis->pExAirFanVariate != NULL && pThis->pExAirFanVariate->xExAirFanRemote == TRUE)
@@ -306,6 +319,7 @@ void vSystem_ExAirFanConstantSwitch(System* pt)
             }
         }
     }
+    vDigitalOutputCommit();
     ucConstantFanRequestNum = pThis->ucConstantFanRequestNum;   
 #if DEBUG_ENABLE > 0
     myprintf("vSystem_ExAirFanConstantSwitch  ucConstantFanRequestNum %d  ucRunningNum %d \n", pThis->ucConstantFanRequestNum, ucRunningNum);
@@ -396,7 +410,6 @@ void vSystem_ExAirRequest_Vol(System* pt)
 /*系统排风机控制周期定时器*/
 void vSystem_ExAirFanCtrlTmrCallback(void* p_tmr, void* p_arg)
 {
-    OS_ERR    err   = OS_ERR_NONE;
     System*   pThis = (System*)p_arg;
     ExAirFan* pExAirFan = NULL;
    
@@ -421,14 +434,13 @@ void vSystem_ExAirFanCtrlTmrCallback(void* p_tmr, void* p_arg)
                 vSystem_AdjustExAirFanFreq(pThis, pThis->usExAirFanMinFreq);        //最小频率
             
                //开启排风机运行定时器
-                if( OSTmrStateGet(&pThis->sExAirFanRequestTimeTmr, &err) != OS_TMR_STATE_RUNNING || 
+                if( usGetTmrState(&pThis->sExAirFanRequestTimeTmr) != OS_TMR_STATE_RUNNING || 
                     ulExAirFanRequestTime != pThis->ulExAirFanRequestTime )
                 {
                     ulExAirFanRequestTime = pThis->ulExAirFanRequestTime;
-                    xTimerRegist(&pThis->sExAirFanRequestTimeTmr, pThis->ulExAirFanRequestTime, 0, 
-                                 OS_OPT_TMR_ONE_SHOT, vSystem_ExAirFanRequestTimeTmrCallback, pThis, FALSE);
+                    (void)xTmrRearm(&pThis->sExAirFanRequestTimeTmr, pThis->ulExAirFanRequestTime);
 #if DEBUG_ENABLE > 0
-                    myprintf("xTimerRegist  vSystem_ExAirFanRequestTimeTmrCallback %ld\n", pThis->ulExAirFanRequestTime);
+                    myprintf("xTmrRearm  vSystem_ExAirFanRequestTimeTmrCallback %ld\n", pThis->ulExAirFanRequestTime);
 #endif
                 }
             }
@@ -448,15 +460,14 @@ void vSystem_ExAirFanCtrlTmrCallback(void* p_tmr, void* p_arg)
         if(pThis->ulExAirFanRequestTime >= pThis->usExAirFanRunTimeLeast)
         {
             //开启排风机运行定时器
-            if( OSTmrStateGet(&pThis->sExAirFanRequestTimeTmr, &err) != OS_TMR_STATE_RUNNING || 
+            if( usGetTmrState(&pThis->sExAirFanRequestTimeTmr) != OS_TMR_STATE_RUNNING || 
                 ulExAirFanRequestTime != pThis->ulExAirFanRequestTime )
             {
                 ulExAirFanRequestTime = pThis->ulExAirFanRequestTime;
                 vSystem_ExAirFanConstantSwitch(pThis);
-                xTimerRegist(&pThis->sExAirFanRequestTimeTmr, pThis->ulExAirFanRequestTime, 0, 
-                             OS_OPT_TMR_ONE_SHOT, vSystem_ExAirFanRequestTimeTmrCallback, pThis, FALSE);
+                (void)xTmrRearm(&pThis->sExAirFanRequestTimeTmr, pThis->ulExAirFanRequestTime);
 #if DEBUG_ENABLE > 0
-                myprintf("xTimerRegist  vSystem_ExAirFanRequestTimeTmrCallback %ld\n", pThis->ulExAirFanRequestTime);
+                myprintf("xTmrRearm  vSystem_ExAirFanRequestTimeTmrCallback %ld\n", pThis->ulExAirFanRequestTime);
 #endif
             }
         }
@@ -469,7 +480,6 @@ void vSystem_ExAirFanCtrlTmrCallback(void* p_tmr, void* p_arg)
 /*系统全定频排风风机控制*/
 void vSystem_ExAirFanConstantCtrl(System* pt)
 {
-    OS_ERR    err   = OS_ERR_NONE;
     System*   pThis = (System*)pt;
     
     if(pThis->eSystemMode == MODE_MANUAL || pThis->eSystemMode ==MODE_CLOSE)
@@ -483,11 +493,11 @@ void vSystem_ExAirFanConstantCtrl(System* pt)
     {
         vSystem_ExAirFanConstantAlwaysOpen(pThis);
         
-        if(OSTmrStateGet(&pThis->sExAirFanRequestTimeTmr, &err) == OS_TMR_STATE_RUNNING)    
+        if(usGetTmrState(&pThis->sExAirFanRequestTimeTmr) == OS_TMR_STATE_RUNNING)    
         {
             vSystem_ExAirFanConstantSwitch(pThis);      //处于运行需求定时期间防止风机故障或远程本地状态变化，要随时切换风机
         }
-        if(OSTmrStateGet(&pThis->sExAirFanCtrlTmr, &err) != OS_TMR_STATE_RUNNING || ucConstantFanRequestNum != pThis->ucConstantFanRequestNum)
+        if(usGetTmrState(&pThis->sExAirFanCtrlTmr) != OS_TMR_STATE_RUNNING || ucConstantFanRequestNum != pThis->ucConstantFanRequestNum)
         {
             //每个【排风机控制周期】（默认1800s）周期执行一次以下A、B、C逻辑
             (void)xTimerRegist(&pThis->sExAirFanCtrlTmr, 0, pThis->usExAirFanCtrlPeriod,  
@@ -531,7 +541,6 @@ void vSystem_AdjustExAirFanFreq(System* pt, uint16_t usFreq)
 void vSystem_ExAirFanBothCtrl(System* pt)
 {
     uint16_t  usFreq    = 0;
-    OS_ERR    err       = OS_ERR_NONE;
     System*   pThis     = (System*)pt;
     ExAirFan* pExAirFan = pThis->pExAirFanVariate;
     
@@ -571,11 +580,11 @@ void vSystem_ExAirFanBothCtrl(System* pt)
     }
     else    //否则，每个【排风机控制周期】（默认1800s）周期执行一次以下A、B、C逻辑：
     { 
-        if(OSTmrStateGet(&pThis->sExAirFanRequestTimeTmr, &err) == OS_TMR_STATE_RUNNING)    
+        if(usGetTmrState(&pThis->sExAirFanRequestTimeTmr) == OS_TMR_STATE_RUNNING)    
         {
             vSystem_ExAirFanConstantSwitch(pThis);        //处于运行需求定时期间防止风机故障或远程本地状态变化，要随时切换风机
         }
-        if(OSTmrStateGet(&pThis->sExAirFanCtrlTmr, &err) != OS_TMR_STATE_RUNNING || ucConstantFanRequestNum != pThis->ucConstantFanRequestNum)
+        if(usGetTmrState(&pThis->sExAirFanCtrlTmr) != OS_TMR_STATE_RUNNING || ucConstantFanRequestNum != pThis->ucConstantFanRequestNum)
         {
             (void)xTimerRegist(&pThis->sExAirFanCtrlTmr, 0, usExAirFanCtrlPeriod,  
                                OS_OPT_TMR_PERIODIC, vSystem_ExAirFanCtrlTmrCallback, pThis, TRUE);
@@ -711,8 +720,8 @@ void vSystem_SetExAirFanFreqRange(System* pt, uint16_t usMinFreq, uint16_t usMax
     System*   pThis     = (System*)pt;
     ExAirFan* pExAirFan = NULL;
     
-    pThis->usExAirFanMinFreq = usMinFreq;
-    pThis->usExAirFanMaxFreq = usMaxFreq;
+    EEPROM_SET(pThis->usExAirFanMinFreq, usMinFreq)
+    EEPROM_SET(pThis->usExAirFanMaxFreq, usMaxFreq)
   
 #if DEBUG_ENABLE > 0
     myprintf("vSystem_SetExAirFanFreqRange  usMinFreq %d  usMaxFreq %d\n", pThis->usExAirFanMinFreq, pThis->usExAirFanMaxFreq);
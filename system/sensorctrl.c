@@ -1,30 +1,71 @@
 #include "system.h"
 #include "systemctrl.h"
 
-/*系统CO2浓度变化*/
-void vSystem_CO2PPM(System* pt)
+/*系统传感器聚合初始化，按当前数值和故障状态计入*/
+void vSystem_InitSensorAgg(System* pt)
 {
-    uint8_t  n, ucCO2Num; 
-    uint16_t usTotalCO2PPM, usCO2PPM;   
-    
+    uint8_t n;
     System* pThis = (System*)pt;
-    
-    ModularRoof* pModularRoof = NULL;
-    CO2Sensor*   pCO2Sensor   = NULL;
-    
-    for(n=0, ucCO2Num=0, usTotalCO2PPM=0, usCO2PPM=0; n < CO2_SEN_NUM; n++)
+
+    (void)xAggregateInit(&pThis->sCO2Agg,     AGG_MEAN, pThis->sCO2AggMember,     NULL, CO2_SEN_NUM);
+    (void)xAggregateInit(&pThis->sTempOutAgg, AGG_MEAN, pThis->sTempOutAggMember, NULL, TEMP_HUMI_SEN_OUT_NUM);
+    (void)xAggregateInit(&pThis->sHumiOutAgg, AGG_MEAN, pThis->sHumiOutAggMember, NULL, TEMP_HUMI_SEN_OUT_NUM);
+    (void)xAggregateInit(&pThis->sTempInAgg,  AGG_MEAN, pThis->sTempInAggMember,  NULL, TEMP_HUMI_SEN_IN_NUM);
+    (void)xAggregateInit(&pThis->sHumiInAgg,  AGG_MEAN, pThis->sHumiInAggMember,  NULL, TEMP_HUMI_SEN_IN_NUM);
+
+    for(n=0; n < CO2_SEN_NUM; n++)
     {
-        pCO2Sensor = (CO2Sensor*)pThis->psCO2SenList[n];
-        if(pCO2Sensor->xCO2SenErr == FALSE)
-        {
-            usTotalCO2PPM = usTotalCO2PPM + pCO2Sensor->usAvgCO2PPM;
-            ucCO2Num++;
-        }  
+        vSystem_CO2SensorUpdate(pThis, pThis->psCO2SenList[n]);
+    }
+    for(n=0; n < TEMP_HUMI_SEN_OUT_NUM; n++)
+    {
+        vSystem_TempHumiSensorUpdate(pThis, pThis->psTempHumiSenOutList[n]);
+    }
+    for(n=0; n < TEMP_HUMI_SEN_IN_NUM; n++)
+    {
+        vSystem_TempHumiSensorUpdate(pThis, pThis->psTempHumiSenInList[n]);
+    }
+}
+
+/*CO2传感器数据更新，按设备序号增量计入系统聚合*/
+void vSystem_CO2SensorUpdate(System* pt, CO2Sensor* pCO2Sensor)
+{
+    System* pThis = (System*)pt;
+
+    vAggregateUpdate(&pThis->sCO2Agg, pCO2Sensor->Sensor.Device.ucDevIndex,
+                     pCO2Sensor->usAvgCO2PPM, pCO2Sensor->xCO2SenErr == FALSE);
+}
+
+/*温湿度传感器数据更新，按传感器类型和设备序号增量计入系统聚合*/
+void vSystem_TempHumiSensorUpdate(System* pt, TempHumiSensor* pTempHumiSensor)
+{
+    uint8_t ucDevIndex;
+    System* pThis = (System*)pt;
+
+    ucDevIndex = pTempHumiSensor->Sensor.Device.ucDevIndex;
+    if(pTempHumiSensor->Sensor.eSensorType == TYPE_TEMP_HUMI_IN)
+    {
+        vAggregateUpdate(&pThis->sTempInAgg, ucDevIndex, pTempHumiSensor->sAvgTemp,  pTempHumiSensor->xTempSenErr == FALSE);
+        vAggregateUpdate(&pThis->sHumiInAgg, ucDevIndex, pTempHumiSensor->usAvgHumi, pTempHumiSensor->xHumiSenErr == FALSE);
     }
-    if(ucCO2Num != 0)
+    else
     {
-        usCO2PPM = usTotalCO2PPM / ucCO2Num;  //CO2平均浓度
+        vAggregateUpdate(&pThis->sTempOutAgg, ucDevIndex, pTempHumiSensor->sAvgTemp,  pTempHumiSensor->xTempSenErr == FALSE);
+        vAggregateUpdate(&pThis->sHumiOutAgg, ucDevIndex, pTempHumiSensor->usAvgHumi, pTempHumiSensor->xHumiSenErr == FALSE);
     }
+}
+
+/*系统CO2浓度变化*/
+void vSystem_CO2PPM(System* pt)
+{
+    uint8_t  n;
+    uint16_t usCO2PPM;
+
+    System* pThis = (System*)pt;
+    ModularRoof* pModularRoof = NULL;
+
+    usCO2PPM = (uint16_t)lAggregateGetValue(&pThis->sCO2Agg);  //CO2平均浓度
+
     if(pThis->usCO2PPM != usCO2PPM && pThis->xCO2SenErr == FALSE)
     {
         pThis->usCO2PPM = usCO2PPM;
@@ -43,7 +84,7 @@ void vSystem_CO2PPM(System* pt)
             vSystem_DelAlarmRequst(pThis); //否则申请消除声光报警
         }     
 #if DEBUG_ENABLE > 0
-    myprintf("vSystem_CO2PPM  pThis->usCO2PPM %d ucCO2Num %d\n", pThis->usCO2PPM, ucCO2Num);
+    myprintf("vSystem_CO2PPM  pThis->usCO2PPM %d ucCO2Num %d\n", pThis->usCO2PPM, pThis->sCO2Agg.usCount);
 #endif   
         vSystem_ExAirFanCtrl(pThis);  
     } 
@@ -53,22 +94,13 @@ void vSystem_CO2PPM(System* pt)
 void vSystem_CO2SensorErr(System* pt)
 {
     BOOL xCO2SenErr;
-    uint8_t  n, ucCO2Num;  
+    uint8_t  n;
     System* pThis = (System*)pt;
     
     ModularRoof* pModularRoof = NULL;
-    CO2Sensor*   pCO2Sensor   = NULL;
-    
-    for(n=0, ucCO2Num=0; n < CO2_SEN_NUM; n++)
-    {
-        pCO2Sensor = (CO2Sensor*)pThis->psCO2SenList[n];
-        if(pCO2Sensor->xCO2SenErr == FALSE)
-        {
-            ucCO2Num++;
-        }  
-    }
+
     //所有二氧化碳传感器均故障，下发一个总故障标志给空调机组
-    xCO2SenErr= (ucCO2Num == 0) ? TRUE:FALSE;
+    xCO2SenErr= (pThis->sCO2Agg.usCount == 0) ? TRUE:FALSE;
     if(pThis->xCO2SenErr != xCO2SenErr)
     {
         pThis->xCO2SenErr = xCO2SenErr;
@@ -88,7 +120,7 @@ void vSystem_CO2SensorErr(System* pt)
         }              
     }
 #if DEBUG_ENABLE > 0
-    myprintf("vSystem_CO2SensorErr ucTempNum %d  xCO2SenErr %d \n", ucCO2Num, pThis->xCO2SenErr);
+    myprintf("vSystem_CO2SensorErr ucTempNum %d  xCO2SenErr %d \n", pThis->sCO2Agg.usCount, pThis->xCO2SenErr);
 #endif     
     vSystem_CO2PPM(pThis);    
 }
@@ -96,40 +128,13 @@ void vSystem_CO2SensorErr(System* pt)
 /*系统室外温湿度变化*/
 void vSystem_TempHumiOut(System* pt)
 {
-    uint8_t  n, ucTempNum, ucHumiNum; 
-    int16_t  sTotalTemp, sAmbientOut_T;
-    uint16_t usTotalHumi, usAmbientOut_H;  
+    int16_t  sAmbientOut_T;
+    uint16_t usAmbientOut_H;
     
     System* pThis = (System*)pt;
     
-    ModularRoof*       pModularRoof = NULL;
-    TempHumiSensor* pTempHumiSensor = NULL;
-    
-    ucTempNum = 0;
-    ucHumiNum = 0;
-    
-    for(n=0,sTotalTemp=0,usTotalHumi=0, sAmbientOut_T=0, usAmbientOut_H=0; n < TEMP_HUMI_SEN_OUT_NUM; n++)
-    {
-        pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenOutList[n];
-        if(pTempHumiSensor->xTempSenErr == FALSE)
-        {
-            sTotalTemp  = sTotalTemp + pTempHumiSensor->sAvgTemp;
-            ucTempNum++;            
-        }
-        if(pTempHumiSensor->xHumiSenErr == FALSE)
-        {
-            usTotalHumi = usTotalHumi + pTempHumiSensor->usAvgHumi;
-            ucHumiNum++;
-        }           
-    }
-    if(ucTempNum != 0)
-    {
-        sAmbientOut_T  = sTotalTemp / ucTempNum;  //室外平均环境温度
-    }
-    if(ucHumiNum != 0)
-    {
-        usAmbientOut_H = usTotalHumi / ucHumiNum;  //室外平均环境湿度
-    }
+    sAmbientOut_T  = (int16_t)lAggregateGetValue(&pThis->sTempOutAgg);   //室外平均环境温度
+    usAmbientOut_H = (uint16_t)lAggregateGetValue(&pThis->sHumiOutAgg);  //室外平均环境湿度
 
     if(pThis->sAmbientOut_T != sAmbientOut_T || pThis->usAmbientOut_H != usAmbientOut_H)
     {
@@ -143,7 +148,7 @@ void vSystem_TempHumiOut(System* pt)
         } 
 #if DEBUG_ENABLE > 0
     myprintf("vSystem_TempHumiOut  sAmbientOut_T %d  usAmbientOut_H %d ucTempNum %d  ucHumiNum %d\n", 
-             pThis->sAmbientOut_T,  pThis->usAmbientOut_H, ucTempNum, ucHumiNum);
+             pThis->sAmbientOut_T,  pThis->usAmbientOut_H, pThis->sTempOutAgg.usCount, pThis->sHumiOutAgg.usCount);
 #endif         
         vSystem_ChangeUnitRunningMode(pThis);  //模式切换逻辑        
     }  
@@ -153,29 +158,11 @@ void vSystem_TempHumiOut(System* pt)
 void vSystem_TempHumiOutErr(System* pt)
 {
     BOOL xTempSenOutErr, xHumiSenOutErr;
-    uint8_t  n, ucTempNum, ucHumiNum;
-    
-    System*         pThis = (System*)pt;
-    TempHumiSensor* pTempHumiSensor = NULL;
-    
-    ucTempNum = 0;
-    ucHumiNum = 0;
-    
-    for(n=0; n < TEMP_HUMI_SEN_OUT_NUM; n++)
-    {
-        pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenOutList[n];
-        if(pTempHumiSensor->xTempSenErr == FALSE)
-        {
-            ucTempNum++;            
-        }
-        if(pTempHumiSensor->xHumiSenErr == FALSE)
-        {
-            ucHumiNum++;
-        }           
-    }
+    System* pThis = (System*)pt;
+
     //传感器全部故障
-    xTempSenOutErr = (ucTempNum == 0) ? TRUE:FALSE;
-    xHumiSenOutErr = (ucHumiNum == 0) ? TRUE:FALSE;
+    xTempSenOutErr = (pThis->sTempOutAgg.usCount == 0) ? TRUE:FALSE;
+    xHumiSenOutErr = (pThis->sHumiOutAgg.usCount == 0) ? TRUE:FALSE;
     
     if(pThis->xTempSenOutErr != xTempSenOutErr || pThis->xHumiSenOutErr != xHumiSenOutErr)
     {
@@ -195,7 +182,7 @@ void vSystem_TempHumiOutErr(System* pt)
     }
 #if DEBUG_ENABLE > 0
     myprintf("vSystem_TempHumiOutErr ucTempNum %d ucHumiNum %d xTempSenOutErr %d xHumiSenOutErr %d \n", 
-             ucTempNum, ucHumiNum, pThis->xTempSenOutErr, pThis->xHumiSenOutErr);
+             pThis->sTempOutAgg.usCount, pThis->sHumiOutAgg.usCount, pThis->xTempSenOutErr, pThis->xHumiSenOutErr);
 #endif     
     vSystem_TempHumiOut(pThis);
 }
@@ -203,40 +190,16 @@ void vSystem_TempHumiOutErr(System* pt)
 /*系统室内温湿度变化*/
 void vSystem_TempHumiIn(System* pt)
 {
-    uint8_t  n, ucTempNum, ucHumiNum; 
-    int16_t  sTotalTemp, sAmbientIn_T;
-    uint16_t usTotalHumi, usAmbientIn_H;  
-    
+    uint8_t  n;
+    int16_t  sAmbientIn_T;
+    uint16_t usAmbientIn_H;
+
     System* pThis = (System*)pt;
-    
     ModularRoof*    pModularRoof    = NULL;
-    TempHumiSensor* pTempHumiSensor = NULL;
 
-    ucTempNum = 0;
-    ucHumiNum = 0;
-    
-    for(n=0, sTotalTemp=0, usTotalHumi=0, sAmbientIn_T=0, usAmbientIn_H=0; n < TEMP_HUMI_SEN_IN_NUM; n++)
-    {
-        pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenInList[n]; 
-        if(pTempHumiSensor->xTempSenErr == FALSE)
-        {
-            sTotalTemp  = sTotalTemp + pTempHumiSensor->sAvgTemp;
-            ucTempNum++;            
-        }
-        if(pTempHumiSensor->xHumiSenErr == FALSE)
-        {
-            usTotalHumi = usTotalHumi + pTempHumiSensor->usAvgHumi;
-            ucHumiNum++;
-        }            
-    }
-    if(ucTempNum != 0)
-    {
-         sAmbientIn_T  = sTotalTemp / ucTempNum;  //室内平均环境温度
-    }
-    if(ucHumiNum != 0)
-    {
-         usAmbientIn_H = usTotalHumi / ucHumiNum;  //室内平均环境湿度
-    }
+    sAmbientIn_T  = (int16_t)lAggregateGetValue(&pThis->sTempInAgg);   //室内平均环境温度
+    usAmbientIn_H = (uint16_t)lAggregateGetValue(&pThis->sHumiInAgg);  //室内平均环境湿度
+
     for(n=0; n < MODULAR_ROOF_NUM; n++)
     {
         pModularRoof = pThis->psModularRoofList[n];
@@ -255,7 +218,8 @@ void vSystem_TempHumiIn(System* pt)
         } 
 #if DEBUG_ENABLE > 0
         myprintf("vSystem_TempHumiIn  sAmbientIn_T %d  usAmbientIn_H %d ucTempNum %d ucHumiNum %d  sTotalTemp %d usTotalHumi %d\n", 
-                  pThis->sAmbientIn_T, pThis->usAmbientIn_H, ucTempNum, ucHumiNum, sTotalTemp, usTotalHumi);
+                  pThis->sAmbientIn_T, pThis->usAmbientIn_H, pThis->sTempInAgg.usCount, pThis->sHumiInAgg.usCount,
+                  pThis->sTempInAgg.lSum, pThis->sHumiInAgg.lSum);
 #endif   
         vSystem_ChangeUnitRunningMode(pThis);  //模式切换逻辑   
     } 
@@ -265,34 +229,14 @@ void vSystem_TempHumiIn(System* pt)
 void vSystem_TempHumiInErr(System* pt)
 {
     BOOL xTempSenInErr, xHumiSenInErr;
-    uint8_t  n, ucTempNum, ucHumiNum;   
-    
-    int16_t  sTotalTemp = 0;
-    uint16_t usTotalHumi = 0;  
-    
+    uint8_t  n;
+
     System* pThis = (System*)pt;
-    
-    ModularRoof*       pModularRoof = NULL;
-    TempHumiSensor* pTempHumiSensor = NULL;
-    
-    ucTempNum = 0;
-    ucHumiNum = 0;
-    
-    for(n=0; n < TEMP_HUMI_SEN_IN_NUM; n++)
-    {
-        pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenInList[n]; 
-        if(pTempHumiSensor->xTempSenErr == FALSE)
-        {
-            ucTempNum++;            
-        }
-        if(pTempHumiSensor->xHumiSenErr == FALSE)
-        {
-            ucHumiNum++;
-        }            
-    }
+    ModularRoof* pModularRoof = NULL;
+
     //传感器全部故障
-    xTempSenInErr = (ucTempNum == 0) ? TRUE:FALSE;
-    xHumiSenInErr = (ucHumiNum == 0) ? TRUE:FALSE;
+    xTempSenInErr = (pThis->sTempInAgg.usCount == 0) ? TRUE:FALSE;
+    xHumiSenInErr = (pThis->sHumiInAgg.usCount == 0) ? TRUE:FALSE;
     
     if(pThis->xTempSenInErr != xTempSenInErr || pThis->xHumiSenInErr != xHumiSenInErr)
     {
@@ -319,7 +263,7 @@ void vSystem_TempHumiInErr(System* pt)
     }
 #if DEBUG_ENABLE > 0
     myprintf("vSystem_TempHumiInErr ucTempNum %d ucHumiNum %d xTempSenInErr %d xHumiSenInErr %d \n", 
-             ucTempNum, ucHumiNum, pThis->xTempSenInErr, pThis->xHumiSenInErr);
+             pThis->sTempInAgg.usCount, pThis->sHumiInAgg.usCount, pThis->xTempSenInErr, pThis->xHumiSenInErr);
 #endif  
     vSystem_TempHumiIn(pThis);
 }
@@ -16,14 +16,19 @@
 #define SYSTEM_POLL_TIME_OUT_S   10
 #define SYSTEM_POLL_INTERVAL_S   10
 
+#define SYSTEM_CTRL_MINOR_MS     500      //控制执行器小帧周期(ms)
+#define SYSTEM_CTRL_MAJOR_NUM    20       //大帧小帧数，大帧10s
+#define SYSTEM_CTRL_FRAMES(s)    ((s) * 1000 / SYSTEM_CTRL_MINOR_MS)
+
 #define MODE_CHANGE_TIME         1
 #define MODE_CHANGE_PERIOD       3
 #define MODE_ADJUST_TEMP         15
 
-#define HANDLE(p_arg1, p_arg2) if( (void*)psMsg->pvArg == (void*)(&p_arg1) )\
-         {p_arg2; myprintf("**********************HANDLE*********************\n");goto begin;}
+//事件响应绑定：变量变化时以p_arg3为参数调用p_arg2
+#define HANDLE(p_arg1, p_arg2, p_arg3) (void)xEventHandlerRegist((void*)(&p_arg1), (pxEventHandler)p_arg2, (void*)p_arg3);
 
 int16_t   LastAmbientIn_T = 0;         
+OS_TICK   SysFirstCtrlTick = 0;        //上电到系统开始响应控制的时间(tick)
          
 System*  psSystem = NULL;
 System   SystemCore;
@@ -88,39 +93,336 @@ void vSystem_ParameterSysn(System* pt)
         
         if(pThis->eRunningMode != RUN_MODE_WET)
         {
-            pModularRoof->usCoolTempSet = pThis->usTempSet;
-            pModularRoof->usHeatTempSet = pThis->usTempSet;
+            pModularRoof->usCoolTempSet = pThis->sCtrlIn.usTempSet;
+            pModularRoof->usHeatTempSet = pThis->sCtrlIn.usTempSet;
         }
-        pModularRoof->usHumidityMin   = pThis->usHumidityMin;
-        pModularRoof->usHumidityMax   = pThis->usHumidityMax;
+        pModularRoof->usHumidityMin   = pThis->sCtrlIn.usHumidityMin;
+        pModularRoof->usHumidityMax   = pThis->sCtrlIn.usHumidityMax;
         
-        pModularRoof->usCO2AdjustThr_V  = pThis->usCO2AdjustThr_V;
-        pModularRoof->usCO2AdjustDeviat = pThis->usCO2AdjustDeviat;
+        pModularRoof->usCO2AdjustThr_V  = pThis->sCtrlIn.usCO2AdjustThr_V;
+        pModularRoof->usCO2AdjustDeviat = pThis->sCtrlIn.usCO2AdjustDeviat;
         
-        pModularRoof->sAmbientIn_T  = pThis->sAmbientIn_T;
-        pModularRoof->usAmbientIn_H = pThis->usAmbientIn_H;
-        pModularRoof->usCO2PPM      = pThis->usCO2PPM;     
+        pModularRoof->sAmbientIn_T  = pThis->sCtrlIn.sAmbientIn_T;
+        pModularRoof->usAmbientIn_H = pThis->sCtrlIn.usAmbientIn_H;
+        pModularRoof->usCO2PPM      = pThis->sCtrlIn.usCO2PPM;     
     }
 
     //防止温度长时间不变化而导致无法切换模式
-    if(pThis->eSystemMode == MODE_AUTO && pThis->eSystemState != STATE_CLOSED && LastAmbientIn_T == pThis->sAmbientIn_T)
+    if(pThis->sCtrlIn.eSystemMode == MODE_AUTO && pThis->sCtrlIn.eSystemState != STATE_CLOSED && LastAmbientIn_T == pThis->sCtrlIn.sAmbientIn_T)
     {
         vSystem_ChangeUnitRunningMode(pThis);
     }
-    LastAmbientIn_T = pThis->sAmbientIn_T;
+    LastAmbientIn_T = pThis->sCtrlIn.sAmbientIn_T;
 }
 
-/*系统周期轮询*/
-void vSystem_PollTask(void *p_arg)
+/*控制输入快照，事件任务优先级更高，锁调度保证同一帧输入一致*/
+void vSystem_CtrlSnapshot(System* pt)
 {
     OS_ERR    err = OS_ERR_NONE;
+    System* pThis = (System*)pt;
+    
+    OSSchedLock(&err);
+    pThis->sCtrlIn.eSystemMode       = pThis->eSystemMode;
+    pThis->sCtrlIn.eSystemState      = pThis->eSystemState;
+    pThis->sCtrlIn.sAmbientIn_T      = pThis->sAmbientIn_T;
+    pThis->sCtrlIn.usAmbientIn_H     = pThis->usAmbientIn_H;
+    pThis->sCtrlIn.usCO2PPM          = pThis->usCO2PPM;
+    pThis->sCtrlIn.usTempSet         = pThis->usTempSet;
+    pThis->sCtrlIn.usEnergyTemp      = pThis->usEnergyTemp;
+    pThis->sCtrlIn.usTempDeviat      = pThis->usTempDeviat;
+    pThis->sCtrlIn.usHumidityMin     = pThis->usHumidityMin;
+    pThis->sCtrlIn.usHumidityMax     = pThis->usHumidityMax;
+    pThis->sCtrlIn.usCO2AdjustThr_V  = pThis->usCO2AdjustThr_V;
+    pThis->sCtrlIn.usCO2AdjustDeviat = pThis->usCO2AdjustDeviat;
+    OSSchedUnlock(&err);
+}
+
+/*系统周期轮询，由控制执行器按固定小帧调度*/
+void vSystem_PollTask(void *p_arg)
+{
     System* pThis = (System*)p_arg;
     
-    OSTimeDlyHMSM(0, 0, 60, 0, OS_OPT_TIME_HMSM_STRICT, &err);
-    while(DEF_TRUE)
-	{
-        OSTimeDlyHMSM(0, 0, 10, 0, OS_OPT_TIME_HMSM_STRICT, &err);
-        vSystem_ParameterSysn(pThis);
+    (void)xEEPROMDataWaitReady(0);   //参数恢复完成后开始轮询
+    vSystem_InitCtrlExec(pThis);
+    vCyclicTask(&pThis->sCtrlExec);
+}
+
+/***********************BMS事件响应函数***********************/
+void vSystem_BMSSystemMode(BMS* psBMS)
+{
+    vSystem_ChangeSystemMode(psSystem, psBMS->eSystemMode);
+}
+
+void vSystem_BMSRunningMode(BMS* psBMS)
+{
+    vSystem_SetUnitRunningMode(psSystem, psBMS->eRunningMode);
+}
+
+void vSystem_BMSAlarmClean(BMS* psBMS)
+{
+    vSystem_CleanAlarm(psSystem, &psBMS->xAlarmClean);
+}
+
+void vSystem_BMSAlarmEnable(BMS* psBMS)
+{
+    vSystem_AlarmEnable(psSystem, psBMS->xAlarmEnable);
+}
+
+void vSystem_BMSTempSet(BMS* psBMS)
+{
+    vSystem_SetTemp(psSystem, psBMS->usTempSet);
+}
+
+void vSystem_BMSFreAirSet(BMS* psBMS)
+{
+    vSystem_SetFreAir(psSystem, psBMS->usFreAirSet_Vol_H, psBMS->usFreAirSet_Vol_L);
+}
+
+void vSystem_BMSExAirRatio(BMS* psBMS)
+{
+    vSystem_ExAirRatio(psSystem, psBMS->ucExAirCoolRatio, psBMS->ucExAirHeatRatio);
+}
+
+void vSystem_BMSHumidity(BMS* psBMS)
+{
+    vSystem_SetHumidity(psSystem, psBMS->usHumidityMin, psBMS->usHumidityMax);
+}
+
+void vSystem_BMSCO2AdjustThr_V(BMS* psBMS)
+{
+    vSystem_SetCO2AdjustThr_V(psSystem, psBMS->usCO2AdjustThr_V);
+}
+
+void vSystem_BMSCO2AdjustDeviat(BMS* psBMS)
+{
+    vSystem_SetCO2AdjustDeviat(psSystem, psBMS->usCO2AdjustDeviat);
+}
+
+void vSystem_BMSExAirFanFreq(BMS* psBMS)
+{
+    vSystem_AdjustExAirFanFreq(psSystem, psBMS->usExAirFanFreq);
+}
+
+void vSystem_BMSExAirFanFreqRange(BMS* psBMS)
+{
+    vSystem_SetExAirFanFreqRange(psSystem, psBMS->usExAirFanMinFreq, psBMS->usExAirFanMaxFreq);
+}
+
+void vSystem_BMSExAirFanType(BMS* psBMS)
+{
+    vSystem_ChangeExAirFanType(psSystem, psBMS->eExAirFanType);
+}
+
+void vSystem_BMSExAirFanCtrlPeriod(BMS* psBMS)
+{
+    vSystem_SetExAirFanCtrlPeriod(psSystem, psBMS->usExAirFanCtrlPeriod);
+}
+
+void vSystem_BMSExAirFanRated(BMS* psBMS)
+{
+    vSystem_SetExAirFanRated(psSystem, psBMS->usExAirFanRated_Vol_H, psBMS->usExAirFanRated_Vol_L);
+}
+
+void vSystem_BMSAICalib(BMS* psBMS)
+{
+    uint8_t  n;
+    uint32_t ulCalib;
+    
+    for(n=0; n < AI_NUM; n++)
+    {
+        if(xAnalogInputSetCalib(n+1, psBMS->usAICalibGain[n], psBMS->sAICalibOffset[n]) == FALSE)   //参数无效恢复为当前值
+        {
+            ulCalib = ulAnalogInputGetCalib(n+1);
+            psBMS->usAICalibGain[n]  = (uint16_t)(ulCalib >> 16);
+            psBMS->sAICalibOffset[n] = (int16_t)(ulCalib & 0xFFFF);
+        }
+    }
+}
+
+/***********************主机事件响应函数***********************/
+void vSystem_ModularRoofSupAirTemp(ModularRoof* pModularRoof)
+{
+    vSystem_UnitSupAirTemp(psSystem, pModularRoof);
+}
+
+void vSystem_ModularRoofFreAir(ModularRoof* pModularRoof)
+{
+    vSystem_UnitUpdate(psSystem, pModularRoof);
+    vSystem_UnitFreAir(psSystem);
+}
+
+void vSystem_ModularRoofErr(ModularRoof* pModularRoof)
+{
+    vSystem_UnitUpdate(psSystem, pModularRoof);
+    vSystem_UnitErr(psSystem);
+}
+
+void vSystem_ModularRoofTempHumiIn(ModularRoof* pModularRoof)
+{
+    vSystem_UnitUpdate(psSystem, pModularRoof);
+    vSystem_UnitTempHumiIn(psSystem);
+}
+
+void vSystem_ModularRoofTempHumiOut(ModularRoof* pModularRoof)
+{
+    vSystem_UnitUpdate(psSystem, pModularRoof);
+    vSystem_UnitTempHumiOut(psSystem);
+}
+
+void vSystem_ModularRoofCO2PPM(ModularRoof* pModularRoof)
+{
+    vSystem_UnitUpdate(psSystem, pModularRoof);
+    vSystem_UnitCO2PPM(psSystem);
+}
+
+/***********************传感器事件响应函数***********************/
+void vSystem_CO2SenPPM(CO2Sensor* pCO2Sensor)
+{
+    vSystem_CO2SensorUpdate(psSystem, pCO2Sensor);
+    vSystem_CO2PPM(psSystem);
+}
+
+void vSystem_CO2SenErr(CO2Sensor* pCO2Sensor)
+{
+    vSystem_CO2SensorUpdate(psSystem, pCO2Sensor);
+    vSystem_CO2SensorErr(psSystem);
+}
+
+void vSystem_TempHumiSenOut(TempHumiSensor* pTempHumiSensor)
+{
+    vSystem_TempHumiSensorUpdate(psSystem, pTempHumiSensor);
+    vSystem_TempHumiOut(psSystem);
+}
+
+void vSystem_TempHumiSenOutErr(TempHumiSensor* pTempHumiSensor)
+{
+    vSystem_TempHumiSensorUpdate(psSystem, pTempHumiSensor);
+    vSystem_TempHumiOutErr(psSystem);
+}
+
+void vSystem_TempHumiSenIn(TempHumiSensor* pTempHumiSensor)
+{
+    vSystem_TempHumiSensorUpdate(psSystem, pTempHumiSensor);
+    vSystem_TempHumiIn(psSystem);
+}
+
+void vSystem_TempHumiSenInErr(TempHumiSensor* pTempHumiSensor)
+{
+    vSystem_TempHumiSensorUpdate(psSystem, pTempHumiSensor);
+    vSystem_TempHumiInErr(psSystem);
+}
+
+/*系统事件响应注册，每个监控变量绑定一个响应函数，事件到来时按监控ID直接调用*/
+void vSystem_RegistEventHandler(System* pt)
+{
+    uint8_t n;
+    System* pThis = (System*)pt;
+    
+    ModularRoof*    pModularRoof    = NULL;
+    ExAirFan*       pExAirFan       = NULL;
+    TempHumiSensor* pTempHumiSensor = NULL;
+    CO2Sensor*      pCO2Sensor      = NULL;
+    BMS*            psBMS           = BMS_Core();
+    
+    /***********************BMS事件响应***********************/
+    HANDLE(psBMS->eSystemMode,       vSystem_BMSSystemMode,   psBMS)  
+    HANDLE(psBMS->eRunningMode,      vSystem_BMSRunningMode,  psBMS) 
+    HANDLE(psBMS->xAlarmClean,       vSystem_BMSAlarmClean,   psBMS) 
+    HANDLE(psBMS->xAlarmEnable,      vSystem_BMSAlarmEnable,  psBMS)
+    HANDLE(psBMS->xExAirFanErrClean, vSystem_ExAirFanErrClean, pThis)         
+    
+    HANDLE(psBMS->usTempSet,         vSystem_BMSTempSet,      psBMS)
+    HANDLE(psBMS->usFreAirSet_Vol_H, vSystem_BMSFreAirSet,    psBMS)
+    HANDLE(psBMS->usFreAirSet_Vol_L, vSystem_BMSFreAirSet,    psBMS)
+    
+    HANDLE(psBMS->ucExAirCoolRatio,  vSystem_BMSExAirRatio,   psBMS)
+    HANDLE(psBMS->ucExAirHeatRatio,  vSystem_BMSExAirRatio,   psBMS)
+    
+    HANDLE(psBMS->usHumidityMin,     vSystem_BMSHumidity,     psBMS)
+    HANDLE(psBMS->usHumidityMax,     vSystem_BMSHumidity,     psBMS)
+    
+    HANDLE(psBMS->usCO2AdjustThr_V,  vSystem_BMSCO2AdjustThr_V,  psBMS)
+    HANDLE(psBMS->usCO2AdjustDeviat, vSystem_BMSCO2AdjustDeviat, psBMS)
+    
+    HANDLE(psBMS->usExAirFanFreq,    vSystem_BMSExAirFanFreq,      psBMS)
+    HANDLE(psBMS->usExAirFanMinFreq, vSystem_BMSExAirFanFreqRange, psBMS)
+    HANDLE(psBMS->usExAirFanMaxFreq, vSystem_BMSExAirFanFreqRange, psBMS)
+    
+    HANDLE(psBMS->eExAirFanType,        vSystem_BMSExAirFanType,       psBMS)
+    HANDLE(psBMS->usExAirFanCtrlPeriod, vSystem_BMSExAirFanCtrlPeriod, psBMS)
+    
+    HANDLE(psBMS->usExAirFanRated_Vol_H, vSystem_BMSExAirFanRated, psBMS)                                                                     
+    HANDLE(psBMS->usExAirFanRated_Vol_L, vSystem_BMSExAirFanRated, psBMS)
+    
+    for(n=0; n < AI_NUM; n++)
+    {
+        HANDLE(psBMS->usAICalibGain[n],  vSystem_BMSAICalib, psBMS)
+        HANDLE(psBMS->sAICalibOffset[n], vSystem_BMSAICalib, psBMS)
+    }
+
+    /***********************主机事件响应***********************/
+    for(n=0; n < MODULAR_ROOF_NUM; n++)
+    {
+        pModularRoof = pThis->psModularRoofList[n]; 
+        
+        HANDLE(pModularRoof->Device.eRunningState, vSystem_DeviceRunningState, pThis)
+        HANDLE(pModularRoof->eRunningMode,         vSystem_DeviceRunningState, pThis)
+        
+        HANDLE(pModularRoof->sSupAir_T,    vSystem_ModularRoofSupAirTemp, pModularRoof)
+        HANDLE(pModularRoof->usFreAir_Vol, vSystem_ModularRoofFreAir,     pModularRoof)            
+
+        HANDLE(pModularRoof->xStopErrFlag, vSystem_ModularRoofErr, pModularRoof)
+        HANDLE(pModularRoof->xCommErr,     vSystem_ModularRoofErr, pModularRoof)
+        
+        HANDLE(pModularRoof->sAmbientInSelf_T,  vSystem_ModularRoofTempHumiIn, pModularRoof)
+        HANDLE(pModularRoof->usAmbientInSelf_H, vSystem_ModularRoofTempHumiIn, pModularRoof)
+        
+        HANDLE(pModularRoof->sAmbientOutSelf_T,  vSystem_ModularRoofTempHumiOut, pModularRoof)
+        HANDLE(pModularRoof->usAmbientOutSelf_H, vSystem_ModularRoofTempHumiOut, pModularRoof)
+        
+        HANDLE(pModularRoof->usCO2PPMSelf, vSystem_ModularRoofCO2PPM, pModularRoof)
+    }
+
+    /***********************排风机事件响应***********************/
+    for(n=0; n < EX_AIR_FAN_NUM; n++)  
+    {
+        pExAirFan =  pThis->psExAirFanList[n];
+        
+        HANDLE(pExAirFan->xExAirFanErr,         vSystem_ExAirFanErr,          pThis)
+        HANDLE(pExAirFan->xExAirFanRemote,      vSystem_ExAirFanRemoteChange, pThis)
+        HANDLE(pExAirFan->Device.eRunningState, vSystem_DeviceRunningState,   pThis)
+    }
+
+    /***********************CO2传感器事件响应***********************/
+    for(n=0; n < CO2_SEN_NUM; n++)
+    {
+        pCO2Sensor = (CO2Sensor*)pThis->psCO2SenList[n];
+        
+        HANDLE(pCO2Sensor->usAvgCO2PPM, vSystem_CO2SenPPM, pCO2Sensor) 
+        HANDLE(pCO2Sensor->xCO2SenErr,  vSystem_CO2SenErr, pCO2Sensor)
+    }
+    
+    /***********************室外温湿度传感器事件响应***********************/
+    for(n=0; n < TEMP_HUMI_SEN_OUT_NUM; n++)
+    {
+        pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenOutList[n];
+        
+        HANDLE(pTempHumiSensor->sAvgTemp,    vSystem_TempHumiSenOut,    pTempHumiSensor) 
+        HANDLE(pTempHumiSensor->xTempSenErr, vSystem_TempHumiSenOutErr, pTempHumiSensor)
+        
+        HANDLE(pTempHumiSensor->usAvgHumi,   vSystem_TempHumiSenOut,    pTempHumiSensor) 
+        HANDLE(pTempHumiSensor->xHumiSenErr, vSystem_TempHumiSenOutErr, pTempHumiSensor)
+    }
+    
+    /***********************室内温湿度传感器事件响应***********************/
+    for(n=0; n < TEMP_HUMI_SEN_IN_NUM; n++)
+    {
+        pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenInList[n];  
+
+        HANDLE(pTempHumiSensor->sAvgTemp,    vSystem_TempHumiSenIn,    pTempHumiSensor)                 
+        HANDLE(pTempHumiSensor->usAvgHumi,   vSystem_TempHumiSenIn,    pTempHumiSensor)
+        HANDLE(pTempHumiSensor->xTempSenErr, vSystem_TempHumiSenInErr, pTempHumiSensor)            
+        HANDLE(pTempHumiSensor->xHumiSenErr, vSystem_TempHumiSenInErr, pTempHumiSensor)
     }
 }
 
@@ -134,17 +436,11 @@ void vSystem_EventPollTask(void *p_arg)
     
     System* pThis = (System*)p_arg;
     
-    ModularRoof*    pModularRoof    = NULL;
     ExAirFan*       pExAirFan       = NULL;
-    TempHumiSensor* pTempHumiSensor = NULL;
-    CO2Sensor*      pCO2Sensor      = NULL;
-    sEventMsg*      psMsg           = NULL;
+    sEventBatch*    psBatch         = NULL;
     BMS*            psBMS           = NULL;
     
-    while(xEEPROMDataIsReady() == FALSE)
-    {
-        OSTimeDlyHMSM(0, 0, 1, 0, OS_OPT_TIME_HMSM_STRICT, &err);
-    }
+    (void)xEEPROMDataWaitReady(0);
     psSystem = System_Core();
     psBMS    = BMS_Core();
     
@@ -167,109 +463,28 @@ void vSystem_EventPollTask(void *p_arg)
         myprintf("pExAirFan %d ulRunTime_S %ld  usRunTime_H %d \n", n, pExAirFan->Device.ulRunTime_S, pExAirFan->Device.usRunTime_H);
 #endif
     }
+    vSystem_RegistEventHandler(pThis);
+    
+    SysFirstCtrlTick = OSTimeGet(&err);
+    myprintf("vSystem_EventPollTask ready tick %ld  first ctrl tick %ld\n", ulEEPROMDataReadyTick(), SysFirstCtrlTick);
+    
     while(DEF_TRUE)
 	{ 
-begin:       
-        psMsg = (sEventMsg*)OSTaskQPend(0, OS_OPT_PEND_BLOCKING, &msgSize, NULL, &err);
-        if(psMsg == NULL || err != OS_ERR_NONE)
+        psBatch = (sEventBatch*)OSTaskQPend(0, OS_OPT_PEND_BLOCKING, &msgSize, NULL, &err);
+        if(psBatch == NULL || err != OS_ERR_NONE)
         {
             continue;
         }
-        /***********************BMS事件响应***********************/
-        HANDLE(psBMS->eSystemMode,       vSystem_ChangeSystemMode(psSystem, psBMS->eSystemMode))  
-        HANDLE(psBMS->eRunningMode,      vSystem_SetUnitRunningMode(psSystem, psBMS->eRunningMode)) 
-        HANDLE(psBMS->xAlarmClean,       vSystem_CleanAlarm(psSystem, &psBMS->xAlarmClean)) 
-        HANDLE(psBMS->xAlarmEnable,      vSystem_AlarmEnable(psSystem, psBMS->xAlarmEnable))
-        HANDLE(psBMS->xExAirFanErrClean, vSystem_ExAirFanErrClean(psSystem))         
-        
-        HANDLE(psBMS->usTempSet,         vSystem_SetTemp(psSystem, psBMS->usTempSet))
-        HANDLE(psBMS->usFreAirSet_Vol_H, vSystem_SetFreAir(psSystem, psBMS->usFreAirSet_Vol_H, psBMS->usFreAirSet_Vol_L))
-        HANDLE(psBMS->usFreAirSet_Vol_L, vSystem_SetFreAir(psSystem, psBMS->usFreAirSet_Vol_H, psBMS->usFreAirSet_Vol_L))
-        
-        HANDLE(psBMS->ucExAirCoolRatio, vSystem_ExAirRatio(psSystem, psBMS->ucExAirCoolRatio, psBMS->ucExAirHeatRatio))
-        HANDLE(psBMS->ucExAirHeatRatio, vSystem_ExAirRatio(psSystem, psBMS->ucExAirCoolRatio, psBMS->ucExAirHeatRatio))
-        
-        HANDLE(psBMS->usHumidityMin, vSystem_SetHumidity(psSystem, psBMS->usHumidityMin, psBMS->usHumidityMax))
-        HANDLE(psBMS->usHumidityMax, vSystem_SetHumidity(psSystem, psBMS->usHumidityMin, psBMS->usHumidityMax))
-        
-        HANDLE(psBMS->usCO2AdjustThr_V,  vSystem_SetCO2AdjustThr_V(psSystem, psBMS->usCO2AdjustThr_V))
-        HANDLE(psBMS->usCO2AdjustDeviat, vSystem_SetCO2AdjustDeviat(psSystem, psBMS->usCO2AdjustDeviat))
-        
-        HANDLE(psBMS->usExAirFanFreq,    vSystem_AdjustExAirFanFreq(psSystem, psBMS->usExAirFanFreq))
-        HANDLE(psBMS->usExAirFanMinFreq, vSystem_SetExAirFanFreqRange(psSystem, psBMS->usExAirFanMinFreq, psBMS->usExAirFanMaxFreq))
-        HANDLE(psBMS->usExAirFanMaxFreq, vSystem_SetExAirFanFreqRange(psSystem, psBMS->usExAirFanMinFreq, psBMS->usExAirFanMaxFreq))
-        
-        HANDLE(psBMS->eExAirFanType,        vSystem_ChangeExAirFanType(psSystem, psBMS->eExAirFanType))
-        HANDLE(psBMS->usExAirFanCtrlPeriod, vSystem_SetExAirFanCtrlPeriod(psSystem, psBMS->usExAirFanCtrlPeriod))
-        
-        HANDLE(psBMS->usExAirFanRated_Vol_H, vSystem_SetExAirFanRated(psSystem, psBMS->usExAirFanRated_Vol_H, psBMS->usExAirFanRated_Vol_L))                                                                     
-        HANDLE(psBMS->usExAirFanRated_Vol_L, vSystem_SetExAirFanRated(psSystem, psBMS->usExAirFanRated_Vol_H, psBMS->usExAirFanRated_Vol_L))
-
-        /***********************主机事件响应***********************/
-        for(n=0; n < MODULAR_ROOF_NUM; n++)
-        {
-            pModularRoof = pThis->psModularRoofList[n]; 
-            
-            HANDLE(pModularRoof->Device.eRunningState, vSystem_DeviceRunningState(psSystem))
-            HANDLE(pModularRoof->eRunningMode,         vSystem_DeviceRunningState(psSystem))
-            
-            HANDLE(pModularRoof->sSupAir_T,    vSystem_UnitSupAirTemp(psSystem, pModularRoof))
-            HANDLE(pModularRoof->usFreAir_Vol, vSystem_UnitFreAir(psSystem))            
- 
-            HANDLE(pModularRoof->xStopErrFlag, vSystem_UnitErr(psSystem))
-            HANDLE(pModularRoof->xCommErr,     vSystem_UnitErr(psSystem))
-            
-            HANDLE(pModularRoof->sAmbientInSelf_T,  vSystem_UnitTempHumiIn(psSystem))
-            HANDLE(pModularRoof->usAmbientInSelf_H, vSystem_UnitTempHumiIn(psSystem))
-            
-            HANDLE(pModularRoof->sAmbientOutSelf_T,  vSystem_UnitTempHumiOut(psSystem))
-            HANDLE(pModularRoof->usAmbientOutSelf_H, vSystem_UnitTempHumiOut(psSystem))
-            
-            HANDLE(pModularRoof->usCO2PPMSelf, vSystem_UnitCO2PPM(psSystem))
-        }
-
-        /***********************排风机事件响应***********************/
-        for(n=0; n < EX_AIR_FAN_NUM; n++)  
-        {
-            pExAirFan =  pThis->psExAirFanList[n];
-            
-            HANDLE(pExAirFan->xExAirFanErr,         vSystem_ExAirFanErr(psSystem))
-            HANDLE(pExAirFan->xExAirFanRemote,      vSystem_ExAirFanRemoteChange(psSystem))
-            HANDLE(pExAirFan->Device.eRunningState, vSystem_DeviceRunningState(psSystem))
-        }
-
-        /***********************CO2传感器事件响应***********************/
-        for(n=0; n < CO2_SEN_NUM; n++)
-        {
-            pCO2Sensor = (CO2Sensor*)pThis->psCO2SenList[n];
-            
-            HANDLE(pCO2Sensor->usAvgCO2PPM, vSystem_CO2PPM(psSystem)) 
-            HANDLE(pCO2Sensor->xCO2SenErr,  vSystem_CO2SensorErr(psSystem))
-        }
-        
-        /***********************室外温湿度传感器事件响应***********************/
-        for(n=0; n < TEMP_HUMI_SEN_OUT_NUM; n++)
+        for(n=0; n < psBatch->ucCount; n++)
         {
-            pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenOutList[n];
-            
-            HANDLE(pTempHumiSensor->sAvgTemp,    vSystem_TempHumiOut(psSystem)) 
-            HANDLE(pTempHumiSensor->xTempSenErr, vSystem_TempHumiOutErr(psSystem))
-            
-            HANDLE(pTempHumiSensor->usAvgHumi,   vSystem_TempHumiOut(psSystem)) 
-            HANDLE(pTempHumiSensor->xHumiSenErr, vSystem_TempHumiOutErr(psSystem))
-        }
-        
-        /***********************室内温湿度传感器事件响应***********************/
-        for(n=0; n < TEMP_HUMI_SEN_IN_NUM; n++)
-        {
-            pTempHumiSensor = (TempHumiSensor*)pThis->psTempHumiSenInList[n];  
-
-            HANDLE(pTempHumiSensor->sAvgTemp,    vSystem_TempHumiIn(psSystem))                 
-            HANDLE(pTempHumiSensor->usAvgHumi,   vSystem_TempHumiIn(psSystem))
-            HANDLE(pTempHumiSensor->xTempSenErr, vSystem_TempHumiInErr(psSystem))            
-            HANDLE(pTempHumiSensor->xHumiSenErr, vSystem_TempHumiInErr(psSystem))
+            if(xEventHandle(&psBatch->sMsgList[n]) == TRUE)
+            {
+#if DEBUG_ENABLE > 0 
+                myprintf("**********************HANDLE*********************\n");
+#endif
+            }
         }
-        myprintf("******************************OSTaskOver******************************\n");
+        vEventBatchRelease(psBatch);
     }
 }
 
@@ -279,7 +494,7 @@ BOOL xSystem_CreatePollTask(System* pt)
     OS_ERR    err = OS_ERR_NONE;
     System* pThis = (System*)pt;
 
-    err = eTaskCreate(psSysEventPollTaskTCB, vSystem_EventPollTask, pThis, SysEventPollTaskPrio, 
+    err = eEventTaskCreate(psSysEventPollTaskTCB, vSystem_EventPollTask, pThis, SysEventPollTaskPrio, 
                       psSysEventPollTaskStk, SysEventPollTaskStkSize);
 
     err = eTaskCreate(psSysPollTaskTCB, vSystem_PollTask, pThis, SysPollTaskPrio, 
@@ -287,14 +502,14 @@ BOOL xSystem_CreatePollTask(System* pt)
     return (err == OS_ERR_NONE);              
 }
 
-/*系统周期轮询定时器中断*/
-void vSystem_PollTmrCallback(void * p_tmr, void * p_arg)
+/*系统设备运行时间累计*/
+void vSystem_RuntimeAccount(System* pt)
 {
     uint8_t n;
     ModularRoof*    pModularRoof    = NULL;
     ExAirFan*       pExAirFan       = NULL;
     
-     System* pThis = (System*)p_arg;
+    System* pThis = (System*)pt;
     
     /*********************主机运行时间*************************/
     for(n=0; n < MODULAR_ROOF_NUM; n++)
@@ -331,11 +546,21 @@ void vSystem_PollTmrCallback(void * p_tmr, void * p_arg)
 //    vSystem_DeviceRunningState(pThis);
 }
     
-/*系统运行时间初始化*/
-void vSystem_InitRuntimeTmr(System* pt)
+/*控制执行器初始化：参数同步、运行时间累计与模式切换判断按声明周期错相执行。
+  声光报警仍由事件任务在数据变化时判断，不在执行器中重复执行*/
+void vSystem_InitCtrlExec(System* pt)
 {
     System* pThis = (System*)pt; 
-    (void)xTimerRegist(&pThis->sSysPollTmr, 0, SYSTEM_POLL_TIME_OUT_S, OS_OPT_TMR_PERIODIC, vSystem_PollTmrCallback, pThis, FALSE);                       
+    
+    (void)xCyclicInit(&pThis->sCtrlExec, SYSTEM_CTRL_MINOR_MS, SYSTEM_CTRL_MAJOR_NUM, ulCyclicClock_us);
+    vCyclicSetSnapshot(&pThis->sCtrlExec, (pxCyclicJob)vSystem_CtrlSnapshot, pThis);
+    
+    (void)xCyclicRegist(&pThis->sCtrlExec, SYS_JOB_PARAM_SYNC, (pxCyclicJob)vSystem_ParameterSysn, pThis, 
+                        SYSTEM_CTRL_FRAMES(SYSTEM_POLL_INTERVAL_S), 0, 0);
+    (void)xCyclicRegist(&pThis->sCtrlExec, SYS_JOB_RUNTIME, (pxCyclicJob)vSystem_RuntimeAccount, pThis, 
+                        SYSTEM_CTRL_FRAMES(SYSTEM_POLL_TIME_OUT_S), SYSTEM_CTRL_FRAMES(SYSTEM_POLL_TIME_OUT_S)/2, 0);
+    (void)xCyclicRegist(&pThis->sCtrlExec, SYS_JOB_MODE, (pxCyclicJob)vSystem_UnitRunningModeJob, pThis, 
+                        1, 0, 0);
 }
  
 /*系统EEPROM数据注册*/
@@ -464,6 +689,27 @@ void vSystem_InitDefaultData(System* pt)
 //    myprintf("vSystem_InitDefaultData ulExAirFanRated_Vol %ld \n\n", pThis->ulExAirFanRated_Vol);
 }
 
+#if DEBUG_ENABLE > 0 
+/*各类对象池使用情况*/
+void vSystem_ReportObjPool(void)
+{
+    uint8_t n;
+    const LW_OOPC_Pool* psPoolList[] = { LW_OOPC_POOL_INFO(ModularRoof),   LW_OOPC_POOL_INFO(SupAirFan),
+                                         LW_OOPC_POOL_INFO(Modular),       LW_OOPC_POOL_INFO(AmbientOutFan),
+                                         LW_OOPC_POOL_INFO(Compressor),    LW_OOPC_POOL_INFO(ExAirFan),
+                                         LW_OOPC_POOL_INFO(CO2Sensor),     LW_OOPC_POOL_INFO(TempHumiSensor),
+#if MB_MASTER_DTU_ENABLED  > 0
+                                         LW_OOPC_POOL_INFO(DTU),
+#endif
+                                       };
+    for(n = 0; n < sizeof(psPoolList) / sizeof(psPoolList[0]); n++)
+    {
+        myprintf("pool %s size %d used %d/%d ram %d\n", psPoolList[n]->type, psPoolList[n]->size,
+                 psPoolList[n]->used, psPoolList[n]->num, psPoolList[n]->size * psPoolList[n]->num);
+    }
+}
+#endif
+
 /*系统初始化*/
 void vSystem_Init(System* pt)
 {
@@ -496,8 +742,8 @@ void vSystem_Init(System* pt)
     }
 #endif 
     
-    /*实例化各设备对象时，要特别注意防止内存溢出，要根据设备多少调整堆区大小，
-      堆区大小通过修改startup_LPC407x_8x.s 文件中的Heap_Size*/
+    /*各设备对象从静态对象池取出，增减设备时须同步修改app_config.h中的
+      设备数量及对象池配置，对象池超限时type##_new返回NULL*/
                      
     /*********************主机*************************/
     for(n=0; n < MODULAR_ROOF_NUM; n++)
@@ -508,8 +754,6 @@ void vSystem_Init(System* pt)
         {
             pModularRoof->init(pModularRoof, pThis->psMBMasterInfo, ucDevAddr++, n); //初始化
             pThis->psModularRoofList[n] = pModularRoof;
-        
-            CONNECT( &pModularRoof->sValChange, psSysEventPollTaskTCB);  //绑定主机变量变化事件     
         } 
     }
     /*********************排风风机*************************/
@@ -520,8 +764,6 @@ void vSystem_Init(System* pt)
         {
             pExAirFan->init(pExAirFan, &ExAirFanSet[n], n);
             pThis->psExAirFanList[n] = pExAirFan; 
-            
-            CONNECT( &pExAirFan->sValChange, psSysEventPollTaskTCB);  //绑定风机变量变化事件  
         }     
     }
     /***********************CO2传感器***********************/
@@ -532,8 +774,6 @@ void vSystem_Init(System* pt)
         {
             pCO2Sensor->Sensor.init( SUPER_PTR(pCO2Sensor, Sensor),  pThis->psMBMasterInfo, TYPE_CO2, ucDevAddr++, n); //向上转型，由子类转为父类
             pThis->psCO2SenList[n] = pCO2Sensor;
-            
-            CONNECT( &pCO2Sensor->Sensor.sValChange, psSysEventPollTaskTCB);  //绑定传感器变量变化事件
         }
     }
     /***********************室外温湿度传感器***********************/
@@ -544,8 +784,6 @@ void vSystem_Init(System* pt)
         {
             pTempHumiSensor->Sensor.init( SUPER_PTR(pTempHumiSensor, Sensor),  pThis->psMBMasterInfo, TYPE_TEMP_HUMI_OUT, ucDevAddr++, n);
             pThis->psTempHumiSenOutList[n] = pTempHumiSensor;
-            
-            CONNECT( &pTempHumiSensor->Sensor.sValChange, psSysEventPollTaskTCB);  //绑定传感器变量变化事件 
         }          
     }
     /***********************室内温湿度传感器***********************/
@@ -556,8 +794,6 @@ void vSystem_Init(System* pt)
         {
             pTempHumiSensor->Sensor.init( SUPER_PTR(pTempHumiSensor, Sensor),  pThis->psMBMasterInfo, TYPE_TEMP_HUMI_IN, ucDevAddr++, n);
             pThis->psTempHumiSenInList[n] = pTempHumiSensor; 
-            
-            CONNECT( &pTempHumiSensor->Sensor.sValChange, psSysEventPollTaskTCB);  //绑定传感器变量变化事件    
         }
     } 
 //    /*********************电表*************************/
@@ -567,19 +803,26 @@ void vSystem_Init(System* pt)
 //    pThis->pUnitMeter->init(pThis->pUnitMeter, pThis->psMBMasterInfo, ucDevAddr++);
 //    pThis->pExAirFanMeter->init(pThis->pExAirFanMeter, pThis->psMBMasterInfo, ucDevAddr++);    
     
+    vSystem_InitUnitAgg(pThis);      //机组、传感器聚合，之后由事件响应增量更新
+    vSystem_InitSensorAgg(pThis);
+    vSystem_InitModeTmr(pThis);      //控制定时器先绑定回调，事件响应中原位重装
+    vSystem_InitExAirFanTmr(pThis);
+    
     (void)xSystem_CreatePollTask(pThis);
-    CONNECT( &(BMS_Core()->sValChange), psSysEventPollTaskTCB);  // 绑定BMS变量变化事件
+    SUBSCRIBE(TOPIC_ALL, psSysEventPollTaskTCB, EVENT_SUB_PRIO_DEFAULT)  //订阅所有设备变量变化事件(BMS、主机、风机、传感器)
     
     vSystem_InitDefaultData(pThis);
     vSystem_RegistEEPROMData(pThis);
-    
-    vSystem_InitRuntimeTmr(pThis);
+
     pThis->psBMS = (BMS*)BMS_Core();
     
+#if DEBUG_ENABLE > 0 
+    vSystem_ReportObjPool();
+#endif
     myprintf("vSystem_Init \n");   
 }
 
-CTOR(System)   //系统构造函数
+STATIC_CTOR(System)   //系统构造函数
     SUPER_CTOR(Device);
 END_CTOR
 
@@ -8,13 +8,42 @@
 #include "meter.h"
 #include "bms.h"
 #include "md_timer.h"
+#include "md_aggregate.h"
+#include "md_cyclic.h"
 
-#define EX_AIR_FAN_NUM          4        //排风机数量
-#define MODULAR_ROOF_NUM        2        //屋顶机数量 
-                                
-#define CO2_SEN_NUM             3        //CO2传感器数量
-#define TEMP_HUMI_SEN_OUT_NUM   1        //室外温湿度传感器数量
-#define TEMP_HUMI_SEN_IN_NUM    12       //室内温湿度传感器数量
+typedef enum   /*控制执行器任务槽位，同一小帧内按槽位顺序执行*/
+{
+    SYS_JOB_PARAM_SYNC  = 0,     //参数同步及模式切换判断
+    SYS_JOB_RUNTIME     = 1,     //设备运行时间累计
+    SYS_JOB_MODE        = 2,     //运行模式切换判断
+    SYS_JOB_NUM,
+}eSystemCtrlJob;
+
+#define MODE_TRANSITION_MAX_NUM 16       //模式切换表最大项数
+
+typedef struct  /*模式切换统计，按模式切换表序号计数*/
+{
+    uint32_t          ulEvalCount;                           //判断次数
+    uint16_t          usEvalMax_us;                          //单次判断最大耗时(us)
+    uint32_t          ulArmCount[MODE_TRANSITION_MAX_NUM];   //条件满足开始计时次数
+    uint32_t          ulFireCount[MODE_TRANSITION_MAX_NUM];  //切换次数
+}sModeStats;
+
+typedef struct  /*控制输入快照，每个小帧开始时锁存，执行器内控制任务只读快照*/
+{
+    eSystemMode       eSystemMode;              //系统模式
+    eSystemState      eSystemState;             //系统状态
+    int16_t           sAmbientIn_T;             //室内环境干球温度
+    uint16_t          usAmbientIn_H;            //室内环境湿度
+    uint16_t          usCO2PPM;                 //CO2平均浓度
+    uint16_t          usTempSet;                //目标温度值设定
+    uint16_t          usEnergyTemp;             //节能温度
+    uint16_t          usTempDeviat;             //温度偏差
+    uint16_t          usHumidityMin;            //设定湿度min
+    uint16_t          usHumidityMax;            //设定湿度max
+    uint16_t          usCO2AdjustThr_V;         //CO2浓度调节阈值
+    uint16_t          usCO2AdjustDeviat;        //CO2浓度调节偏差
+}sCtrlInput;
 
 CLASS(System)   /*系统*/
 {
@@ -98,25 +127,24 @@ CLASS(System)   /*系统*/
 
     eExAirFanType     eExAirFanType;            //排风机类型(0: 全变频  1：变频+定频)
     
-    OS_TMR            sSysPollTmr;              //系统周期轮询定时器 
-    OS_TMR            sExAirFanCtrlTmr;         //排风机控制周期定时器
-    OS_TMR            sExAirFanRequestTimeTmr;  //排风机运行需求时间定时器
-    
-    OS_TMR            sModeChangeTmr_1;         //模式切换时间t1(min)定时器
-    OS_TMR            sModeChangeTmr_2;         //模式切换时间t2(min)定时器
-    OS_TMR            sModeChangeTmr_3;         //模式切换时间t3(min)定时器
-    OS_TMR            sModeChangeTmr_4;         //模式切换时间t4(min)定时器
-    OS_TMR            sModeChangeTmr_5;         //模式切换时间t5(min)定时器
-    OS_TMR            sModeChangeTmr_6;         //模式切换时间t6(min)定时器
-    OS_TMR            sModeChangeTmr_7;         //模式切换时间t7(min)定时器
-    OS_TMR            sModeChangeTmr_8;         //模式切换时间t8(min)定时器
-    
-    OS_TMR            sModeChangePeriodTmr_1;   //模式切换间隔t1(min)定时器
-    OS_TMR            sModeChangePeriodTmr_2;   //模式切换间隔t2(min)定时器
-    OS_TMR            sModeChangePeriodTmr_3;   //模式切换间隔t3(min)定时器
-    OS_TMR            sModeChangePeriodTmr_4;   //模式切换间隔t4(min)定时器
-    OS_TMR            sModeChangePeriodTmr_5;   //模式切换间隔t5(min)定时器
-    OS_TMR            sModeChangePeriodTmr_6;   //模式切换间隔t6(min)定时器
+    sTimer            sExAirFanCtrlTmr;         //排风机控制周期定时器
+    sTimer            sExAirFanRequestTimeTmr;  //排风机运行需求时间定时器
+    
+    sTimer            sModeChangeTmr_1;         //模式切换时间t1(min)定时器
+    sTimer            sModeChangeTmr_2;         //模式切换时间t2(min)定时器
+    sTimer            sModeChangeTmr_3;         //模式切换时间t3(min)定时器
+    sTimer            sModeChangeTmr_4;         //模式切换时间t4(min)定时器
+    sTimer            sModeChangeTmr_5;         //模式切换时间t5(min)定时器
+    sTimer            sModeChangeTmr_6;         //模式切换时间t6(min)定时器
+    sTimer            sModeChangeTmr_7;         //模式切换时间t7(min)定时器
+    sTimer            sModeChangeTmr_8;         //模式切换时间t8(min)定时器
+    
+    sTimer            sModeChangePeriodTmr_1;   //模式切换间隔t1(min)定时器
+    sTimer            sModeChangePeriodTmr_2;   //模式切换间隔t2(min)定时器
+    sTimer            sModeChangePeriodTmr_3;   //模式切换间隔t3(min)定时器
+    sTimer            sModeChangePeriodTmr_4;   //模式切换间隔t4(min)定时器
+    sTimer            sModeChangePeriodTmr_5;   //模式切换间隔t5(min)定时器
+    sTimer            sModeChangePeriodTmr_6;   //模式切换间隔t6(min)定时器
    
     BOOL              xCompFirstRun;            //压缩机首次开启
     BOOL              xUnitErrFlag;             //机组总故障标志
@@ -154,7 +182,38 @@ CLASS(System)   /*系统*/
     ModularRoof*      psModularRoofList[MODULAR_ROOF_NUM];           //屋顶机列表                 
     TempHumiSensor*   psTempHumiSenOutList[TEMP_HUMI_SEN_OUT_NUM];   //室外温湿度传感器列表
     TempHumiSensor*   psTempHumiSenInList[TEMP_HUMI_SEN_IN_NUM];     //室内温湿度传感器列表
+    
+    sAggregate        sCO2Agg;                                       //CO2浓度聚合
+    sAggregate        sTempOutAgg;                                   //室外温度聚合
+    sAggregate        sHumiOutAgg;                                   //室外湿度聚合
+    sAggregate        sTempInAgg;                                    //室内温度聚合
+    sAggregate        sHumiInAgg;                                    //室内湿度聚合
+    
+    sAggregate        sUnitFreAirAgg;                                //机组新风量聚合
+    sAggregate        sUnitCO2Agg;                                   //机组CO2浓度聚合
+    sAggregate        sUnitTempOutAgg;                               //机组室外温度聚合
+    sAggregate        sUnitHumiOutAgg;                               //机组室外湿度聚合
+    sAggregate        sUnitTempInAgg;                                //机组室内温度聚合
+    sAggregate        sUnitHumiInAgg;                                //机组室内湿度聚合
+    
+    sAggMember        sCO2AggMember[CO2_SEN_NUM];                    //CO2浓度聚合成员
+    sAggMember        sTempOutAggMember[TEMP_HUMI_SEN_OUT_NUM];      //室外温度聚合成员
+    sAggMember        sHumiOutAggMember[TEMP_HUMI_SEN_OUT_NUM];      //室外湿度聚合成员
+    sAggMember        sTempInAggMember[TEMP_HUMI_SEN_IN_NUM];        //室内温度聚合成员
+    sAggMember        sHumiInAggMember[TEMP_HUMI_SEN_IN_NUM];        //室内湿度聚合成员
+    
+    sAggMember        sUnitFreAirAggMember[MODULAR_ROOF_NUM];        //机组新风量聚合成员
+    sAggMember        sUnitCO2AggMember[MODULAR_ROOF_NUM];           //机组CO2浓度聚合成员
+    sAggMember        sUnitTempOutAggMember[MODULAR_ROOF_NUM];       //机组室外温度聚合成员
+    sAggMember        sUnitHumiOutAggMember[MODULAR_ROOF_NUM];       //机组室外湿度聚合成员
+    sAggMember        sUnitTempInAggMember[MODULAR_ROOF_NUM];        //机组室内温度聚合成员
+    sAggMember        sUnitHumiInAggMember[MODULAR_ROOF_NUM];        //机组室内湿度聚合成员
                       
+    sCyclicExec       sCtrlExec;                                     //控制循环执行器
+    sCtrlInput        sCtrlIn;                                       //控制输入快照
+    uint8_t           ucModeReq;                                     //模式切换判断请求，由控制执行器处理
+    sModeStats        sModeStats;                                    //模式切换统计
+    
     sMBMasterInfo*    psMBMasterInfo;   //通讯主栈
 
     void   (*init)( System* pt);
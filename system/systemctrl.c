@@ -112,7 +112,7 @@ void vSystem_SetTemp(System* pt, uint16_t usTempSet)
 
     if( pThis->usTempSet != usTempSet)
     {
-        pThis->usTempSet = usTempSet;
+        EEPROM_SET(pThis->usTempSet, usTempSet)
 
 #if DEBUG_ENABLE > 0
         myprintf("vSystem_SetTemp %d\n", pThis->usTempSet);
@@ -228,6 +228,7 @@ void vSystem_SetExAirFanCtrlPeriod(System* pt, uint16_t usExAirFanCtrlPeriod)
 #if DEBUG_ENABLE > 0
         myprintf("vSystem_SetExAirFanCtrlPeriod  usExAirFanCtrlPeriod %d  \n", pThis->usExAirFanCtrlPeriod);
 #endif 
+        (void)xTmrChangePeriod(&pThis->sExAirFanCtrlTmr, pThis->usExAirFanCtrlPeriod);  //运行中的控制周期下次到期起生效
         vSystem_ExAirFanCtrl(pThis);   
     }
 }
@@ -239,8 +240,8 @@ void vSystem_SetHumidity(System* pt, uint16_t usHumidityMin, uint16_t usHumidity
     System* pThis = (System*)pt;
     
     ModularRoof* pModularRoof = NULL;
-    pThis->usHumidityMin = usHumidityMin;
-    pThis->usHumidityMax = usHumidityMax;
+    EEPROM_SET(pThis->usHumidityMin, usHumidityMin)
+    EEPROM_SET(pThis->usHumidityMax, usHumidityMax)
     
     for(n=0; n < MODULAR_ROOF_NUM; n++)
     {
@@ -263,7 +264,7 @@ void vSystem_SetCO2AdjustThr_V(System* pt, uint16_t usCO2AdjustThr_V)
     
     if(pThis->usCO2AdjustThr_V != usCO2AdjustThr_V)
     {
-        pThis->usCO2AdjustThr_V = usCO2AdjustThr_V;
+        EEPROM_SET(pThis->usCO2AdjustThr_V, usCO2AdjustThr_V)
         for(n=0; n < MODULAR_ROOF_NUM; n++)
         {
             pModularRoof = pThis->psModularRoofList[n]; 
@@ -283,7 +284,7 @@ void vSystem_SetCO2AdjustDeviat(System* pt, uint16_t usCO2AdjustDeviat)
     System* pThis = (System*)pt;
     
     ModularRoof* pModularRoof = NULL;
-    pThis->usCO2AdjustDeviat = usCO2AdjustDeviat;
+    EEPROM_SET(pThis->usCO2AdjustDeviat, usCO2AdjustDeviat)
     
     for(n=0; n < MODULAR_ROOF_NUM; n++)
     {
@@ -394,13 +395,30 @@ void vSystem_DelAlarm(System* pt)
 }
 
 /*清除声光报警请求*/
+typedef struct   /*机组报警判断用同帧快照*/
+{
+    ModularRoof* pModularRoof;
+    BOOL         xStopErrFlag;
+    int16_t      sSupAir_T;
+}sUnitAlarmSnap;
+
+/*机组报警快照拷贝，由顺序锁读者调用*/
+static void vSystem_CopyUnitAlarmSnap(void* pvArg)
+{
+    sUnitAlarmSnap* psSnap = (sUnitAlarmSnap*)pvArg;
+
+    psSnap->xStopErrFlag = psSnap->pModularRoof->xStopErrFlag;
+    psSnap->sSupAir_T    = psSnap->pModularRoof->sSupAir_T;
+}
+
 void vSystem_DelAlarmRequst(System* pt)
 {
     uint8_t  n = 0; 
     System* pThis = (System*)pt;
     
-    ModularRoof* pModularRoof = NULL;
-    ExAirFan*    pExAirFan    = NULL;
+    ModularRoof*   pModularRoof = NULL;
+    ExAirFan*      pExAirFan    = NULL;
+    sUnitAlarmSnap sSnap;
     
     if(pThis->xAlarmEnable == FALSE)
     {
@@ -409,14 +427,16 @@ void vSystem_DelAlarmRequst(System* pt)
     for(n=0; n < MODULAR_ROOF_NUM; n++)
     {
         pModularRoof = pThis->psModularRoofList[n]; 
+        sSnap.pModularRoof = pModularRoof;
+        (void)ulSeqReadCopy(&pModularRoof->sMBSlaveDev.sDataLock, vSystem_CopyUnitAlarmSnap, &sSnap);
 
        //(1)群控控制器与空调机组通讯故障,  (8)空调机组停机保护。声光报警        
-        if( (pModularRoof->sMBSlaveDev.xOnLine == FALSE) || (pModularRoof->xStopErrFlag) ) 
+        if( (pModularRoof->sMBSlaveDev.xOnLine == FALSE) || (sSnap.xStopErrFlag) ) 
         {
             return;
         } 
         //(3)当送风温度大于【送风温度最大值】（默认45℃）,声光报警
-        if(pModularRoof->sSupAir_T > pThis->usSupAirMax_T)
+        if(sSnap.sSupAir_T > pThis->usSupAirMax_T)
         {
             return;            
         }         
@@ -464,8 +484,9 @@ void vSystem_AlarmEnable(System* pt, BOOL xAlarmEnable)
     uint8_t  n = 0; 
     System* pThis = (System*)pt;
     
-    ModularRoof* pModularRoof = NULL;
-    ExAirFan*    pExAirFan    = NULL;
+    ModularRoof*   pModularRoof = NULL;
+    ExAirFan*      pExAirFan    = NULL;
+    sUnitAlarmSnap sSnap;
     
     pThis->xAlarmEnable = xAlarmEnable;
     if(xAlarmEnable == TRUE)
@@ -473,15 +494,17 @@ void vSystem_AlarmEnable(System* pt, BOOL xAlarmEnable)
         for(n=0; n < MODULAR_ROOF_NUM; n++)
         {
             pModularRoof = pThis->psModularRoofList[n]; 
+            sSnap.pModularRoof = pModularRoof;
+            (void)ulSeqReadCopy(&pModularRoof->sMBSlaveDev.sDataLock, vSystem_CopyUnitAlarmSnap, &sSnap);
         
            //(1)群控控制器与空调机组通讯故障,  (8)空调机组停机保护。声光报警        
-            if( (pModularRoof->sMBSlaveDev.xOnLine == FALSE) || (pModularRoof->xStopErrFlag) ) 
+            if( (pModularRoof->sMBSlaveDev.xOnLine == FALSE) || (sSnap.xStopErrFlag) ) 
             {
                 vSystem_SetAlarm(pThis);
                 return;
             } 
             //(3)当送风温度大于【送风温度最大值】（默认45℃）,声光报警
-            if(pModularRoof->sSupAir_T > pThis->usSupAirMax_T)
+            if(sSnap.sSupAir_T > pThis->usSupAirMax_T)
             {
                 vSystem_SetAlarm(pThis);
                 return;            
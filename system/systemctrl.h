@@ -11,6 +11,7 @@ void vSystem_CleanAlarm(System* pt, BOOL* pxAlarmClean);
 void vSystem_RegistAlarmIO(System* pt, uint8_t ucSwitch_DO);
 
 void vSystem_DeviceRunningState(System* pt);
+void vSystem_InitCtrlExec(System* pt);
 void vSystem_ChangeSystemMode(System* pt, eSystemMode eSystemMode);
 
 void vSystem_SetTemp(System* pt, uint16_t usTempSet);
@@ -28,7 +29,12 @@ void vSystem_CloseUnits(System* pt);
 
 void vSystem_AdjustUnitRunningMode(System* pt);
 void vSystem_ChangeUnitRunningMode(System* pt);
+void vSystem_UnitRunningModeJob(System* pt);
 void vSystem_SetUnitRunningMode(System* pt, eRunningMode eRunMode);
+void vSystem_InitModeTmr(System* pt);
+
+void vSystem_InitUnitAgg(System* pt);
+void vSystem_UnitUpdate(System* pt, ModularRoof* pModularRoof);
 
 void vSystem_UnitSupAirTemp(System* pt, ModularRoof* pModularRoof);
 void vSystem_UnitErr(System* pt);
@@ -41,6 +47,7 @@ void vSystem_UnitFreAir(System* pt);
 
 /*********************排风风机*************************/
 void vSystem_CloseExAirFans(System* pt);
+void vSystem_InitExAirFanTmr(System* pt);
 
 void vSystem_SetExAirFanCtrlPeriod(System* pt, uint16_t usExAirFanCtrlPeriod);
 void vSystem_SetExAirFanFreqRange(System* pt, uint16_t usMinFreq, uint16_t usMaxFreq);
@@ -55,6 +62,10 @@ void vSystem_ExAirFanRemoteChange(System* pt);
 void vSystem_ExAirFanErr(System* pt);
 void vSystem_ExAirFanErrClean(System* pt);
 /*********************传感器*************************/
+void vSystem_InitSensorAgg(System* pt);
+void vSystem_CO2SensorUpdate(System* pt, CO2Sensor* pCO2Sensor);
+void vSystem_TempHumiSensorUpdate(System* pt, TempHumiSensor* pTempHumiSensor);
+
 void vSystem_CO2SensorErr(System* pt);
 void vSystem_CO2PPM(System* pt);
 
@@ -2,6 +2,8 @@
 #include "system.h"
 #include "systemctrl.h"
 
+#include "stddef.h"
+
 #define MODULAR_POLL_TIME_OUT_S   30
 
 /*系统开启所有机组*/
@@ -55,7 +57,7 @@ BOOL xSystem_UnitCompsClosed(System* pt)
     return TRUE;
 }
 
-/*切换机组节能温度*/
+/*切换机组节能温度，目标温度取控制输入快照*/
 uint16_t usSystem_ChangeEnergyTemp(System* pt)
 {
     uint8_t  n = 0;
@@ -63,8 +65,8 @@ uint16_t usSystem_ChangeEnergyTemp(System* pt)
     ModularRoof* pModularRoof = NULL;
     
     uint16_t usTempSet     = 0;
-    uint16_t usEnergyTemp  = pThis->usEnergyTemp;
-    uint16_t usTempDeviat  = pThis->usTempDeviat;
+    uint16_t usEnergyTemp  = pThis->sCtrlIn.usEnergyTemp;
+    uint16_t usTempDeviat  = pThis->sCtrlIn.usTempDeviat;
     
      /*注：1、当室内目标温度>=【节能温度】（默认25℃），
                     机组制冷目标温度=室内目标温度；
@@ -76,13 +78,13 @@ uint16_t usSystem_ChangeEnergyTemp(System* pt)
     {
         return 0;
     }
-    if(pThis->usTempSet < pThis->usEnergyTemp)
+    if(pThis->sCtrlIn.usTempSet < usEnergyTemp)
     {
         usTempSet = usEnergyTemp - usTempDeviat;
     }
     else
     {
-        usTempSet = pThis->usTempSet;
+        usTempSet = pThis->sCtrlIn.usTempSet;
     }
     for(n=0; n < MODULAR_ROOF_NUM; n++)  //调整制冷温度
     {
@@ -150,6 +152,89 @@ void vSystem_SetUnitRunningMode(System* pt, eRunningMode eRunMode)
     (void)vSystem_ExAirRequest_Vol(pThis);  //计算排风需求量
 }
 
+/*模式切换条件类型*/
+#define MODE_GUARD_TEMP_ABOVE    0      //室内温度 > 基准 + 调节温度
+#define MODE_GUARD_TEMP_BELOW    1      //室内温度 < 基准 - 调节温度
+#define MODE_GUARD_COMP_IDLE     2      //机组压缩机全部待机(首次开启不纳入)
+
+/*温度基准*/
+#define MODE_REF_TEMP_SET        0      //室内目标温度
+#define MODE_REF_ENERGY_TEMP     1      //节能温度T，见usSystem_ChangeEnergyTemp
+
+/*进入模式动作*/
+#define MODE_ENTRY_COMP_FIRST    0x01   //压缩机全部关闭时置首次开启
+#define MODE_ENTRY_COMP_HOLD     0x02   //该模式判断持续条件前置首次开启，压机待机条件不生效
+
+#define MODE_NONE                0xFFFF
+
+#define MODE_REQ_CHANGE          0x01   //输入变化，判断是否开始切换计时
+#define MODE_REQ_ADJUST          0x02   //切换时间到期，判断是否切换模式
+#define MODE_OFFSET(field)       ((uint16_t)offsetof(System, field))
+#define MODE_U16(pThis, usOff)   (*(uint16_t*)((uint8_t*)(pThis) + (usOff)))
+#define MODE_TMR(pThis, usOff)   ((sTimer*)((uint8_t*)(pThis) + (usOff)))
+
+typedef struct  /*模式切换：条件持续【模式切换时间】且满足【模式切换间隔时间】后切换*/
+{
+    uint8_t   ucFrom;          //当前运行模式
+    uint8_t   ucTo;            //目标运行模式
+    uint8_t   ucGuard;         //条件类型
+    uint8_t   ucRef;           //温度基准
+    uint16_t  usAdjustTemp;    //模式调节温度参数
+    uint16_t  usChangeTime;    //模式切换时间参数(min)
+    uint16_t  usChangeTmr;     //模式切换时间定时器
+    uint16_t  usPeriodTmr;     //模式切换间隔定时器，运行中不允许切换
+}sModeTransition;
+
+typedef struct  /*进入模式：重装本模式出口的切换间隔定时器*/
+{
+    uint8_t   ucMode;          //运行模式
+    uint8_t   ucFlag;          //进入动作
+    uint16_t  usPeriodTmr[2];  //切换间隔定时器
+    uint16_t  usPeriodTime[2]; //切换间隔时间参数(min)
+}sModeEntry;
+
+/*模式切换表，同一模式按表中顺序判断，先满足者生效*/
+static const sModeTransition ModeTransitionTable[] = {
+    //（1）送风模式：T1/t1/间隔1切换为湿膜，T2/t2/间隔2切换为制热
+    {RUN_MODE_FAN,  RUN_MODE_WET,  MODE_GUARD_TEMP_ABOVE, MODE_REF_TEMP_SET,    MODE_OFFSET(usModeAdjustTemp_1), 
+     MODE_OFFSET(usModeChangeTime_1), MODE_OFFSET(sModeChangeTmr_1), MODE_OFFSET(sModeChangePeriodTmr_1)},
+    {RUN_MODE_FAN,  RUN_MODE_HEAT, MODE_GUARD_TEMP_BELOW, MODE_REF_TEMP_SET,    MODE_OFFSET(usModeAdjustTemp_2), 
+     MODE_OFFSET(usModeChangeTime_2), MODE_OFFSET(sModeChangeTmr_2), MODE_OFFSET(sModeChangePeriodTmr_2)},
+    //（2）湿膜模式：T+T3/t3/间隔3切换为制冷，T4/t4/间隔4切换为送风
+    {RUN_MODE_WET,  RUN_MODE_COOL, MODE_GUARD_TEMP_ABOVE, MODE_REF_ENERGY_TEMP, MODE_OFFSET(usModeAdjustTemp_3), 
+     MODE_OFFSET(usModeChangeTime_3), MODE_OFFSET(sModeChangeTmr_3), MODE_OFFSET(sModeChangePeriodTmr_3)},
+    {RUN_MODE_WET,  RUN_MODE_FAN,  MODE_GUARD_TEMP_BELOW, MODE_REF_TEMP_SET,    MODE_OFFSET(usModeAdjustTemp_4), 
+     MODE_OFFSET(usModeChangeTime_4), MODE_OFFSET(sModeChangeTmr_4), MODE_OFFSET(sModeChangePeriodTmr_4)},
+    //（3）制冷模式：T5/t5/间隔5或压机待机t7/间隔5切换为湿膜
+    {RUN_MODE_COOL, RUN_MODE_WET,  MODE_GUARD_TEMP_BELOW, MODE_REF_TEMP_SET,    MODE_OFFSET(usModeAdjustTemp_5), 
+     MODE_OFFSET(usModeChangeTime_5), MODE_OFFSET(sModeChangeTmr_5), MODE_OFFSET(sModeChangePeriodTmr_5)},
+    {RUN_MODE_COOL, RUN_MODE_WET,  MODE_GUARD_COMP_IDLE,  MODE_REF_TEMP_SET,    MODE_NONE, 
+     MODE_OFFSET(usModeChangeTime_7), MODE_OFFSET(sModeChangeTmr_7), MODE_OFFSET(sModeChangePeriodTmr_5)},
+    //（4）制热模式：T6/t6/间隔6或压机待机t8/间隔6切换为送风
+    {RUN_MODE_HEAT, RUN_MODE_FAN,  MODE_GUARD_TEMP_ABOVE, MODE_REF_TEMP_SET,    MODE_OFFSET(usModeAdjustTemp_6), 
+     MODE_OFFSET(usModeChangeTime_6), MODE_OFFSET(sModeChangeTmr_6), MODE_OFFSET(sModeChangePeriodTmr_6)},
+    {RUN_MODE_HEAT, RUN_MODE_FAN,  MODE_GUARD_COMP_IDLE,  MODE_REF_TEMP_SET,    MODE_NONE, 
+     MODE_OFFSET(usModeChangeTime_8), MODE_OFFSET(sModeChangeTmr_8), MODE_OFFSET(sModeChangePeriodTmr_6)},
+};
+
+/*进入模式表*/
+static const sModeEntry ModeEntryTable[] = {
+    {RUN_MODE_FAN,  0,                      {MODE_OFFSET(sModeChangePeriodTmr_1), MODE_NONE}, 
+                                            {MODE_OFFSET(usModeChangePeriod_1),   MODE_NONE}},
+    {RUN_MODE_WET,  0,                      {MODE_OFFSET(sModeChangePeriodTmr_3), MODE_OFFSET(sModeChangePeriodTmr_4)}, 
+                                            {MODE_OFFSET(usModeChangePeriod_3),   MODE_OFFSET(usModeChangePeriod_4)}},
+    {RUN_MODE_COOL, MODE_ENTRY_COMP_FIRST,  {MODE_OFFSET(sModeChangePeriodTmr_5), MODE_NONE}, 
+                                            {MODE_OFFSET(usModeChangePeriod_5),   MODE_NONE}},
+    {RUN_MODE_HEAT, MODE_ENTRY_COMP_FIRST | MODE_ENTRY_COMP_HOLD, 
+                                            {MODE_OFFSET(sModeChangePeriodTmr_6), MODE_NONE}, 
+                                            {MODE_OFFSET(usModeChangePeriod_6),   MODE_NONE}},
+};
+
+#define MODE_TRANSITION_NUM   (sizeof(ModeTransitionTable) / sizeof(sModeTransition))
+#define MODE_ENTRY_NUM        (sizeof(ModeEntryTable) / sizeof(sModeEntry))
+
+typedef char ModeTransitionNumCheck[(MODE_TRANSITION_NUM <= MODE_TRANSITION_MAX_NUM) ? 1 : -1];  //编译期检查统计容量
+
 void vSystem_ModeChangePeriodTimeCallback(void* p_tmr, void* p_arg)
 {
     System* pThis = (System*)p_arg;
@@ -159,294 +244,202 @@ void vSystem_ModeChangePeriodTimeCallback(void* p_tmr, void* p_arg)
 #endif         
 }
 
-/*调整机组运行模式*/
-void vSystem_AdjustUnitRunningMode(System* pt)
+void vSystem_ModeChangeTimeCallback(void* p_tmr, void* p_arg)
 {
-    uint8_t  n = 0;
-    System* pThis = (System*)pt;
-    ModularRoof* pModularRoof = NULL;
+    System* pThis = (System*)p_arg;
     
-    uint16_t usTempSet     = 0;
-    int16_t  sAmbientIn_T  = pThis->sAmbientIn_T;
-    uint16_t usEnergyTemp  = pThis->usEnergyTemp;
-    uint16_t usTempDeviat  = pThis->usTempDeviat;
+#if DEBUG_ENABLE > 0
+    myprintf("vSystem_ModeChangeTimeCallback \n");
+#endif         
+    vSystem_AdjustUnitRunningMode(pThis);
+}
+
+/*查找进入模式表*/
+static const sModeEntry* psSystem_ModeEntry(uint8_t ucMode)
+{
+    uint8_t n;
     
-    if(pThis->eSystemMode != MODE_AUTO || pThis->eSystemState == STATE_CLOSED)   //6. 自动模式且已经运行
+    for(n=0; n < MODE_ENTRY_NUM; n++)
     {
-        return;
-    }  
-#if DEBUG_ENABLE > 0
-    myprintf("vSystem_AdjustUnitRunningMode %d\n", pThis->eRunningMode);
-#endif      
-    //（1）系统送风模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_FAN)
-    {
-        //室内温度>室内目标温度+ T1（默认1.5℃），持续满足t1(默认5min)时间，
-        //且满足【模式切换间隔时间1】（默认10min）则机组切换为湿膜模式；
-        if( (sAmbientIn_T > pThis->usTempSet + pThis->usModeAdjustTemp_1) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_1) != OS_TMR_STATE_RUNNING) &&
-            (usGetTmrState(&pThis->sModeChangePeriodTmr_1) != OS_TMR_STATE_RUNNING) )
-        {
-            vSystem_SetUnitRunningMode(pThis, RUN_MODE_WET);
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_3, pThis->usModeChangePeriod_3*60, 0, 
-                               OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_4, pThis->usModeChangePeriod_4*60, 0, 
-                   OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            
-            myprintf("xTimerRegist sModeChangePeriodTmr_3 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            myprintf("xTimerRegist sModeChangePeriodTmr_4 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            
-            return;            
-        }
-        //室内温度<室内目标温度- T2（默认1.5℃），持续满足t2(默认5min)时间，
-        //且满足【模式切换间隔时间2】（默认10min）则机组切换为制热模式；
-        if( (sAmbientIn_T < pThis->usTempSet - pThis->usModeAdjustTemp_2) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_2) != OS_TMR_STATE_RUNNING) &&
-            (usGetTmrState(&pThis->sModeChangePeriodTmr_2) != OS_TMR_STATE_RUNNING) )
+        if(ModeEntryTable[n].ucMode == ucMode)
         {
-            vSystem_SetUnitRunningMode(pThis, RUN_MODE_HEAT);
-            if(xSystem_UnitCompsClosed(pThis) == TRUE)
-            {
-                pThis->xCompFirstRun = TRUE;
-            }
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_6, pThis->usModeChangePeriod_6*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangePeriodTmr_6 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            return;
+            return &ModeEntryTable[n];
         }
     }
-    //（2）系统湿膜模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_WET)
+    return NULL;
+}
+
+/*模式切换条件判断，温度取控制输入快照*/
+static BOOL xSystem_ModeGuard(System* pt, const sModeTransition* psTrans, int32_t lEnergyTemp)
+{
+    System* pThis = (System*)pt;
+    int32_t lRef  = (psTrans->ucRef == MODE_REF_ENERGY_TEMP) ? lEnergyTemp : (int32_t)pThis->sCtrlIn.usTempSet;
+    
+    switch(psTrans->ucGuard)
+    {
+        case MODE_GUARD_TEMP_ABOVE:
+            return (pThis->sCtrlIn.sAmbientIn_T > lRef + MODE_U16(pThis, psTrans->usAdjustTemp)) ? TRUE : FALSE;
+        case MODE_GUARD_TEMP_BELOW:
+            return (pThis->sCtrlIn.sAmbientIn_T < lRef - MODE_U16(pThis, psTrans->usAdjustTemp)) ? TRUE : FALSE;
+        case MODE_GUARD_COMP_IDLE:
+            return ( (pThis->xCompFirstRun == FALSE) && (xSystem_UnitCompsClosed(pThis) == TRUE) ) ? TRUE : FALSE;
+        default:
+            return FALSE;
+    }
+}
+
+/*进入目标模式，重装本模式出口的切换间隔定时器*/
+static void vSystem_EnterUnitRunningMode(System* pt, uint8_t ucMode)
+{
+    uint8_t n;
+    System* pThis = (System*)pt;
+    
+    const sModeEntry* psEntry = psSystem_ModeEntry(ucMode);
+    
+    vSystem_SetUnitRunningMode(pThis, (eRunningMode)ucMode);
+    if(psEntry == NULL)
     {
-        usTempSet = usSystem_ChangeEnergyTemp(pThis);
-        
-        //室内温度>T+ T3（默认1.5℃），持续满足t3(默认5min)时间，
-        //且满足【模式切换间隔时间3】（默认10min）则机组切换为制冷模式；
-        if( (sAmbientIn_T > usTempSet + pThis->usModeAdjustTemp_3) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_3) != OS_TMR_STATE_RUNNING) && 
-            (usGetTmrState(&pThis->sModeChangePeriodTmr_3) != OS_TMR_STATE_RUNNING) )
+        return;
+    }
+    if( (psEntry->ucFlag & MODE_ENTRY_COMP_FIRST) && (xSystem_UnitCompsClosed(pThis) == TRUE) )
+    {
+        pThis->xCompFirstRun = TRUE;  //首次开启
+    }
+    for(n=0; n < 2; n++)
+    {
+        if(psEntry->usPeriodTmr[n] != MODE_NONE)
         {
-            vSystem_SetUnitRunningMode(pThis, RUN_MODE_COOL);
-            if(xSystem_UnitCompsClosed(pThis) == TRUE)        //首次切入制冷模式
-            {
-                pThis->xCompFirstRun = TRUE;  //首次开启
-            }
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_5, pThis->usModeChangePeriod_5*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangePeriodTmr_5 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-
-            return;
+            (void)xTmrRearm(MODE_TMR(pThis, psEntry->usPeriodTmr[n]), MODE_U16(pThis, psEntry->usPeriodTime[n])*60);
         }
-        //室内温度<室内目标温度- T4（默认1.5℃），持续满足t4(默认5min)时间，
-        //且满足【模式切换间隔时间4】（默认10min）则机组切换为送风模式；
-        if( (sAmbientIn_T < pThis->usTempSet - pThis->usModeAdjustTemp_4) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_4) != OS_TMR_STATE_RUNNING) &&
-            (usGetTmrState(&pThis->sModeChangePeriodTmr_4) != OS_TMR_STATE_RUNNING) )
-        {
-            vSystem_SetUnitRunningMode(pThis, RUN_MODE_FAN);
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_1, pThis->usModeChangePeriod_1*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangePeriodTmr_1 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
+    }
+}
 
-            return;
-        }
+/**************************************************************
+*@brief 模式切换表解释执行，遍历当前模式的切换项，每次最多一个切换项生效
+*@param xAdjust FALSE：条件满足且切换时间定时器空闲时开始计时
+*               TRUE ：切换时间到期后条件仍满足且不在切换间隔内时切换模式
+***************************************************************/
+static void vSystem_EvalUnitRunningMode(System* pt, BOOL xAdjust)
+{
+    uint8_t  n;
+    uint32_t ulBegin, ulCost;
+    int32_t  lEnergyTemp = 0;
+    BOOL     xEnergyTemp = FALSE;
+    
+    System*                pThis   = (System*)pt;
+    sModeStats*            psStats = &pThis->sModeStats;
+    const sModeTransition* psTrans = NULL;
+    const sModeEntry*      psEntry = psSystem_ModeEntry(pThis->eRunningMode);
+    
+    if(pThis->sCtrlIn.eSystemMode != MODE_AUTO || pThis->sCtrlIn.eSystemState == STATE_CLOSED)   //6. 自动模式且已经运行
+    {
+        return;
+    }
+    ulBegin = ulCyclicClock_us();
+    if( (xAdjust == FALSE) && (psEntry != NULL) && (psEntry->ucFlag & MODE_ENTRY_COMP_HOLD) )
+    {
+        pThis->xCompFirstRun = TRUE;
     }
-    //（3）系统制冷模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_COOL)
+    for(n=0; n < MODE_TRANSITION_NUM; n++)
     {
-        //室内温度<室内目标温度- T5（默认1.5℃）持续满足t5(默认5min)时间
-        //且满足【模式切换间隔时间5】（默认10min）机组切换为湿膜模式。
-        if( (sAmbientIn_T < pThis->usTempSet - pThis->usModeAdjustTemp_5) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_5) != OS_TMR_STATE_RUNNING) &&
-            (usGetTmrState(&pThis->sModeChangePeriodTmr_5) != OS_TMR_STATE_RUNNING) )
+        psTrans = &ModeTransitionTable[n];
+        if(psTrans->ucFrom != pThis->eRunningMode)
         {
-            vSystem_SetUnitRunningMode(pThis, RUN_MODE_WET);
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_3, pThis->usModeChangePeriod_3*60, 0, 
-                               OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_4, pThis->usModeChangePeriod_4*60, 0, 
-                   OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            
-            myprintf("xTimerRegist sModeChangePeriodTmr_3 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            myprintf("xTimerRegist sModeChangePeriodTmr_4 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-           
-            return;
+            continue;
         }
-        //机组压缩机全部待机（首次开启，压缩机未运行不纳入压机待机情况）持续满足t7(默认5min)
-        //且满足【模式切换间隔时间5】（默认10min）机组切换为湿膜模式。
-        if((pThis->xCompFirstRun == FALSE) && (xSystem_UnitCompsClosed(pThis) == TRUE) )
+        if( (psTrans->ucRef == MODE_REF_ENERGY_TEMP) && (xEnergyTemp == FALSE) )   //湿膜模式同步机组节能温度
         {
-            if( (usGetTmrState(&pThis->sModeChangeTmr_7) != OS_TMR_STATE_RUNNING) && 
-                (usGetTmrState(&pThis->sModeChangePeriodTmr_5) != OS_TMR_STATE_RUNNING) )
-            {
-                vSystem_SetUnitRunningMode(pThis, RUN_MODE_WET);
-                (void)xTimerRegist(&pThis->sModeChangePeriodTmr_3, pThis->usModeChangePeriod_3*60, 0, 
-                                   OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-                (void)xTimerRegist(&pThis->sModeChangePeriodTmr_4, pThis->usModeChangePeriod_4*60, 0, 
-                       OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-                
-                myprintf("xTimerRegist sModeChangePeriodTmr_3 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-                myprintf("xTimerRegist sModeChangePeriodTmr_4 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-                
-                return;
-            }
+            lEnergyTemp = usSystem_ChangeEnergyTemp(pThis);
+            xEnergyTemp = TRUE;
         }
-    }  
-    //（4）系统制热模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_HEAT)
-    {
-        //室内温度>室内目标温度+ T6（默认1.5℃）持续满足t6(默认5min)时间
-        //且满足【模式切换间隔时间6】（默认10min）则机组切换为送风模式；
-        if( (sAmbientIn_T > pThis->usTempSet + pThis->usModeAdjustTemp_6) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_6) != OS_TMR_STATE_RUNNING) &&
-             (usGetTmrState(&pThis->sModeChangePeriodTmr_6) != OS_TMR_STATE_RUNNING) )
+        if( (xSystem_ModeGuard(pThis, psTrans, lEnergyTemp) == FALSE) || 
+            (usGetTmrState(MODE_TMR(pThis, psTrans->usChangeTmr)) == OS_TMR_STATE_RUNNING) )
         {
-            vSystem_SetUnitRunningMode(pThis, RUN_MODE_FAN);
-            (void)xTimerRegist(&pThis->sModeChangePeriodTmr_1, pThis->usModeChangePeriod_1*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangePeriodTmr_1 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            return;
+            continue;
         }
-        //机组压缩机全部待机（首次开启，压缩机未运行不纳入压机待机情况）持续满足t8(默认5min)
-        //且满足【模式切换间隔时间6】（默认10min）则机组切换为送风模式；
-        if( (pThis->xCompFirstRun == FALSE) && (xSystem_UnitCompsClosed(pThis) == TRUE) )
+        if(xAdjust == FALSE)
         {
-            if( (usGetTmrState(&pThis->sModeChangeTmr_8) != OS_TMR_STATE_RUNNING) && 
-                (usGetTmrState(&pThis->sModeChangePeriodTmr_6) != OS_TMR_STATE_RUNNING) )
-            {
-                vSystem_SetUnitRunningMode(pThis, RUN_MODE_FAN);
-                (void)xTimerRegist(&pThis->sModeChangePeriodTmr_1, pThis->usModeChangePeriod_1*60, 0, 
-                                    OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangePeriodTimeCallback, pThis, FALSE);
-                myprintf("xTimerRegist sModeChangePeriodTmr_1 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-                return;
-            }
+            (void)xTmrRearm(MODE_TMR(pThis, psTrans->usChangeTmr), MODE_U16(pThis, psTrans->usChangeTime)*60);
+            psStats->ulArmCount[n]++;
+            break;
+        }
+        if(usGetTmrState(MODE_TMR(pThis, psTrans->usPeriodTmr)) != OS_TMR_STATE_RUNNING)
+        {
+            vSystem_EnterUnitRunningMode(pThis, psTrans->ucTo);
+            psStats->ulFireCount[n]++;
+#if DEBUG_ENABLE > 0
+            myprintf("vSystem_EvalUnitRunningMode %d -> %d sAmbientIn_T %d\n", psTrans->ucFrom, psTrans->ucTo, pThis->sCtrlIn.sAmbientIn_T);
+#endif
+            break;
         }
-    } 
+    }
+    ulCost = ulCyclicClock_us() - ulBegin;
+    psStats->ulEvalCount++;
+    if(ulCost > psStats->usEvalMax_us)
+    {
+        psStats->usEvalMax_us = (ulCost > UINT16_MAX) ? UINT16_MAX : (uint16_t)ulCost;
+    }
 }
 
-void vSystem_ModeChangeTimeCallback(void* p_tmr, void* p_arg)
+/*模式切换判断请求置位，事件任务、定时器与控制执行器均可调用*/
+static void vSystem_RequestUnitRunningMode(System* pt, uint8_t ucReq)
 {
-    System* pThis = (System*)p_arg;
+    OS_ERR  err = OS_ERR_NONE;
+    System* pThis = (System*)pt;
     
-#if DEBUG_ENABLE > 0
-    myprintf("vSystem_ModeChangeTimeCallback \n");
-#endif         
-    vSystem_AdjustUnitRunningMode(pThis);
+    OSSchedLock(&err);
+    pThis->ucModeReq |= ucReq;
+    OSSchedUnlock(&err);
+}
+
+/*调整机组运行模式，切换时间到期后由控制执行器判断*/
+void vSystem_AdjustUnitRunningMode(System* pt)
+{
+    vSystem_RequestUnitRunningMode(pt, MODE_REQ_ADJUST);
 }
 
-/*切换机组运行模式*/
+/*切换机组运行模式，输入变化后由控制执行器判断*/
 void vSystem_ChangeUnitRunningMode(System* pt)
 {
-    System* pThis = (System*)pt; 
+    vSystem_RequestUnitRunningMode(pt, MODE_REQ_CHANGE);
+}
+
+/*模式切换判断任务，由控制执行器每个小帧调用，按快照输入处理请求，先调整后切换*/
+void vSystem_UnitRunningModeJob(System* pt)
+{
+    uint8_t ucReq;
+    OS_ERR  err = OS_ERR_NONE;
+    System* pThis = (System*)pt;
     
-    uint16_t usTempSet     = 0;
-    int16_t  sAmbientIn_T  = pThis->sAmbientIn_T;
-    uint16_t usEnergyTemp  = pThis->usEnergyTemp;
-    uint16_t usTempDeviat  = pThis->usTempDeviat;
+    OSSchedLock(&err);
+    ucReq = pThis->ucModeReq;
+    pThis->ucModeReq = 0;
+    OSSchedUnlock(&err);
     
-    //6. 自动模式
-    if(pThis->eSystemMode != MODE_AUTO || pThis->eSystemState == STATE_CLOSED)
+    if(ucReq & MODE_REQ_ADJUST)
     {
-        return;
+        vSystem_EvalUnitRunningMode(pThis, TRUE);
     }
-//#if DEBUG_ENABLE > 0
-//    myprintf("vSystem_ChangeUnitRunningMode %d\n", pThis->eRunningMode);
-//#endif           
-    //（1）系统送风模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_FAN)
-    {
-        //室内温度>室内目标温度+ T1（默认1.5℃），持续满足t1(默认5min)时间
-        if( (sAmbientIn_T > pThis->usTempSet + pThis->usModeAdjustTemp_1) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_1) != OS_TMR_STATE_RUNNING) )
-        {
-            (void)xTimerRegist(&pThis->sModeChangeTmr_1, pThis->usModeChangeTime_1*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangeTmr_1 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            return;
-            
-        }
-        //室内温度<室内目标温度- T2（默认1.5℃），持续满足t2(默认5min)时间
-        if( (sAmbientIn_T < pThis->usTempSet - pThis->usModeAdjustTemp_2) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_2) != OS_TMR_STATE_RUNNING) )
-        {
-            (void)xTimerRegist(&pThis->sModeChangeTmr_2, pThis->usModeChangeTime_2*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-             myprintf("xTimerRegist sModeChangeTmr_2 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-             return;
-        }
-    }
-    //（2）系统湿膜模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_WET)
+    if(ucReq & MODE_REQ_CHANGE)
     {
-        usTempSet = usSystem_ChangeEnergyTemp(pThis);
-        
-        //室内温度>T+ T3（默认1.5℃），持续满足t3(默认5min)时间
-        if( (sAmbientIn_T > usTempSet + pThis->usModeAdjustTemp_3) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_3) != OS_TMR_STATE_RUNNING) )
-        {
-            (void)xTimerRegist(&pThis->sModeChangeTmr_3, pThis->usModeChangeTime_3*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangeTmr_3 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            return;
-        }
-        //室内温度<室内目标温度- T4（默认1.5℃），持续满足t2(默认5min)时间
-        if( (pThis->sAmbientIn_T < pThis->usTempSet - pThis->usModeAdjustTemp_4) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_4) != OS_TMR_STATE_RUNNING) )
-        {
-            (void)xTimerRegist(&pThis->sModeChangeTmr_4, pThis->usModeChangeTime_4*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangeTmr_4 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);            
-            return;
-        }
+        vSystem_EvalUnitRunningMode(pThis, FALSE);
     }
-    //（3）系统制冷模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_COOL)
-    {
-        //室内温度<室内目标温度- T5（默认1.5℃）持续满足t5(默认5min)时间
-        if( (sAmbientIn_T < pThis->usTempSet - pThis->usModeAdjustTemp_5) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_5) != OS_TMR_STATE_RUNNING) )
-        {
-            (void)xTimerRegist(&pThis->sModeChangeTmr_5, pThis->usModeChangeTime_5*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangeTmr_5 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            return;
-        }
-        //机组压缩机全部待机（首次开启，压缩机未运行不纳入压机待机情况）持续满足t7(默认5min)
-        if((pThis->xCompFirstRun == FALSE) && (xSystem_UnitCompsClosed(pThis) == TRUE) )
-        {
-            if(usGetTmrState(&pThis->sModeChangeTmr_7) != OS_TMR_STATE_RUNNING)
-            {
-                (void)xTimerRegist(&pThis->sModeChangeTmr_7, pThis->usModeChangeTime_7*60, 0, 
-                                    OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-                myprintf("xTimerRegist sModeChangeTmr_7 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-                return;
-            }
-        }
-    }  
-    //（4）系统制热模式运行，按照以下切换
-    if(pThis->eRunningMode == RUN_MODE_HEAT)
+}
+
+/*模式切换定时器初始化，按模式切换表绑定回调，控制逻辑中按需原位重装*/
+void vSystem_InitModeTmr(System* pt)
+{
+    uint8_t  n = 0;
+    System*  pThis = (System*)pt;
+    
+    for(n=0; n < MODE_TRANSITION_NUM; n++)
     {
-        pThis->xCompFirstRun = TRUE;
-        //室内温度>室内目标温度+ T6（默认1.5℃）持续满足t6(默认5min)时间
-        if( (sAmbientIn_T > pThis->usTempSet + pThis->usModeAdjustTemp_6) && 
-            (usGetTmrState(&pThis->sModeChangeTmr_6) != OS_TMR_STATE_RUNNING) )
-        {
-            (void)xTimerRegist(&pThis->sModeChangeTmr_6, pThis->usModeChangeTime_6*60, 0, 
-                                OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-            myprintf("xTimerRegist sModeChangeTmr_6 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);
-            return;
-        }
-        //机组压缩机全部待机（首次开启，压缩机未运行不纳入压机待机情况）持续满足t7(默认5min)
-        if( (pThis->xCompFirstRun == FALSE) && (xSystem_UnitCompsClosed(pThis) == TRUE) )
-        {
-            if(usGetTmrState(&pThis->sModeChangeTmr_8) != OS_TMR_STATE_RUNNING)
-            {
-                (void)xTimerRegist(&pThis->sModeChangeTmr_8, pThis->usModeChangeTime_8*60, 0, 
-                                    OS_OPT_TMR_ONE_SHOT, vSystem_ModeChangeTimeCallback, pThis, FALSE);
-                myprintf("xTimerRegist sModeChangeTmr_8 %d sAmbientIn_T %d\n", pThis->eRunningMode, sAmbientIn_T);                
-                return;
-            }
-        }
+        (void)xTimerCreate(MODE_TMR(pThis, ModeTransitionTable[n].usChangeTmr), OS_OPT_TMR_ONE_SHOT, 
+                           vSystem_ModeChangeTimeCallback, pThis);
+        (void)xTimerCreate(MODE_TMR(pThis, ModeTransitionTable[n].usPeriodTmr), OS_OPT_TMR_ONE_SHOT, 
+                           vSystem_ModeChangePeriodTimeCallback, pThis);
     }
+    memset(&pThis->sModeStats, 0, sizeof(sModeStats));
 }
 
 /*机组送风温度变化*/
@@ -466,25 +459,79 @@ void vSystem_UnitSupAirTemp(System* pt, ModularRoof* pModularRoof)
     }         
 }
 
-/*机组新风量变化*/
-void vSystem_UnitFreAir(System* pt)
+/*机组聚合初始化，按当前数值和故障状态计入*/
+void vSystem_InitUnitAgg(System* pt)
 {
-    uint8_t  n = 0; 
+    uint8_t n;
+    System* pThis = (System*)pt;
+
+    (void)xAggregateInit(&pThis->sUnitFreAirAgg,  AGG_MEAN, pThis->sUnitFreAirAggMember,  NULL, MODULAR_ROOF_NUM);
+    (void)xAggregateInit(&pThis->sUnitCO2Agg,     AGG_MEAN, pThis->sUnitCO2AggMember,     NULL, MODULAR_ROOF_NUM);
+    (void)xAggregateInit(&pThis->sUnitTempOutAgg, AGG_MEAN, pThis->sUnitTempOutAggMember, NULL, MODULAR_ROOF_NUM);
+    (void)xAggregateInit(&pThis->sUnitHumiOutAgg, AGG_MEAN, pThis->sUnitHumiOutAggMember, NULL, MODULAR_ROOF_NUM);
+    (void)xAggregateInit(&pThis->sUnitTempInAgg,  AGG_MEAN, pThis->sUnitTempInAggMember,  NULL, MODULAR_ROOF_NUM);
+    (void)xAggregateInit(&pThis->sUnitHumiInAgg,  AGG_MEAN, pThis->sUnitHumiInAggMember,  NULL, MODULAR_ROOF_NUM);
 
-    System*      pThis         = (System*)pt;
-    BMS*         psBMS         = BMS_Core();
-    ModularRoof* pModularRoof  = NULL;
-    uint32_t ulTotalFreAir_Vol = 0;
-    
     for(n=0; n < MODULAR_ROOF_NUM; n++)
     {
-        pModularRoof = pThis->psModularRoofList[n];
-        if(pModularRoof->xStopErrFlag == FALSE && pModularRoof->xCommErr == FALSE) //机组无故障
-        {    
-            ulTotalFreAir_Vol +=  pModularRoof->usFreAir_Vol;
-        }
+        vSystem_UnitUpdate(pThis, pThis->psModularRoofList[n]);
     }
-    pThis->ulTotalFreAir_Vol = ulTotalFreAir_Vol;
+}
+
+typedef struct   /*机组同帧快照*/
+{
+    ModularRoof* pModularRoof;
+    BOOL         xOnline, xStopErr;
+    uint16_t     usFreAir_Vol, usCO2PPM, usHumiOut, usHumiIn;
+    int16_t      sTempOut, sTempIn;
+}sUnitSnap;
+
+/*机组快照拷贝，由顺序锁读者调用*/
+static void vSystem_CopyUnitSnap(void* pvArg)
+{
+    sUnitSnap*   psSnap = (sUnitSnap*)pvArg;
+    ModularRoof* pModularRoof = psSnap->pModularRoof;
+
+    psSnap->xOnline      = (pModularRoof->xCommErr == FALSE) ? TRUE:FALSE;   //机组在线
+    psSnap->xStopErr     = pModularRoof->xStopErrFlag;
+    psSnap->usFreAir_Vol = pModularRoof->usFreAir_Vol;
+    psSnap->usCO2PPM     = pModularRoof->usCO2PPMSelf;
+    psSnap->sTempOut     = pModularRoof->sAmbientOutSelf_T;
+    psSnap->usHumiOut    = pModularRoof->usAmbientOutSelf_H;
+    psSnap->sTempIn      = pModularRoof->sAmbientInSelf_T;
+    psSnap->usHumiIn     = pModularRoof->usAmbientInSelf_H;
+}
+
+/*机组数据更新，按设备序号增量计入机组聚合。机组数据由主栈轮询任务写入，
+  按设备版本锁读取同一帧数据，不阻塞轮询*/
+void vSystem_UnitUpdate(System* pt, ModularRoof* pModularRoof)
+{
+    uint8_t   ucDevIndex;
+    sUnitSnap sSnap;
+    System*   pThis = (System*)pt;
+
+    sSnap.pModularRoof = pModularRoof;
+    (void)ulSeqReadCopy(&pModularRoof->sMBSlaveDev.sDataLock, vSystem_CopyUnitSnap, &sSnap);
+
+    ucDevIndex = pModularRoof->Device.ucDevIndex;
+
+    //新风量只统计无故障机组
+    vAggregateUpdate(&pThis->sUnitFreAirAgg,  ucDevIndex, sSnap.usFreAir_Vol,
+                     (sSnap.xOnline == TRUE && sSnap.xStopErr == FALSE) ? TRUE:FALSE);
+    vAggregateUpdate(&pThis->sUnitCO2Agg,     ucDevIndex, sSnap.usCO2PPM,  sSnap.xOnline);
+    vAggregateUpdate(&pThis->sUnitTempOutAgg, ucDevIndex, sSnap.sTempOut,  sSnap.xOnline);
+    vAggregateUpdate(&pThis->sUnitHumiOutAgg, ucDevIndex, sSnap.usHumiOut, sSnap.xOnline);
+    vAggregateUpdate(&pThis->sUnitTempInAgg,  ucDevIndex, sSnap.sTempIn,   sSnap.xOnline);
+    vAggregateUpdate(&pThis->sUnitHumiInAgg,  ucDevIndex, sSnap.usHumiIn,  sSnap.xOnline);
+}
+
+/*机组新风量变化*/
+void vSystem_UnitFreAir(System* pt)
+{
+    System* pThis = (System*)pt;
+    BMS*    psBMS = BMS_Core();
+
+    pThis->ulTotalFreAir_Vol = (uint32_t)pThis->sUnitFreAirAgg.lSum;   //无故障机组新风量之和
     psBMS->usTotalFreAir_Vol_H = pThis->ulTotalFreAir_Vol / 65535;
     psBMS->usTotalFreAir_Vol_L = pThis->ulTotalFreAir_Vol % 65535;
 }
@@ -492,29 +539,16 @@ void vSystem_UnitFreAir(System* pt)
 /*机组CO2浓度变化*/
 void vSystem_UnitCO2PPM(System* pt)
 { 
-    uint8_t  n, ucNum; 
-    uint16_t usTotalCO2PPM, usCO2PPM;   
-    
+    uint16_t usCO2PPM;
     System* pThis = (System*)pt;
     
-    ModularRoof* pModularRoof = NULL;
-    CO2Sensor*   pCO2Sensor   = NULL;
-    
     if(pThis->xCO2SenErr == TRUE)   //系统传感器故障，采用机组参数
     {
-        for(n=0; n < MODULAR_ROOF_NUM; n++)
-        {
-            pModularRoof = pThis->psModularRoofList[n];
-            if( pModularRoof->xCommErr == FALSE)  //机组在线
-            {
-                usTotalCO2PPM += pModularRoof->usCO2PPMSelf;
-                ucNum++;
-            }
-        }
-        if(ucNum != 0) 
+        if(pThis->sUnitCO2Agg.usCount == 0)   //机组均离线
         {
-            usCO2PPM  = usTotalCO2PPM / ucNum;    //机组CO2平均浓度
+            return;
         }
+        usCO2PPM = (uint16_t)lAggregateGetValue(&pThis->sUnitCO2Agg);    //机组CO2平均浓度
         if(pThis->usCO2PPM != usCO2PPM)
         {
             pThis->usCO2PPM = usCO2PPM;
@@ -535,34 +569,19 @@ void vSystem_UnitCO2PPM(System* pt)
 /*机组室外温湿度变化*/
 void vSystem_UnitTempHumiOut(System* pt)
 {
-    uint8_t  n, ucNum;
-    int16_t  sTotalTemp = 0; 
-    uint16_t usTotalHumi = 0;  
-    
     System* pThis = (System*)pt;
-    ModularRoof* pModularRoof = NULL;
  
     if( (pThis->xTempSenOutErr == TRUE) || (pThis->xHumiSenOutErr == TRUE) )   //系统传感器故障，采用机组参数
     {
-        for(n=0; n < MODULAR_ROOF_NUM; n++)
-        {
-            pModularRoof = pThis->psModularRoofList[n];
-            if(pModularRoof->xCommErr == FALSE)  //机组在线
-            {
-                sTotalTemp  +=  pModularRoof->sAmbientOutSelf_T;
-                usTotalHumi += pModularRoof->usAmbientOutSelf_H;
-                ucNum++;
-            }
-        }
-        if(ucNum != 0) 
+        if(pThis->sUnitTempOutAgg.usCount != 0)
         {
             if( pThis->xTempSenOutErr == TRUE)              
             {
-                pThis->sAmbientOut_T  = sTotalTemp / ucNum;    //机组室外平均环境温度
+                pThis->sAmbientOut_T  = (int16_t)lAggregateGetValue(&pThis->sUnitTempOutAgg);    //机组室外平均环境温度
             }
             if( pThis->xHumiSenOutErr == TRUE)      
             {
-                pThis->usAmbientOut_H  = usTotalHumi / ucNum;  //机组室外平均环境湿度
+                pThis->usAmbientOut_H = (uint16_t)lAggregateGetValue(&pThis->sUnitHumiOutAgg);   //机组室外平均环境湿度
             }
         }
     }
@@ -571,35 +590,25 @@ void vSystem_UnitTempHumiOut(System* pt)
 /*机组室内温湿度变化*/
 void vSystem_UnitTempHumiIn(System* pt)
 {
-    uint8_t  n, ucNum;
- 
-    int16_t  sTotalTemp, sAmbientIn_T; 
-    uint16_t usTotalHumi, usAmbientIn_H;  
-    
+    int16_t  sAmbientIn_T;
+    uint16_t usAmbientIn_H;
+
     System* pThis = (System*)pt;
-    ModularRoof* pModularRoof = NULL;
  
     if( (pThis->xTempSenInErr == TRUE) || (pThis->xHumiSenInErr == TRUE) )   //系统传感器故障，采用机组参数
     {
-        for(n=0, sTotalTemp=0, usTotalHumi=0; n < MODULAR_ROOF_NUM; n++)
-        {
-            pModularRoof = pThis->psModularRoofList[n];
-            if(pModularRoof->xCommErr == FALSE)  //机组在线
-            {
-                sTotalTemp  +=  pModularRoof->sAmbientInSelf_T;
-                usTotalHumi += pModularRoof->usAmbientInSelf_H;
-                ucNum++;;
-            }   
-        }
-        if(ucNum != 0) 
+        sAmbientIn_T  = pThis->sAmbientIn_T;
+        usAmbientIn_H = pThis->usAmbientIn_H;
+
+        if(pThis->sUnitTempInAgg.usCount != 0)
         {
             if( pThis->xTempSenInErr == TRUE)              
             {
-                sAmbientIn_T  = sTotalTemp / ucNum;     //机组室内平均环境温度
+                sAmbientIn_T  = (int16_t)lAggregateGetValue(&pThis->sUnitTempInAgg);    //机组室内平均环境温度
             }
             if( pThis->xHumiSenInErr == TRUE)      
             {
-                usAmbientIn_H  = usTotalHumi / ucNum;  //机组室内平均环境湿度
+                usAmbientIn_H = (uint16_t)lAggregateGetValue(&pThis->sUnitHumiInAgg);   //机组室内平均环境湿度
             }
         }
         if(pThis->sAmbientIn_T != sAmbientIn_T || pThis->usAmbientIn_H != usAmbientIn_H)